@@ -0,0 +1,132 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLScriptedModuleNode.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void CountEvents(vtkObject*, unsigned long, void* clientData, void*)
+{
+  int* counter = reinterpret_cast<int*>(clientData);
+  (*counter)++;
+}
+
+//-----------------------------------------------------------------------------
+int TestModifiedRequests(bool batchProcess)
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkMRMLScene> scene;
+  appLogic->SetMRMLScene(scene);
+  appLogic->SetBatchProcessRequests(batchProcess);
+
+  int numberOfBatchProcesses = 0;
+  vtkNew<vtkCallbackCommand> batchProcessCallback;
+  batchProcessCallback->SetCallback(CountEvents);
+  batchProcessCallback->SetClientData(&numberOfBatchProcesses);
+  scene->AddObserver(vtkMRMLScene::StartBatchProcessEvent, batchProcessCallback);
+
+  int numberOfNodeModifications = 0;
+  vtkNew<vtkCallbackCommand> modifiedCallback;
+  modifiedCallback->SetCallback(CountEvents);
+  modifiedCallback->SetClientData(&numberOfNodeModifications);
+
+  const int numberOfNodes = 100;
+  std::vector<vtkSmartPointer<vtkMRMLScriptedModuleNode> > nodes;
+  for (int i = 0; i < numberOfNodes; ++i)
+  {
+    vtkNew<vtkMRMLScriptedModuleNode> node;
+    scene->AddNode(node);
+    node->AddObserver(vtkCommand::ModifiedEvent, modifiedCallback);
+    nodes.push_back(node.GetPointer());
+  }
+
+  // Requests are rejected until the queues are active
+  CHECK_INT(appLogic->RequestModified(nodes[0]), 0);
+  appLogic->CreateProcessingThread();
+
+  // Each node is requested to be modified twice (non-consecutive requests)
+  for (int repeat = 0; repeat < 2; ++repeat)
+  {
+    for (int i = 0; i < numberOfNodes; ++i)
+    {
+      CHECK_BOOL(appLogic->RequestModified(nodes[i]) != 0, true);
+    }
+  }
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 2 * numberOfNodes);
+
+  appLogic->ProcessModified();
+  if (batchProcess)
+  {
+    // All requests are processed in one pass, each node is modified once
+    CHECK_INT(appLogic->GetModifiedQueueSize(), 0);
+    CHECK_INT(numberOfNodeModifications, numberOfNodes);
+    CHECK_INT(numberOfBatchProcesses, 1);
+    CHECK_INT(appLogic->GetNumberOfProcessedRequests(vtkSlicerApplicationLogic::RequestModifiedEvent), 2 * numberOfNodes);
+  }
+  else
+  {
+    // Only one request is processed per pass
+    CHECK_INT(appLogic->GetModifiedQueueSize(), 2 * numberOfNodes - 1);
+    CHECK_INT(numberOfNodeModifications, 1);
+    CHECK_INT(numberOfBatchProcesses, 0);
+    CHECK_INT(appLogic->GetNumberOfProcessedRequests(vtkSlicerApplicationLogic::RequestModifiedEvent), 1);
+    while (appLogic->GetModifiedQueueSize() > 0)
+    {
+      appLogic->ProcessModified();
+    }
+    CHECK_INT(numberOfNodeModifications, 2 * numberOfNodes);
+  }
+
+  CHECK_BOOL(appLogic->GetAverageRequestLatency(vtkSlicerApplicationLogic::RequestModifiedEvent) >= 0.0, true);
+  CHECK_BOOL(appLogic->GetMaximumRequestLatency(vtkSlicerApplicationLogic::RequestModifiedEvent)
+    >= appLogic->GetAverageRequestLatency(vtkSlicerApplicationLogic::RequestModifiedEvent), true);
+  CHECK_INT(appLogic->GetNumberOfProcessedRequests(vtkSlicerApplicationLogic::RequestReadDataEvent), 0);
+
+  appLogic->ResetRequestStatistics();
+  CHECK_INT(appLogic->GetNumberOfProcessedRequests(vtkSlicerApplicationLogic::RequestModifiedEvent), 0);
+  CHECK_DOUBLE(appLogic->GetMaximumRequestLatency(vtkSlicerApplicationLogic::RequestModifiedEvent), 0.0);
+
+  // Pending requests are released when the logic is deleted
+  appLogic->RequestModified(nodes[0]);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerApplicationLogicRequestTest(int , char * [])
+{
+  CHECK_EXIT_SUCCESS(TestModifiedRequests(false));
+  CHECK_EXIT_SUCCESS(TestModifiedRequests(true));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// ITKSYS includes
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+class vtkSlicerTaskTestLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkSlicerTaskTestLogic* New();
+  vtkTypeMacro(vtkSlicerTaskTestLogic, vtkMRMLAbstractLogic);
+
+  void RunTask(void* clientData)
+  {
+    std::string name(reinterpret_cast<const char*>(clientData));
+    if (name == "blocking")
+    {
+      this->BlockingTaskStarted = true;
+      while (!this->ReleaseBlockingTask)
+      {
+        itksys::SystemTools::Delay(1);
+      }
+    }
+    std::lock_guard<std::mutex> lock(this->Lock);
+    this->ExecutedTasks.push_back(name);
+  }
+
+  int GetNumberOfExecutedTasks()
+  {
+    std::lock_guard<std::mutex> lock(this->Lock);
+    return static_cast<int>(this->ExecutedTasks.size());
+  }
+
+  std::mutex Lock;
+  std::vector<std::string> ExecutedTasks;
+  std::atomic<bool> BlockingTaskStarted{ false };
+  std::atomic<bool> ReleaseBlockingTask{ false };
+
+protected:
+  vtkSlicerTaskTestLogic() = default;
+  ~vtkSlicerTaskTestLogic() override = default;
+};
+
+vtkStandardNewMacro(vtkSlicerTaskTestLogic);
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void ScheduleTestTask(vtkSlicerApplicationLogic* appLogic, vtkSlicerTaskTestLogic* logic,
+  const char* name, int type, int priority, bool cancel = false)
+{
+  vtkNew<vtkSlicerTask> task;
+  task->SetType(type);
+  task->SetPriority(priority);
+  task->SetTaskFunction(logic, (vtkSlicerTask::TaskFunctionPointer)&vtkSlicerTaskTestLogic::RunTask,
+    const_cast<char*>(name));
+  appLogic->ScheduleTask(task);
+  if (cancel)
+  {
+    task->Cancel();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool WaitForExecutedTasks(vtkSlicerTaskTestLogic* logic, int expectedNumberOfTasks)
+{
+  // Wait up to 10 seconds
+  for (int i = 0; i < 10000 && logic->GetNumberOfExecutedTasks() < expectedNumberOfTasks; ++i)
+  {
+    itksys::SystemTools::Delay(1);
+  }
+  return logic->GetNumberOfExecutedTasks() == expectedNumberOfTasks;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerApplicationLogicTaskTest(int , char * [])
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkSlicerTaskTestLogic> logic;
+
+  // Tasks are rejected until threads are created
+  vtkNew<vtkSlicerTask> task;
+  CHECK_INT(appLogic->ScheduleTask(task), 0);
+
+  appLogic->SetNumberOfProcessingThreads(1);
+  appLogic->CreateProcessingThread();
+
+  // Scheduled tasks start without polling delay
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  ScheduleTestTask(appLogic, logic, "first", vtkSlicerTask::Processing, 0);
+  CHECK_BOOL(WaitForExecutedTasks(logic, 1), true);
+  timer->StopTimer();
+  std::cout << "Task start latency: " << timer->GetElapsedTime() * 1000.0 << "ms" << std::endl;
+
+  // Block the processing thread
+  ScheduleTestTask(appLogic, logic, "blocking", vtkSlicerTask::Processing, 0);
+  while (!logic->BlockingTaskStarted)
+  {
+    itksys::SystemTools::Delay(1);
+  }
+  ScheduleTestTask(appLogic, logic, "low", vtkSlicerTask::Processing, 0);
+  ScheduleTestTask(appLogic, logic, "canceled", vtkSlicerTask::Processing, 5, true);
+  ScheduleTestTask(appLogic, logic, "high", vtkSlicerTask::Processing, 10);
+  CHECK_INT(appLogic->GetNumberOfPendingTasks(vtkSlicerTask::Processing), 3);
+
+  // Networking tasks are not blocked by processing tasks
+  ScheduleTestTask(appLogic, logic, "networking", vtkSlicerTask::Networking, 0);
+  CHECK_BOOL(WaitForExecutedTasks(logic, 2), true);
+  CHECK_STD_STRING(logic->ExecutedTasks[1], "networking");
+
+  // Pending tasks are executed by priority, canceled task is skipped
+  logic->ReleaseBlockingTask = true;
+  CHECK_BOOL(WaitForExecutedTasks(logic, 5), true);
+  CHECK_STD_STRING(logic->ExecutedTasks[2], "blocking");
+  CHECK_STD_STRING(logic->ExecutedTasks[3], "high");
+  CHECK_STD_STRING(logic->ExecutedTasks[4], "low");
+  CHECK_INT(appLogic->GetNumberOfPendingTasks(vtkSlicerTask::Processing), 0);
+
+  appLogic->TerminateProcessingThread();
+  CHECK_INT(appLogic->ScheduleTask(task), 0);
+
+  return EXIT_SUCCESS;
+}
@@ -34,6 +34,7 @@
 // VTK includes
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
 
 // ITKSYS includes
 #include <itksys/SystemTools.hxx>
@@ -47,13 +48,94 @@
 # include <sys/resource.h>
 #endif
 
+#include <map>
 #include <queue>
+#include <set>
 
 #include "vtkSlicerApplicationLogicRequests.h"
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
-class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
+/// Scheduled tasks, with a separate queue for each task type so that
+/// a task of one type never blocks tasks of another type.
+/// Within a queue, tasks are ordered by priority then by scheduling order.
+/// Access must be guarded by vtkSlicerApplicationLogic::ProcessingTaskQueueLock.
+class ProcessingTaskQueue
+{
+public:
+  void Push(vtkSlicerTask* task)
+  {
+    int taskType = task->GetType();
+    if (taskType == vtkSlicerTask::Undefined)
+    {
+      taskType = vtkSlicerTask::Processing;
+    }
+    this->Queues[taskType].push(QueuedTask(task, this->NextSequenceNumber++));
+  }
+
+  bool IsEmpty(int taskType)
+  {
+    return this->Queues[taskType].empty();
+  }
+
+  int GetSize(int taskType)
+  {
+    return static_cast<int>(this->Queues[taskType].size());
+  }
+
+  vtkSmartPointer<vtkSlicerTask> Pop(int taskType)
+  {
+    std::priority_queue<QueuedTask>& queue = this->Queues[taskType];
+    if (queue.empty())
+    {
+      return nullptr;
+    }
+    vtkSmartPointer<vtkSlicerTask> task = queue.top().Task;
+    queue.pop();
+    return task;
+  }
+
+  void Clear()
+  {
+    this->Queues.clear();
+  }
+
+private:
+  struct QueuedTask
+  {
+    QueuedTask(vtkSlicerTask* task, unsigned long sequenceNumber)
+      : Task(task)
+      , Priority(task->GetPriority())
+      , SequenceNumber(sequenceNumber)
+    {
+    }
+    // std::priority_queue returns the largest element first:
+    // higher priority first, then the one that was scheduled earlier.
+    bool operator<(const QueuedTask& other) const
+    {
+      if (this->Priority != other.Priority)
+      {
+        return this->Priority < other.Priority;
+      }
+      return this->SequenceNumber > other.SequenceNumber;
+    }
+    vtkSmartPointer<vtkSlicerTask> Task;
+    int Priority;
+    unsigned long SequenceNumber;
+  };
+
+  std::map<int, std::priority_queue<QueuedTask> > Queues;
+  unsigned long NextSequenceNumber{ 0 };
+};
+
+//----------------------------------------------------------------------------
+struct ModifiedRequest
+{
+  /// Object to modify, its reference count is incremented while it is in the queue
+  vtkObject* Object;
+  /// Time when the request was made (in seconds)
+  double RequestTime;
+};
+class ModifiedQueue : public std::queue<ModifiedRequest> {};
 class ReadDataQueue : public std::queue<DataRequest*> {};
 class WriteDataQueue : public std::queue<DataRequest*> {};
 
@@ -64,8 +146,9 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::PlatformMultiThreader::New();
-  this->ProcessingThreadId = -1;
   this->ProcessingThreadActive = false;
+  this->NumberOfProcessingThreads = 1;
+  this->NumberOfNetworkingThreads = 1;
 
   this->ModifiedQueueActive = false;
 
@@ -73,6 +156,8 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 
   this->WriteDataQueueActive = false;
 
+  this->BatchProcessRequests = false;
+
   this->InternalTaskQueue = new ProcessingTaskQueue;
   this->InternalModifiedQueue = new ModifiedQueue;
 
@@ -86,19 +171,11 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 {
   // Note that TerminateThread does not kill a thread, it only waits
-  // for the thread to finish.  We need to signal the thread that we
+  // for the thread to finish.  We need to signal the threads that we
   // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
+  if (this->ProcessingThreader)
   {
-    // Signal the processingThread that we are terminating.
-    this->ProcessingThreadActiveLock.lock();
-    this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock.unlock();
-
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-
-    this->ProcessingThreadId = -1;
+    this->TerminateProcessingThread();
   }
 
   delete this->InternalTaskQueue;
@@ -106,7 +183,7 @@ vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
   this->ModifiedQueueLock.lock();
   while (!(*this->InternalModifiedQueue).empty())
   {
-    vtkObject *obj = (*this->InternalModifiedQueue).front();
+    vtkObject *obj = (*this->InternalModifiedQueue).front().Object;
     (*this->InternalModifiedQueue).pop();
     obj->Delete(); // decrement ref count
   }
@@ -124,6 +201,94 @@ unsigned int vtkSlicerApplicationLogic::GetReadDataQueueSize()
   return static_cast<unsigned int>( (*this->InternalReadDataQueue).size() );
 }
 
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetModifiedQueueSize()
+{
+  std::lock_guard<std::mutex> lock(this->ModifiedQueueLock);
+  return static_cast<unsigned int>( (*this->InternalModifiedQueue).size() );
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetWriteDataQueueSize()
+{
+  std::lock_guard<std::mutex> lock(this->WriteDataQueueLock);
+  return static_cast<unsigned int>( (*this->InternalWriteDataQueue).size() );
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerApplicationLogic::RequestStatistics* vtkSlicerApplicationLogic::GetRequestStatistics(unsigned long requestEvent)
+{
+  switch (requestEvent)
+  {
+    case vtkSlicerApplicationLogic::RequestModifiedEvent: return &this->ModifiedRequestStatistics;
+    case vtkSlicerApplicationLogic::RequestReadDataEvent: return &this->ReadDataRequestStatistics;
+    case vtkSlicerApplicationLogic::RequestWriteDataEvent: return &this->WriteDataRequestStatistics;
+    default: return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::UpdateRequestStatistics(unsigned long requestEvent, double requestTime)
+{
+  RequestStatistics* statistics = this->GetRequestStatistics(requestEvent);
+  if (!statistics)
+  {
+    return;
+  }
+  double latency = vtkTimerLog::GetUniversalTime() - requestTime;
+  statistics->NumberOfProcessedRequests++;
+  statistics->TotalLatency += latency;
+  statistics->MaximumLatency = std::max(statistics->MaximumLatency, latency);
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSlicerApplicationLogic::GetNumberOfProcessedRequests(unsigned long requestEvent)
+{
+  RequestStatistics* statistics = this->GetRequestStatistics(requestEvent);
+  if (!statistics)
+  {
+    vtkErrorMacro("GetNumberOfProcessedRequests failed: invalid request event " << requestEvent);
+    return 0;
+  }
+  return statistics->NumberOfProcessedRequests;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetAverageRequestLatency(unsigned long requestEvent)
+{
+  RequestStatistics* statistics = this->GetRequestStatistics(requestEvent);
+  if (!statistics)
+  {
+    vtkErrorMacro("GetAverageRequestLatency failed: invalid request event " << requestEvent);
+    return 0.0;
+  }
+  if (statistics->NumberOfProcessedRequests == 0)
+  {
+    return 0.0;
+  }
+  return statistics->TotalLatency / statistics->NumberOfProcessedRequests;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetMaximumRequestLatency(unsigned long requestEvent)
+{
+  RequestStatistics* statistics = this->GetRequestStatistics(requestEvent);
+  if (!statistics)
+  {
+    vtkErrorMacro("GetMaximumRequestLatency failed: invalid request event " << requestEvent);
+    return 0.0;
+  }
+  return statistics->MaximumLatency;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ResetRequestStatistics()
+{
+  this->ModifiedRequestStatistics = RequestStatistics();
+  this->ReadDataRequestStatistics = RequestStatistics();
+  this->WriteDataRequestStatistics = RequestStatistics();
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::SetMRMLSceneDataIO(vtkMRMLScene* newMRMLScene,
                                                    vtkMRMLRemoteIOLogic *remoteIOLogic,
@@ -169,36 +334,27 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
   {
     this->ProcessingThreadActiveLock.lock();
     this->ProcessingThreadActive = true;
     this->ProcessingThreadActiveLock.unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
-
-    // Start four network threads (TODO: make the number of threads a setting)
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    /*
-     * TODO: it looks like curl is not thread safe by default
-     * - maybe there's a setting that cmcurl can have
-     *   similar to the --enable-threading of the standard curl build
-     *
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    */
+    for (int i = 0; i < this->NumberOfProcessingThreads; ++i)
+    {
+      this->ProcessingThreadIDs.push_back(this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                      this));
+    }
+
+    // Note: curl is not thread safe by default, therefore only a single
+    // networking thread is started by default.
+    for (int i = 0; i < this->NumberOfNetworkingThreads; ++i)
+    {
+      this->NetworkingThreadIDs.push_back(this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
+                      this));
+    }
 
     // Setup the communication channel back to the main thread
     this->ModifiedQueueActiveLock.lock();
@@ -221,7 +377,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
   {
     this->ModifiedQueueActiveLock.lock();
     this->ModifiedQueueActive = false;
@@ -239,21 +395,42 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock.unlock();
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    // Wake up all the worker threads. Acquiring the queue lock ensures that
+    // no thread is between checking the active flag and starting to wait.
+    {
+      std::lock_guard<std::mutex> lock(this->ProcessingTaskQueueLock);
+      this->InternalTaskQueue->Clear();
+    }
+    this->ProcessingTaskQueueCondition.notify_all();
 
-    std::vector<int>::const_iterator idIterator;
-    idIterator = this->NetworkingThreadIDs.begin();
-    while (idIterator != this->NetworkingThreadIDs.end())
+    for (int threadId : this->ProcessingThreadIDs)
     {
-      this->ProcessingThreader->TerminateThread( *idIterator );
-      ++idIterator;
+      this->ProcessingThreader->TerminateThread(threadId);
     }
-    this->NetworkingThreadIDs.clear();
+    this->ProcessingThreadIDs.clear();
 
+    for (int threadId : this->NetworkingThreadIDs)
+    {
+      this->ProcessingThreader->TerminateThread(threadId);
+    }
+    this->NetworkingThreadIDs.clear();
   }
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerApplicationLogic::IsProcessingThreadActive()
+{
+  std::lock_guard<std::mutex> lock(this->ProcessingThreadActiveLock);
+  return this->ProcessingThreadActive;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfPendingTasks(int taskType)
+{
+  std::lock_guard<std::mutex> lock(this->ProcessingTaskQueueLock);
+  return this->InternalTaskQueue->GetSize(taskType);
+}
+
 //----------------------------------------------------------------------------
 itk::ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic::ProcessingThreaderCallback(void* arg)
@@ -276,50 +453,10 @@ vtkSlicerApplicationLogic::ProcessingThreaderCallback(void* arg)
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = nullptr;
-
-  while (active)
-  {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock.lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock.unlock();
-
-    if (active)
-    {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-      {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-        {
-          (*this->InternalTaskQueue).pop();
-        }
-        else
-        {
-          task = nullptr;
-        }
-      }
-      this->ProcessingTaskQueueLock.unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-      {
-        task->Execute();
-        task = nullptr;
-      }
-    }
-
-    // busy wait
-    itksys::SystemTools::Delay(100);
-  }
+  this->ProcessTasks(vtkSlicerTask::Processing);
 }
 
+//----------------------------------------------------------------------------
 itk::ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic::NetworkingThreaderCallback(void* arg)
 {
@@ -341,45 +478,35 @@ vtkSlicerApplicationLogic::NetworkingThreaderCallback(void* arg)
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = nullptr;
+  this->ProcessTasks(vtkSlicerTask::Networking);
+}
 
-  while (active)
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessTasks(int taskType)
+{
+  while (true)
   {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock.lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock.unlock();
-
-    if (active)
+    vtkSmartPointer<vtkSlicerTask> task;
     {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-      {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-        {
-          (*this->InternalTaskQueue).pop();
-        }
-        else
+      // Sleep until a task is scheduled or the threads are terminated
+      std::unique_lock<std::mutex> lock(this->ProcessingTaskQueueLock);
+      bool active = true;
+      this->ProcessingTaskQueueCondition.wait(lock, [this, taskType, &active]
         {
-          task = nullptr;
-        }
-      }
-      this->ProcessingTaskQueueLock.unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
+          active = this->IsProcessingThreadActive();
+          return !active || !this->InternalTaskQueue->IsEmpty(taskType);
+        });
+      if (!active)
       {
-        task->Execute();
-        task = nullptr;
+        break;
       }
+      task = this->InternalTaskQueue->Pop(taskType);
     }
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+    if (task && !task->IsCanceled())
+    {
+      task->Execute();
+    }
   }
 }
 
@@ -395,9 +522,17 @@ int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
     return false;
   }
 
+  if (!task)
+  {
+    return false;
+  }
+
   this->ProcessingTaskQueueLock.lock();
-  (*this->InternalTaskQueue).push( task );
+  this->InternalTaskQueue->Push( task );
   this->ProcessingTaskQueueLock.unlock();
+  // Processing and networking threads wait on the same condition variable,
+  // therefore all of them are woken up and those without work go back to sleep.
+  this->ProcessingTaskQueueCondition.notify_all();
   return true;
 }
 
@@ -415,10 +550,13 @@ vtkMTimeType vtkSlicerApplicationLogic::RequestModified(vtkObject *obj)
   }
 
   obj->Register(this);
+  ModifiedRequest request;
+  request.Object = obj;
+  request.RequestTime = vtkTimerLog::GetUniversalTime();
   this->ModifiedQueueLock.lock();
   this->RequestTimeStamp.Modified();
   vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalModifiedQueue).push(obj);
+  (*this->InternalModifiedQueue).push(request);
   this->ModifiedQueueLock.unlock();
   return uid;
 }
@@ -556,6 +694,24 @@ vtkMTimeType vtkSlicerApplicationLogic::RequestReadScene(
   return uid;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ModifyObject(vtkObject* obj)
+{
+  vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(obj);
+  if (node)
+  {
+    // use Start/EndModify to also invoke all pending events that might have been
+    // accumulated because of previous use of SetDisableModifiedEvent (e.g., in itkMRMLIDImageIO).
+    bool wasModified = node->StartModify();
+    node->Modified();
+    node->EndModify(wasModified);
+  }
+  else
+  {
+    obj->Modified();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessModified()
 {
@@ -568,48 +724,51 @@ void vtkSlicerApplicationLogic::ProcessModified()
     return;
   }
 
-  vtkSmartPointer<vtkObject> obj = nullptr;
-  // pull an object off the queue to modify
+  // pull objects off the queue to modify: all of them in batch mode,
+  // otherwise only the first one (with its consecutive copies)
+  std::vector<vtkSmartPointer<vtkObject> > objectsToModify;
+  std::set<vtkObject*> objectsInBatch;
   this->ModifiedQueueLock.lock();
-  if ((*this->InternalModifiedQueue).size() > 0)
+  while (!(*this->InternalModifiedQueue).empty())
   {
-    obj = (*this->InternalModifiedQueue).front();
+    ModifiedRequest request = (*this->InternalModifiedQueue).front();
+    if (!this->BatchProcessRequests && !objectsToModify.empty()
+      && objectsToModify.back().GetPointer() != request.Object)
+    {
+      break;
+    }
     (*this->InternalModifiedQueue).pop();
-
+    this->UpdateRequestStatistics(vtkSlicerApplicationLogic::RequestModifiedEvent, request.RequestTime);
     // pop off any extra copies of the same object to save some updates
-    while (!(*this->InternalModifiedQueue).empty()
-           && (obj == (*this->InternalModifiedQueue).front()))
+    if (objectsInBatch.insert(request.Object).second)
     {
-      (*this->InternalModifiedQueue).pop();
-      obj->Delete(); // decrement ref count
+      objectsToModify.push_back(request.Object);
     }
+    // decrement reference count that was increased when it was added to the queue
+    request.Object->Delete();
   }
+  bool queueEmpty = (*this->InternalModifiedQueue).empty();
   this->ModifiedQueueLock.unlock();
 
-  // Modify the object
-  //  - decrement reference count that was increased when it was added to the queue
-  if (obj.GetPointer())
+  // Modify the objects
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  bool batchProcess = (scene && objectsToModify.size() > 1);
+  if (batchProcess)
   {
-    vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(obj);
-    if (node)
-    {
-      // use Start/EndModify to also invoke all pending events that might have been
-      // accumulated because of previous use of SetDisableModifiedEvent (e.g., in itkMRMLIDImageIO).
-      bool wasModified = node->StartModify();
-      node->Modified();
-      node->EndModify(wasModified);
-    }
-    else
-    {
-      obj->Modified();
-    }
-    obj->Delete();
-    obj = nullptr;
+    scene->StartState(vtkMRMLScene::BatchProcessState);
+  }
+  for (vtkObject* obj : objectsToModify)
+  {
+    this->ModifyObject(obj);
+  }
+  if (batchProcess)
+  {
+    scene->EndState(vtkMRMLScene::BatchProcessState);
   }
 
   // schedule the next timer sooner in case there is stuff in the queue
   // otherwise for a while later
-  int delay = (*this->InternalModifiedQueue).size() > 0 ? 0: 200;
+  int delay = queueEmpty ? 200 : 0;
   this->InvokeEvent(vtkSlicerApplicationLogic::RequestModifiedEvent, &delay);
 }
 
@@ -625,29 +784,46 @@ void vtkSlicerApplicationLogic::ProcessReadData()
     return;
   }
 
-  // pull an object off the queue
-  DataRequest* req = nullptr;
+  // pull requests off the queue: all of them in batch mode, otherwise only one
+  std::vector<DataRequest*> requests;
   this->ReadDataQueueLock.lock();
-  if ((*this->InternalReadDataQueue).size() > 0)
+  while (!(*this->InternalReadDataQueue).empty()
+    && (this->BatchProcessRequests || requests.empty()))
   {
-    req = (*this->InternalReadDataQueue).front();
+    requests.push_back((*this->InternalReadDataQueue).front());
     (*this->InternalReadDataQueue).pop();
   }
+  bool queueEmpty = (*this->InternalReadDataQueue).empty();
   this->ReadDataQueueLock.unlock();
 
-  vtkMTimeType uid = 0;
-  if (req)
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  bool batchProcess = (scene && requests.size() > 1);
+  if (batchProcess)
+  {
+    scene->StartState(vtkMRMLScene::BatchProcessState);
+  }
+  std::vector<vtkMTimeType> uids;
+  for (DataRequest* req : requests)
   {
-    uid = req->GetUID();
+    this->UpdateRequestStatistics(vtkSlicerApplicationLogic::RequestReadDataEvent, req->GetRequestTime());
+    vtkMTimeType uid = req->GetUID();
     req->Execute(this);
     delete req;
+    if (uid)
+    {
+      uids.push_back(uid);
+    }
+  }
+  if (batchProcess)
+  {
+    scene->EndState(vtkMRMLScene::BatchProcessState);
   }
 
-  int delay = (*this->InternalReadDataQueue).size() > 0 ? 0: 200;
+  int delay = queueEmpty ? 200 : 0;
   // schedule the next timer sooner in case there is stuff in the queue
   // otherwise for a while later
   this->InvokeEvent(vtkSlicerApplicationLogic::RequestReadDataEvent, &delay);
-  if (uid)
+  for (vtkMTimeType uid : uids)
   {
     this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
                       reinterpret_cast<void*>(uid));
@@ -666,32 +842,45 @@ void vtkSlicerApplicationLogic::ProcessWriteData()
     return;
   }
 
-  // pull an object off the queue
-  DataRequest *req = nullptr;
+  // pull requests off the queue: all of them in batch mode, otherwise only one
+  std::vector<DataRequest*> requests;
   this->WriteDataQueueLock.lock();
-  if ((*this->InternalWriteDataQueue).size() > 0)
+  while (!(*this->InternalWriteDataQueue).empty()
+    && (this->BatchProcessRequests || requests.empty()))
   {
-    req = (*this->InternalWriteDataQueue).front();
+    requests.push_back((*this->InternalWriteDataQueue).front());
     (*this->InternalWriteDataQueue).pop();
   }
+  bool queueEmpty = (*this->InternalWriteDataQueue).empty();
   this->WriteDataQueueLock.unlock();
 
-  if (req)
+  if (requests.empty())
+  {
+    return;
+  }
+
+  std::vector<vtkMTimeType> uids;
+  for (DataRequest* req : requests)
   {
+    this->UpdateRequestStatistics(vtkSlicerApplicationLogic::RequestWriteDataEvent, req->GetRequestTime());
     vtkMTimeType uid = req->GetUID();
     req->Execute(this);
     delete req;
-
-    // schedule the next timer sooner in case there is stuff in the queue
-    // otherwise for a while later
-    int delay = (*this->InternalWriteDataQueue).size() > 0 ? 0 : 200;
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestWriteDataEvent, &delay);
     if (uid)
     {
-      this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
-        reinterpret_cast<void*>(uid));
+      uids.push_back(uid);
     }
   }
+
+  // schedule the next timer sooner in case there is stuff in the queue
+  // otherwise for a while later
+  int delay = queueEmpty ? 200 : 0;
+  this->InvokeEvent(vtkSlicerApplicationLogic::RequestWriteDataEvent, &delay);
+  for (vtkMTimeType uid : uids)
+  {
+    this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
+      reinterpret_cast<void*>(uid));
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 #include <itkPlatformMultiThreader.h>
 
 // STL includes
+#include <condition_variable>
 #include <mutex>
 
 class vtkMRMLSelectionNode;
@@ -68,11 +69,28 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
                           vtkDataIOManagerLogic *dataIOManagerLogic);
 
 
-  /// Create a thread for processing
+  /// Create the threads for processing and networking tasks
+  /// \sa SetNumberOfProcessingThreads(), SetNumberOfNetworkingThreads()
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing and networking threads.
+  /// Tasks that are still in the queue are discarded.
   void TerminateProcessingThread();
+
+  /// Number of threads that execute vtkSlicerTask::Processing tasks.
+  /// Only used when threads are created by CreateProcessingThread(). Default is 1.
+  vtkSetClampMacro(NumberOfProcessingThreads, int, 1, 32);
+  vtkGetMacro(NumberOfProcessingThreads, int);
+
+  /// Number of threads that execute vtkSlicerTask::Networking tasks.
+  /// Only used when threads are created by CreateProcessingThread(). Default is 1.
+  vtkSetClampMacro(NumberOfNetworkingThreads, int, 1, 32);
+  vtkGetMacro(NumberOfNetworkingThreads, int);
+
+  /// Return the number of tasks of the specified type that are scheduled
+  /// but not started yet.
+  int GetNumberOfPendingTasks(int taskType);
+
   /// List of events potentially fired by the application logic
   enum RequestEvents
   {
@@ -86,9 +104,12 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
       RequestProcessedEvent
   };
 
-  /// Schedule a task to run in the processing thread. Returns true if
-  /// task was successfully scheduled. ScheduleTask() is called from the
-  /// main thread to run something in the processing thread.
+  /// Schedule a task to run in a processing or networking thread (depending
+  /// on the task type). Returns true if task was successfully scheduled.
+  /// ScheduleTask() is called from the main thread to run something in a
+  /// processing thread. An idle thread picks up the task immediately.
+  /// Tasks of vtkSlicerTask::Undefined type are run in processing threads.
+  /// \sa vtkSlicerTask::SetPriority(), vtkSlicerTask::Cancel()
   int ScheduleTask( vtkSlicerTask* );
 
   /// Request a Modified call on an object.  This method allows a
@@ -142,6 +163,37 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// multiple items are being returned and have all been returned).
   unsigned int GetReadDataQueueSize();
 
+  /// Return the number of Modified requests that are waiting to be processed.
+  unsigned int GetModifiedQueueSize();
+
+  /// Return the number of write requests that are waiting to be processed.
+  unsigned int GetWriteDataQueueSize();
+
+  /// If enabled, ProcessModified(), ProcessReadData() and ProcessWriteData()
+  /// process all pending requests in one pass instead of one request per timer event.
+  /// Multiple Modified requests of the same object are merged into one
+  /// and the scene is put in BatchProcessState while several Modified or read
+  /// requests are processed, so that observers update only once per pass.
+  /// Default is off.
+  vtkSetMacro(BatchProcessRequests, bool);
+  vtkGetMacro(BatchProcessRequests, bool);
+  vtkBooleanMacro(BatchProcessRequests, bool);
+
+  /// Return the number of processed requests since the last ResetRequestStatistics() call.
+  /// \a requestEvent is RequestModifiedEvent, RequestReadDataEvent, or RequestWriteDataEvent.
+  /// Merged Modified requests are counted individually.
+  unsigned long GetNumberOfProcessedRequests(unsigned long requestEvent);
+
+  /// Return the average and maximum time (in seconds) between a request and
+  /// the start of its processing on the main thread.
+  /// \a requestEvent is RequestModifiedEvent, RequestReadDataEvent, or RequestWriteDataEvent.
+  /// \sa ResetRequestStatistics()
+  double GetAverageRequestLatency(unsigned long requestEvent);
+  double GetMaximumRequestLatency(unsigned long requestEvent);
+
+  /// Reset request counters and latency measurements.
+  void ResetRequestStatistics();
+
 
   /// Request that data be written from a file to a remote destination.
   /// Return the request UID (monotonically increasing) of the request or 0 if
@@ -239,6 +291,13 @@ protected:
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
 
+  /// Task processing loop of a worker thread: waits for a task of \a taskType
+  /// to be scheduled and executes it, until threads are terminated.
+  void ProcessTasks(int taskType);
+
+  /// Thread-safe check if worker threads should keep running.
+  bool IsProcessingThreadActive();
+
   /// Process a request to read data into a scene.  This method is
   /// called by ProcessReadData() in the application main thread
   /// because calls to load data will cause a Modified() on a node
@@ -246,6 +305,22 @@ protected:
   void ProcessReadSceneData( ReadDataRequest &req );
   void ProcessWriteSceneData( WriteDataRequest &req );
 
+  /// Apply a Modified request on an object
+  void ModifyObject(vtkObject* obj);
+
+  struct RequestStatistics
+  {
+    unsigned long NumberOfProcessedRequests{ 0 };
+    double TotalLatency{ 0.0 };
+    double MaximumLatency{ 0.0 };
+  };
+
+  /// Return statistics of the queue identified by \a requestEvent, nullptr if invalid.
+  RequestStatistics* GetRequestStatistics(unsigned long requestEvent);
+
+  /// Record that a request that was issued at \a requestTime is now processed.
+  void UpdateRequestStatistics(unsigned long requestEvent, double requestTime);
+
   /// Set background thread (background processing, networking) priority, which
   /// can be set via an environment variable SLICER_BACKGROUND_THREAD_PRIORITY.
   /// Value of the variable must be an integer
@@ -259,6 +334,8 @@ private:
   itk::PlatformMultiThreader::Pointer ProcessingThreader;
   std::mutex ProcessingThreadActiveLock;
   std::mutex ProcessingTaskQueueLock;
+  /// Signaled when a task is scheduled or worker threads are terminated
+  std::condition_variable ProcessingTaskQueueCondition;
   std::mutex ModifiedQueueActiveLock;
   std::mutex ModifiedQueueLock;
   std::mutex ReadDataQueueActiveLock;
@@ -266,12 +343,20 @@ private:
   std::mutex WriteDataQueueActiveLock;
   std::mutex WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
   std::vector<int> NetworkingThreadIDs;
+  int NumberOfProcessingThreads;
+  int NumberOfNetworkingThreads;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
   int ReadDataQueueActive;
   int WriteDataQueueActive;
+  bool BatchProcessRequests;
+
+  /// Request statistics are only accessed from the main thread
+  RequestStatistics ModifiedRequestStatistics;
+  RequestStatistics ReadDataRequestStatistics;
+  RequestStatistics WriteDataRequestStatistics;
 
   ProcessingTaskQueue* InternalTaskQueue;
   ModifiedQueue*       InternalModifiedQueue;
@@ -19,6 +19,9 @@
 #include <vtkMRMLSubjectHierarchyNode.h>
 #include <vtkMRMLTableNode.h>
 
+// VTK includes
+#include <vtkTimerLog.h>
+
 //----------------------------------------------------------------------------
 class DataRequest
 {
@@ -26,11 +29,13 @@ public:
   DataRequest()
   {
     m_UID = 0;
+    m_RequestTime = vtkTimerLog::GetUniversalTime();
   }
 
   DataRequest(int uid)
   {
     m_UID = uid;
+    m_RequestTime = vtkTimerLog::GetUniversalTime();
   }
 
   virtual ~DataRequest()  = default;
@@ -39,8 +44,12 @@ public:
 
   int GetUID()const{return m_UID;}
 
+  /// Time when the request was made (in seconds)
+  double GetRequestTime()const{return m_RequestTime;}
+
 protected:
   vtkMTimeType m_UID;
+  double m_RequestTime;
 };
 
 //----------------------------------------------------------------------------
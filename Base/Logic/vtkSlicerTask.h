@@ -6,6 +6,9 @@
 #include "vtkMRMLAbstractLogic.h"
 #include "vtkSlicerBaseLogic.h"
 
+// STD includes
+#include <atomic>
+
 class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerTask : public vtkObject
 {
 public:
@@ -38,6 +41,19 @@ public:
   void SetTypeToProcessing() {this->SetType(vtkSlicerTask::Processing);};
   void SetTypeToNetworking() {this->SetType(vtkSlicerTask::Networking);};
 
+  ///
+  /// Priority of the task. Among scheduled tasks of the same type, the task with
+  /// the highest priority is executed first. Tasks of the same priority are
+  /// executed in the order they were scheduled. Default is 0.
+  vtkSetMacro(Priority, int);
+  vtkGetMacro(Priority, int);
+
+  ///
+  /// Request cancellation of the task. A task that is canceled before a
+  /// worker thread picks it up is discarded without being executed.
+  void Cancel() { this->Canceled = true; };
+  bool IsCanceled() { return this->Canceled; };
+
   const char* GetTypeAsString( ) {
     switch (this->Type)
     {
@@ -60,6 +76,8 @@ private:
   void *TaskClientData;
 
   int Type;
+  int Priority;
+  std::atomic<bool> Canceled;
 
 };
 #endif
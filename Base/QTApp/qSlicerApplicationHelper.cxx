@@ -34,6 +34,7 @@
 #ifdef Slicer_BUILD_CLI_SUPPORT
 # include "qSlicerCLIExecutableModuleFactory.h"
 # include "qSlicerCLILoadableModuleFactory.h"
+# include "qSlicerCLIModuleDescriptionCache.h"
 #endif
 #include "qSlicerCommandOptions.h"
 #include "qSlicerCoreModuleFactory.h"
@@ -178,12 +179,26 @@ void qSlicerApplicationHelper::setupModuleFactoryManager(qSlicerModuleFactoryMan
     // main process. See more information in https://github.com/Slicer/Slicer/issues/4893.
     const bool preferExecutableCLIs = true;
 
+    // Retrieving module descriptions requires running each CLI executable or loading each CLI library,
+    // which is slow. Descriptions are cached between sessions unless "Modules/CacheCLIModuleDescriptions"
+    // is disabled in the settings.
+    qSlicerCLIModuleDescriptionCache* cliDescriptionCache = nullptr;
+    if (app->revisionUserSettings()->value("Modules/CacheCLIModuleDescriptions", true).toBool())
+    {
+      cliDescriptionCache = new qSlicerCLIModuleDescriptionCache(moduleFactoryManager);
+      cliDescriptionCache->setFilePath(qSlicerCLIModuleDescriptionCache::defaultFilePath());
+      QObject::connect(moduleFactoryManager, SIGNAL(modulesInstantiated(QStringList)),
+                       cliDescriptionCache, SLOT(save()));
+    }
+
     qSlicerCLILoadableModuleFactory* cliLoadableFactory = new qSlicerCLILoadableModuleFactory();
     cliLoadableFactory->setTempDirectory(tempDirectory);
+    cliLoadableFactory->setDescriptionCache(cliDescriptionCache);
     moduleFactoryManager->registerFactory(cliLoadableFactory, preferExecutableCLIs ? 0 : 1);
 
     qSlicerCLIExecutableModuleFactory* cliExecutableFactory = new qSlicerCLIExecutableModuleFactory();
     cliExecutableFactory->setTempDirectory(tempDirectory);
+    cliExecutableFactory->setDescriptionCache(cliDescriptionCache);
     moduleFactoryManager->registerFactory(cliExecutableFactory, preferExecutableCLIs ? 1 : 0);
 
     if (!options->disableBuiltInModules() &&
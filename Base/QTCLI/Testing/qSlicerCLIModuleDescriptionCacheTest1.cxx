@@ -0,0 +1,91 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+// CTK includes
+#include <ctkCoreTestingMacros.h>
+
+// Slicer includes
+#include <qSlicerCLIModuleDescriptionCache.h>
+
+// STD includes
+#include <cstdlib>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+bool writeFile(const QString& filePath, const QByteArray& content)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  return file.write(content) == content.size();
+}
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIModuleDescriptionCacheTest1(int, char * [] )
+{
+  QTemporaryDir tempDir;
+  CHECK_BOOL(tempDir.isValid(), true);
+  QString cacheFilePath = QDir(tempDir.path()).filePath("CLIModuleDescriptions.cache");
+  QString modulePath = QDir(tempDir.path()).filePath("CLIModule");
+  QString xmlDescription = "<executable><title>CLIModule</title></executable>";
+  CHECK_BOOL(writeFile(modulePath, "module"), true);
+
+  QString cachedXmlDescription;
+  {
+    // Caching is disabled without file path
+    qSlicerCLIModuleDescriptionCache cache;
+    cache.setDescription(modulePath, xmlDescription);
+    CHECK_BOOL(cache.description(modulePath, cachedXmlDescription), false);
+  }
+  {
+    qSlicerCLIModuleDescriptionCache cache;
+    cache.setFilePath(cacheFilePath);
+    CHECK_BOOL(cache.description(modulePath, cachedXmlDescription), false);
+    CHECK_INT(cache.missCount(), 1);
+    cache.setDescription(modulePath, xmlDescription);
+    CHECK_BOOL(cache.description(modulePath, cachedXmlDescription), true);
+    CHECK_QSTRING(cachedXmlDescription, xmlDescription);
+    CHECK_INT(cache.hitCount(), 1);
+    CHECK_BOOL(cache.save(), true);
+    CHECK_BOOL(QFile::exists(cacheFilePath), true);
+  }
+  {
+    // Entries are read back from the cache file
+    qSlicerCLIModuleDescriptionCache cache;
+    cache.setFilePath(cacheFilePath);
+    cachedXmlDescription.clear();
+    CHECK_BOOL(cache.description(modulePath, cachedXmlDescription), true);
+    CHECK_QSTRING(cachedXmlDescription, xmlDescription);
+  }
+  {
+    // Entry is outdated after the module file changed
+    CHECK_BOOL(writeFile(modulePath, "modified module"), true);
+    qSlicerCLIModuleDescriptionCache cache;
+    cache.setFilePath(cacheFilePath);
+    CHECK_BOOL(cache.description(modulePath, cachedXmlDescription), false);
+    CHECK_INT(cache.missCount(), 1);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slicer includes
+#include <vtkSlicerCLIModuleLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+class vtkSlicerCLIModuleTestLogic : public vtkSlicerCLIModuleLogic
+{
+public:
+  static vtkSlicerCLIModuleTestLogic* New();
+  vtkTypeMacro(vtkSlicerCLIModuleTestLogic, vtkSlicerCLIModuleLogic);
+
+  using vtkSlicerCLIModuleLogic::CreateSharedMemoryTransferDirectory;
+};
+vtkStandardNewMacro(vtkSlicerCLIModuleTestLogic);
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogicTest1(int, char * [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkSlicerCLIModuleTestLogic> logic;
+  logic->SetMRMLScene(scene);
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(128, 128, 64);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_NOT_NULL(volumeNode);
+  volumeNode->SetAndObserveImageData(imageData);
+  std::vector<std::string> inputNodeIDs;
+  inputNodeIDs.push_back(volumeNode->GetID());
+
+  // Shared memory transfer is disabled
+  logic->SetAllowSharedMemoryTransfer(0);
+  CHECK_STD_STRING(logic->CreateSharedMemoryTransferDirectory(inputNodeIDs, 1), "");
+  logic->SetAllowSharedMemoryTransfer(1);
+
+  std::string directory = logic->CreateSharedMemoryTransferDirectory(inputNodeIDs, 1);
+  if (directory.empty())
+  {
+    std::cout << "Shared memory transfer is not available on this system" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  CHECK_BOOL(vtksys::SystemTools::FileIsDirectory(directory), true);
+#ifndef _WIN32
+  // Transferred data may contain patient information, only the current user
+  // may access the directory.
+  struct stat directoryStatus;
+  CHECK_INT(stat(directory.c_str(), &directoryStatus), 0);
+  CHECK_INT(static_cast<int>(directoryStatus.st_mode & 0777), 0700);
+#endif
+
+  // Each module execution gets its own directory
+  std::string otherDirectory = logic->CreateSharedMemoryTransferDirectory(inputNodeIDs, 1);
+  CHECK_BOOL(otherDirectory.empty(), false);
+  CHECK_BOOL(otherDirectory != directory, true);
+
+  CHECK_BOOL(static_cast<bool>(vtksys::SystemTools::RemoveADirectory(directory)), true);
+  CHECK_BOOL(static_cast<bool>(vtksys::SystemTools::RemoveADirectory(otherDirectory)), true);
+
+  // Data size is estimated from the input nodes: outputs that would not fit
+  // in shared memory are exchanged through the temporary directory.
+  CHECK_STD_STRING(logic->CreateSharedMemoryTransferDirectory(inputNodeIDs, 1 << 30), "");
+
+  // Outputs are not accounted for without inputs
+  std::string emptyInputDirectory = logic->CreateSharedMemoryTransferDirectory(std::vector<std::string>(), 1 << 30);
+  CHECK_BOOL(emptyInputDirectory.empty(), false);
+  CHECK_BOOL(static_cast<bool>(vtksys::SystemTools::RemoveADirectory(emptyInputDirectory)), true);
+
+  return EXIT_SUCCESS;
+}
@@ -25,6 +25,7 @@
 // Slicer includes
 #include "qSlicerCLIExecutableModuleFactory.h"
 #include "qSlicerCLIModule.h"
+#include "qSlicerCLIModuleDescriptionCache.h"
 #include "qSlicerCLIModuleFactoryHelper.h"
 #include "qSlicerUtils.h"
 #include <vtkSlicerCLIModuleLogic.h>
@@ -49,8 +50,9 @@ QString findPython()
 
 //-----------------------------------------------------------------------------
 qSlicerCLIExecutableModuleFactoryItem::qSlicerCLIExecutableModuleFactoryItem(
-  const QString& newTempDirectory)
+  const QString& newTempDirectory, qSlicerCLIModuleDescriptionCache* descriptionCache)
   : TempDirectory(newTempDirectory)
+  , DescriptionCache(descriptionCache)
   , CLIModule(nullptr)
 {
 }
@@ -98,7 +100,8 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
 
   //
   // If the xml file exists, read it and associate it with the module
-  // description. If not, run the CLI executable with "--xml".
+  // description. If not, use the description cached at a previous startup
+  // or run the CLI executable with "--xml".
   //
   QString xmlDescription;
   if (QFile::exists(xmlFilePath))
@@ -114,9 +117,14 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
       this->appendInstantiateErrorString(qSlicerCLIModule::tr("Failed to read XML Description"));
     }
   }
-  else
+  else if (!this->DescriptionCache
+           || !this->DescriptionCache->description(this->path(), xmlDescription))
   {
     xmlDescription = this->runCLIWithXmlArgument();
+    if (this->DescriptionCache && !xmlDescription.isEmpty())
+    {
+      this->DescriptionCache->setDescription(this->path(), xmlDescription);
+    }
   }
   if (xmlDescription.isEmpty())
   {
@@ -235,6 +243,7 @@ public:
 
 private:
   QString TempDirectory;
+  QPointer<qSlicerCLIModuleDescriptionCache> DescriptionCache;
 };
 
 //-----------------------------------------------------------------------------
@@ -285,7 +294,7 @@ ctkAbstractFactoryItem<qSlicerAbstractCoreModule>* qSlicerCLIExecutableModuleFac
 ::createFactoryFileBasedItem()
 {
   Q_D(qSlicerCLIExecutableModuleFactory);
-  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory);
+  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory, d->DescriptionCache);
 }
 
 //-----------------------------------------------------------------------------
@@ -300,3 +309,17 @@ void qSlicerCLIExecutableModuleFactory::setTempDirectory(const QString& newTempD
   Q_D(qSlicerCLIExecutableModuleFactory);
   d->TempDirectory = newTempDirectory;
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::setDescriptionCache(qSlicerCLIModuleDescriptionCache* descriptionCache)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  d->DescriptionCache = descriptionCache;
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCLIModuleDescriptionCache* qSlicerCLIExecutableModuleFactory::descriptionCache()const
+{
+  Q_D(const qSlicerCLIExecutableModuleFactory);
+  return d->DescriptionCache;
+}
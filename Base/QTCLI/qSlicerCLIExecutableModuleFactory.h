@@ -25,6 +25,10 @@
 #include "qSlicerAbstractCoreModule.h"
 #include "qSlicerBaseQTCLIExport.h"
 class qSlicerCLIModule;
+class qSlicerCLIModuleDescriptionCache;
+
+// Qt includes
+#include <QPointer>
 
 // CTK includes
 #include <ctkPimpl.h>
@@ -35,7 +39,8 @@ class qSlicerCLIExecutableModuleFactoryItem
   : public ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>
 {
 public:
-  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory);
+  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory,
+                                        qSlicerCLIModuleDescriptionCache* descriptionCache = nullptr);
   bool load() override;
   void uninstantiate() override;
 protected:
@@ -46,6 +51,7 @@ protected:
   QString runCLIWithXmlArgument();
 private:
   QString TempDirectory;
+  QPointer<qSlicerCLIModuleDescriptionCache> DescriptionCache;
   qSlicerCLIModule* CLIModule;
 };
 
@@ -71,6 +77,11 @@ public:
 
   void setTempDirectory(const QString& newTempDirectory);
 
+  /// Set the cache used to avoid running the executables with "--xml"
+  /// to retrieve the module descriptions. Caching is disabled if nullptr (default).
+  void setDescriptionCache(qSlicerCLIModuleDescriptionCache* descriptionCache);
+  qSlicerCLIModuleDescriptionCache* descriptionCache()const;
+
 protected:
   bool isValidFile(const QFileInfo& file)const override;
 
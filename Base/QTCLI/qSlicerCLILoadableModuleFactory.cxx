@@ -23,6 +23,7 @@
 // Slicer includes
 #include "qSlicerCLILoadableModuleFactory.h"
 #include "qSlicerCLIModule.h"
+#include "qSlicerCLIModuleDescriptionCache.h"
 #include "qSlicerCLIModuleFactoryHelper.h"
 #include "qSlicerUtils.h"
 
@@ -31,18 +32,40 @@
 
 //-----------------------------------------------------------------------------
 qSlicerCLILoadableModuleFactoryItem::qSlicerCLILoadableModuleFactoryItem(
-  const QString& newTempDirectory) : TempDirectory(newTempDirectory)
+  const QString& newTempDirectory, qSlicerCLIModuleDescriptionCache* descriptionCache)
+  : TempDirectory(newTempDirectory)
+  , DescriptionCache(descriptionCache)
 {
 }
 
 //-----------------------------------------------------------------------------
 bool qSlicerCLILoadableModuleFactoryItem::load()
 {
-  // If XML description file exists, skip loading. It will be
-  // lazily done by calling ModuleDescription::GetTarget() method.
-  if (!QFile::exists(this->xmlModuleDescriptionFilePath()))
+  // If XML description file exists or the description is cached, skip loading.
+  // It will be lazily done by calling ModuleDescription::GetTarget() method.
+  QString cachedXmlDescription;
+  if (!QFile::exists(this->xmlModuleDescriptionFilePath())
+      && (!this->DescriptionCache
+          || !this->DescriptionCache->description(this->path(), cachedXmlDescription)))
   {
-    return this->Superclass::load();
+    if (!this->Superclass::load())
+    {
+      return false;
+    }
+    if (this->DescriptionCache)
+    {
+      // Cache the description right away: if an executable of the same module
+      // takes precedence then this item is never instantiated, but the library
+      // would still be loaded at each startup just to be registered.
+      const char* xmlDescription = reinterpret_cast<const char*>(this->symbolAddress("XMLModuleDescription"));
+      if (xmlDescription)
+      {
+        ModuleLogo logo;
+        this->updateLogo(this, logo);
+        this->DescriptionCache->setDescription(this->path(), QString(xmlDescription), &logo);
+      }
+    }
+    return true;
   }
   else
   {
@@ -95,10 +118,14 @@ qSlicerAbstractCoreModule* qSlicerCLILoadableModuleFactoryItem::instanciator()
   // description. The "ModuleEntryPoint" address will be lazily retrieved
   // after calling ModuleDescription::GetTarget() method.
   //
-  // If not, directly resolve the symbols "XMLModuleDescription" and
+  // If not, use the description and logo cached at a previous startup, the
+  // same way as the xml file.
+  //
+  // Otherwise, directly resolve the symbols "XMLModuleDescription" and
   // "ModuleEntryPoint" from the loaded library.
   //
   QString xmlDescription;
+  ModuleLogo cachedLogo;
   if (QFile::exists(xmlFilePath))
   {
     QFile xmlFile(xmlFilePath);
@@ -116,6 +143,13 @@ qSlicerAbstractCoreModule* qSlicerCLILoadableModuleFactoryItem::instanciator()
     module->moduleDescription().SetTargetCallback(
           this, qSlicerCLILoadableModuleFactoryItem::loadLibraryAndResolveSymbols);
   }
+  else if (this->DescriptionCache
+           && this->DescriptionCache->description(this->path(), xmlDescription, &cachedLogo))
+  {
+    // Set callback to allow lazy loading of target symbols.
+    module->moduleDescription().SetTargetCallback(
+          this, qSlicerCLILoadableModuleFactoryItem::loadLibraryAndResolveSymbols);
+  }
   else
   {
     // Library is expected to already be loaded
@@ -134,6 +168,10 @@ qSlicerAbstractCoreModule* qSlicerCLILoadableModuleFactoryItem::instanciator()
   module->setModuleType("SharedObjectModule");
 
   module->setXmlModuleDescription(xmlDescription);
+  if (cachedLogo.GetBufferLength() > 0)
+  {
+    module->setLogo(cachedLogo);
+  }
   module->setTempDirectory(this->TempDirectory);
   module->setPath(this->path());
   module->setInstalled(qSlicerCLIModuleFactoryHelper::isInstalled(this->path()));
@@ -270,6 +308,7 @@ public:
 
 private:
   QString TempDirectory;
+  QPointer<qSlicerCLIModuleDescriptionCache> DescriptionCache;
 };
 
 //-----------------------------------------------------------------------------
@@ -314,7 +353,7 @@ ctkAbstractFactoryItem<qSlicerAbstractCoreModule>* qSlicerCLILoadableModuleFacto
 createFactoryFileBasedItem()
 {
   Q_D(qSlicerCLILoadableModuleFactory);
-  return new qSlicerCLILoadableModuleFactoryItem(d->TempDirectory);
+  return new qSlicerCLILoadableModuleFactoryItem(d->TempDirectory, d->DescriptionCache);
 }
 
 //-----------------------------------------------------------------------------
@@ -330,6 +369,20 @@ void qSlicerCLILoadableModuleFactory::setTempDirectory(const QString& newTempDir
   d->TempDirectory = newTempDirectory;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCLILoadableModuleFactory::setDescriptionCache(qSlicerCLIModuleDescriptionCache* descriptionCache)
+{
+  Q_D(qSlicerCLILoadableModuleFactory);
+  d->DescriptionCache = descriptionCache;
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCLIModuleDescriptionCache* qSlicerCLILoadableModuleFactory::descriptionCache()const
+{
+  Q_D(const qSlicerCLILoadableModuleFactory);
+  return d->DescriptionCache;
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCLILoadableModuleFactory::isValidFile(const QFileInfo& file)const
 {
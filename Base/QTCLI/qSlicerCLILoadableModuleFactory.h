@@ -22,6 +22,9 @@
 #ifndef __qSlicerCLILoadableModuleFactory_h
 #define __qSlicerCLILoadableModuleFactory_h
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkPimpl.h>
 #include <ctkAbstractLibraryFactory.h>
@@ -33,6 +36,7 @@
 class ModuleDescription;
 class ModuleLogo;
 class qSlicerCLIModule;
+class qSlicerCLIModuleDescriptionCache;
 
 //-----------------------------------------------------------------------------
 class qSlicerCLILoadableModuleFactoryItem
@@ -40,7 +44,8 @@ class qSlicerCLILoadableModuleFactoryItem
 {
 public:
   typedef ctkFactoryLibraryItem<qSlicerAbstractCoreModule> Superclass;
-  qSlicerCLILoadableModuleFactoryItem(const QString& newTempDirectory);
+  qSlicerCLILoadableModuleFactoryItem(const QString& newTempDirectory,
+                                      qSlicerCLIModuleDescriptionCache* descriptionCache = nullptr);
   bool load() override;
 
   static void loadLibraryAndResolveSymbols(
@@ -56,6 +61,7 @@ protected:
   static bool updateLogo(qSlicerCLILoadableModuleFactoryItem* item, ModuleLogo& logo);
 private:
   QString TempDirectory;
+  QPointer<qSlicerCLIModuleDescriptionCache> DescriptionCache;
 };
 
 class qSlicerCLILoadableModuleFactoryPrivate;
@@ -82,6 +88,11 @@ public:
 
   void setTempDirectory(const QString& newTempDirectory);
 
+  /// Set the cache used to avoid loading the libraries at startup
+  /// to retrieve the module descriptions. Caching is disabled if nullptr (default).
+  void setDescriptionCache(qSlicerCLIModuleDescriptionCache* descriptionCache);
+  qSlicerCLIModuleDescriptionCache* descriptionCache()const;
+
 protected:
   ctkAbstractFactoryItem<qSlicerAbstractCoreModule>*
     createFactoryFileBasedItem() override;
@@ -0,0 +1,316 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+// Slicer includes
+#include "qSlicerCLIModuleDescriptionCache.h"
+#include "qSlicerCoreApplication.h"
+
+// SlicerExecutionModel includes
+#include <ModuleLogo.h>
+
+namespace
+{
+// Identifies the file type ("SCDC") and the layout of the entries
+const quint32 CacheFileMagic = 0x53434443;
+const qint32 CacheFileVersion = 1;
+}
+
+//-----------------------------------------------------------------------------
+class qSlicerCLIModuleDescriptionCachePrivate
+{
+  Q_DECLARE_PUBLIC(qSlicerCLIModuleDescriptionCache);
+protected:
+  qSlicerCLIModuleDescriptionCache* const q_ptr;
+public:
+  qSlicerCLIModuleDescriptionCachePrivate(qSlicerCLIModuleDescriptionCache& object);
+
+  struct Entry
+  {
+    qint64 FileSize{ -1 };
+    qint64 LastModified{ -1 };
+    QString XmlDescription;
+    QByteArray Logo;
+    qint32 LogoWidth{ 0 };
+    qint32 LogoHeight{ 0 };
+    qint32 LogoPixelSize{ 0 };
+    qint32 LogoOptions{ 0 };
+  };
+
+  /// Read all entries from the cache file, if not read yet
+  void loadIfNeeded();
+  /// Returns true if the module file still has the size and modification time stored in the entry
+  static bool isUpToDate(const QFileInfo& moduleFile, const Entry& entry);
+
+  QString FilePath;
+  QHash<QString, Entry> Entries;
+  bool Loaded{ false };
+  bool Modified{ false };
+  int HitCount{ 0 };
+  int MissCount{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+qSlicerCLIModuleDescriptionCachePrivate::qSlicerCLIModuleDescriptionCachePrivate(qSlicerCLIModuleDescriptionCache& object)
+  : q_ptr(&object)
+{
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIModuleDescriptionCachePrivate::loadIfNeeded()
+{
+  if (this->Loaded)
+  {
+    return;
+  }
+  this->Loaded = true;
+  this->Entries.clear();
+  if (this->FilePath.isEmpty())
+  {
+    return;
+  }
+  QFile file(this->FilePath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    // not an error, the cache file is created at the first save
+    return;
+  }
+  // read the whole file at once, parsing from memory is much faster than many small reads
+  QByteArray content = file.readAll();
+  file.close();
+
+  QDataStream stream(content);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 magic = 0;
+  qint32 version = 0;
+  qint32 numberOfEntries = 0;
+  stream >> magic >> version >> numberOfEntries;
+  if (stream.status() != QDataStream::Ok
+      || magic != CacheFileMagic || version != CacheFileVersion || numberOfEntries < 0)
+  {
+    qWarning() << "qSlicerCLIModuleDescriptionCache: ignoring invalid cache file" << this->FilePath;
+    return;
+  }
+  QHash<QString, Entry> entries;
+  entries.reserve(numberOfEntries);
+  for (qint32 entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+  {
+    QString modulePath;
+    Entry entry;
+    stream >> modulePath >> entry.FileSize >> entry.LastModified >> entry.XmlDescription
+           >> entry.Logo >> entry.LogoWidth >> entry.LogoHeight >> entry.LogoPixelSize >> entry.LogoOptions;
+    if (stream.status() != QDataStream::Ok)
+    {
+      qWarning() << "qSlicerCLIModuleDescriptionCache: ignoring corrupted cache file" << this->FilePath;
+      return;
+    }
+    entries.insert(modulePath, entry);
+  }
+  this->Entries = entries;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModuleDescriptionCachePrivate::isUpToDate(const QFileInfo& moduleFile, const Entry& entry)
+{
+  return moduleFile.exists()
+    && moduleFile.size() == entry.FileSize
+    && moduleFile.lastModified().toMSecsSinceEpoch() == entry.LastModified;
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerCLIModuleDescriptionCache methods
+
+//-----------------------------------------------------------------------------
+qSlicerCLIModuleDescriptionCache::qSlicerCLIModuleDescriptionCache(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new qSlicerCLIModuleDescriptionCachePrivate(*this))
+{
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCLIModuleDescriptionCache::~qSlicerCLIModuleDescriptionCache() = default;
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIModuleDescriptionCache::filePath()const
+{
+  Q_D(const qSlicerCLIModuleDescriptionCache);
+  return d->FilePath;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIModuleDescriptionCache::setFilePath(const QString& filePath)
+{
+  Q_D(qSlicerCLIModuleDescriptionCache);
+  if (d->FilePath == filePath)
+  {
+    return;
+  }
+  d->FilePath = filePath;
+  d->Entries.clear();
+  d->Loaded = false;
+  d->Modified = false;
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIModuleDescriptionCache::defaultFilePath()
+{
+  qSlicerCoreApplication* app = qSlicerCoreApplication::application();
+  if (!app)
+  {
+    return QString();
+  }
+  QFileInfo settingsFileInfo(app->slicerRevisionUserSettingsFilePath());
+  return settingsFileInfo.absoluteDir().filePath(
+    settingsFileInfo.completeBaseName() + "-CLIModuleDescriptions.cache");
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModuleDescriptionCache::description(const QString& modulePath,
+  QString& xmlDescription, ModuleLogo* logo)
+{
+  Q_D(qSlicerCLIModuleDescriptionCache);
+  if (d->FilePath.isEmpty())
+  {
+    return false;
+  }
+  d->loadIfNeeded();
+  QFileInfo moduleFile(modulePath);
+  QHash<QString, qSlicerCLIModuleDescriptionCachePrivate::Entry>::const_iterator entryIt =
+    d->Entries.constFind(moduleFile.absoluteFilePath());
+  if (entryIt == d->Entries.constEnd() || !d->isUpToDate(moduleFile, entryIt.value()))
+  {
+    d->MissCount++;
+    return false;
+  }
+  d->HitCount++;
+  xmlDescription = entryIt.value().XmlDescription;
+  if (logo && !entryIt.value().Logo.isEmpty())
+  {
+    logo->SetLogo(entryIt.value().Logo.constData(),
+                  entryIt.value().LogoWidth, entryIt.value().LogoHeight,
+                  entryIt.value().LogoPixelSize, static_cast<unsigned long>(entryIt.value().Logo.size()),
+                  entryIt.value().LogoOptions);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIModuleDescriptionCache::setDescription(const QString& modulePath,
+  const QString& xmlDescription, const ModuleLogo* logo)
+{
+  Q_D(qSlicerCLIModuleDescriptionCache);
+  if (d->FilePath.isEmpty())
+  {
+    return;
+  }
+  d->loadIfNeeded();
+  QFileInfo moduleFile(modulePath);
+  if (!moduleFile.exists())
+  {
+    return;
+  }
+  qSlicerCLIModuleDescriptionCachePrivate::Entry entry;
+  entry.FileSize = moduleFile.size();
+  entry.LastModified = moduleFile.lastModified().toMSecsSinceEpoch();
+  entry.XmlDescription = xmlDescription;
+  if (logo && logo->GetBufferLength() > 0)
+  {
+    entry.Logo = QByteArray(logo->GetLogo(), static_cast<int>(logo->GetBufferLength()));
+    entry.LogoWidth = logo->GetWidth();
+    entry.LogoHeight = logo->GetHeight();
+    entry.LogoPixelSize = logo->GetPixelSize();
+    entry.LogoOptions = logo->GetOptions();
+  }
+  d->Entries.insert(moduleFile.absoluteFilePath(), entry);
+  d->Modified = true;
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIModuleDescriptionCache::hitCount()const
+{
+  Q_D(const qSlicerCLIModuleDescriptionCache);
+  return d->HitCount;
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIModuleDescriptionCache::missCount()const
+{
+  Q_D(const qSlicerCLIModuleDescriptionCache);
+  return d->MissCount;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModuleDescriptionCache::save()
+{
+  Q_D(qSlicerCLIModuleDescriptionCache);
+  if (!d->Modified || d->FilePath.isEmpty())
+  {
+    return true;
+  }
+
+  // Drop entries of modules that were removed (for example, uninstalled extensions)
+  QHash<QString, qSlicerCLIModuleDescriptionCachePrivate::Entry>::iterator entryIt = d->Entries.begin();
+  while (entryIt != d->Entries.end())
+  {
+    if (!QFile::exists(entryIt.key()))
+    {
+      entryIt = d->Entries.erase(entryIt);
+    }
+    else
+    {
+      ++entryIt;
+    }
+  }
+
+  QByteArray content;
+  QDataStream stream(&content, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << CacheFileMagic << CacheFileVersion << static_cast<qint32>(d->Entries.size());
+  for (entryIt = d->Entries.begin(); entryIt != d->Entries.end(); ++entryIt)
+  {
+    const qSlicerCLIModuleDescriptionCachePrivate::Entry& entry = entryIt.value();
+    stream << entryIt.key() << entry.FileSize << entry.LastModified << entry.XmlDescription
+           << entry.Logo << entry.LogoWidth << entry.LogoHeight << entry.LogoPixelSize << entry.LogoOptions;
+  }
+
+  // Write into a temporary file and rename it, so that the cache file is never partially written
+  QSaveFile file(d->FilePath);
+  if (!file.open(QIODevice::WriteOnly)
+      || file.write(content) != content.size()
+      || !file.commit())
+  {
+    qWarning() << "qSlicerCLIModuleDescriptionCache: failed to write cache file" << d->FilePath;
+    return false;
+  }
+  d->Modified = false;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIModuleDescriptionCache::clear()
+{
+  Q_D(qSlicerCLIModuleDescriptionCache);
+  d->Entries.clear();
+  d->Loaded = true;
+  d->Modified = true;
+}
@@ -0,0 +1,95 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qSlicerCLIModuleDescriptionCache_h
+#define __qSlicerCLIModuleDescriptionCache_h
+
+// Qt includes
+#include <QObject>
+
+// CTK includes
+#include <ctkPimpl.h>
+
+// Slicer includes
+#include "qSlicerBaseQTCLIExport.h"
+
+class ModuleLogo;
+class qSlicerCLIModuleDescriptionCachePrivate;
+
+/// \brief Persistent cache of the XML descriptions of CLI modules.
+///
+/// Retrieving the description of a CLI module requires launching the
+/// executable with "--xml" or loading the shared library, which makes
+/// application startup slow when many CLI modules are installed.
+/// The cache stores the description (and the logo of loadable modules) of each
+/// module file, keyed by the file path, size, and modification time.
+///
+/// The whole cache file is read at once, when a description is first requested.
+/// Entries are validated lazily: the module file is only checked when its
+/// description is requested, and a stale entry is ignored (and later replaced).
+/// Modified cache is written by save(), which is typically called when all
+/// modules are instantiated.
+class Q_SLICER_BASE_QTCLI_EXPORT qSlicerCLIModuleDescriptionCache : public QObject
+{
+  Q_OBJECT
+  /// Path of the cache file. Caching is disabled if it is empty.
+  Q_PROPERTY(QString filePath READ filePath WRITE setFilePath)
+  /// Number of descriptions that were found in the cache.
+  Q_PROPERTY(int hitCount READ hitCount)
+  /// Number of descriptions that were not found in the cache or were outdated.
+  Q_PROPERTY(int missCount READ missCount)
+public:
+  typedef QObject Superclass;
+  explicit qSlicerCLIModuleDescriptionCache(QObject* parent = nullptr);
+  ~qSlicerCLIModuleDescriptionCache() override;
+
+  /// Get/set the path of the cache file.
+  /// Setting a new path discards all cached descriptions that were not saved yet.
+  QString filePath()const;
+  void setFilePath(const QString& filePath);
+
+  /// Default cache file path: next to the revision specific user settings file.
+  /// Returns empty string if the application is not instantiated.
+  static QString defaultFilePath();
+
+  /// Get the cached description of the module file \a modulePath.
+  /// Returns false if there is no entry or the module file changed since it was cached.
+  /// \param logo If not nullptr, it is set to the cached logo of the module.
+  bool description(const QString& modulePath, QString& xmlDescription, ModuleLogo* logo = nullptr);
+
+  /// Store the description of the module file \a modulePath.
+  /// The current size and modification time of the module file is saved with it.
+  void setDescription(const QString& modulePath, const QString& xmlDescription, const ModuleLogo* logo = nullptr);
+
+  int hitCount()const;
+  int missCount()const;
+
+public slots:
+  /// Write the cache file if it was modified.
+  /// Entries of module files that do not exist anymore are dropped.
+  bool save();
+
+  /// Remove all entries. The cache file is overwritten at the next save().
+  void clear();
+
+protected:
+  QScopedPointer<qSlicerCLIModuleDescriptionCachePrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qSlicerCLIModuleDescriptionCache);
+  Q_DISABLE_COPY(qSlicerCLIModuleDescriptionCache);
+};
+
+#endif
@@ -29,13 +29,16 @@
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointSet.h>
 #include <vtkStringArray.h>
 #include <vtksys/SystemTools.hxx>
 
@@ -48,12 +51,14 @@
 #include <algorithm>
 #include <cassert>
 #include <ctime>
+#include <map>
 #include <mutex>
 #include <random>
 #include <set>
 
 #ifdef _WIN32
 #else
+#include <sys/statvfs.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -192,6 +197,7 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
 
   int RedirectModuleStreams;
 
@@ -289,6 +295,44 @@ public:
   /// being executed with their.
   RequestType LastRequests;
 
+  /// Store the private shared memory transfer directory of a CLI node being
+  /// executed. A previous directory of the node is removed.
+  /// \sa RemoveTransferDirectory()
+  void SetTransferDirectory(vtkMRMLCommandLineModuleNode* node, const std::string& directory)
+  {
+    this->RemoveTransferDirectory(node);
+    std::lock_guard<std::mutex> lock(this->TransferDirectoriesLock);
+    this->TransferDirectories[node] = directory;
+  }
+  /// Remove the shared memory transfer directory of a CLI node with all
+  /// the files that it contains.
+  /// \sa SetTransferDirectory()
+  void RemoveTransferDirectory(vtkMRMLCommandLineModuleNode* node)
+  {
+    std::string directory;
+    {
+      std::lock_guard<std::mutex> lock(this->TransferDirectoriesLock);
+      std::map<vtkMRMLCommandLineModuleNode*, std::string>::iterator it =
+        this->TransferDirectories.find(node);
+      if (it == this->TransferDirectories.end())
+      {
+        return;
+      }
+      directory = it->second;
+      this->TransferDirectories.erase(it);
+    }
+    if (itksys::SystemTools::FileIsDirectory(directory)
+        && !itksys::SystemTools::RemoveADirectory(directory))
+    {
+      vtkGenericWarningMacro("Unable to delete temporary directory " << directory);
+    }
+  }
+
+  /// Private shared memory transfer directories of the CLI nodes being
+  /// executed. They are accessed from the processing and the main threads.
+  std::mutex TransferDirectoriesLock;
+  std::map<vtkMRMLCommandLineModuleNode*, std::string> TransferDirectories;
+
   vtkSmartPointer<vtkSlicerCLIRescheduleCallback> RescheduleCallback;
   vtkSmartPointer<vtkSlicerCLIOneShotCallbackCallback>OneShotCallbackCallback;
 };
@@ -305,6 +349,7 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 1;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -408,6 +453,22 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+  {
+    this->Internal->AllowSharedMemoryTransfer = value;
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -484,6 +545,86 @@ vtkSlicerCLIModuleLogic
   return fname;
 }
 
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic
+::CreateSharedMemoryTransferDirectory(const std::vector<std::string>& inputNodeIDs,
+                                      int numberOfOutputs)
+{
+  if (this->GetAllowSharedMemoryTransfer() == 0 || !this->GetMRMLScene())
+  {
+    return std::string();
+  }
+#ifdef _WIN32
+  return std::string();
+#else
+  // POSIX shared memory objects are files in a tmpfs file system, which is
+  // accessible to the module process as a regular directory. Files written
+  // there never reach the disk.
+  const std::string sharedMemoryDirectory = "/dev/shm";
+  if (!vtksys::SystemTools::FileIsDirectory(sharedMemoryDirectory)
+      || access(sharedMemoryDirectory.c_str(), W_OK) != 0)
+  {
+    return std::string();
+  }
+
+  // Estimate the size of the transferred data: inputs are written by Slicer,
+  // outputs are assumed to be not larger than the largest input.
+  unsigned long long inputSizeBytes = 0;
+  unsigned long long largestInputSizeBytes = 0;
+  for (const std::string& inputNodeID : inputNodeIDs)
+  {
+    vtkDataObject* data = nullptr;
+    vtkMRMLNode* inputNode = this->GetMRMLScene()->GetNodeByID(inputNodeID.c_str());
+    if (vtkMRMLVolumeNode::SafeDownCast(inputNode))
+    {
+      data = vtkMRMLVolumeNode::SafeDownCast(inputNode)->GetImageData();
+    }
+    else if (vtkMRMLModelNode::SafeDownCast(inputNode))
+    {
+      data = vtkMRMLModelNode::SafeDownCast(inputNode)->GetMesh();
+    }
+    if (data)
+    {
+      // GetActualMemorySize returns kibibytes
+      unsigned long long sizeBytes = static_cast<unsigned long long>(data->GetActualMemorySize()) * 1024;
+      inputSizeBytes += sizeBytes;
+      largestInputSizeBytes = std::max(largestInputSizeBytes, sizeBytes);
+    }
+  }
+  unsigned long long requiredSizeBytes =
+    inputSizeBytes + static_cast<unsigned long long>(std::max(numberOfOutputs, 0)) * largestInputSizeBytes;
+
+  // Leave at least half of the shared memory free for other processes
+  struct statvfs fileSystemInfo;
+  if (statvfs(sharedMemoryDirectory.c_str(), &fileSystemInfo) != 0)
+  {
+    return std::string();
+  }
+  unsigned long long availableSizeBytes =
+    static_cast<unsigned long long>(fileSystemInfo.f_bavail) * fileSystemInfo.f_frsize;
+  if (requiredSizeBytes > availableSizeBytes / 2)
+  {
+    vtkDebugMacro("Not enough shared memory for transferring " << requiredSizeBytes
+      << " bytes of data, using temporary directory instead");
+    return std::string();
+  }
+
+  // The shared memory file system is shared by all users, while transferred
+  // data may contain patient information. mkdtemp creates a new directory
+  // that only the current user can access (0700).
+  std::string directoryTemplate = sharedMemoryDirectory + "/Slicer-CLI-XXXXXX";
+  std::vector<char> directory(directoryTemplate.begin(), directoryTemplate.end());
+  directory.push_back('\0');
+  if (mkdtemp(directory.data()) == nullptr)
+  {
+    vtkWarningMacro("Failed to create directory in " << sharedMemoryDirectory
+      << ", using temporary directory instead");
+    return std::string();
+  }
+  return std::string(directory.data());
+#endif
+}
+
 //----------------------------------------------------------------------------
 std::string
 vtkSlicerCLIModuleLogic
@@ -914,6 +1055,67 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     = node0->GetModuleDescription().GetParameterGroups().end();
   std::vector<ModuleParameterGroup>::iterator pgit;
 
+  // Deduce the values/ids of the hidden parameters first, so that the nodes
+  // they refer to are taken into account in the transferred data size.
+  std::vector<std::string> transferInputNodeIDs;
+  int numberOfTransferOutputs = 0;
+  for (pgit = pgbeginit; pgit != pgendit; ++pgit)
+  {
+    for (ModuleParameter& parameter : (*pgit).GetParameters())
+    {
+      if (parameter.GetTag() != "image" && parameter.GetTag() != "geometry"
+          && parameter.GetTag() != "transform" && parameter.GetTag() != "table"
+          && parameter.GetTag() != "measurement" && parameter.GetTag() != "pointfile")
+      {
+        continue;
+      }
+      if (parameter.GetHidden() == "true")
+      {
+        // cache the id so we don't have to look for it later
+        parameter.SetValue(this->FindHiddenNodeID(node0->GetModuleDescription(), parameter));
+      }
+      if (parameter.GetTag() == "image" || parameter.GetTag() == "geometry")
+      {
+        if (parameter.GetChannel() == "input")
+        {
+          transferInputNodeIDs.push_back(parameter.GetValue());
+        }
+        else if (parameter.GetChannel() == "output")
+        {
+          numberOfTransferOutputs++;
+        }
+      }
+    }
+  }
+
+  // Images and models of command line modules are exchanged through shared
+  // memory if possible, to avoid writing and reading them from disk.
+  // Shared object modules already get images directly from the scene.
+  std::string sharedMemoryDirectory;
+  if (commandType == CommandLineModule)
+  {
+    sharedMemoryDirectory = this->CreateSharedMemoryTransferDirectory(
+      transferInputNodeIDs, numberOfTransferOutputs);
+  }
+  // The directory is removed when the module is done and its outputs are
+  // read back into the scene, whether the execution succeeded or not.
+  struct SharedMemoryTransferDirectoryCleanup
+  {
+    ~SharedMemoryTransferDirectoryCleanup()
+    {
+      if (this->Logic->Internal->GetLastRequest(this->Node) == 0)
+      {
+        this->Logic->Internal->RemoveTransferDirectory(this->Node);
+      }
+    }
+    vtkSlicerCLIModuleLogic* Logic;
+    vtkMRMLCommandLineModuleNode* Node;
+  } sharedMemoryTransferDirectoryCleanup{this, node0};
+  if (!sharedMemoryDirectory.empty() && this->GetDeleteTemporaryFiles())
+  {
+    this->Internal->SetTransferDirectory(node0, sharedMemoryDirectory);
+  }
+
   // Make a pass over the parameters and establish which parameters
   // have images or geometry or transforms or tables or point files that need to be written
   // before execution or loaded upon completion.
@@ -932,17 +1134,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           || (*pit).GetTag() == "transform" || (*pit).GetTag() == "table"
           || (*pit).GetTag() == "measurement" || (*pit).GetTag() == "pointfile")
       {
+        // hidden parameters have already been deduced
         std::string id = (*pit).GetValue();
 
-        // if the parameter is hidden, then deduce its value/id
-        if ((*pit).GetHidden() == "true")
-        {
-          id = this->FindHiddenNodeID(node0->GetModuleDescription(), *pit);
-
-          // cache the id so we don't have to look for it later
-          (*pit).SetValue( id );
-        }
-
         // only keep track of objects associated with real nodes
         if (!this->GetMRMLScene()->GetNodeByID(id.c_str()) || id == "None")
         {
@@ -955,6 +1149,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              id,
                                              (*pit).GetFileExtensions(),
                                              commandType);
+        if (!sharedMemoryDirectory.empty()
+            && ((*pit).GetTag() == "image" || (*pit).GetTag() == "geometry"))
+        {
+          fname = sharedMemoryDirectory + "/" + vtksys::SystemTools::GetFilenameName(fname);
+        }
 
         filesToDelete.insert(fname);
         if ((*pit).GetChannel() == "input")
@@ -2526,6 +2725,7 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       this->Internal->LastRequests.erase(it);
       // we are not interested in any request anymore because the cli node is
       // Completed.
+      this->Internal->RemoveTransferDirectory(node);
 
       node->SetStatus(vtkMRMLCommandLineModuleNode::Completed);
     }
@@ -96,6 +96,15 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory for transferring volumes and models
+  /// to and from command line (executable) modules.
+  /// If enabled and a shared memory file system is available (/dev/shm),
+  /// data files are exchanged through it instead of the temporary directory on disk,
+  /// as long as the data fits comfortably in the available shared memory.
+  /// Enabled by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -145,6 +154,17 @@ protected:
                                      const std::vector<std::string>& extensions,
                                      CommandLineModuleType commandType);
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
+  /// Create a private shared memory directory, only accessible by the current
+  /// user, where image and geometry files can be exchanged with the module.
+  /// The transferred data size is estimated from the \a inputNodeIDs volume and
+  /// model nodes, assuming that the \a numberOfOutputs outputs are not larger
+  /// than the largest input.
+  /// Returns empty string if data has to be exchanged through the temporary
+  /// directory (shared memory transfer is disabled, not available on this
+  /// platform, or there is not enough free shared memory).
+  /// The caller is responsible for removing the directory.
+  std::string CreateSharedMemoryTransferDirectory(const std::vector<std::string>& inputNodeIDs,
+                                                  int numberOfOutputs);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
 
@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QDir>
+#include <QElapsedTimer>
 
 // Slicer includes
 #include "qSlicerCoreApplication.h"
@@ -60,6 +61,12 @@ public:
   QMap<QString, qSlicerModuleFactory*> RegisteredModules;
   QMap<QString, QStringList> ModuleDependees;
 
+  /// Time spent in each factory for registering (including checking
+  /// file validity) and instantiating modules, in nanoseconds
+  QMap<qSlicerModuleFactory*, qint64> RegistrationTimes;
+  QMap<qSlicerModuleFactory*, qint64> InstantiationTimes;
+  QMap<qSlicerModuleFactory*, int> InstantiationCounts;
+
   bool Verbose;
 };
 
@@ -157,6 +164,21 @@ void qSlicerAbstractModuleFactoryManager::printAdditionalInfo()
   d->printAdditionalInfo();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::printFactoryTimes()
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  qDebug() << "Module factory times:";
+  foreach(qSlicerModuleFactory* factory, d->Factories.keys())
+  {
+    qDebug().noquote() << QString("\t%1: registration %2s, instantiation %3s (%4 modules)")
+      .arg(typeid(*factory).name())
+      .arg(QString::number(d->RegistrationTimes.value(factory) / 1e9, 'f', 3))
+      .arg(QString::number(d->InstantiationTimes.value(factory) / 1e9, 'f', 3))
+      .arg(d->InstantiationCounts.value(factory));
+  }
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerAbstractModuleFactoryManager
 ::registerFactory(qSlicerModuleFactory* factory, int priority)
@@ -172,6 +194,9 @@ void qSlicerAbstractModuleFactoryManager::unregisterFactory(qSlicerModuleFactory
   Q_D(qSlicerAbstractModuleFactoryManager);
   Q_ASSERT(d->Factories.contains(factory));
   d->Factories.remove(factory);
+  d->RegistrationTimes.remove(factory);
+  d->InstantiationTimes.remove(factory);
+  d->InstantiationCounts.remove(factory);
   delete factory;
 }
 
@@ -254,7 +279,10 @@ void qSlicerAbstractModuleFactoryManager::registerModules()
   // \todo: don't support factories other than filebased factories
   foreach(qSlicerModuleFactory* factory, d->notFileBasedFactories())
   {
+    QElapsedTimer timer;
+    timer.start();
     factory->registerItems();
+    d->RegistrationTimes[factory] += timer.nsecsElapsed();
     foreach(const QString& moduleName, factory->itemKeys())
     {
       if (d->Verbose)
@@ -301,7 +329,11 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
     {
       qDebug() << " checking file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
     }
-    if (!factory->isValidFile(file))
+    QElapsedTimer timer;
+    timer.start();
+    bool validFile = factory->isValidFile(file);
+    d->RegistrationTimes[factory] += timer.nsecsElapsed();
+    if (!validFile)
     {
       continue;
     }
@@ -348,7 +380,10 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
     emit moduleIgnored(moduleName);
     return;
   }
+  QElapsedTimer timer;
+  timer.start();
   QString registeredModuleName = moduleFactory->registerFileItem(file);
+  d->RegistrationTimes[moduleFactory] += timer.nsecsElapsed();
   if (registeredModuleName != moduleName)
   {
     //qDebug() << "Ignore module" << moduleName;
@@ -387,6 +422,11 @@ void qSlicerAbstractModuleFactoryManager::instantiateModules()
   signal(SIGINT, SIG_DFL);
   #endif
 
+  if (d->Verbose)
+  {
+    this->printFactoryTimes();
+  }
+
   emit this->modulesInstantiated(this->instantiatedModuleNames());
 }
 
@@ -401,7 +441,11 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
     qCritical() << "Fail to instantiate module " << moduleName << " (not registered)";
     return nullptr;
   }
+  QElapsedTimer timer;
+  timer.start();
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  d->InstantiationTimes[factory] += timer.nsecsElapsed();
+  d->InstantiationCounts[factory] += 1;
   if (!module)
   {
     qCritical() << "Fail to instantiate module " << moduleName;
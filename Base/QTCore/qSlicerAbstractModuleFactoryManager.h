@@ -96,6 +96,11 @@ public:
   /// Print internal state using qDebug()
   virtual void printAdditionalInfo();
 
+  /// Print the time spent in each factory for registering and instantiating
+  /// modules using qDebug(). It is printed automatically after instantiateModules()
+  /// if verbose module discovery is enabled.
+  void printFactoryTimes();
+
   /// \brief Register a \a factory
   /// The factory will be deleted when unregistered
   /// (e.g. in ~qSlicerAbstractModuleFactoryManager())
@@ -0,0 +1,110 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeDisplayNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkTrivialProducer.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+/// Trigger automatic window/level computation and return computation time
+double UpdateAutoLevels(vtkMRMLScalarVolumeDisplayNode* displayNode)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  displayNode->Modified();
+  timer->StopTimer();
+  return timer->GetElapsedTime();
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLScalarVolumeDisplayNodeAutoLevelsTest(int argc, char* argv[])
+{
+  int imageSize = 200;
+  if (argc > 1)
+  {
+    imageSize = atoi(argv[1]);
+  }
+
+  // Uniformly distributed random values between 0 and 999
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(imageSize, imageSize, imageSize / 2);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  unsigned int seed = 1;
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    voxels[i] = static_cast<short>((seed >> 16) % 1000);
+  }
+  vtkNew<vtkTrivialProducer> imageProducer;
+  imageProducer->SetOutput(image);
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  displayNode->SetAutoWindowLevel(0);
+  displayNode->SetAutoLevelsMaximumNumberOfSamples(0);
+  displayNode->SetInputImageDataConnection(imageProducer->GetOutputPort());
+
+  // Exact computation (image is marked as modified to make sure levels are recomputed)
+  displayNode->SetAutoWindowLevel(1);
+  image->Modified();
+  double exactTimeSec = UpdateAutoLevels(displayNode);
+  double exactMin = displayNode->GetWindowLevelMin();
+  double exactMax = displayNode->GetWindowLevelMax();
+  std::cout << "Exact auto levels: " << exactMin << ", " << exactMax
+    << " (" << exactTimeSec * 1000.0 << "ms)" << std::endl;
+  CHECK_BOOL(exactMin >= 0.0 && exactMin <= 5.0, true);
+  CHECK_BOOL(exactMax >= 994.0 && exactMax <= 999.0, true);
+
+  // Cached result is used if neither the image nor the sampling changed
+  double cachedTimeSec = UpdateAutoLevels(displayNode);
+  CHECK_DOUBLE(displayNode->GetWindowLevelMin(), exactMin);
+  CHECK_DOUBLE(displayNode->GetWindowLevelMax(), exactMax);
+  std::cout << "Cached auto levels: " << cachedTimeSec * 1000.0 << "ms" << std::endl;
+
+  // Sampled computation
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  displayNode->SetAutoLevelsMaximumNumberOfSamples(100000);
+  timer->StopTimer();
+  double sampledMin = displayNode->GetWindowLevelMin();
+  double sampledMax = displayNode->GetWindowLevelMax();
+  std::cout << "Sampled auto levels: " << sampledMin << ", " << sampledMax
+    << " (" << timer->GetElapsedTime() * 1000.0 << "ms)" << std::endl;
+  CHECK_BOOL(std::abs(sampledMin - exactMin) <= 5.0, true);
+  CHECK_BOOL(std::abs(sampledMax - exactMax) <= 5.0, true);
+
+  // Modified image is not taken from the cache
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    voxels[i] *= 2;
+  }
+  image->Modified();
+  UpdateAutoLevels(displayNode);
+  CHECK_BOOL(std::abs(displayNode->GetWindowLevelMin() - 2.0 * sampledMin) <= 10.0, true);
+  CHECK_BOOL(std::abs(displayNode->GetWindowLevelMax() - 2.0 * sampledMax) <= 10.0, true);
+
+  return EXIT_SUCCESS;
+}
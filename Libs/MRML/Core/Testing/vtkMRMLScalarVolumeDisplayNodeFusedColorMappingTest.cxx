@@ -0,0 +1,203 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLColorTableNode.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeDisplayNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkAlgorithm.h>
+#include <vtkAlgorithmOutput.h>
+#include <vtkImageData.h>
+#include <vtkImageToImageStencil.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkTrivialProducer.h>
+
+// STD includes
+#include <cstring>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateImage(int scalarType, int size)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, 1);
+  image->AllocateScalars(scalarType, 1);
+  bool isUnsignedChar = (scalarType == VTK_UNSIGNED_CHAR);
+  for (int y = 0; y < size; ++y)
+  {
+    for (int x = 0; x < size; ++x)
+    {
+      int i = y * size + x;
+      double value = isUnsignedChar ? (i % 256) : ((i * 37) % 4096 - 1024);
+      if (scalarType == VTK_FLOAT)
+      {
+        value += 0.25;
+      }
+      image->SetScalarComponentFromDouble(x, y, 0, 0, value);
+    }
+  }
+  return image;
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> GetOutputImage(vtkMRMLScalarVolumeDisplayNode* displayNode, bool fused,
+  double* elapsedTimeSec = nullptr)
+{
+  displayNode->SetFusedColorMapping(fused);
+  vtkAlgorithm* producer = displayNode->GetOutputImageDataConnection()->GetProducer();
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  producer->Update();
+  timer->StopTimer();
+  if (elapsedTimeSec)
+  {
+    *elapsedTimeSec = timer->GetElapsedTime();
+  }
+  vtkSmartPointer<vtkImageData> output = vtkSmartPointer<vtkImageData>::New();
+  output->DeepCopy(producer->GetOutputDataObject(0));
+  return output;
+}
+
+//---------------------------------------------------------------------------
+int CheckFusedOutputMatchesClassicOutput(vtkMRMLScalarVolumeDisplayNode* displayNode, const char* description)
+{
+  vtkSmartPointer<vtkImageData> classicOutput = GetOutputImage(displayNode, false);
+  vtkSmartPointer<vtkImageData> fusedOutput = GetOutputImage(displayNode, true);
+  CHECK_INT(fusedOutput->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(fusedOutput->GetNumberOfScalarComponents(), 4);
+  CHECK_INT(fusedOutput->GetNumberOfPoints(), classicOutput->GetNumberOfPoints());
+  CHECK_INT(classicOutput->GetNumberOfScalarComponents(), 4);
+  const unsigned char* classicPtr = static_cast<unsigned char*>(classicOutput->GetScalarPointer());
+  const unsigned char* fusedPtr = static_cast<unsigned char*>(fusedOutput->GetScalarPointer());
+  for (vtkIdType i = 0; i < 4 * classicOutput->GetNumberOfPoints(); ++i)
+  {
+    if (classicPtr[i] != fusedPtr[i])
+    {
+      std::cerr << "Fused output differs from classic output (" << description << ")"
+        << " at point " << i / 4 << " component " << i % 4 << ": "
+        << int(fusedPtr[i]) << " != " << int(classicPtr[i]) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestFusedColorMapping(int scalarType, int imageSize, bool directMapping)
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Color table with transparent entries at the low end
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  colorNode->SetTypeToUser();
+  colorNode->SetNumberOfColors(256);
+  for (int i = 0; i < 256; ++i)
+  {
+    colorNode->SetColor(i, i / 255.0, 1.0 - i / 255.0, 0.5, i < 16 ? 0.0 : 1.0);
+  }
+  scene->AddNode(colorNode);
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode);
+  displayNode->SetAutoWindowLevel(0);
+  if (directMapping)
+  {
+    displayNode->SetScalarRangeFlag(vtkMRMLDisplayNode::UseDirectMapping);
+  }
+  displayNode->SetAndObserveColorNodeID(colorNode->GetID());
+
+  vtkSmartPointer<vtkImageData> image = CreateImage(scalarType, imageSize);
+  vtkNew<vtkTrivialProducer> imageProducer;
+  imageProducer->SetOutput(image);
+  displayNode->SetInputImageDataConnection(imageProducer->GetOutputPort());
+
+  displayNode->SetWindowLevel(600.0, 100.0);
+  CHECK_EXIT_SUCCESS(CheckFusedOutputMatchesClassicOutput(displayNode, "window/level"));
+
+  displayNode->SetWindowLevel(10000.0, 0.0);
+  CHECK_EXIT_SUCCESS(CheckFusedOutputMatchesClassicOutput(displayNode, "wide window"));
+
+  displayNode->SetWindowLevel(600.0, 100.0);
+  displayNode->SetApplyThreshold(1);
+  displayNode->SetThreshold(20.5, 180.0);
+  CHECK_EXIT_SUCCESS(CheckFusedOutputMatchesClassicOutput(displayNode, "threshold"));
+
+  vtkNew<vtkImageToImageStencil> stencil;
+  stencil->SetInputData(image);
+  stencil->ThresholdByUpper(50.0);
+  displayNode->SetBackgroundImageStencilDataConnection(stencil->GetOutputPort());
+  CHECK_EXIT_SUCCESS(CheckFusedOutputMatchesClassicOutput(displayNode, "threshold and stencil"));
+
+  displayNode->SetApplyThreshold(0);
+  CHECK_EXIT_SUCCESS(CheckFusedOutputMatchesClassicOutput(displayNode, "stencil"));
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLScalarVolumeDisplayNodeFusedColorMappingTest(int argc, char* argv[])
+{
+  // Small images are mapped voxel by voxel, large 8 and 16-bit images use a color table of all values
+  const int scalarTypes[] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT };
+  for (int scalarType : scalarTypes)
+  {
+    for (int imageSize : { 64, 300 })
+    {
+      std::cout << "Scalar type: " << vtkImageScalarTypeNameMacro(scalarType) << ", image size: " << imageSize << std::endl;
+      CHECK_EXIT_SUCCESS(TestFusedColorMapping(scalarType, imageSize, false));
+      CHECK_EXIT_SUCCESS(TestFusedColorMapping(scalarType, imageSize, true));
+    }
+  }
+
+  // Compare speed of the two pipelines on a large slice
+  int imageSize = 2048;
+  if (argc > 1)
+  {
+    imageSize = atoi(argv[1]);
+  }
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  colorNode->SetTypeToGrey();
+  scene->AddNode(colorNode);
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode);
+  displayNode->SetAutoWindowLevel(0);
+  displayNode->SetAndObserveColorNodeID(colorNode->GetID());
+  vtkNew<vtkTrivialProducer> imageProducer;
+  imageProducer->SetOutput(CreateImage(VTK_SHORT, imageSize));
+  displayNode->SetInputImageDataConnection(imageProducer->GetOutputPort());
+  const int numberOfWindowLevelChanges = 10;
+  for (int fused = 0; fused <= 1; ++fused)
+  {
+    double totalTimeSec = 0.0;
+    for (int i = 0; i < numberOfWindowLevelChanges; ++i)
+    {
+      displayNode->SetWindowLevel(400.0 + i * 10.0, 40.0 + i);
+      double elapsedTimeSec = 0.0;
+      GetOutputImage(displayNode, fused != 0, &elapsedTimeSec);
+      totalTimeSec += elapsedTimeSec;
+    }
+    std::cout << (fused ? "Fused" : "Classic") << " color mapping of " << imageSize << "x" << imageSize
+      << " slice: " << totalTimeSec * 1000.0 / numberOfWindowLevelChanges << "ms" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
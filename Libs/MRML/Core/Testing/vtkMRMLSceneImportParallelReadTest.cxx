@@ -0,0 +1,127 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLMessageCollection.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfModels = 8;
+
+//---------------------------------------------------------------------------
+int ImportScene(const std::string& sceneFileName, int numberOfThreads)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetMaximumNumberOfDataReadThreads(numberOfThreads);
+  CHECK_INT(scene->GetMaximumNumberOfDataReadThreads(), numberOfThreads);
+
+  vtkNew<vtkMRMLMessageCollection> userMessages;
+  CHECK_INT(scene->Import(userMessages), 1);
+  CHECK_INT(userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent), 0);
+  // Read times are not reported to the user
+  CHECK_INT(userMessages->GetNumberOfMessagesOfType(vtkCommand::MessageEvent), 0);
+
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), NumberOfModels);
+  for (int modelIndex = 0; modelIndex < NumberOfModels; ++modelIndex)
+  {
+    std::stringstream modelName;
+    modelName << "Model" << modelIndex;
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(scene->GetFirstNodeByName(modelName.str().c_str()));
+    CHECK_NOT_NULL(modelNode);
+    CHECK_NOT_NULL(modelNode->GetPolyData());
+    // Each model has a different resolution, which allows checking that meshes are not mixed up
+    int resolution = 8 + modelIndex;
+    CHECK_INT(modelNode->GetPolyData()->GetNumberOfPoints(), resolution * (resolution - 2) + 2);
+  }
+
+  // Data of imported nodes is not kept in storage nodes
+  std::vector<vtkMRMLNode*> storageNodes;
+  scene->GetNodesByClass("vtkMRMLModelStorageNode", storageNodes);
+  CHECK_INT(static_cast<int>(storageNodes.size()), NumberOfModels);
+  for (vtkMRMLNode* node : storageNodes)
+  {
+    vtkMRMLStorageNode* storageNode = vtkMRMLStorageNode::SafeDownCast(node);
+    CHECK_BOOL(storageNode->CanPreloadData(), true);
+    storageNode->ClearPreloadedData();
+  }
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneImportParallelReadTest(int argc, char* argv[])
+{
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = argv[1];
+
+  // Create a scene with several models and save it
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(tempDir.c_str());
+  for (int modelIndex = 0; modelIndex < NumberOfModels; ++modelIndex)
+  {
+    int resolution = 8 + modelIndex;
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(resolution);
+    sphere->SetPhiResolution(resolution);
+    sphere->Update();
+
+    std::stringstream modelName;
+    modelName << "Model" << modelIndex;
+    vtkNew<vtkMRMLModelNode> modelNode;
+    modelNode->SetName(modelName.str().c_str());
+    modelNode->SetAndObservePolyData(sphere->GetOutput());
+    scene->AddNode(modelNode);
+
+    vtkNew<vtkMRMLModelStorageNode> storageNode;
+    scene->AddNode(storageNode);
+    modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+    std::string fileName = tempDir + "/vtkMRMLSceneImportParallelReadTest_" + modelName.str() + ".vtp";
+    storageNode->SetFileName(fileName.c_str());
+    CHECK_INT(storageNode->WriteData(modelNode), 1);
+  }
+  std::string sceneFileName = tempDir + "/vtkMRMLSceneImportParallelReadTest.mrml";
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Commit(), 1);
+
+  // Sequential and concurrent reading must give the same result
+  CHECK_EXIT_SUCCESS(ImportScene(sceneFileName, 1));
+  CHECK_EXIT_SUCCESS(ImportScene(sceneFileName, 4));
+
+  // Out of range values are clamped
+  vtkNew<vtkMRMLScene> otherScene;
+  otherScene->SetMaximumNumberOfDataReadThreads(0);
+  CHECK_INT(otherScene->GetMaximumNumberOfDataReadThreads(), 1);
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Mimic widgets and logics that query the scene each time a node is added.
+void onNodeAdded(vtkObject* caller, unsigned long, void* clientData, void*)
+{
+  vtkMRMLScene* scene = vtkMRMLScene::SafeDownCast(caller);
+  int* numberOfTransformNodes = reinterpret_cast<int*>(clientData);
+  *numberOfTransformNodes = scene->GetNumberOfNodesByClass("vtkMRMLTransformNode");
+  scene->GetFirstNodeByClass("vtkMRMLScriptedModuleNode");
+}
+
+//---------------------------------------------------------------------------
+int TestNodesByClassConsistency()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode1;
+  scene->AddNode(volumeNode1);
+  vtkNew<vtkMRMLLinearTransformNode> transformNode1;
+  scene->AddNode(transformNode1);
+
+  // Abstract base classes are indexed on first request
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLVolumeNode"), 1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformNode"), 1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), 2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 0);
+
+  // Indexed classes are kept up-to-date
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode2;
+  scene->AddNode(volumeNode2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLVolumeNode"), 2);
+  CHECK_POINTER(scene->GetNthNodeByClass(1, "vtkMRMLVolumeNode"), volumeNode2.GetPointer());
+  CHECK_NULL(scene->GetNthNodeByClass(2, "vtkMRMLVolumeNode"));
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), 3);
+
+  // Scene order is preserved when inserting nodes
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode0;
+  scene->InsertBeforeNode(volumeNode1, volumeNode0);
+  std::vector<vtkMRMLNode*> volumeNodes;
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLScalarVolumeNode", volumeNodes), 3);
+  CHECK_POINTER(volumeNodes[0], volumeNode0.GetPointer());
+  CHECK_POINTER(volumeNodes[1], volumeNode1.GetPointer());
+  CHECK_POINTER(volumeNodes[2], volumeNode2.GetPointer());
+
+  scene->RemoveNode(volumeNode1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLVolumeNode"), 2);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLVolumeNode"), volumeNode0.GetPointer());
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), 3);
+
+  vtkSmartPointer<vtkCollection> transformNodes = vtkSmartPointer<vtkCollection>::Take(
+    scene->GetNodesByClass("vtkMRMLTransformNode"));
+  CHECK_INT(transformNodes->GetNumberOfItems(), 1);
+  CHECK_POINTER(transformNodes->GetItemAsObject(0), transformNode1.GetPointer());
+
+  scene->Clear(1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), 0);
+  CHECK_NULL(scene->GetFirstNodeByClass("vtkMRMLVolumeNode"));
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestNodesByClassPerformance(int numberOfNodes)
+{
+  // Synthetic scene with many transform and scripted module nodes
+  std::stringstream sceneXML;
+  sceneXML << "<MRML>";
+  for (int i = 0; i < numberOfNodes; ++i)
+  {
+    if (i % 2)
+    {
+      sceneXML << "<LinearTransform id=\"vtkMRMLLinearTransformNode" << i << "\" name=\"Transform" << i << "\" > </LinearTransform>";
+    }
+    else
+    {
+      sceneXML << "<ScriptedModule id=\"vtkMRMLScriptedModuleNode" << i << "\" name=\"Parameters" << i << "\" > </ScriptedModule>";
+    }
+  }
+  sceneXML << "</MRML>";
+
+  vtkNew<vtkMRMLScene> scene;
+  int numberOfTransformNodes = 0;
+  vtkNew<vtkCallbackCommand> nodeAddedCallback;
+  nodeAddedCallback->SetCallback(onNodeAdded);
+  nodeAddedCallback->SetClientData(&numberOfTransformNodes);
+  scene->AddObserver(vtkMRMLScene::NodeAddedEvent, nodeAddedCallback);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  scene->SetLoadFromXMLString(1);
+  scene->SetSceneXMLString(sceneXML.str());
+  scene->Import();
+  timer->StopTimer();
+  std::cout << "Import of " << numberOfNodes << " nodes: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  CHECK_INT(numberOfTransformNodes, numberOfNodes / 2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLLinearTransformNode"), numberOfNodes / 2);
+
+  timer->StartTimer();
+  for (int i = 0; i < 1000; ++i)
+  {
+    scene->GetNthNodeByClass(i, "vtkMRMLTransformNode");
+    scene->GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode");
+  }
+  timer->StopTimer();
+  std::cout << "1000 GetNthNodeByClass/GetNumberOfNodesByClass calls: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneNodesByClassTest(int argc, char* argv[])
+{
+  int numberOfNodes = 50000;
+  if (argc > 1)
+  {
+    numberOfNodes = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestNodesByClassConsistency());
+  CHECK_EXIT_SUCCESS(TestNodesByClassPerformance(numberOfNodes));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneNodesByNameTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLScriptedModuleNode> node1;
+  node1->SetName("Segment_1");
+  scene->AddNode(node1);
+  vtkNew<vtkMRMLLinearTransformNode> node2;
+  node2->SetName("segment_2");
+  scene->AddNode(node2);
+  vtkNew<vtkMRMLScriptedModuleNode> node3;
+  node3->SetName("Segment_1");
+  scene->AddNode(node3);
+
+  //---------------------------------------------------------------------------
+  // Exact name lookup
+  CHECK_POINTER(scene->GetFirstNodeByName("Segment_1"), node1.GetPointer());
+  CHECK_NULL(scene->GetFirstNodeByName("segment_1"));
+  vtkSmartPointer<vtkCollection> nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByName("Segment_1"));
+  CHECK_INT(nodes->GetNumberOfItems(), 2);
+  CHECK_POINTER(nodes->GetItemAsObject(0), node1.GetPointer());
+  CHECK_POINTER(nodes->GetItemAsObject(1), node3.GetPointer());
+  nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByClassByName("vtkMRMLTransformNode", "segment_2"));
+  CHECK_INT(nodes->GetNumberOfItems(), 1);
+  CHECK_POINTER(scene->GetFirstNode("Segment_1", "vtkMRMLScriptedModuleNode"), node1.GetPointer());
+  CHECK_NULL(scene->GetFirstNode("Segment_1", "vtkMRMLTransformNode"));
+
+  //---------------------------------------------------------------------------
+  // Case insensitive lookup
+  std::vector<vtkMRMLNode*> foundNodes;
+  CHECK_INT(scene->GetNodesByName("SEGMENT_2", foundNodes, false), 1);
+  CHECK_POINTER(foundNodes[0], node2.GetPointer());
+  CHECK_INT(scene->GetNodesByName("SEGMENT_2", foundNodes, true), 0);
+
+  //---------------------------------------------------------------------------
+  // Regular expression lookup
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^Segment_[0-9]$", foundNodes), 2);
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^[sS]egment_", foundNodes), 3);
+  CHECK_INT(scene->GetNodesByNameRegularExpression("_2$", foundNodes), 1);
+  CHECK_POINTER(foundNodes[0], node2.GetPointer());
+  // Alternation disables anchored prefix pruning
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^Segment_1|_2$", foundNodes), 3);
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^(Segment_1|segment_2)$", foundNodes), 3);
+
+  //---------------------------------------------------------------------------
+  // Nodes are found in scene order, not in the order they got their name
+  node1->SetName("Other");
+  node1->SetName("Segment_1");
+  CHECK_POINTER(scene->GetFirstNodeByName("Segment_1"), node1.GetPointer());
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^[sS]egment_", foundNodes), 3);
+  CHECK_POINTER(foundNodes[0], node1.GetPointer());
+  CHECK_POINTER(foundNodes[1], node2.GetPointer());
+  CHECK_POINTER(foundNodes[2], node3.GetPointer());
+  vtkNew<vtkMRMLScriptedModuleNode> node4;
+  node4->SetName("Segment_1");
+  scene->InsertBeforeNode(node1, node4);
+  CHECK_POINTER(scene->GetFirstNodeByName("Segment_1"), node4.GetPointer());
+  nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByName("Segment_1"));
+  CHECK_INT(nodes->GetNumberOfItems(), 3);
+  CHECK_POINTER(nodes->GetItemAsObject(1), node1.GetPointer());
+  CHECK_POINTER(nodes->GetItemAsObject(2), node3.GetPointer());
+  scene->RemoveNode(node4);
+
+  //---------------------------------------------------------------------------
+  // Renaming and removing nodes keeps the index up-to-date
+  node3->SetName("Renamed");
+  CHECK_POINTER(scene->GetFirstNodeByName("Renamed"), node3.GetPointer());
+  nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByName("Segment_1"));
+  CHECK_INT(nodes->GetNumberOfItems(), 1);
+  scene->RemoveNode(node1);
+  CHECK_NULL(scene->GetFirstNodeByName("Segment_1"));
+  // Renaming a node that is not in the scene does not change the index
+  node1->SetName("Renamed");
+  CHECK_INT(scene->GetNodesByName("Renamed", foundNodes), 1);
+
+  //---------------------------------------------------------------------------
+  // Unique names are generated using the index
+  std::string uniqueName = scene->GenerateUniqueName("Renamed");
+  CHECK_STD_STRING(uniqueName, "Renamed_1");
+
+  const int numberOfNodes = 20000;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfNodes; ++i)
+  {
+    vtkNew<vtkMRMLScriptedModuleNode> node;
+    node->SetName(scene->GenerateUniqueName("Parameters").c_str());
+    scene->AddNode(node);
+  }
+  // first generated name is "Parameters", then "Parameters_1", "Parameters_2"...
+  CHECK_NOT_NULL(scene->GetFirstNodeByName("Parameters"));
+  for (int i = 1; i < numberOfNodes; ++i)
+  {
+    std::stringstream name;
+    name << "Parameters_" << i;
+    CHECK_NOT_NULL(scene->GetFirstNodeByName(name.str().c_str()));
+  }
+  timer->StopTimer();
+  std::cout << "Add and find " << numberOfNodes << " nodes by name: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_INT(scene->GetNodesByNameRegularExpression("^Parameters_1[0-9]*$", foundNodes), 11111);
+
+  return EXIT_SUCCESS;
+}
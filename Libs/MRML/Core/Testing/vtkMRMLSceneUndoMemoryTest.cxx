@@ -0,0 +1,210 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+namespace
+{
+
+const int ImageSize = 64;
+
+//---------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* AddVolume(vtkMRMLScene* scene, const char* name, short value)
+{
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(ImageSize, ImageSize, ImageSize);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->Fill(value);
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName(name);
+  volumeNode->SetUndoEnabled(true);
+  volumeNode->SetAndObserveImageData(imageData);
+  scene->AddNode(volumeNode);
+  return volumeNode;
+}
+
+//---------------------------------------------------------------------------
+void FillVolume(vtkMRMLScalarVolumeNode* volumeNode, short value)
+{
+  // Modify bulk data in-place, without notifying the volume node
+  volumeNode->GetImageData()->GetPointData()->GetScalars()->Fill(value);
+  volumeNode->GetImageData()->GetPointData()->GetScalars()->Modified();
+}
+
+//---------------------------------------------------------------------------
+short GetVoxelValue(vtkMRMLScalarVolumeNode* volumeNode)
+{
+  return *static_cast<short*>(volumeNode->GetImageData()->GetScalarPointer(1, 2, 3));
+}
+
+//---------------------------------------------------------------------------
+int TestUndoMemory(bool copyOnWrite, unsigned long& undoMemorySize)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  scene->SetUndoCopyOnWrite(copyOnWrite);
+  CHECK_BOOL(scene->GetUndoCopyOnWrite(), copyOnWrite);
+  vtkMRMLScalarVolumeNode* unchangedVolume = AddVolume(scene, "Unchanged", 1);
+  vtkMRMLScalarVolumeNode* changedVolume = AddVolume(scene, "Changed", 10);
+  CHECK_INT(static_cast<int>(scene->GetUndoMemorySize()), 0);
+
+  const int numberOfStates = 4;
+  for (int stateIndex = 0; stateIndex < numberOfStates; ++stateIndex)
+  {
+    scene->SaveStateForUndo();
+    FillVolume(changedVolume, 10 + stateIndex + 1);
+  }
+  CHECK_INT(scene->GetNumberOfUndoLevels(), numberOfStates);
+  undoMemorySize = scene->GetUndoMemorySize();
+  std::cout << "Undo memory size (copy-on-write " << (copyOnWrite ? "on" : "off") << "): "
+    << undoMemorySize << " KiB" << std::endl;
+
+  // Undo restores the in-place modified image
+  CHECK_INT(GetVoxelValue(changedVolume), 14);
+  scene->Undo();
+  CHECK_INT(GetVoxelValue(changedVolume), 13);
+  scene->Undo();
+  CHECK_INT(GetVoxelValue(changedVolume), 12);
+  CHECK_INT(GetVoxelValue(unchangedVolume), 1);
+  CHECK_BOOL(scene->GetRedoMemorySize() > 0, true);
+  scene->Redo();
+  CHECK_INT(GetVoxelValue(changedVolume), 13);
+  CHECK_INT(GetVoxelValue(unchangedVolume), 1);
+
+  // Removed node is restored and earlier states are not affected by changing it
+  // (in copy-on-write mode both states share the same copy of the node)
+  scene->SaveStateForUndo();
+  scene->SaveStateForUndo();
+  scene->RemoveNode(unchangedVolume);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLScalarVolumeNode"), 1);
+  scene->Undo();
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLScalarVolumeNode"), 2);
+  unchangedVolume = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNodeByName("Unchanged"));
+  CHECK_NOT_NULL(unchangedVolume);
+  FillVolume(unchangedVolume, 2);
+  scene->Undo();
+  unchangedVolume = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNodeByName("Unchanged"));
+  CHECK_NOT_NULL(unchangedVolume);
+  CHECK_INT(GetVoxelValue(unchangedVolume), 1);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestUndoMemoryLimit()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  scene->SetUndoCopyOnWrite(true);
+  vtkMRMLScalarVolumeNode* volumeNode = AddVolume(scene, "Volume", 0);
+  unsigned long volumeMemorySize = volumeNode->GetImageData()->GetActualMemorySize();
+
+  // Allow about 3 copies of the volume
+  scene->SetMaximumUndoMemorySize(volumeMemorySize * 3 + volumeMemorySize / 2);
+  for (int stateIndex = 0; stateIndex < 10; ++stateIndex)
+  {
+    scene->SaveStateForUndo();
+    FillVolume(volumeNode, stateIndex + 1);
+  }
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 3);
+  CHECK_BOOL(scene->GetUndoMemorySize() <= scene->GetMaximumUndoMemorySize(), true);
+
+  // The most recent state is kept even if it is larger than the limit
+  scene->SetMaximumUndoMemorySize(1);
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 1);
+  scene->Undo();
+  CHECK_INT(GetVoxelValue(volumeNode), 9);
+
+  // Number of states limit is still applied
+  scene->SetMaximumUndoMemorySize(0);
+  scene->SetMaximumNumberOfSavedUndoStates(2);
+  for (int stateIndex = 0; stateIndex < 5; ++stateIndex)
+  {
+    scene->SaveStateForUndo();
+  }
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 2);
+
+  // Redo states are included in the memory limit
+  scene->SetMaximumNumberOfSavedUndoStates(10);
+  scene->ClearUndoStack();
+  for (int stateIndex = 0; stateIndex < 4; ++stateIndex)
+  {
+    scene->SaveStateForUndo();
+    FillVolume(volumeNode, stateIndex + 1);
+  }
+  scene->Undo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 3);
+  CHECK_BOOL(scene->GetRedoMemorySize() > 0, true);
+  scene->SetMaximumUndoMemorySize(volumeMemorySize * 3 + volumeMemorySize / 2);
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 2);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestUndoBulkDataSharing()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  scene->SetUndoCopyOnWrite(true);
+  vtkMRMLScalarVolumeNode* volumeNode = AddVolume(scene, "Volume", 5);
+  unsigned long volumeMemorySize = volumeNode->GetImageData()->GetActualMemorySize();
+
+  // Image data is shared between copies of the node if only the node properties are changed
+  scene->SaveStateForUndo();
+  volumeNode->SetName("Renamed");
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 2);
+  CHECK_BOOL(scene->GetUndoMemorySize() < volumeMemorySize * 2, true);
+
+  // Restored node does not modify the image data of the other saved states
+  scene->RemoveNode(volumeNode);
+  scene->Undo();
+  volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNodeByName("Renamed"));
+  CHECK_NOT_NULL(volumeNode);
+  FillVolume(volumeNode, 7);
+  scene->Undo();
+  volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNodeByName("Volume"));
+  CHECK_NOT_NULL(volumeNode);
+  CHECK_INT(GetVoxelValue(volumeNode), 5);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneUndoMemoryTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  unsigned long fullCopyMemorySize = 0;
+  CHECK_EXIT_SUCCESS(TestUndoMemory(false, fullCopyMemorySize));
+  unsigned long copyOnWriteMemorySize = 0;
+  CHECK_EXIT_SUCCESS(TestUndoMemory(true, copyOnWriteMemorySize));
+  // Without copy-on-write, both volumes are copied in each state (8 copies).
+  // With copy-on-write, the unchanged volume is copied only once (5 copies).
+  CHECK_BOOL(copyOnWriteMemorySize * 7 < fullCopyMemorySize * 5, true);
+
+  CHECK_EXIT_SUCCESS(TestUndoMemoryLimit());
+  CHECK_EXIT_SUCCESS(TestUndoBulkDataSharing());
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,8 @@ Care Ontario.
 #include "vtkMRMLSegmentationNode.h"
 #include "vtkMRMLSegmentationStorageNode.h"
 #include "vtkOrientedImageData.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkSegment.h"
 #include "vtkSegmentationConverterFactory.h"
 
 // Converter rules
@@ -33,6 +35,12 @@ Care Ontario.
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
+
+// VTK includes
+#include <vtkPointData.h>
+
 int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
 {
   vtkNew<vtkMRMLSegmentationStorageNode> node1;
@@ -54,6 +62,8 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToClosedSurfaceConversionRule>::New());
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkFractionalLabelmapToClosedSurfaceConversionRule>::New());
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkClosedSurfaceToFractionalLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule>::New());
 
   const char* itkSnapSegmentationFilename = argv[1]; // ITKSnapSegmentation.nii.gz
   const char* oldSlicerSegmentationFilename = argv[2]; // OldSlicerSegmentation.seg.nrrd: Segmentation before shared labelmaps implemented.
@@ -116,6 +126,22 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
     CHECK_INT(numberOfLayers, 2);
   }
 
+  std::cout << "Testing preloaded shared labelmap segmentation" << std::endl;
+  {
+    vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+    scene->AddNode(segmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> segmentationStorageNode;
+    scene->AddNode(segmentationStorageNode);
+    segmentationStorageNode->SetFileName(slicerSegmentationFilename);
+    CHECK_BOOL(segmentationStorageNode->CanPreloadData(), true);
+    CHECK_BOOL(segmentationStorageNode->PreloadData(), true);
+    CHECK_INT(segmentationStorageNode->ReadData(segmentationNode), 1);
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+    CHECK_NOT_NULL(segmentation);
+    CHECK_INT(segmentation->GetNumberOfSegments(), 3);
+    CHECK_INT(segmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()), 2);
+  }
+
   std::cout << "Testing empty segmentation" << std::endl;
   {
     // Create empty segmentation
@@ -155,5 +181,68 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
     vtksys::SystemTools::RemoveFile(emptySegmentationFilename);
   }
 
+  std::cout << "Testing sparse binary labelmap segmentation" << std::endl;
+  {
+    vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+    scene->AddNode(segmentationNode);
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+    segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+    for (int segmentIndex = 0; segmentIndex < 2; ++segmentIndex)
+    {
+      vtkNew<vtkOrientedImageData> image;
+      image->SetExtent(0, 39, 0, 29, 0, 19);
+      image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+      image->GetPointData()->GetScalars()->Fill(0);
+      for (int k = 5; k < 15; ++k)
+      {
+        for (int j = 5; j < 25; ++j)
+        {
+          for (int i = 5 + segmentIndex * 15; i < 20 + segmentIndex * 15; ++i)
+          {
+            *static_cast<unsigned char*>(image->GetScalarPointer(i, j, k)) = 1;
+          }
+        }
+      }
+      vtkNew<vtkOrientedSparseBinaryLabelmap> sparseLabelmap;
+      CHECK_BOOL(sparseLabelmap->SetFromImage(image), true);
+      vtkNew<vtkSegment> segment;
+      segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName(), sparseLabelmap);
+      segmentation->AddSegment(segment);
+    }
+
+    // Sparse binary labelmaps are written as binary labelmaps
+    vtkNew<vtkMRMLSegmentationStorageNode> segmentationStorageNode;
+    scene->AddNode(segmentationStorageNode);
+    segmentationNode->SetAndObserveStorageNodeID(segmentationStorageNode->GetID());
+    CHECK_STRING(segmentationStorageNode->GetDefaultWriteFileExtension(), "seg.nrrd");
+    std::string sparseSegmentationFilename = std::string(tempDir) + "/SparseSegmentation.seg.nrrd";
+    segmentationStorageNode->SetFileName(sparseSegmentationFilename.c_str());
+    CHECK_INT(segmentationStorageNode->WriteData(segmentationNode), 1);
+    // Segmentation is not modified by writing
+    CHECK_STD_STRING(segmentation->GetSourceRepresentationName(),
+      vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+    CHECK_BOOL(segmentation->ContainsRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()), false);
+
+    // Sparse binary labelmap is the source representation after reading
+    vtkNew<vtkMRMLSegmentationNode> segmentationNodeFromFile;
+    scene->AddNode(segmentationNodeFromFile);
+    CHECK_INT(segmentationStorageNode->ReadData(segmentationNodeFromFile), 1);
+    vtkSegmentation* segmentationFromFile = segmentationNodeFromFile->GetSegmentation();
+    CHECK_STD_STRING(segmentationFromFile->GetSourceRepresentationName(),
+      vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+    CHECK_BOOL(segmentationFromFile->ContainsRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()), false);
+    CHECK_INT(segmentationFromFile->GetNumberOfSegments(), 2);
+    for (int segmentIndex = 0; segmentIndex < 2; ++segmentIndex)
+    {
+      vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+        segmentationFromFile->GetNthSegment(segmentIndex)->GetRepresentation(
+          vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName()));
+      CHECK_NOT_NULL(sparseLabelmap);
+      CHECK_INT(static_cast<int>(sparseLabelmap->GetNumberOfVoxelsInside()), 15 * 20 * 10);
+    }
+
+    vtksys::SystemTools::RemoveFile(sparseSegmentationFilename);
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,150 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkIdList.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <set>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+struct EventRecorder
+{
+  int NumberOfItemModifiedEvents{0};
+  int NumberOfItemReparentedEvents{0};
+  int NumberOfItemAddedEvents{0};
+  int NumberOfBatchModifiedEvents{0};
+  std::vector<vtkIdType> BatchModifiedItemIDs;
+};
+
+//---------------------------------------------------------------------------
+void RecordEvent(vtkObject*, unsigned long eid, void* clientData, void* callData)
+{
+  EventRecorder* recorder = reinterpret_cast<EventRecorder*>(clientData);
+  switch (eid)
+  {
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent:
+      recorder->NumberOfItemModifiedEvents++;
+      break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
+      recorder->NumberOfItemReparentedEvents++;
+      break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent:
+      recorder->NumberOfItemAddedEvents++;
+      break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemsBatchModifiedEvent:
+    {
+      recorder->NumberOfBatchModifiedEvents++;
+      vtkIdList* itemIDs = reinterpret_cast<vtkIdList*>(callData);
+      for (vtkIdType index = 0; itemIDs && index < itemIDs->GetNumberOfIds(); ++index)
+      {
+        recorder->BatchModifiedItemIDs.push_back(itemIDs->GetId(index));
+      }
+    }
+      break;
+    default:
+      break;
+  }
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNodeBatchModifyTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  vtkIdType folder1ItemID = shNode->CreateFolderItem(sceneItemID, "Folder1");
+  vtkIdType folder2ItemID = shNode->CreateFolderItem(sceneItemID, "Folder2");
+  vtkIdType folder3ItemID = shNode->CreateFolderItem(sceneItemID, "Folder3");
+
+  EventRecorder recorder;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(RecordEvent);
+  callback->SetClientData(&recorder);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemsBatchModifiedEvent, callback);
+
+  // Without batch modify, each change invokes its own event
+  shNode->SetItemName(folder1ItemID, "Renamed");
+  CHECK_BOOL(recorder.NumberOfItemModifiedEvents > 0, true);
+  CHECK_INT(recorder.NumberOfBatchModifiedEvents, 0);
+  recorder = EventRecorder();
+
+  //---------------------------------------------------------------------------
+  // Changes are collected until the outermost batch ends
+  CHECK_BOOL(shNode->IsItemBatchModifyInProgress(), false);
+  CHECK_INT(shNode->StartItemBatchModify(), 0);
+  CHECK_BOOL(shNode->IsItemBatchModifyInProgress(), true);
+
+  shNode->SetItemName(folder1ItemID, "Folder1");
+  shNode->SetItemName(folder1ItemID, "Folder1 renamed");
+  shNode->SetItemParent(folder2ItemID, folder1ItemID);
+
+  CHECK_INT(shNode->StartItemBatchModify(), 1);
+  shNode->SetItemAttribute(folder3ItemID, "Attribute", "Value");
+  // Added events are still invoked immediately
+  vtkIdType folder4ItemID = shNode->CreateFolderItem(folder3ItemID, "Folder4");
+  CHECK_INT(recorder.NumberOfItemAddedEvents, 1);
+  shNode->SetItemName(folder4ItemID, "Folder4 renamed");
+  CHECK_BOOL(shNode->RemoveItem(folder4ItemID), true);
+  CHECK_INT(shNode->EndItemBatchModify(), 1);
+
+  CHECK_INT(recorder.NumberOfItemModifiedEvents, 0);
+  CHECK_INT(recorder.NumberOfItemReparentedEvents, 0);
+  CHECK_INT(recorder.NumberOfBatchModifiedEvents, 0);
+
+  CHECK_INT(shNode->EndItemBatchModify(), 0);
+  CHECK_BOOL(shNode->IsItemBatchModifyInProgress(), false);
+
+  // One event with each affected item listed once, removed items are not listed
+  CHECK_INT(recorder.NumberOfItemModifiedEvents, 0);
+  CHECK_INT(recorder.NumberOfItemReparentedEvents, 0);
+  CHECK_INT(recorder.NumberOfBatchModifiedEvents, 1);
+  std::set<vtkIdType> batchModifiedItemIDs(recorder.BatchModifiedItemIDs.begin(), recorder.BatchModifiedItemIDs.end());
+  CHECK_INT(static_cast<int>(batchModifiedItemIDs.size()), static_cast<int>(recorder.BatchModifiedItemIDs.size()));
+  CHECK_BOOL(batchModifiedItemIDs.count(folder1ItemID) > 0, true);
+  CHECK_BOOL(batchModifiedItemIDs.count(folder2ItemID) > 0, true);
+  CHECK_BOOL(batchModifiedItemIDs.count(folder3ItemID) > 0, true);
+  CHECK_BOOL(batchModifiedItemIDs.count(folder4ItemID) > 0, false);
+  CHECK_INT(shNode->GetItemParent(folder2ItemID), folder1ItemID);
+  CHECK_STD_STRING(shNode->GetItemName(folder1ItemID), "Folder1 renamed");
+
+  //---------------------------------------------------------------------------
+  // Empty batch does not invoke any event, unbalanced end is reported
+  recorder = EventRecorder();
+  shNode->StartItemBatchModify();
+  shNode->EndItemBatchModify();
+  CHECK_INT(recorder.NumberOfBatchModifiedEvents, 0);
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(shNode->EndItemBatchModify(), 0);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int TestIndexConsistency()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  vtkIdType subjectItemID = shNode->CreateSubjectItem(sceneItemID, "Subject");
+  vtkIdType studyItemID = shNode->CreateStudyItem(subjectItemID, "Study");
+  vtkIdType folderItemID = shNode->CreateFolderItem(sceneItemID, "Folder");
+  std::vector<vtkIdType> seriesItemIDs;
+  for (int i = 0; i < 4; ++i)
+  {
+    std::stringstream name;
+    name << "Series" << i;
+    vtkIdType seriesItemID = shNode->CreateFolderItem(studyItemID, name.str());
+    shNode->SetItemUID(seriesItemID, "DICOM", name.str());
+    seriesItemIDs.push_back(seriesItemID);
+  }
+
+  // UID lookup
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series2"), seriesItemIDs[2]);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series5"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID("Other", "Series2"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Changed and removed UIDs
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  shNode->SetItemUID(seriesItemIDs[2], "DICOM", "Changed");
+  TESTING_OUTPUT_ASSERT_WARNINGS_END();
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series2"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Changed"), seriesItemIDs[2]);
+  CHECK_BOOL(shNode->RemoveItemUID(seriesItemIDs[2], "DICOM"), true);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Changed"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Same UID in multiple items: the other one is found after removing the first
+  shNode->SetItemUID(folderItemID, "DICOM", "Series3");
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series3"), seriesItemIDs[3]);
+  CHECK_BOOL(shNode->RemoveItem(seriesItemIDs[3]), true);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series3"), folderItemID);
+
+  // Positions
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[0]), 0);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[2]), 2);
+  CHECK_BOOL(shNode->MoveItem(seriesItemIDs[2], seriesItemIDs[0]), true);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[2]), 0);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[0]), 1);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[1]), 2);
+  CHECK_BOOL(shNode->MoveItem(seriesItemIDs[2], vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID), true);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[2]), 2);
+  CHECK_BOOL(shNode->MoveItem(seriesItemIDs[0], seriesItemIDs[2]), true);
+  CHECK_INT(shNode->GetItemByPositionUnderParent(studyItemID, 0), seriesItemIDs[1]);
+  CHECK_INT(shNode->GetItemByPositionUnderParent(studyItemID, 1), seriesItemIDs[0]);
+  CHECK_INT(shNode->GetItemByPositionUnderParent(studyItemID, 2), seriesItemIDs[2]);
+
+  // Reparent
+  shNode->SetItemParent(seriesItemIDs[1], folderItemID);
+  CHECK_INT(shNode->GetItemParent(seriesItemIDs[1]), folderItemID);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[1]), 0);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[0]), 0);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series1"), seriesItemIDs[1]);
+
+  // Removing a parent item reparents its children
+  CHECK_BOOL(shNode->RemoveItem(studyItemID, true, false), true);
+  CHECK_INT(shNode->GetItemParent(seriesItemIDs[0]), subjectItemID);
+  CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[2]), 1);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "Series0"), seriesItemIDs[0]);
+
+  // Data node lookup
+  vtkNew<vtkMRMLModelNode> dataNode;
+  scene->AddNode(dataNode);
+  vtkIdType dataItemID = shNode->CreateItem(folderItemID, dataNode);
+  CHECK_INT(shNode->GetItemByDataNode(dataNode), dataItemID);
+  CHECK_BOOL(shNode->RemoveItem(dataItemID, false), true);
+  CHECK_INT(shNode->GetItemByDataNode(dataNode), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestIndexPerformance(int numberOfSeries)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+
+  // Create a DICOM-like hierarchy with many series in each study
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkIdType subjectItemID = shNode->CreateSubjectItem(shNode->GetSceneItemID(), "Subject");
+  vtkIdType studyItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+  std::vector<vtkIdType> seriesItemIDs;
+  for (int i = 0; i < numberOfSeries; ++i)
+  {
+    if (i % 100 == 0)
+    {
+      studyItemID = shNode->CreateStudyItem(subjectItemID, "Study");
+    }
+    std::stringstream uid;
+    uid << "1.2.3." << i;
+    vtkIdType seriesItemID = shNode->CreateFolderItem(studyItemID, uid.str());
+    shNode->SetItemUID(seriesItemID, "DICOM", uid.str());
+    seriesItemIDs.push_back(seriesItemID);
+  }
+  timer->StopTimer();
+  std::cout << "Create " << numberOfSeries << " series: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfSeries; ++i)
+  {
+    std::stringstream uid;
+    uid << "1.2.3." << i;
+    CHECK_INT(shNode->GetItemByUID("DICOM", uid.str().c_str()), seriesItemIDs[i]);
+  }
+  timer->StopTimer();
+  std::cout << "Find " << numberOfSeries << " series by UID: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  // Reparent all series into the last study.
+  // Series that are already in the last study are first, the reparented ones are appended.
+  int firstSeriesInLastStudy = ((numberOfSeries - 1) / 100) * 100;
+  int numberOfSeriesInLastStudy = numberOfSeries - firstSeriesInLastStudy;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfSeries; ++i)
+  {
+    shNode->SetItemParent(seriesItemIDs[i], studyItemID, false);
+    int expectedPosition = (i < firstSeriesInLastStudy ? numberOfSeriesInLastStudy + i : i - firstSeriesInLastStudy);
+    CHECK_INT(shNode->GetItemPositionUnderParent(seriesItemIDs[i]), expectedPosition);
+  }
+  timer->StopTimer();
+  std::cout << "Reparent " << numberOfSeries << " series: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNodeIndexTest(int argc, char* argv[])
+{
+  int numberOfSeries = 5000;
+  if (argc > 1)
+  {
+    numberOfSeries = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestIndexConsistency());
+  CHECK_EXIT_SUCCESS(TestIndexPerformance(numberOfSeries));
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 =========================================================================auto=*/
 
 #include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLVectorVolumeNode.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
@@ -124,6 +125,49 @@ int TestVoxelVectorType(const std::string& tempDir, const std::string& fileExten
   return EXIT_SUCCESS;
 }
 
+//---------------------------------------------------------------------------
+int TestPreloadData(const std::string& tempDir)
+{
+  // Check that a scalar volume that is read on a worker thread is used by ReadData.
+  std::cout << "TestPreloadData" << std::endl;
+
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_NOT_NULL(volumeNode);
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(10, 20, 30);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->Fill(7);
+  volumeNode->SetAndObserveImageData(imageData);
+
+  vtkMRMLVolumeArchetypeStorageNode* storageNode = vtkMRMLVolumeArchetypeStorageNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLVolumeArchetypeStorageNode"));
+  CHECK_NOT_NULL(storageNode);
+  storageNode->SetSingleFile(true);
+  storageNode->SetFileName(tempFilename(tempDir, "preload", "mha", true).c_str());
+  CHECK_BOOL(storageNode->WriteData(volumeNode), true);
+
+  vtkMRMLScalarVolumeNode* readVolumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  readVolumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  CHECK_BOOL(storageNode->CanPreloadData(), true);
+  CHECK_BOOL(storageNode->PreloadData(), true);
+  CHECK_BOOL(storageNode->ReadData(readVolumeNode), true);
+  CHECK_NOT_NULL(readVolumeNode->GetImageData());
+  CHECK_INT(readVolumeNode->GetImageData()->GetDimensions()[2], 30);
+  CHECK_DOUBLE(readVolumeNode->GetImageData()->GetScalarComponentAsDouble(5, 10, 15, 0), 7.0);
+
+  // Vector volumes are not preloaded
+  vtkMRMLVectorVolumeNode* vectorVolumeNode = vtkMRMLVectorVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLVectorVolumeNode"));
+  vectorVolumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  CHECK_BOOL(storageNode->CanPreloadData(), false);
+
+  return EXIT_SUCCESS;
+}
+
 int vtkMRMLVolumeArchetypeStorageNodeTest1(int argc, char* argv[])
 {
   if (argc != 2)
@@ -144,6 +188,8 @@ int vtkMRMLVolumeArchetypeStorageNodeTest1(int argc, char* argv[])
   CHECK_EXIT_SUCCESS(TestVoxelVectorType(tempDir, "tif",  false,     false,   true,  false));
   CHECK_EXIT_SUCCESS(TestVoxelVectorType(tempDir, "jpg",  false,     false,   true,  false));
 
+  CHECK_EXIT_SUCCESS(TestPreloadData(tempDir));
+
   std::cout << "Test passed." << std::endl;
   return EXIT_SUCCESS;
 }
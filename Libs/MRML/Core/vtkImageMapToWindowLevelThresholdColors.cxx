@@ -0,0 +1,475 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTypeTraits.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageMapToWindowLevelThresholdColors);
+vtkCxxSetObjectMacro(vtkImageMapToWindowLevelThresholdColors, LookupTable, vtkScalarsToColors);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+unsigned char ClampToUnsignedChar(double value)
+{
+  if (value > 255.0)
+  {
+    return 255;
+  }
+  if (value < 0.0)
+  {
+    return 0;
+  }
+  return static_cast<unsigned char>(value);
+}
+
+//----------------------------------------------------------------------------
+/// Maps input values to 0..255 the same way as vtkImageMapToWindowLevelColors
+/// (luminance output, no lookup table), so that results are identical.
+template <class T>
+class WindowLevelMapper
+{
+public:
+  WindowLevelMapper(double window, double level)
+  {
+    const double rangeMin = static_cast<double>(vtkTypeTraits<T>::Min());
+    const double rangeMax = static_cast<double>(vtkTypeTraits<T>::Max());
+    const double lower = level - fabs(window) / 2.0;
+    const double upper = lower + fabs(window);
+    const double adjustedLower = std::min(std::max(lower, rangeMin), rangeMax);
+    const double adjustedUpper = std::min(std::max(upper, rangeMin), rangeMax);
+    this->Lower = static_cast<T>(adjustedLower);
+    this->Upper = static_cast<T>(adjustedUpper);
+    double lowerValue = 255.0 * (adjustedLower - lower) / window;
+    double upperValue = 255.0 * (adjustedUpper - lower) / window;
+    if (window < 0.0)
+    {
+      lowerValue += 255.0;
+      upperValue += 255.0;
+    }
+    this->LowerValue = ClampToUnsignedChar(lowerValue);
+    this->UpperValue = ClampToUnsignedChar(upperValue);
+    this->Shift = window / 2.0 - level;
+    this->Scale = 255.0 / window;
+  }
+
+  unsigned char Map(T value) const
+  {
+    if (value <= this->Lower)
+    {
+      return this->LowerValue;
+    }
+    if (value >= this->Upper)
+    {
+      return this->UpperValue;
+    }
+    return static_cast<unsigned char>((value + this->Shift) * this->Scale);
+  }
+
+protected:
+  T Lower;
+  T Upper;
+  unsigned char LowerValue;
+  unsigned char UpperValue;
+  double Shift;
+  double Scale;
+};
+
+//----------------------------------------------------------------------------
+/// Tests if input values are in the threshold range the same way as vtkImageThreshold.
+template <class T>
+class ThresholdTester
+{
+public:
+  ThresholdTester(double lower, double upper)
+  {
+    const double rangeMin = static_cast<double>(vtkTypeTraits<T>::Min());
+    const double rangeMax = static_cast<double>(vtkTypeTraits<T>::Max());
+    this->Lower = static_cast<T>(std::min(std::max(lower, rangeMin), rangeMax));
+    this->Upper = static_cast<T>(std::min(std::max(upper, rangeMin), rangeMax));
+  }
+
+  bool IsInside(T value) const
+  {
+    return this->Lower <= value && value <= this->Upper;
+  }
+
+protected:
+  T Lower;
+  T Upper;
+};
+
+//----------------------------------------------------------------------------
+/// The classic pipeline combines lookup table alpha with the threshold
+/// using a logical AND, therefore alpha is either 0 or 255.
+void BinarizeAlpha(unsigned char* rgba, vtkIdType numberOfValues)
+{
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+  {
+    rgba[4 * i + 3] = (rgba[4 * i + 3] ? 255 : 0);
+  }
+}
+
+//----------------------------------------------------------------------------
+struct ColorMappingParameters
+{
+  double Window;
+  double Level;
+  bool ApplyThreshold;
+  double LowerThreshold;
+  double UpperThreshold;
+  /// Lookup table for mapping input values directly (nullptr if window/level is used)
+  vtkScalarsToColors* DirectLookupTable;
+  const unsigned char* LuminanceColors;
+  /// Colors of all possible input values (nullptr if colors are computed for each voxel)
+  const unsigned char* ValueColors;
+};
+
+//----------------------------------------------------------------------------
+ColorMappingParameters GetColorMappingParameters(vtkImageMapToWindowLevelThresholdColors* self)
+{
+  ColorMappingParameters parameters = {};
+  parameters.Window = self->GetWindow();
+  parameters.Level = self->GetLevel();
+  parameters.ApplyThreshold = self->GetApplyThreshold();
+  parameters.LowerThreshold = self->GetLowerThreshold();
+  parameters.UpperThreshold = self->GetUpperThreshold();
+  parameters.DirectLookupTable = self->GetBypassWindowLevel() ? self->GetLookupTable() : nullptr;
+  return parameters;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void ComputeValueColors(const ColorMappingParameters& parameters, std::vector<unsigned char>& valueColors)
+{
+  const vtkIdType minValue = static_cast<vtkIdType>(vtkTypeTraits<T>::Min());
+  const vtkIdType numberOfValues = static_cast<vtkIdType>(vtkTypeTraits<T>::Max()) - minValue + 1;
+  std::vector<T> values(numberOfValues);
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+  {
+    values[i] = static_cast<T>(minValue + i);
+  }
+  valueColors.resize(4 * numberOfValues);
+  if (parameters.DirectLookupTable)
+  {
+    parameters.DirectLookupTable->MapScalarsThroughTable(values.data(), valueColors.data(),
+      vtkTypeTraits<T>::VTKTypeID(), numberOfValues, 1, VTK_RGBA);
+    BinarizeAlpha(valueColors.data(), numberOfValues);
+  }
+  else
+  {
+    WindowLevelMapper<T> windowLevel(parameters.Window, parameters.Level);
+    for (vtkIdType i = 0; i < numberOfValues; ++i)
+    {
+      memcpy(&valueColors[4 * i], parameters.LuminanceColors + 4 * windowLevel.Map(values[i]), 4);
+    }
+  }
+  if (parameters.ApplyThreshold)
+  {
+    ThresholdTester<T> threshold(parameters.LowerThreshold, parameters.UpperThreshold);
+    for (vtkIdType i = 0; i < numberOfValues; ++i)
+    {
+      if (!threshold.IsInside(values[i]))
+      {
+        valueColors[4 * i + 3] = 0;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageMapToWindowLevelThresholdColorsExecute(const ColorMappingParameters& parameters,
+  vtkImageData* inData, T* inPtr, vtkImageData* outData, unsigned char* outPtr,
+  vtkImageStencilData* stencil, int outExt[6])
+{
+  vtkIdType inIncX, inIncY, inIncZ;
+  inData->GetIncrements(inIncX, inIncY, inIncZ);
+  vtkIdType outIncX, outIncY, outIncZ;
+  outData->GetIncrements(outIncX, outIncY, outIncZ);
+  const vtkIdType rowLength = outExt[1] - outExt[0] + 1;
+
+  WindowLevelMapper<T> windowLevel(parameters.Window, parameters.Level);
+  ThresholdTester<T> threshold(parameters.LowerThreshold, parameters.UpperThreshold);
+
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+  {
+    for (int y = outExt[2]; y <= outExt[3]; ++y)
+    {
+      const T* inRow = inPtr + (z - outExt[4]) * inIncZ + (y - outExt[2]) * inIncY;
+      unsigned char* outRow = outPtr + (z - outExt[4]) * outIncZ + (y - outExt[2]) * outIncY;
+
+      if (parameters.ValueColors)
+      {
+        // Window/level, lookup table and threshold are all precomputed
+        // (only used for 8 and 16-bit integer types)
+        const vtkIdType minValue = static_cast<vtkIdType>(vtkTypeTraits<T>::Min());
+        for (vtkIdType x = 0; x < rowLength; ++x)
+        {
+          memcpy(outRow + 4 * x, parameters.ValueColors + 4 * (static_cast<vtkIdType>(inRow[x * inIncX]) - minValue), 4);
+        }
+      }
+      else
+      {
+        if (parameters.DirectLookupTable)
+        {
+          parameters.DirectLookupTable->MapScalarsThroughTable(const_cast<T*>(inRow), outRow,
+            vtkTypeTraits<T>::VTKTypeID(), rowLength, inIncX, VTK_RGBA);
+          BinarizeAlpha(outRow, rowLength);
+        }
+        else
+        {
+          for (vtkIdType x = 0; x < rowLength; ++x)
+          {
+            memcpy(outRow + 4 * x, parameters.LuminanceColors + 4 * windowLevel.Map(inRow[x * inIncX]), 4);
+          }
+        }
+        if (parameters.ApplyThreshold)
+        {
+          for (vtkIdType x = 0; x < rowLength; ++x)
+          {
+            if (!threshold.IsInside(inRow[x * inIncX]))
+            {
+              outRow[4 * x + 3] = 0;
+            }
+          }
+        }
+      }
+
+      if (stencil)
+      {
+        // Make voxels transparent in the gaps between stencil extents
+        int r1 = 0;
+        int r2 = 0;
+        int iter = 0;
+        int gapStart = outExt[0];
+        bool moreExtents = true;
+        while (moreExtents)
+        {
+          moreExtents = stencil->GetNextExtent(r1, r2, outExt[0], outExt[1], y, z, iter);
+          int gapEnd = moreExtents ? r1 - 1 : outExt[1];
+          for (int x = gapStart; x <= gapEnd; ++x)
+          {
+            outRow[4 * (x - outExt[0]) + 3] = 0;
+          }
+          gapStart = r2 + 1;
+        }
+      }
+    }
+  }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetNumberOfInputPorts(2);
+}
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::~vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetLookupTable(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Window: " << this->Window << "\n";
+  os << indent << "Level: " << this->Level << "\n";
+  os << indent << "BypassWindowLevel: " << this->BypassWindowLevel << "\n";
+  os << indent << "ApplyThreshold: " << this->ApplyThreshold << "\n";
+  os << indent << "LowerThreshold: " << this->LowerThreshold << "\n";
+  os << indent << "UpperThreshold: " << this->UpperThreshold << "\n";
+  os << indent << "LookupTable: " << this->LookupTable << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::SetStencilConnection(vtkAlgorithmOutput* stencilConnection)
+{
+  this->SetInputConnection(1, stencilConnection);
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput* vtkImageMapToWindowLevelThresholdColors::GetStencilConnection()
+{
+  return this->GetNumberOfInputConnections(1) > 0 ? this->GetInputConnection(1, 0) : nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageMapToWindowLevelThresholdColors::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->LookupTable)
+  {
+    mTime = std::max(mTime, this->LookupTable->GetMTime());
+  }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (port == 1)
+  {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageStencilData");
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+    return 1;
+  }
+  return this->Superclass::FillInputPortInformation(port, info);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestInformation(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestData(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkImageData* inData = vtkImageData::GetData(inputVector[0]);
+  if (!inData || !inData->GetPointData() || !inData->GetPointData()->GetScalars())
+  {
+    vtkErrorMacro("RequestData: input image scalars are missing");
+    return 0;
+  }
+
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  outputVector->GetInformationObject(0)->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+  vtkIdType numberOfOutputVoxels = 1;
+  for (int i = 0; i < 3; ++i)
+  {
+    numberOfOutputVoxels *= std::max(0, updateExtent[2 * i + 1] - updateExtent[2 * i] + 1);
+  }
+
+  // Tables are shared by all threads, so they must be computed before the work is split
+  this->UpdateColorTables(inData, numberOfOutputVoxels);
+
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::UpdateColorTables(vtkImageData* inData, vtkIdType numberOfOutputVoxels)
+{
+  const int numberOfLuminanceValues = 256;
+  this->LuminanceColors.resize(4 * numberOfLuminanceValues);
+  if (this->LookupTable)
+  {
+    this->LookupTable->Build();
+  }
+  if (this->LookupTable && !this->BypassWindowLevel)
+  {
+    unsigned char luminanceValues[numberOfLuminanceValues];
+    for (int i = 0; i < numberOfLuminanceValues; ++i)
+    {
+      luminanceValues[i] = static_cast<unsigned char>(i);
+    }
+    this->LookupTable->MapScalarsThroughTable(luminanceValues, this->LuminanceColors.data(),
+      VTK_UNSIGNED_CHAR, numberOfLuminanceValues, 1, VTK_RGBA);
+    BinarizeAlpha(this->LuminanceColors.data(), numberOfLuminanceValues);
+  }
+  else
+  {
+    for (int i = 0; i < numberOfLuminanceValues; ++i)
+    {
+      memset(&this->LuminanceColors[4 * i], i, 3);
+      this->LuminanceColors[4 * i + 3] = 255;
+    }
+  }
+
+  ColorMappingParameters parameters = GetColorMappingParameters(this);
+  parameters.LuminanceColors = this->LuminanceColors.data();
+
+  // Computing the colors of all possible input values is only worth it if there are more voxels than values
+  int scalarType = inData->GetScalarType();
+  vtkIdType numberOfPossibleValues = 0;
+  switch (scalarType)
+  {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+    case VTK_UNSIGNED_CHAR:
+      numberOfPossibleValues = 256;
+      break;
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+      numberOfPossibleValues = 65536;
+      break;
+    default:
+      break;
+  }
+  if (numberOfPossibleValues == 0 || numberOfOutputVoxels < numberOfPossibleValues)
+  {
+    this->ValueColors.clear();
+    return;
+  }
+  switch (scalarType)
+  {
+    case VTK_CHAR: ComputeValueColors<char>(parameters, this->ValueColors); break;
+    case VTK_SIGNED_CHAR: ComputeValueColors<signed char>(parameters, this->ValueColors); break;
+    case VTK_UNSIGNED_CHAR: ComputeValueColors<unsigned char>(parameters, this->ValueColors); break;
+    case VTK_SHORT: ComputeValueColors<short>(parameters, this->ValueColors); break;
+    case VTK_UNSIGNED_SHORT: ComputeValueColors<unsigned short>(parameters, this->ValueColors); break;
+    default: break;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::ThreadedRequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData, vtkImageData** outData, int outExt[6], int vtkNotUsed(threadId))
+{
+  vtkImageStencilData* stencil = nullptr;
+  if (inputVector[1]->GetNumberOfInformationObjects() > 0)
+  {
+    stencil = vtkImageStencilData::SafeDownCast(
+      inputVector[1]->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+  }
+
+  ColorMappingParameters parameters = GetColorMappingParameters(this);
+  parameters.LuminanceColors = this->LuminanceColors.data();
+  parameters.ValueColors = this->ValueColors.empty() ? nullptr : this->ValueColors.data();
+
+  void* inPtr = inData[0][0]->GetScalarPointerForExtent(outExt);
+  unsigned char* outPtr = static_cast<unsigned char*>(outData[0]->GetScalarPointerForExtent(outExt));
+  switch (inData[0][0]->GetScalarType())
+  {
+    vtkTemplateMacro(vtkImageMapToWindowLevelThresholdColorsExecute(parameters,
+      inData[0][0], static_cast<VTK_TT*>(inPtr), outData[0], outPtr, stencil, outExt));
+    default:
+      vtkErrorMacro("ThreadedRequestData: unknown input scalar type");
+      return;
+  }
+}
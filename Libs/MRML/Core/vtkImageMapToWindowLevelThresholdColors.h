@@ -0,0 +1,128 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageMapToWindowLevelThresholdColors_h
+#define __vtkImageMapToWindowLevelThresholdColors_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+// STD includes
+#include <vector>
+
+class vtkAlgorithmOutput;
+class vtkImageStencilData;
+class vtkScalarsToColors;
+
+/// \brief Map a scalar image to RGBA colors for slice display in a single pass.
+///
+/// Computes the same output as the scalar volume display pipeline of
+/// vtkMRMLScalarVolumeDisplayNode (window/level, lookup table, threshold and
+/// background stencil), but without creating intermediate images.
+///
+/// Window/level maps the input to 0..255, which is then mapped to RGBA using
+/// the lookup table. The lookup table range is expected to be [0, 255], unless
+/// window/level is bypassed, in which case the input values are mapped through
+/// the lookup table directly. If no lookup table is set then window/level
+/// luminance is used for all color components.
+///
+/// The output alpha is 255 if the lookup table alpha is non-zero, the voxel is
+/// within the threshold range (if threshold is applied), and the voxel is inside
+/// the stencil (if a stencil is connected); otherwise it is 0.
+///
+/// For 8 and 16-bit integer inputs the color of every possible input value is
+/// precomputed once per update, so the per-voxel work is a single table lookup.
+class VTK_MRML_EXPORT vtkImageMapToWindowLevelThresholdColors : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageMapToWindowLevelThresholdColors *New();
+  vtkTypeMacro(vtkImageMapToWindowLevelThresholdColors, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  ///
+  /// Window and level used for mapping the input to 0..255.
+  vtkSetMacro(Window, double);
+  vtkGetMacro(Window, double);
+  vtkSetMacro(Level, double);
+  vtkGetMacro(Level, double);
+
+  ///
+  /// If enabled then input values are mapped through the lookup table directly,
+  /// without window/level. Disabled by default.
+  vtkSetMacro(BypassWindowLevel, bool);
+  vtkGetMacro(BypassWindowLevel, bool);
+  vtkBooleanMacro(BypassWindowLevel, bool);
+
+  ///
+  /// If enabled then voxels outside the [LowerThreshold, UpperThreshold] range
+  /// are made fully transparent. Disabled by default.
+  vtkSetMacro(ApplyThreshold, bool);
+  vtkGetMacro(ApplyThreshold, bool);
+  vtkBooleanMacro(ApplyThreshold, bool);
+  vtkSetMacro(LowerThreshold, double);
+  vtkGetMacro(LowerThreshold, double);
+  vtkSetMacro(UpperThreshold, double);
+  vtkGetMacro(UpperThreshold, double);
+
+  ///
+  /// Lookup table that maps window/level output (or input values if window/level
+  /// is bypassed) to RGBA colors.
+  virtual void SetLookupTable(vtkScalarsToColors*);
+  vtkGetObjectMacro(LookupTable, vtkScalarsToColors);
+
+  ///
+  /// Optional stencil (input port 1). Voxels outside the stencil are made
+  /// fully transparent.
+  void SetStencilConnection(vtkAlgorithmOutput* stencilConnection);
+  vtkAlgorithmOutput* GetStencilConnection();
+
+  /// Take into account the lookup table modification time.
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkImageMapToWindowLevelThresholdColors();
+  ~vtkImageMapToWindowLevelThresholdColors() override;
+
+  int FillInputPortInformation(int port, vtkInformation* info) override;
+  int RequestInformation(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
+  void ThreadedRequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector, vtkImageData*** inData, vtkImageData** outData,
+    int outExt[6], int threadId) override;
+
+  /// Compute color tables for the current input, before processing is split between threads.
+  /// \param numberOfOutputVoxels is used for deciding if computing a table entry for each
+  ///   possible input value is cheaper than mapping each voxel.
+  void UpdateColorTables(vtkImageData* inData, vtkIdType numberOfOutputVoxels);
+
+  double Window{ 255.0 };
+  double Level{ 127.5 };
+  bool BypassWindowLevel{ false };
+  bool ApplyThreshold{ false };
+  double LowerThreshold{ VTK_SHORT_MIN };
+  double UpperThreshold{ VTK_SHORT_MAX };
+  vtkScalarsToColors* LookupTable{ nullptr };
+
+  /// RGBA colors for each window/level output value (256 entries)
+  std::vector<unsigned char> LuminanceColors;
+  /// RGBA colors for each possible input value, with threshold applied.
+  /// Empty if colors are computed for each voxel.
+  std::vector<unsigned char> ValueColors;
+
+private:
+  vtkImageMapToWindowLevelThresholdColors(const vtkImageMapToWindowLevelThresholdColors&) = delete;
+  void operator=(const vtkImageMapToWindowLevelThresholdColors&) = delete;
+};
+
+#endif
@@ -43,6 +43,9 @@ class VTK_MRML_EXPORT vtkMRMLLinearTransformSequenceStorageNode : public vtkMRML
   /// Return true if the node can be read in.
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Sequences are read by a custom reader, preloading is not supported
+  bool CanPreloadData() override { return false; };
+
   /// Return true if the node can be written by using the writer.
   bool CanWriteFromReferenceNode(vtkMRMLNode* refNode) override;
   int WriteDataInternal(vtkMRMLNode *refNode) override;
@@ -187,28 +187,104 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
+  int coordinateSystemInFileHeader = -1;
+  vtkSmartPointer<vtkPointSet> meshFromFile;
+  if (this->PreloadedMesh && this->PreloadedFileName == fullName)
+  {
+    // File was already read by PreloadData(), report the warnings of the reader
+    meshFromFile = this->PreloadedMesh;
+    coordinateSystemInFileHeader = this->PreloadedCoordinateSystemInFileHeader;
+    if (this->PreloadedMessages && this->GetUserMessages())
+    {
+      this->GetUserMessages()->AddMessages(this->PreloadedMessages);
+    }
+    this->ClearPreloadedData();
+  }
+  else if (!this->ReadMeshFromFile(fullName, this->GetUserMessages(), meshFromFile, coordinateSystemInFileHeader))
+  {
+    return 0;
+  }
+
+  if (coordinateSystemInFileHeader >= 0)
+  {
+    // coordinate system specified in the file, use it (regardless oassumingf what was the preferred coordinate system in the node)
+    this->CoordinateSystem = coordinateSystemInFileHeader;
+  }
+  else
+  {
+    // no coordinate system in the file, use the currently set coordinate system
+    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
+      << fullName.c_str() << " does not contain coordinate system information. Assuming "
+      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
+  }
+
+  vtkSmartPointer<vtkPointSet> meshToSetInNode;
+  if (this->CoordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
+  {
+    // no flip of first two axes
+    meshToSetInNode = meshFromFile;
+  }
+  else
+  {
+    // transform from RAS to LPS
+    if (meshFromFile->IsA("vtkPolyData"))
+    {
+      meshToSetInNode = vtkSmartPointer<vtkPolyData>::New();
+    }
+    else
+    {
+      meshToSetInNode = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    }
+    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
+  }
+  modelNode->SetAndObserveMesh(meshToSetInNode);
+
+  if (modelNode->GetMesh() != nullptr)
+  {
+    for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
+    {
+      vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
+      // is there an active scalar array?
+      if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
+      {
+        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
+        if (scalarRange)
+        {
+          vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
+          displayNode->SetScalarRange(scalarRange);
+        }
+      }
+    } // For all display nodes
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadMeshFromFile(const std::string& fullName, vtkMRMLMessageCollection* userMessages,
+  vtkSmartPointer<vtkPointSet>& meshFromFile, int& coordinateSystemInFileHeader)
+{
   // compute file prefix
   std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
   if( extension.empty() )
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
       "Model file '" << fullName.c_str() << "' has no file extension while trying to read node (" << (this->ID ? this->ID : "(unknown)") << ").");
     return 0;
   }
 
   vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): extension = " << extension.c_str());
 
-  int coordinateSystemInFileHeader = -1;
-  vtkSmartPointer<vtkPointSet> meshFromFile;
+  coordinateSystemInFileHeader = -1;
+  meshFromFile = nullptr;
   try
   {
     if (extension == std::string(".g") || extension == std::string(".byu"))
     {
       vtkNew<vtkBYUReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetGeometryFileName(fullName.c_str());
       reader->Update();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       meshFromFile = reader->GetOutput();
     }
     else if (extension == std::string(".vtk"))
@@ -227,10 +303,10 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         reader->ReadAllColorScalarsOn();
         reader->ReadAllTCoordsOn();
         reader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(reader);
+        userMessages->SetObservedObject(reader);
         reader->Update();
         meshFromFile = reader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else if (unstructuredGridReader->IsFileUnstructuredGrid())
       {
@@ -241,14 +317,14 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         unstructuredGridReader->ReadAllColorScalarsOn();
         unstructuredGridReader->ReadAllTCoordsOn();
         unstructuredGridReader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(unstructuredGridReader);
+        userMessages->SetObservedObject(unstructuredGridReader);
         unstructuredGridReader->Update();
         meshFromFile = unstructuredGridReader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
           "Failed to load model from VTK file " << fullName << " as it does not contain polydata nor unstructured grid."
           << " The file might be loadable as a volume.");
       }
@@ -257,50 +333,50 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".vtp"))
     {
       vtkNew<vtkXMLPolyDataReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".ucd"))
     {
       vtkNew<vtkAVSucdReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
     }
     else if (extension == std::string(".vtu"))
     {
       vtkNew<vtkXMLUnstructuredGridReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".stl"))
     {
       vtkNew<vtkSTLReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetHeader());
     }
     else if (extension == std::string(".ply"))
     {
       vtkNew<vtkPLYReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       vtkStringArray* comments = reader->GetComments();
       for (int commentIndex = 0; commentIndex < comments->GetNumberOfValues(); commentIndex++)
       {
@@ -315,11 +391,11 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".obj"))
     {
       vtkNew<vtkOBJReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetComment());
     }
     else if (extension == std::string(".meta"))  // model in meta format
@@ -340,7 +416,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
       catch(itk::ExceptionObject &ex)
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
           "Failed to load model from ITK .meta file " << fullName << ": " << ex.GetDescription());
         return 0;
       }
@@ -384,76 +460,59 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
     else
     {
-      vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+      vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
         "Failed to load model: unrecognized file extension '" << extension << "' of file '" << fullName << "'.");
       return 0;
     }
   }
   catch (...)
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
       "Failed to load model: unknown exception while trying to load the file '" << fullName << "'.");
     return 0;
   }
 
-  if (this->GetUserMessages()->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
+  if (userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
   {
     // User messages are already logged, no need for logging more
     return 0;
   }
+  return 1;
+}
 
-  if (coordinateSystemInFileHeader >= 0)
-  {
-    // coordinate system specified in the file, use it (regardless oassumingf what was the preferred coordinate system in the node)
-    this->CoordinateSystem = coordinateSystemInFileHeader;
-  }
-  else
-  {
-    // no coordinate system in the file, use the currently set coordinate system
-    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
-      << fullName.c_str() << " does not contain coordinate system information. Assuming "
-      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
-  }
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::CanPreloadData()
+{
+  return this->GetWriteState() != SkippedNoData;
+}
 
-  vtkSmartPointer<vtkPointSet> meshToSetInNode;
-  if (this->CoordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::PreloadDataInternal(const std::string& fullName)
+{
+  this->ClearPreloadedData();
+  vtkNew<vtkMRMLMessageCollection> preloadMessages;
+  int coordinateSystemInFileHeader = -1;
+  vtkSmartPointer<vtkPointSet> meshFromFile;
+  if (!this->ReadMeshFromFile(fullName, preloadMessages, meshFromFile, coordinateSystemInFileHeader)
+    || !meshFromFile)
   {
-    // no flip of first two axes
-    meshToSetInNode = meshFromFile;
+    // ReadData will try again and report the errors
+    return false;
   }
-  else
-  {
-    // transform from RAS to LPS
-    if (meshFromFile->IsA("vtkPolyData"))
-    {
-      meshToSetInNode = vtkSmartPointer<vtkPolyData>::New();
-    }
-    else
-    {
-      meshToSetInNode = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    }
-    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
-  }
-  modelNode->SetAndObserveMesh(meshToSetInNode);
+  this->PreloadedMesh = meshFromFile;
+  this->PreloadedCoordinateSystemInFileHeader = coordinateSystemInFileHeader;
+  this->PreloadedFileName = fullName;
+  this->PreloadedMessages = preloadMessages;
+  return true;
+}
 
-  if (modelNode->GetMesh() != nullptr)
-  {
-    for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
-    {
-      vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
-      // is there an active scalar array?
-      if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
-      {
-        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
-        if (scalarRange)
-        {
-          vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
-          displayNode->SetScalarRange(scalarRange);
-        }
-      }
-    } // For all display nodes
-  }
-  return 1;
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::ClearPreloadedData()
+{
+  this->PreloadedMesh = nullptr;
+  this->PreloadedCoordinateSystemInFileHeader = -1;
+  this->PreloadedFileName.clear();
+  this->PreloadedMessages = nullptr;
 }
 
 //----------------------------------------------------------------------------
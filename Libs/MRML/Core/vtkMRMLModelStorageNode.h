@@ -17,6 +17,10 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
+class vtkMRMLMessageCollection;
 class vtkMRMLModelNode;
 class vtkPointSet;
 
@@ -45,6 +49,11 @@ public:
   /// Return true if the reference node can be read in
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Models can be preloaded (read into memory on a worker thread)
+  /// \sa vtkMRMLStorageNode::PreloadData()
+  bool CanPreloadData() override;
+  void ClearPreloadedData() override;
+
   /// Get/Set flag that controls if points are to be written in various coordinate systems
   vtkSetClampMacro(CoordinateSystem, int, 0, vtkMRMLStorageNode::CoordinateSystemType_Last-1);
   vtkGetMacro(CoordinateSystem, int);
@@ -76,11 +85,26 @@ protected:
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read the mesh from file without modifying the model node
+  bool PreloadDataInternal(const std::string& fullName) override;
+
+  /// Read mesh and coordinate system information from the file.
+  /// Errors are logged in \a userMessages. Returns 1 on success, 0 otherwise.
+  int ReadMeshFromFile(const std::string& fullName, vtkMRMLMessageCollection* userMessages,
+    vtkSmartPointer<vtkPointSet>& meshFromFile, int& coordinateSystemInFileHeader);
+
   static int GetCoordinateSystemFromFileHeader(const char* header);
 
   static int GetCoordinateSystemFromFieldData(vtkPointSet* mesh);
 
   int CoordinateSystem;
+
+  /// Mesh read by PreloadData(), used by the next ReadData() call
+  vtkSmartPointer<vtkPointSet> PreloadedMesh;
+  int PreloadedCoordinateSystemInFileHeader{-1};
+  std::string PreloadedFileName;
+  /// Messages reported while reading the preloaded mesh
+  vtkSmartPointer<vtkMRMLMessageCollection> PreloadedMessages;
 };
 
 #endif
@@ -47,6 +47,8 @@ vtkMRMLNRRDStorageNode::vtkMRMLNRRDStorageNode()
   this->CompressionPresets.emplace_back(this->GetCompressionParameterFastest(), "Fastest");
   this->CompressionPresets.emplace_back(this->GetCompressionParameterNormal(), "Normal");
   this->CompressionPresets.emplace_back(this->GetCompressionParameterMinimumSize(), "Minimum size");
+  this->CompressionPresets.emplace_back(this->GetCompressionParameterFastestParallel(), "Fastest (multithreaded)");
+  this->CompressionPresets.emplace_back(this->GetCompressionParameterNormalParallel(), "Normal (multithreaded)");
 
   this->CompressionParameter = this->GetCompressionParameterFastest();
 }
@@ -154,18 +156,6 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
-  vtkNew<vtkTeemNRRDReader> reader;
-
-  // Set Reader member variables
-  if (this->CenterImage)
-  {
-    reader->SetUseNativeOriginOff();
-  }
-  else
-  {
-    reader->SetUseNativeOriginOn();
-  }
-
   if (volNode->GetImageData())
   {
     volNode->SetAndObserveImageData (nullptr);
@@ -179,6 +169,29 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
+  vtkSmartPointer<vtkTeemNRRDReader> reader;
+  if (this->PreloadedReader && this->PreloadedFileName == fullName)
+  {
+    // File was already read by PreloadData(), the pipeline is up-to-date
+    // therefore the reader does not read the file again.
+    reader = this->PreloadedReader;
+  }
+  else
+  {
+    reader = vtkSmartPointer<vtkTeemNRRDReader>::New();
+  }
+  this->ClearPreloadedData();
+
+  // Set Reader member variables
+  if (this->CenterImage)
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+
   reader->SetFileName(fullName.c_str());
 
   // Check if this is a NRRD file that we can read
@@ -302,6 +315,48 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLNRRDStorageNode::CanPreloadData()
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNRRDStorageNode::ClearPreloadedData()
+{
+  this->PreloadedReader = nullptr;
+  this->PreloadedFileName.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLNRRDStorageNode::PreloadDataInternal(const std::string& fullName)
+{
+  this->ClearPreloadedData();
+  vtkNew<vtkTeemNRRDReader> reader;
+  if (this->CenterImage)
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+  reader->SetFileName(fullName.c_str());
+  if (!reader->CanReadFile(fullName.c_str()))
+  {
+    return false;
+  }
+  reader->Update();
+  if (reader->GetReadStatus() != 0)
+  {
+    // ReadData() reads the file again and reports the error
+    return false;
+  }
+  this->PreloadedReader = reader.GetPointer();
+  this->PreloadedFileName = fullName;
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 {
@@ -374,6 +429,7 @@ int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   writer->SetInputConnection(volNode->GetImageDataConnection());
   writer->SetUseCompression(this->GetUseCompression());
   writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
+  writer->SetParallelCompression(this->IsParallelCompressionParameter(this->CompressionParameter));
 
   // set volume attributes
   writer->SetIJKToRASMatrix(ijkToRas.GetPointer());
@@ -587,11 +643,13 @@ void vtkMRMLNRRDStorageNode::InitializeSupportedWriteFileTypes()
 //----------------------------------------------------------------------------
 int vtkMRMLNRRDStorageNode::GetGzipCompressionLevelFromCompressionParameter(std::string compressionParameter)
 {
-  if (compressionParameter == this->GetCompressionParameterFastest())
+  if (compressionParameter == this->GetCompressionParameterFastest()
+    || compressionParameter == this->GetCompressionParameterFastestParallel())
   {
     return 1;
   }
-  else if(compressionParameter == this->GetCompressionParameterNormal())
+  else if(compressionParameter == this->GetCompressionParameterNormal()
+    || compressionParameter == this->GetCompressionParameterNormalParallel())
   {
     return 6;
   }
@@ -602,6 +660,13 @@ int vtkMRMLNRRDStorageNode::GetGzipCompressionLevelFromCompressionParameter(std:
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLNRRDStorageNode::IsParallelCompressionParameter(std::string compressionParameter)
+{
+  return compressionParameter == this->GetCompressionParameterFastestParallel()
+    || compressionParameter == this->GetCompressionParameterNormalParallel();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNRRDStorageNode::ConfigureForDataExchange()
 {
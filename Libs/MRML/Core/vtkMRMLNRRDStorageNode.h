@@ -16,6 +16,10 @@
 #define __vtkMRMLNRRDStorageNode_h
 
 #include "vtkMRMLStorageNode.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class vtkDoubleArray;
 class vtkTeemNRRDReader;
 
@@ -66,12 +70,22 @@ class VTK_MRML_EXPORT vtkMRMLNRRDStorageNode : public vtkMRMLStorageNode
   /// instance to turn off compression.
   void ConfigureForDataExchange() override;
 
+  /// Volumes can be preloaded (read into memory on a worker thread)
+  /// \sa vtkMRMLStorageNode::PreloadData()
+  bool CanPreloadData() override;
+  void ClearPreloadedData() override;
+
   /// Compression parameter corresponding to minimum compression (fast)
   std::string GetCompressionParameterFastest() { return "gzip_fastest"; };
   /// Compression parameter corresponding to normal compression
   std::string GetCompressionParameterNormal() { return "gzip_normal"; };
   /// Compression parameter corresponding to maximum compression (slow)
   std::string GetCompressionParameterMinimumSize() { return "gzip_minimum_size"; };
+  /// Compression parameter corresponding to minimum compression, computed using multiple threads.
+  /// The file is readable by any NRRD reader, and Slicer decompresses it using multiple threads.
+  std::string GetCompressionParameterFastestParallel() { return "gzip_fastest_parallel"; };
+  /// Compression parameter corresponding to normal compression, computed using multiple threads
+  std::string GetCompressionParameterNormalParallel() { return "gzip_normal_parallel"; };
 
 protected:
   vtkMRMLNRRDStorageNode();
@@ -91,10 +105,20 @@ protected:
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read the image from file without modifying the volume node
+  bool PreloadDataInternal(const std::string& fullName) override;
+
   /// Convert compression parameter string to gzip compression level
   int GetGzipCompressionLevelFromCompressionParameter(std::string parameter);
 
+  /// Return true if the compression parameter requires compressing data using multiple threads
+  bool IsParallelCompressionParameter(std::string parameter);
+
   int CenterImage;
+
+  /// Reader that has read the file in PreloadData(), used by the next ReadData() call
+  vtkSmartPointer<vtkTeemNRRDReader> PreloadedReader;
+  std::string PreloadedFileName;
 };
 
 #endif
@@ -409,7 +409,8 @@ public:
   vtkGetStringMacro(Description);
 
   /// Name of this node, to be set by the user
-  vtkSetStringMacro(Name);
+  /// If the node is in a scene then the scene's node name index is updated.
+  virtual void SetName(const char* name);
   vtkGetStringMacro(Name);
 
   /// ID use by other nodes to reference this node in XML.
@@ -585,6 +586,7 @@ public:
   /// If the event is not invoked immediately then it will be sent with `callData=nullptr`.
   virtual void InvokeCustomModifiedEvent(int eventId, void *callData=nullptr)
   {
+    this->ContentModifiedTime.Modified();
     if (!this->GetDisableModifiedEvent())
     {
       // DisableModify is inactive, we immediately invoke the event
@@ -598,6 +600,14 @@ public:
     }
   }
 
+  /// \brief Get the time of the most recent change of the node.
+  ///
+  /// In addition to the modification time of the node object (see GetMTime()), it
+  /// takes into account changes that are only reported by custom modified events,
+  /// such as in-place modification of bulk data (image data, mesh, segments).
+  /// \sa InvokeCustomModifiedEvent()
+  vtkMTimeType GetContentModifiedTime();
+
   /// Get the scene this node has been added to.
   virtual vtkMRMLScene* GetScene();
 
@@ -1049,6 +1059,7 @@ private:
   int DisableModifiedEvent{0};
   int ModifiedEventPending{0};
   std::map<int, int> CustomModifiedEventPending; // event id, pending value (number of events grouped together)
+  vtkTimeStamp ContentModifiedTime; // updated when a custom modified event is invoked
 };
 
 /// \brief Safe replacement of MRML node start/end modify.
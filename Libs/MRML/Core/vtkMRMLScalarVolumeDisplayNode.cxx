@@ -14,6 +14,7 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkImageMapToWindowLevelThresholdColors.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
@@ -23,6 +24,7 @@ Version:   $Revision: 1.2 $
 #include <vtkAlgorithmOutput.h>
 #include <vtkCallbackCommand.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkExtractVOI.h>
 #include <vtkImageAppendComponents.h>
 #include <vtkImageCast.h>
 #include <vtkImageData.h>
@@ -34,12 +36,15 @@ Version:   $Revision: 1.2 $
 #include <vtkImageThreshold.h>
 #include <vtkObjectFactory.h>
 #include <vtkLookupTable.h>
+#include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkVersion.h>
 
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLScalarVolumeDisplayNode);
@@ -52,6 +57,8 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   this->AutoWindowLevel = 1;
   this->AutoThreshold = 0;
   this->ApplyThreshold = 0;
+  this->FusedColorMapping = 0;
+  this->AutoLevelsMaximumNumberOfSamples = 1000000;
 
   // try setting a default grayscale color map
   //this->SetDefaultColorMap(0);
@@ -102,6 +109,12 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort() );
   this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort() );
 
+  this->FusedMapToColors = vtkImageMapToWindowLevelThresholdColors::New();
+  this->FusedMapToColors->SetWindow(this->MapToWindowLevelColors->GetWindow());
+  this->FusedMapToColors->SetLevel(this->MapToWindowLevelColors->GetLevel());
+  this->FusedMapToColors->SetLowerThreshold(this->Threshold->GetLowerThreshold());
+  this->FusedMapToColors->SetUpperThreshold(this->Threshold->GetUpperThreshold());
+
   this->HistogramStatistics = nullptr;
   this->IsInCalculateAutoLevels = false;
 
@@ -122,6 +135,7 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
   this->ExtractRGB->Delete();
   this->ExtractAlpha->Delete();
   this->MultiplyAlpha->Delete();
+  this->FusedMapToColors->Delete();
 
   if (this->HistogramStatistics)
   {
@@ -169,6 +183,8 @@ void vtkMRMLScalarVolumeDisplayNode
 ::SetInputToImageDataPipeline(vtkAlgorithmOutput *imageDataConnection)
 {
   this->Threshold->SetInputConnection(imageDataConnection);
+  this->FusedMapToColors->SetInputConnection(imageDataConnection);
+  this->FusedMapToColors->SetBypassWindowLevel(this->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDirectMapping);
 
   if (this->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDirectMapping)
   {
@@ -191,6 +207,7 @@ void vtkMRMLScalarVolumeDisplayNode
 ::SetBackgroundImageStencilDataConnection(vtkAlgorithmOutput *imageDataConnection)
 {
   this->MultiplyAlpha->SetStencilConnection(imageDataConnection);
+  this->FusedMapToColors->SetStencilConnection(imageDataConnection);
 }
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetBackgroundImageStencilDataConnection()
@@ -212,6 +229,11 @@ vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetInputImageDataConnection(
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetOutputImageDataConnection()
 {
+  // The fused filter input is only connected if the pipeline is not customized by a subclass
+  if (this->FusedColorMapping && this->FusedMapToColors->GetNumberOfInputConnections(0) > 0)
+  {
+    return this->FusedMapToColors->GetOutputPort();
+  }
   return this->AppendComponents->GetOutputPort();
 }
 
@@ -260,6 +282,16 @@ void vtkMRMLScalarVolumeDisplayNode::WriteXML(ostream& of, int nIndent)
   ss << this->AutoThreshold;
   of << " autoThreshold=\"" << ss.str() << "\"";
   }
+  {
+  std::stringstream ss;
+  ss << this->FusedColorMapping;
+  of << " fusedColorMapping=\"" << ss.str() << "\"";
+  }
+  {
+  std::stringstream ss;
+  ss << this->AutoLevelsMaximumNumberOfSamples;
+  of << " autoLevelsMaximumNumberOfSamples=\"" << ss.str() << "\"";
+  }
   if (this->WindowLevelPresets.size() > 0)
   {
     for (int p = 0; p < this->GetNumberOfWindowLevelPresets(); p++)
@@ -342,6 +374,18 @@ void vtkMRMLScalarVolumeDisplayNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> this->AutoThreshold;
     }
+    else if (!strcmp(attName, "fusedColorMapping"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->FusedColorMapping;
+    }
+    else if (!strcmp(attName, "autoLevelsMaximumNumberOfSamples"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->AutoLevelsMaximumNumberOfSamples;
+    }
     else if (!strncmp(attName, "windowLevelPreset", 17))
     {
       this->AddWindowLevelPresetFromString(attValue);
@@ -362,12 +406,14 @@ void vtkMRMLScalarVolumeDisplayNode::CopyContent(vtkMRMLNode* anode, bool deepCo
     return;
   }
 
+  this->SetAutoLevelsMaximumNumberOfSamples(node->GetAutoLevelsMaximumNumberOfSamples());
   this->SetAutoWindowLevel( node->GetAutoWindowLevel() );
   this->SetWindowLevel(node->GetWindow(), node->GetLevel());
   this->SetAutoThreshold( node->GetAutoThreshold() ); // don't want to run CalculateAutoLevel
   this->SetApplyThreshold(node->GetApplyThreshold());
   this->SetThreshold(node->GetLowerThreshold(), node->GetUpperThreshold());
   this->SetInterpolate(node->Interpolate);
+  this->SetFusedColorMapping(node->FusedColorMapping);
   for (int p = 0; p < node->GetNumberOfWindowLevelPresets(); p++)
   {
     this->AddWindowLevelPreset(node->GetWindowPreset(p), node->GetLevelPreset(p));
@@ -389,11 +435,13 @@ void vtkMRMLScalarVolumeDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << indent.GetNextIndent() << p << " Window: " << this->GetWindowPreset(p) << " | Level: " << this->GetLevelPreset(p) << "\n";
   }
+  os << indent << "AutoLevelsMaximumNumberOfSamples: " << this->AutoLevelsMaximumNumberOfSamples << "\n";
   os << indent << "AutoThreshold:     " << this->AutoThreshold << "\n";
   os << indent << "ApplyThreshold:    " << this->GetApplyThreshold() << "\n";
   os << indent << "UpperThreshold:    " << this->GetUpperThreshold() << "\n";
   os << indent << "LowerThreshold:    " << this->GetLowerThreshold() << "\n";
   os << indent << "Interpolate:       " << this->Interpolate << "\n";
+  os << indent << "FusedColorMapping: " << this->FusedColorMapping << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -439,6 +487,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindow(double window)
   }
 
   this->MapToWindowLevelColors->SetWindow(window);
+  this->FusedMapToColors->SetWindow(window);
   this->Modified();
 }
 
@@ -457,6 +506,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetLevel(double level)
   }
 
   this->MapToWindowLevelColors->SetLevel(level);
+  this->FusedMapToColors->SetLevel(level);
   this->Modified();
 }
 
@@ -471,6 +521,8 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindowLevel(double window, double level)
 
   this->MapToWindowLevelColors->SetWindow(window);
   this->MapToWindowLevelColors->SetLevel(level);
+  this->FusedMapToColors->SetWindow(window);
+  this->FusedMapToColors->SetLevel(level);
   this->Modified();
 }
 
@@ -507,6 +559,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetApplyThreshold(int apply)
   }
   this->ApplyThreshold = apply;
   this->Threshold->SetOutValue(apply ? 0 : 255);
+  this->FusedMapToColors->SetApplyThreshold(apply != 0);
   this->Modified();
 }
 
@@ -543,6 +596,8 @@ void vtkMRMLScalarVolumeDisplayNode::SetThreshold(double lowerThreshold, double
     return;
   }
   this->Threshold->ThresholdBetween( lowerThreshold, upperThreshold );
+  this->FusedMapToColors->SetLowerThreshold(lowerThreshold);
+  this->FusedMapToColors->SetUpperThreshold(upperThreshold);
   this->Modified();
 }
 
@@ -581,6 +636,7 @@ void vtkMRMLScalarVolumeDisplayNode::UpdateLookupTable(vtkMRMLColorNode* newColo
   }
 
   this->MapToColors->SetLookupTable(lookupTable);
+  this->FusedMapToColors->SetLookupTable(lookupTable);
 }
 
 //---------------------------------------------------------------------------
@@ -746,6 +802,60 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     return;
   }
 
+  this->IsInCalculateAutoLevels = true;
+  double intensityRange[2] = { 0.0, 0.0 };
+  vtkMTimeType imageDataMTime = imageDataScalar->GetMTime();
+  auto cachedAutoLevelsIt = this->AutoLevelsCache.find(imageDataScalar);
+  if (cachedAutoLevelsIt != this->AutoLevelsCache.end()
+    && cachedAutoLevelsIt->second.ImageData == imageDataScalar
+    && cachedAutoLevelsIt->second.ImageDataMTime == imageDataMTime
+    && cachedAutoLevelsIt->second.MaximumNumberOfSamples == this->AutoLevelsMaximumNumberOfSamples)
+  {
+    intensityRange[0] = cachedAutoLevelsIt->second.IntensityRange[0];
+    intensityRange[1] = cachedAutoLevelsIt->second.IntensityRange[1];
+  }
+  else
+  {
+    this->ComputeAutoLevelsRange(imageDataScalar, intensityRange);
+
+    // Remove entries of deleted images
+    for (auto it = this->AutoLevelsCache.begin(); it != this->AutoLevelsCache.end();)
+    {
+      if (it->second.ImageData == nullptr)
+      {
+        it = this->AutoLevelsCache.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    AutoLevelsCacheEntry& cacheEntry = this->AutoLevelsCache[imageDataScalar];
+    cacheEntry.ImageData = imageDataScalar;
+    cacheEntry.ImageDataMTime = imageDataMTime;
+    cacheEntry.MaximumNumberOfSamples = this->AutoLevelsMaximumNumberOfSamples;
+    cacheEntry.IntensityRange[0] = intensityRange[0];
+    cacheEntry.IntensityRange[1] = intensityRange[1];
+  }
+  vtkDebugMacro("CalculateScalarAutoLevels:"
+                << " lower: " << intensityRange[0] << " upper: " << intensityRange[1]);
+
+  int disabledModify = this->StartModify();
+  if (this->GetAutoWindowLevel())
+  {
+    this->SetWindowLevelMinMax(intensityRange[0], intensityRange[1]);
+  }
+  if (this->GetAutoThreshold())
+  {
+    this->SetThreshold(intensityRange[0], intensityRange[1]);
+  }
+  this->EndModify(disabledModify);
+  this->IsInCalculateAutoLevels = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLScalarVolumeDisplayNode::ComputeAutoLevelsRange(vtkImageData* imageData, double intensityRange[2])
+{
   if (this->HistogramStatistics == nullptr)
   {
     this->HistogramStatistics = vtkImageHistogramStatistics::New();
@@ -768,22 +878,60 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     this->HistogramStatistics->SetAutoRangeExpansionFactors(0.0, 0.0);
   }
 
-  this->IsInCalculateAutoLevels = true;
-  this->HistogramStatistics->SetInputData(imageDataScalar);
-  this->HistogramStatistics->Update();
-  double* intensityRange = this->HistogramStatistics->GetAutoRange();
-  vtkDebugMacro("CalculateScalarAutoLevels:"
-                << " lower: " << intensityRange[0] << " upper: " << intensityRange[1]);
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  imageData->GetExtent(extent);
+  int dimensions[3] = { 0, 0, 0 };
+  imageData->GetDimensions(dimensions);
+  int sampleRate = 1;
+  if (this->AutoLevelsMaximumNumberOfSamples > 0)
+  {
+    // Use the same sample rate along all non-singleton axes
+    const vtkIdType numberOfVoxels = static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2];
+    int numberOfSampledAxes = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (dimensions[i] > 1)
+      {
+        ++numberOfSampledAxes;
+      }
+    }
+    if (numberOfVoxels > this->AutoLevelsMaximumNumberOfSamples && numberOfSampledAxes > 0)
+    {
+      sampleRate = static_cast<int>(std::pow(static_cast<double>(numberOfVoxels) / this->AutoLevelsMaximumNumberOfSamples,
+        1.0 / numberOfSampledAxes));
+      sampleRate = std::max(sampleRate, 1);
+      // Rounding may leave slightly more samples than allowed
+      auto getNumberOfSamples = [&dimensions](int rate)
+      {
+        vtkIdType numberOfSamples = 1;
+        for (int i = 0; i < 3; ++i)
+        {
+          numberOfSamples *= (dimensions[i] + rate - 1) / rate;
+        }
+        return numberOfSamples;
+      };
+      while (getNumberOfSamples(sampleRate) > this->AutoLevelsMaximumNumberOfSamples)
+      {
+        ++sampleRate;
+      }
+    }
+  }
 
-  int disabledModify = this->StartModify();
-  if (this->GetAutoWindowLevel())
+  if (sampleRate > 1)
   {
-    this->SetWindowLevelMinMax(intensityRange[0], intensityRange[1]);
+    vtkNew<vtkExtractVOI> sampler;
+    sampler->SetInputData(imageData);
+    sampler->SetVOI(extent);
+    sampler->SetSampleRate(dimensions[0] > 1 ? sampleRate : 1,
+      dimensions[1] > 1 ? sampleRate : 1, dimensions[2] > 1 ? sampleRate : 1);
+    sampler->Update();
+    this->HistogramStatistics->SetInputData(sampler->GetOutput());
   }
-  if (this->GetAutoThreshold())
+  else
   {
-    this->SetThreshold(intensityRange[0], intensityRange[1]);
+    this->HistogramStatistics->SetInputData(imageData);
   }
-  this->EndModify(disabledModify);
-  this->IsInCalculateAutoLevels = false;
+  this->HistogramStatistics->Update();
+  intensityRange[0] = this->HistogramStatistics->GetAutoRange()[0];
+  intensityRange[1] = this->HistogramStatistics->GetAutoRange()[1];
 }
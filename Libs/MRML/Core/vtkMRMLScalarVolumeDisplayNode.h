@@ -26,12 +26,16 @@ class vtkImageCast;
 class vtkImageLogic;
 class vtkImageMapToColors;
 class vtkImageMapToWindowLevelColors;
+class vtkImageMapToWindowLevelThresholdColors;
 class vtkImageStencil;
 class vtkImageThreshold;
 class vtkImageExtractComponents;
 class vtkImageMathematics;
 
+#include <vtkWeakPointer.h>
+
 // STD includes
+#include <map>
 #include <vector>
 
 /// \brief MRML node for representing a volume display attributes.
@@ -109,6 +113,19 @@ class VTK_MRML_EXPORT vtkMRMLScalarVolumeDisplayNode : public vtkMRMLVolumeDispl
   /// Utility function that returns the maximum value of the window level
   double GetWindowLevelMax();
 
+  ///
+  /// Maximum number of voxels used for computing automatic window/level and threshold.
+  /// If the image has more voxels then it is sampled on a regular grid (with the same
+  /// stride along each axis) so that at most this many voxels are used.
+  /// Automatic levels are computed from the 0.1 and 99.9 percentiles. Sampling error of
+  /// their rank is in the order of 1/sqrt(samples), which is about 0.1% at the default
+  /// 1 million samples.
+  /// Set to 0 to always use all voxels (exact computation).
+  /// Computed levels are cached for each image data, and only recomputed when the
+  /// image data or this setting changes.
+  vtkGetMacro(AutoLevelsMaximumNumberOfSamples, vtkIdType);
+  vtkSetMacro(AutoLevelsMaximumNumberOfSamples, vtkIdType);
+
   ///
   /// Specifies whether to apply the threshold
   vtkBooleanMacro(ApplyThreshold, int);
@@ -141,6 +158,17 @@ class VTK_MRML_EXPORT vtkMRMLScalarVolumeDisplayNode : public vtkMRMLVolumeDispl
   vtkSetMacro(Interpolate, int);
   vtkBooleanMacro(Interpolate, int);
 
+  ///
+  /// Compute the displayed RGBA image in a single pass (window/level, lookup table,
+  /// threshold, and background mask are applied at once), instead of using a chain
+  /// of image filters. This avoids allocating intermediate images and makes
+  /// interactive window/level adjustment faster on large slice views.
+  /// The output is the same in both modes. Disabled by default.
+  /// Only used by this class, subclasses that set up their own pipeline ignore it.
+  vtkGetMacro(FusedColorMapping, int);
+  vtkSetMacro(FusedColorMapping, int);
+  vtkBooleanMacro(FusedColorMapping, int);
+
   void SetDefaultColorMap() override;
 
   ///
@@ -204,6 +232,10 @@ protected:
   void UpdateLookupTable(vtkMRMLColorNode* newColorNode);
   void CalculateAutoLevels();
 
+  /// Compute intensity range for automatic window/level and threshold.
+  /// Uses sampling if the image is larger than AutoLevelsMaximumNumberOfSamples.
+  void ComputeAutoLevelsRange(vtkImageData* imageData, double intensityRange[2]);
+
   /// Return the image data with scalar type, it can be in the middle of the
   /// pipeline, it's typically the input of the Threshold/WindowLevel filters
   vtkImageData* GetScalarImageData();
@@ -233,6 +265,8 @@ protected:
   int AutoWindowLevel;
   int ApplyThreshold;
   int AutoThreshold;
+  int FusedColorMapping;
+  vtkIdType AutoLevelsMaximumNumberOfSamples;
 
   vtkImageLogic *AlphaLogic;
   vtkImageMapToColors *MapToColors;
@@ -243,6 +277,9 @@ protected:
   vtkImageExtractComponents *ExtractAlpha;
   vtkImageStencil *MultiplyAlpha;
 
+  /// Computes the same output as the filters above, in one pass
+  vtkImageMapToWindowLevelThresholdColors *FusedMapToColors;
+
   ///
   /// window level presets
   std::vector<WindowLevelPreset> WindowLevelPresets;
@@ -251,6 +288,18 @@ protected:
   /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
   vtkImageHistogramStatistics *HistogramStatistics;
   bool IsInCalculateAutoLevels;
+
+  /// Automatic levels computed for each image data, used for avoiding recomputation
+  /// when the display node is modified or a previously shown image (e.g., volume sequence
+  /// item) is displayed again.
+  struct AutoLevelsCacheEntry
+  {
+    vtkWeakPointer<vtkImageData> ImageData;
+    vtkMTimeType ImageDataMTime{0};
+    vtkIdType MaximumNumberOfSamples{0};
+    double IntensityRange[2]{0.0, 0.0};
+  };
+  std::map<vtkImageData*, AutoLevelsCacheEntry> AutoLevelsCache;
 };
 
 #endif
@@ -71,9 +71,13 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLVectorVolumeDisplayNode.h"
 #include "vtkMRMLViewNode.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
+#include "vtkMRMLVolumeNode.h"
 #include "vtkMRMLVolumeSequenceStorageNode.h"
 #include "vtkURIHandler.h"
 
+// SegmentationCore includes
+#include "vtkSegment.h"
+
 #ifdef MRML_USE_vtkTeem
 #include "vtkMRMLDiffusionTensorVolumeDisplayNode.h"
 #include "vtkMRMLDiffusionTensorVolumeNode.h"
@@ -87,9 +91,13 @@ Version:   $Revision: 1.18 $
 #include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
 #include <vtkDebugLeaks.h>
+#include <vtkImageData.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNGWriter.h>
+#include <vtkPointSet.h>
 #include <vtkSmartPointer.h>
+#include <vtkTable.h>
+#include <vtkTimerLog.h>
 
 // VTKSYS includes
 #include <vtksys/RegularExpression.hxx>
@@ -98,14 +106,14 @@ Version:   $Revision: 1.18 $
 
 // STD includes
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <numeric>
+#include <sstream>
+#include <thread>
 
 //#define MRMLSCENE_VERBOSE
 
-#ifdef MRMLSCENE_VERBOSE
-# include <vtkTimerLog.h>
-#endif
-
 vtkCxxSetObjectMacro(vtkMRMLScene, CacheManager, vtkCacheManager);
 vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager);
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable);
@@ -117,6 +125,8 @@ vtkMRMLScene::vtkMRMLScene()
   this->RandomGenerator.seed(std::random_device{}());
 
   this->NodeIDsMTime = 0;
+  this->NodesByClassMTime = 0;
+  this->NodesByNameMTime = 0;
 
   this->Nodes = vtkCollection::New();
   this->MaximumNumberOfSavedUndoStates = 20;
@@ -688,6 +698,94 @@ int bitwiseOr(int firstValue, int secondValue)
 {
   return firstValue | secondValue;
 }
+
+//------------------------------------------------------------------------------
+// Bulk data of nodes that is typically large and may be modified in-place
+vtkDataObject* GetNodeBulkData(vtkMRMLNode* node)
+{
+  if (vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node))
+  {
+    return volumeNode->GetImageData();
+  }
+  if (vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node))
+  {
+    return modelNode->GetMesh();
+  }
+  if (vtkMRMLTableNode* tableNode = vtkMRMLTableNode::SafeDownCast(node))
+  {
+    return tableNode->GetTable();
+  }
+  return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Replace bulk data of a node (see GetNodeBulkData)
+void SetNodeBulkData(vtkMRMLNode* node, vtkDataObject* bulkData)
+{
+  if (vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node))
+  {
+    volumeNode->SetAndObserveImageData(vtkImageData::SafeDownCast(bulkData));
+  }
+  else if (vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node))
+  {
+    modelNode->SetAndObserveMesh(vtkPointSet::SafeDownCast(bulkData));
+  }
+  else if (vtkMRMLTableNode* tableNode = vtkMRMLTableNode::SafeDownCast(node))
+  {
+    tableNode->SetAndObserveTable(vtkTable::SafeDownCast(bulkData));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Time of last change of the node, including in-place changes of bulk data
+// that does not modify the node itself.
+vtkMTimeType GetNodeUndoContentModifiedTime(vtkMRMLNode* node)
+{
+  vtkMTimeType modifiedTime = node->GetContentModifiedTime();
+  vtkDataObject* bulkData = GetNodeBulkData(node);
+  if (bulkData && bulkData->GetMTime() > modifiedTime)
+  {
+    modifiedTime = bulkData->GetMTime();
+  }
+  return modifiedTime;
+}
+
+//------------------------------------------------------------------------------
+// Objects that use memory in a node and their estimated memory size, in kibibytes.
+// Bulk data and segment representations are listed as separate objects, as they may be
+// shared between nodes. Representations that are shared between segments are listed multiple times.
+void GetNodeUndoMemoryItems(vtkMRMLNode* node, std::vector<std::pair<vtkObject*, unsigned long> >& memoryItems)
+{
+  memoryItems.clear();
+  if (!node)
+  {
+    return;
+  }
+  // Approximate size of node properties, attributes, and references
+  memoryItems.emplace_back(node, 1);
+  if (vtkDataObject* bulkData = GetNodeBulkData(node))
+  {
+    memoryItems.emplace_back(bulkData, bulkData->GetActualMemorySize());
+  }
+  vtkMRMLSegmentationNode* segmentationNode = vtkMRMLSegmentationNode::SafeDownCast(node);
+  if (segmentationNode && segmentationNode->GetSegmentation())
+  {
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+    for (int segmentIndex = 0; segmentIndex < segmentation->GetNumberOfSegments(); ++segmentIndex)
+    {
+      vtkSegment* segment = segmentation->GetNthSegment(segmentIndex);
+      std::vector<std::string> representationNames;
+      segment->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+      {
+        if (vtkDataObject* representation = segment->GetRepresentation(representationName))
+        {
+          memoryItems.emplace_back(representation, representation->GetActualMemorySize());
+        }
+      }
+    }
+  }
+}
 }
 
 //------------------------------------------------------------------------------
@@ -874,9 +972,13 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
 
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, nullptr);
 
+    // Read data files concurrently. Data is set in the nodes in UpdateScene.
+    std::map<vtkMRMLStorageNode*, double> preloadTimes = this->PreloadNodesData(addedNodes);
+
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
+
     for (addedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)addedNodes->GetNextItemAsObject(it)) ;)
     {
@@ -886,9 +988,27 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
       if (node->GetAddToScene())
       {
         int errorsBefore = userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent);
+        double updateStartTime = vtkTimerLog::GetUniversalTime();
         userMessages->SetObservedObject(node);
         node->UpdateScene(this);
         userMessages->SetObservedObject(nullptr);
+        vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+        if (this->GetDebug() && storableNode && storableNode->GetNumberOfStorageNodes() > 0 && this->GetReadDataOnLoad())
+        {
+          double preloadTime = 0.0;
+          for (int storageNodeIndex = 0; storageNodeIndex < storableNode->GetNumberOfStorageNodes(); ++storageNodeIndex)
+          {
+            auto preloadTimeIt = preloadTimes.find(storableNode->GetNthStorageNode(storageNodeIndex));
+            if (preloadTimeIt != preloadTimes.end())
+            {
+              preloadTime += preloadTimeIt->second;
+            }
+          }
+          vtkDebugMacro("Read data of node " << (node->GetName() ? node->GetName() : "(undefined)")
+            << " (" << (node->GetID() ? node->GetID() : "(null)") << ") in "
+            << (vtkTimerLog::GetUniversalTime() - updateStartTime) << "s"
+            << " (+" << preloadTime << "s reading the file on a worker thread)");
+        }
         if (errorsBefore < userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent))
         {
           //vtkErrorMacro("Import: error updating node " << node->GetID());
@@ -900,6 +1020,12 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
       }
     }
 
+    // Release data that was preloaded but not used (e.g., because the node failed to read)
+    for (const auto& preloadTime : preloadTimes)
+    {
+      preloadTime.first->ClearPreloadedData();
+    }
+
     this->Modified();
     this->RemoveUnusedNodeReferences();
 #ifdef MRMLSCENE_VERBOSE
@@ -951,6 +1077,82 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
   return success ? 1 : 0;
 }
 
+//------------------------------------------------------------------------------
+std::map<vtkMRMLStorageNode*, double> vtkMRMLScene::PreloadNodesData(vtkCollection* addedNodes)
+{
+  std::map<vtkMRMLStorageNode*, double> preloadTimes;
+  if (!this->ReadDataOnLoad || !addedNodes)
+  {
+    return preloadTimes;
+  }
+  int numberOfThreads = std::min(this->MaximumNumberOfDataReadThreads,
+    std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  if (numberOfThreads < 2)
+  {
+    return preloadTimes;
+  }
+
+  // Collect storage nodes (a storage node may be shared between multiple nodes)
+  std::vector<vtkMRMLStorageNode*> storageNodes;
+  std::set<vtkMRMLStorageNode*> uniqueStorageNodes;
+  vtkMRMLNode* node = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (addedNodes->InitTraversal(it); (node = vtkMRMLNode::SafeDownCast(addedNodes->GetNextItemAsObject(it)));)
+  {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+    if (!storableNode || !storableNode->GetAddToScene())
+    {
+      continue;
+    }
+    for (int storageNodeIndex = 0; storageNodeIndex < storableNode->GetNumberOfStorageNodes(); ++storageNodeIndex)
+    {
+      vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+      if (storageNode && storageNode->CanPreloadData() && uniqueStorageNodes.insert(storageNode).second)
+      {
+        storageNodes.push_back(storageNode);
+      }
+    }
+  }
+  if (storageNodes.size() < 2)
+  {
+    // Nothing to gain from using worker threads
+    return preloadTimes;
+  }
+  numberOfThreads = std::min(numberOfThreads, static_cast<int>(storageNodes.size()));
+
+  std::vector<double> times(storageNodes.size(), 0.0);
+  std::vector<char> preloaded(storageNodes.size(), 0);
+  std::atomic<size_t> nextStorageNodeIndex(0);
+  auto preloadWorker = [&]()
+  {
+    for (size_t index = nextStorageNodeIndex++; index < storageNodes.size(); index = nextStorageNodeIndex++)
+    {
+      double startTime = vtkTimerLog::GetUniversalTime();
+      preloaded[index] = storageNodes[index]->PreloadData() ? 1 : 0;
+      times[index] = vtkTimerLog::GetUniversalTime() - startTime;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int threadIndex = 0; threadIndex < numberOfThreads; ++threadIndex)
+  {
+    threads.emplace_back(preloadWorker);
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (size_t index = 0; index < storageNodes.size(); ++index)
+  {
+    if (preloaded[index])
+    {
+      preloadTimes[storageNodes[index]] = times[index];
+    }
+  }
+  vtkDebugMacro("PreloadNodesData: preloaded " << preloadTimes.size() << " of " << storageNodes.size()
+    << " storage nodes using " << numberOfThreads << " threads");
+  return preloadTimes;
+}
 //------------------------------------------------------------------------------
 int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection, vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
@@ -1305,10 +1507,21 @@ vtkMRMLNode* vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
     n->SetName(this->GenerateUniqueName(n).c_str());
   }
   n->SetScene( this );
+  this->UpdateNodeClassIndex();
+  this->UpdateNodeNameIndex();
+  bool sceneOrderUpToDate = (this->Nodes->GetMTime() <= this->NodeSceneOrderMTime);
   this->Nodes->vtkCollection::AddItem((vtkObject *)n);
 
   // cache the node so the whole scene cache stays up-to date
   this->AddNodeID(n);
+  this->AddNodeToClassIndex(n);
+  this->AddNodeName(n);
+  if (sceneOrderUpToDate)
+  {
+    // appended node is the last one in the scene
+    this->NodeSceneOrder[n] = this->NextNodeSceneOrder++;
+    this->NodeSceneOrderMTime = this->Nodes->GetMTime();
+  }
 
   // Keep the SH up-to-date
   if (vtkMRMLSubjectHierarchyNode::SafeDownCast(n) != nullptr &&
@@ -1522,10 +1735,20 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
   {
     n->SetScene(nullptr);
   }
+  this->UpdateNodeClassIndex();
+  this->UpdateNodeNameIndex();
+  bool sceneOrderUpToDate = (this->Nodes->GetMTime() <= this->NodeSceneOrderMTime);
   this->Nodes->vtkCollection::RemoveItem((vtkObject *)n);
 
   std::string nid = (n->GetID() ? n->GetID() : "");
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromClassIndex(n);
+  this->RemoveNodeName(n, n->GetName());
+  if (sceneOrderUpToDate)
+  {
+    this->NodeSceneOrder.erase(n);
+    this->NodeSceneOrderMTime = this->Nodes->GetMTime();
+  }
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1706,18 +1929,7 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
   }
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-  {
-    if (node->IsA(className))
-    {
-      num++;
-    }
-  }
-  return num;
+  return static_cast<int>(this->GetNodesByClassFromIndex(className).size());
 }
 
 //------------------------------------------------------------------------------
@@ -1729,16 +1941,7 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
   }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-  {
-    if (node->IsA(className))
-    {
-      nodes.push_back(node);
-    }
-  }
+  nodes = this->GetNodesByClassFromIndex(className);
   return static_cast<int>(nodes.size());
 }
 
@@ -1751,15 +1954,9 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return nullptr;
   }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  for (vtkMRMLNode* node : this->GetNodesByClassFromIndex(className))
   {
-    if (node->IsA(className))
-    {
-      nodes->AddItem(node);
-    }
+    nodes->AddItem(node);
   }
   return nodes;
 }
@@ -1820,13 +2017,9 @@ vtkMRMLNode* vtkMRMLScene::GetSingletonNode(const char* singletonTag, const char
     return nullptr;
   }
 
-  vtkCollectionSimpleIterator it;
-  vtkMRMLNode* node = nullptr;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  for (vtkMRMLNode* node : this->GetNodesByClassFromIndex(className))
   {
-    if (node->IsA(className) &&
-        node->GetSingletonTag() != nullptr &&
+    if (node->GetSingletonTag() != nullptr &&
         strcmp(node->GetSingletonTag(), singletonTag) == 0)
     {
       return node;
@@ -1896,22 +2089,12 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return nullptr;
   }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes = this->GetNodesByClassFromIndex(className);
+  if (n >= static_cast<int>(classNodes.size()))
   {
-    if (node->IsA(className))
-    {
-      if (num == n)
-      {
-        return node;
-      }
-      num++;
-    }
+    return nullptr;
   }
-  return nullptr;
+  return classNodes[n];
 }
 
 //------------------------------------------------------------------------------
@@ -1931,17 +2114,108 @@ vtkCollection* vtkMRMLScene::GetNodesByName(const char* name)
     return nodes;
   }
 
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::vector<vtkMRMLNode*> foundNodes;
+  this->GetNodesByName(name, foundNodes);
+  for (vtkMRMLNode* node : foundNodes)
+  {
+    nodes->AddItem(node);
+  }
+  return nodes;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLScene::GetNodesByName(const char* name, std::vector<vtkMRMLNode*>& nodes, bool caseSensitive/*=true*/)
+{
+  nodes.clear();
+  if (!name)
   {
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name))
+    vtkErrorMacro("GetNodesByName: name is null");
+    return 0;
+  }
+  this->UpdateNodeNameIndex();
+  std::pair<NodeNamesType::iterator, NodeNamesType::iterator> range = this->NodesByName.equal_range(name);
+  for (NodeNamesType::iterator it = range.first; it != range.second; ++it)
+  {
+    if (caseSensitive && it->first != name)
     {
-      nodes->AddItem(node);
+      continue;
     }
+    nodes.push_back(it->second);
   }
-  return nodes;
+  this->SortNodesBySceneOrder(nodes);
+  return static_cast<int>(nodes.size());
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLScene::GetNodesByNameRegularExpression(const char* regularExpression, std::vector<vtkMRMLNode*>& nodes)
+{
+  nodes.clear();
+  if (!regularExpression)
+  {
+    vtkErrorMacro("GetNodesByNameRegularExpression: regular expression is null");
+    return 0;
+  }
+  vtksys::RegularExpression regex;
+  if (!regex.compile(regularExpression))
+  {
+    vtkErrorMacro("GetNodesByNameRegularExpression: invalid regular expression: " << regularExpression);
+    return 0;
+  }
+
+  // If the expression is anchored then only names starting with the literal
+  // prefix of the expression need to be tested. This does not apply if there is
+  // an alternation (e.g., "^abc|xyz") or a group, which may contain one.
+  std::string pattern(regularExpression);
+  bool prunable = (!pattern.empty() && pattern[0] == '^');
+  for (size_t i = 1; prunable && i < pattern.size(); ++i)
+  {
+    if (pattern[i] == '\\')
+    {
+      // skip escaped character
+      ++i;
+    }
+    else if (pattern[i] == '|' || pattern[i] == '(')
+    {
+      prunable = false;
+    }
+  }
+  std::string prefix;
+  if (prunable)
+  {
+    const std::string specialCharacters("^$.[]()*+?|\\");
+    for (size_t i = 1; i < pattern.size() && specialCharacters.find(pattern[i]) == std::string::npos; ++i)
+    {
+      prefix += pattern[i];
+    }
+    size_t nextCharacterPosition = 1 + prefix.size();
+    if (!prefix.empty() && nextCharacterPosition < pattern.size()
+      && (pattern[nextCharacterPosition] == '*' || pattern[nextCharacterPosition] == '?'))
+    {
+      // last character of the prefix is optional
+      prefix.pop_back();
+    }
+  }
+
+  this->UpdateNodeNameIndex();
+  NodeNameLess nameLess;
+  for (NodeNamesType::iterator it = this->NodesByName.lower_bound(prefix); it != this->NodesByName.end(); ++it)
+  {
+    if (!prefix.empty())
+    {
+      std::string namePrefix = it->first.substr(0, prefix.size());
+      if (nameLess(namePrefix, prefix) || nameLess(prefix, namePrefix))
+      {
+        // past the names that start with the prefix
+        break;
+      }
+    }
+    if (regex.find(it->first))
+    {
+      nodes.push_back(it->second);
+    }
+  }
+  this->SortNodesBySceneOrder(nodes);
+  return static_cast<int>(nodes.size());
 }
 
 //-----------------------------------------------------------------------------
@@ -1950,6 +2224,26 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNode(const char* byName,
                                         const int* byHideFromEditors,
                                         bool exactNameMatch)
 {
+  if (exactNameMatch && byName)
+  {
+    // Only nodes with matching name need to be checked
+    std::vector<vtkMRMLNode*> nodes;
+    this->GetNodesByName(byName, nodes);
+    for (vtkMRMLNode* node : nodes)
+    {
+      if (byClass && !node->IsA(byClass))
+      {
+        continue;
+      }
+      if (byHideFromEditors && node->GetHideFromEditors() != *byHideFromEditors)
+      {
+        continue;
+      }
+      return node;
+    }
+    return nullptr;
+  }
+
   vtkCollectionSimpleIterator it;
   vtkMRMLNode* node;
   for (this->Nodes->InitTraversal(it);
@@ -1989,16 +2283,12 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNodeByName(const char* name)
     return node;
   }
 
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::vector<vtkMRMLNode*> nodes;
+  if (this->GetNodesByName(name, nodes) == 0)
   {
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name))
-    {
-      return node;
-    }
+    return nullptr;
   }
-  return nullptr;
+  return nodes[0];
 }
 
 //------------------------------------------------------------------------------
@@ -2058,11 +2348,11 @@ vtkCollection* vtkMRMLScene::GetNodesByClassByName(const char* className, const
     return nodes;
   }
 
-  vtkMRMLNode *node;
-  for (int n=0; n < this->Nodes->GetNumberOfItems(); n++)
+  std::vector<vtkMRMLNode*> namedNodes;
+  this->GetNodesByName(name, namedNodes);
+  for (vtkMRMLNode* node : namedNodes)
   {
-    node = (vtkMRMLNode*)this->Nodes->GetItemAsObject(n);
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name) && node->IsA(className))
+    if (node->IsA(className))
     {
       nodes->AddItem(node);
     }
@@ -2136,6 +2426,7 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
     n->SetName(n->GetID());
   }
   n->SetScene( this );
+  this->UpdateNodeNameIndex();
 
   // this is the major difference from AddNodeNoNotify, instead of AddItem,
   // use InsertItem (it inserts the passed object after the index passed)
@@ -2157,6 +2448,9 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
   }
   // cache the node so the whole scene cache stays up-to-date
   this->AddNodeID(n);
+  this->AddNodeName(n);
+  // the class index is ordered as the scene, it is rebuilt on next request
+  this->ClearNodeClassIndex();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2232,6 +2526,7 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
     n->SetName(n->GetID());
   }
   n->SetScene( this );
+  this->UpdateNodeNameIndex();
 
   // this is the major difference from AddNodeNoNotify, instead of AddItem,
   // use InsertItem (it inserts the passed object after the index passed, so
@@ -2255,6 +2550,9 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
   }
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  this->AddNodeName(n);
+  // the class index is ordered as the scene, it is rebuilt on next request
+  this->ClearNodeClassIndex();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2586,7 +2884,7 @@ int vtkMRMLScene::GetUniqueNameIndex(const std::string& baseName)
   bool isUnique = false;
   int index = lastNameIndex;
   // keep looping until you find a name that isn't yet in the scene
-  // TODO: this could be speeded up if it becomes a bottleneck
+  // (names are looked up in the node name index)
   for (; !isUnique; )
   {
     ++index;
@@ -2665,6 +2963,8 @@ void vtkMRMLScene::SaveStateForUndo (vtkMRMLNode *node)
   {
     this->CopyNodeInUndoStack(node);
   }
+  // Memory size of the new state is known only after the nodes are copied
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2696,6 +2996,7 @@ void vtkMRMLScene::SaveStateForUndo (std::vector<vtkMRMLNode *> nodes)
       this->CopyNodeInUndoStack(node);
     }
   }
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2735,6 +3036,7 @@ void vtkMRMLScene::SaveStateForUndo (vtkCollection* nodes)
       this->CopyNodeInUndoStack(node);
     }
   }
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2821,10 +3123,52 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
     return;
   }
 
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  vtkSmartPointer<vtkMRMLNode> snode;
+  vtkSmartPointer<vtkDataObject> sharedBulkData;
+  vtkMTimeType contentModifiedTime = GetNodeUndoContentModifiedTime(copyNode);
+  vtkDataObject* bulkData = GetNodeBulkData(copyNode);
+  if (this->UndoCopyOnWrite && copyNode->GetID())
   {
+    std::map<std::string, UndoNodeCopyInfo>::iterator lastCopyIt = this->LastUndoNodeCopies.find(copyNode->GetID());
+    if (lastCopyIt != this->LastUndoNodeCopies.end()
+      && lastCopyIt->second.Copy
+      && lastCopyIt->second.SourceNode == copyNode)
+    {
+      if (lastCopyIt->second.SourceContentModifiedTime == contentModifiedTime)
+      {
+        // Reuse the copy that was made for a previous state if the node has not changed since then
+        snode = lastCopyIt->second.Copy;
+      }
+      else if (bulkData && lastCopyIt->second.SourceBulkData == bulkData
+        && lastCopyIt->second.SourceBulkDataModifiedTime == bulkData->GetMTime())
+      {
+        // Only node properties have changed, reuse the bulk data of the previous copy
+        sharedBulkData = GetNodeBulkData(lastCopyIt->second.Copy);
+      }
+    }
+  }
+  if (!snode)
+  {
+    snode = vtkSmartPointer<vtkMRMLNode>::Take(copyNode->CreateNodeInstance());
+    if (snode == nullptr)
+    {
+      vtkErrorMacro("CopyNodeInUndoStack: failed to create copy of node " << (copyNode->GetID() ? copyNode->GetID() : "(none)"));
+      return;
+    }
     snode->CopyWithScene(copyNode);
+    if (sharedBulkData)
+    {
+      SetNodeBulkData(snode, sharedBulkData);
+    }
+    if (this->UndoCopyOnWrite && copyNode->GetID())
+    {
+      UndoNodeCopyInfo& lastCopy = this->LastUndoNodeCopies[copyNode->GetID()];
+      lastCopy.SourceNode = copyNode;
+      lastCopy.Copy = snode;
+      lastCopy.SourceContentModifiedTime = contentModifiedTime;
+      lastCopy.SourceBulkData = bulkData;
+      lastCopy.SourceBulkDataModifiedTime = (bulkData ? bulkData->GetMTime() : 0);
+    }
   }
 
   vtkCollection* undoScene = this->UndoStack.back();
@@ -2838,7 +3182,6 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
       break;
     }
   }
-  snode->Delete();
 }
 
 //------------------------------------------------------------------------------
@@ -2969,6 +3312,7 @@ void vtkMRMLScene::Undo()
 
   for (nn=0; nn<addNodes.size(); nn++)
   {
+    this->DetachNodeFromUndoRedoStacks(addNodes[nn], undoScene);
     this->AddNode(addNodes[nn]);
     addNodes[nn]->SetSceneReferences();
   }
@@ -3106,6 +3450,7 @@ void vtkMRMLScene::Redo()
 
   for (nn=0; nn<addNodes.size(); nn++)
   {
+    this->DetachNodeFromUndoRedoStacks(addNodes[nn], undoScene);
     this->AddNode(addNodes[nn]);
   }
   for (nn=0; nn<removeNodes.size(); nn++)
@@ -3134,6 +3479,7 @@ void vtkMRMLScene::ClearUndoStack()
     (*iter)->Delete();
   }
   this->UndoStack.clear();
+  this->LastUndoNodeCopies.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -3489,6 +3835,222 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//-----------------------------------------------------------------------------
+const std::vector<vtkMRMLNode*>& vtkMRMLScene::GetNodesByClassFromIndex(const std::string& className)
+{
+  this->UpdateNodeClassIndex();
+  std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it = this->NodesByClass.find(className);
+  if (it != this->NodesByClass.end())
+  {
+    return it->second;
+  }
+  // First request for this class: collect matching nodes, the list is
+  // maintained by AddNodeToClassIndex/RemoveNodeFromClassIndex from now on.
+  std::vector<vtkMRMLNode*>& classNodes = this->NodesByClass[className];
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator collectionIt;
+  for (this->Nodes->InitTraversal(collectionIt);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(collectionIt)) ;)
+  {
+    if (node->IsA(className.c_str()))
+    {
+      classNodes.push_back(node);
+    }
+  }
+  return classNodes;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeClassIndex()
+{
+  if (this->Nodes && this->Nodes->GetMTime() > this->NodesByClassMTime)
+  {
+#ifdef MRMLSCENE_VERBOSE
+    std::cerr << "Node collection modified outside of the scene, reset node class index..." << std::endl;
+#endif
+    this->ClearNodeClassIndex();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToClassIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+  {
+    return;
+  }
+  for (std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it = this->NodesByClass.begin();
+    it != this->NodesByClass.end(); ++it)
+  {
+    if (node->IsA(it->first.c_str()))
+    {
+      it->second.push_back(node);
+    }
+  }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromClassIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+  {
+    return;
+  }
+  for (std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it = this->NodesByClass.begin();
+    it != this->NodesByClass.end(); ++it)
+  {
+    if (!node->IsA(it->first.c_str()))
+    {
+      continue;
+    }
+    std::vector<vtkMRMLNode*>::iterator nodeIt = std::find(it->second.begin(), it->second.end(), node);
+    if (nodeIt != it->second.end())
+    {
+      it->second.erase(nodeIt);
+    }
+  }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::ClearNodeClassIndex()
+{
+  if (this->Nodes)
+  {
+    this->NodesByClass.clear();
+    this->NodesByClassMTime = this->Nodes->GetMTime();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMRMLScene::NodeNameLess::operator()(const std::string& name1, const std::string& name2) const
+{
+  return std::lexicographical_compare(name1.begin(), name1.end(), name2.begin(), name2.end(),
+    [](char c1, char c2)
+    {
+      return std::tolower(static_cast<unsigned char>(c1)) < std::tolower(static_cast<unsigned char>(c2));
+    });
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeNameIndex()
+{
+  if (!this->Nodes || this->Nodes->GetMTime() <= this->NodesByNameMTime)
+  {
+    return;
+  }
+  this->NodesByName.clear();
+  this->NodesByNameMTime = this->Nodes->GetMTime();
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  {
+    this->AddNodeName(node);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeName(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+  {
+    return;
+  }
+  if (node->GetName())
+  {
+    this->NodesByName.insert(NodeNamesType::value_type(node->GetName(), node));
+  }
+  this->NodesByNameMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeName(vtkMRMLNode* node, const char* name)
+{
+  if (!this->Nodes || !node)
+  {
+    return;
+  }
+  this->NodesByNameMTime = this->Nodes->GetMTime();
+  if (name)
+  {
+    std::pair<NodeNamesType::iterator, NodeNamesType::iterator> range = this->NodesByName.equal_range(name);
+    for (NodeNamesType::iterator it = range.first; it != range.second; ++it)
+    {
+      if (it->second == node)
+      {
+        this->NodesByName.erase(it);
+        return;
+      }
+    }
+  }
+  // The node was not found by name, make sure there is no dangling pointer left.
+  for (NodeNamesType::iterator it = this->NodesByName.begin(); it != this->NodesByName.end(); ++it)
+  {
+    if (it->second == node)
+    {
+      this->NodesByName.erase(it);
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeSceneOrder()
+{
+  if (!this->Nodes || this->Nodes->GetMTime() <= this->NodeSceneOrderMTime)
+  {
+    return;
+  }
+  this->NodeSceneOrder.clear();
+  this->NextNodeSceneOrder = 0;
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  {
+    this->NodeSceneOrder[node] = this->NextNodeSceneOrder++;
+  }
+  this->NodeSceneOrderMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::SortNodesBySceneOrder(std::vector<vtkMRMLNode*>& nodes)
+{
+  if (nodes.size() < 2)
+  {
+    return;
+  }
+  this->UpdateNodeSceneOrder();
+  std::sort(nodes.begin(), nodes.end(), [this](vtkMRMLNode* node1, vtkMRMLNode* node2)
+    {
+      return this->NodeSceneOrder[node1] < this->NodeSceneOrder[node2];
+    });
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::NodeNameChanged(vtkMRMLNode* node, const char* oldName)
+{
+  if (!this->Nodes || !node || !node->GetID())
+  {
+    return;
+  }
+  if (this->Nodes->GetMTime() > this->NodesByNameMTime)
+  {
+    // the index will be rebuilt from the current node names on next request
+    return;
+  }
+  // Only nodes that are in the scene are indexed
+  std::map< std::string, vtkSmartPointer<vtkMRMLNode> >::iterator idIt = this->NodeIDs.find(node->GetID());
+  if (idIt == this->NodeIDs.end() || idIt->second != node)
+  {
+    return;
+  }
+  this->RemoveNodeName(node, oldName);
+  this->AddNodeName(node);
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -3846,15 +4408,185 @@ void vtkMRMLScene::SetMaximumNumberOfSavedUndoStates(int stackSize)
   this->Modified();
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::SetMaximumUndoMemorySize(unsigned long sizeInKiB)
+{
+  if (sizeInKiB == this->MaximumUndoMemorySize)
+  {
+    return;
+  }
+  this->MaximumUndoMemorySize = sizeInKiB;
+  this->TrimUndoStack();
+  this->Modified();
+}
+
 //-----------------------------------------------------------------------------
 void vtkMRMLScene::TrimUndoStack()
 {
+  // Removed states are deleted after all states are removed from the stack
   std::list<vtkSmartPointer<vtkCollection> > removedStacks;
   while(static_cast<int>(this->UndoStack.size()) > this->MaximumNumberOfSavedUndoStates)
   {
-    removedStacks.emplace_back(this->UndoStack.front());
+    removedStacks.push_back(vtkSmartPointer<vtkCollection>::Take(this->UndoStack.front()));
     this->UndoStack.pop_front();
   }
+  if (this->MaximumUndoMemorySize == 0 || this->UndoStack.size() <= 1)
+  {
+    return;
+  }
+
+  // Memory size of the undo and redo states is computed once, then the memory of
+  // objects that are not used by any of the remaining states is subtracted when a state is removed.
+  std::set<vtkObject*> sceneNodes;
+  vtkObject* object = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it); (object = this->Nodes->GetNextItemAsObject(it));)
+  {
+    sceneNodes.insert(object);
+  }
+  std::map<vtkObject*, int> objectUseCounts;
+  std::vector<std::pair<vtkObject*, unsigned long> > memoryItems;
+  unsigned long memorySize = 0;
+  for (std::list<vtkCollection*>* stack : { &this->UndoStack, &this->RedoStack })
+  {
+    for (vtkCollection* state : *stack)
+    {
+      for (state->InitTraversal(it); (object = state->GetNextItemAsObject(it));)
+      {
+        if (sceneNodes.find(object) != sceneNodes.end())
+        {
+          continue;
+        }
+        GetNodeUndoMemoryItems(vtkMRMLNode::SafeDownCast(object), memoryItems);
+        for (const std::pair<vtkObject*, unsigned long>& memoryItem : memoryItems)
+        {
+          if (objectUseCounts[memoryItem.first]++ == 0)
+          {
+            memorySize += memoryItem.second;
+          }
+        }
+      }
+    }
+  }
+
+  while (this->UndoStack.size() > 1 && memorySize > this->MaximumUndoMemorySize)
+  {
+    vtkSmartPointer<vtkCollection> removedStack = vtkSmartPointer<vtkCollection>::Take(this->UndoStack.front());
+    this->UndoStack.pop_front();
+    for (removedStack->InitTraversal(it); (object = removedStack->GetNextItemAsObject(it));)
+    {
+      if (sceneNodes.find(object) != sceneNodes.end())
+      {
+        continue;
+      }
+      GetNodeUndoMemoryItems(vtkMRMLNode::SafeDownCast(object), memoryItems);
+      for (const std::pair<vtkObject*, unsigned long>& memoryItem : memoryItems)
+      {
+        if (--objectUseCounts[memoryItem.first] == 0)
+        {
+          memorySize -= std::min(memorySize, memoryItem.second);
+        }
+      }
+    }
+    // Remove the node copies now, so that the memory is released
+    removedStack->RemoveAllItems();
+  }
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetUndoMemorySize()
+{
+  return this->GetUndoRedoStackMemorySize(this->UndoStack);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetRedoMemorySize()
+{
+  return this->GetUndoRedoStackMemorySize(this->RedoStack);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetUndoRedoStackMemorySize(const std::list<vtkCollection*>& stack)
+{
+  std::set<vtkObject*> sceneNodes;
+  vtkObject* object = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it); (object = this->Nodes->GetNextItemAsObject(it));)
+  {
+    sceneNodes.insert(object);
+  }
+  // Nodes of the scene do not use extra memory, node copies and bulk data that are shared
+  // between states are only counted once.
+  std::set<vtkObject*> countedObjects;
+  std::vector<std::pair<vtkObject*, unsigned long> > memoryItems;
+  unsigned long memorySize = 0;
+  for (vtkCollection* state : stack)
+  {
+    for (state->InitTraversal(it); (object = state->GetNextItemAsObject(it));)
+    {
+      if (sceneNodes.find(object) != sceneNodes.end() || countedObjects.find(object) != countedObjects.end())
+      {
+        continue;
+      }
+      GetNodeUndoMemoryItems(vtkMRMLNode::SafeDownCast(object), memoryItems);
+      for (const std::pair<vtkObject*, unsigned long>& memoryItem : memoryItems)
+      {
+        if (countedObjects.insert(memoryItem.first).second)
+        {
+          memorySize += memoryItem.second;
+        }
+      }
+    }
+  }
+  return memorySize;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::DetachNodeFromUndoRedoStacks(vtkMRMLNode* node, vtkCollection* skipState)
+{
+  if (!node)
+  {
+    return;
+  }
+  if (node->GetID())
+  {
+    std::map<std::string, UndoNodeCopyInfo>::iterator lastCopyIt = this->LastUndoNodeCopies.find(node->GetID());
+    if (lastCopyIt != this->LastUndoNodeCopies.end() && lastCopyIt->second.Copy == node)
+    {
+      this->LastUndoNodeCopies.erase(lastCopyIt);
+    }
+  }
+  vtkDataObject* bulkData = GetNodeBulkData(node);
+  if (bulkData && this->UndoCopyOnWrite)
+  {
+    // Bulk data may be shared with other copies of the node, therefore the node gets its own copy
+    vtkSmartPointer<vtkDataObject> bulkDataCopy = vtkSmartPointer<vtkDataObject>::Take(bulkData->NewInstance());
+    bulkDataCopy->DeepCopy(bulkData);
+    SetNodeBulkData(node, bulkDataCopy);
+  }
+  vtkSmartPointer<vtkMRMLNode> nodeCopy;
+  for (std::list<vtkCollection*>* stack : { &this->UndoStack, &this->RedoStack })
+  {
+    for (vtkCollection* state : *stack)
+    {
+      if (state == skipState)
+      {
+        continue;
+      }
+      // IsItemPresent returns a 1-based index
+      int index = state->IsItemPresent(node) - 1;
+      if (index < 0)
+      {
+        continue;
+      }
+      if (!nodeCopy)
+      {
+        nodeCopy = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+        nodeCopy->CopyWithScene(node);
+      }
+      state->ReplaceItem(index, nodeCopy);
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -29,6 +29,7 @@ Version:   $Revision: 1.18 $
 #include <random>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class vtkCacheManager;
@@ -37,6 +38,7 @@ class vtkTagTable;
 
 class vtkCallbackCommand;
 class vtkCollection;
+class vtkDataObject;
 class vtkGeneralTransform;
 class vtkImageData;
 class vtkURIHandler;
@@ -59,8 +61,9 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   ///
   /// make the vtkMRMLSceneViewNode a friend since it has internal vtkMRMLScene
   /// so that it can call protected methods, for example UpdateNodeIDs()
-  /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// make the vtkMRMLNode a friend so that SetName() can call NodeNameChanged()
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -272,10 +275,28 @@ public:
   /// or traverse collection returned by GetNodes() using a collection iterator.
   vtkMRMLNode *GetNextNodeByClass(const char* className);
 
-  /// Get nodes having the specified name
+  /// Get nodes having the specified name, in the order they are in the scene
   vtkCollection *GetNodesByName(const char* name);
   vtkMRMLNode *GetFirstNodeByName(const char* name);
 
+  /// \brief Get nodes having the specified name, optionally ignoring case.
+  ///
+  /// Nodes are looked up in a name index that is kept up-to-date when nodes
+  /// are added, removed, or renamed, so the scene is not traversed.
+  /// Nodes are returned in the order they are in the scene.
+  /// Returns the number of found nodes.
+  int GetNodesByName(const char* name, std::vector<vtkMRMLNode*>& nodes, bool caseSensitive = true);
+
+  /// \brief Get nodes that have a name matching \a regularExpression
+  /// (vtksys::RegularExpression syntax).
+  ///
+  /// If the expression is anchored to the beginning of the name (e.g., "^Segment_[0-9]+$")
+  /// and contains no alternation or group then only the nodes whose name starts with
+  /// the literal prefix ("Segment_") are tested, otherwise all named nodes are tested.
+  /// Nodes are returned in the order they are in the scene.
+  /// Returns the number of found nodes.
+  int GetNodesByNameRegularExpression(const char* regularExpression, std::vector<vtkMRMLNode*>& nodes);
+
   /// \brief Return the first node in the scene that matches the filtering
   /// criteria if specified.
   ///
@@ -520,6 +541,17 @@ public:
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
+  /// \brief Maximum number of threads used for reading data files during Import().
+  ///
+  /// Data files of storage nodes that support it (see vtkMRMLStorageNode::CanPreloadData())
+  /// are read concurrently on worker threads, then the data is set in the nodes on the
+  /// main thread. Time spent with reading each node is reported in the user messages
+  /// of Import(). Set to 1 to read all data files sequentially on the main thread.
+  /// Default is 4.
+  /// \sa Import(), GetReadDataOnLoad()
+  vtkSetClampMacro(MaximumNumberOfDataReadThreads, int, 1, 64);
+  vtkGetMacro(MaximumNumberOfDataReadThreads, int);
+
   /// \brief Set the XML string to read from by Import() if
   /// GetLoadFromXMLString() is true.
   ///
@@ -783,6 +815,37 @@ public:
   void SetMaximumNumberOfSavedUndoStates(int stackSize);
   vtkGetMacro(MaximumNumberOfSavedUndoStates, int);
 
+  /// \brief Copy-on-write undo mode.
+  ///
+  /// If enabled, SaveStateForUndo() only copies nodes that have changed since their
+  /// state was last saved (see vtkMRMLNode::GetContentModifiedTime()). Copies of unchanged
+  /// nodes, including their bulk data (image data, meshes, segments), are shared between
+  /// saved states instead of being duplicated in each state. If only the properties of a
+  /// volume, model, or table node have changed then its bulk data is still shared.
+  /// Disabled by default.
+  vtkSetMacro(UndoCopyOnWrite, bool);
+  vtkGetMacro(UndoCopyOnWrite, bool);
+  vtkBooleanMacro(UndoCopyOnWrite, bool);
+
+  /// \brief Sets the maximum memory size of saved undo states, in kibibytes.
+  ///
+  /// The oldest saved undo states are removed when the memory used by saved undo and redo
+  /// states exceeds this size. The most recent saved undo state is always kept.
+  /// 0 (default) means there is no memory limit, only the number of states is limited.
+  /// \sa SetMaximumNumberOfSavedUndoStates(), GetUndoMemorySize()
+  void SetMaximumUndoMemorySize(unsigned long sizeInKiB);
+  vtkGetMacro(MaximumUndoMemorySize, unsigned long);
+
+  /// \brief Get estimated memory used by saved undo states, in kibibytes.
+  ///
+  /// Node copies that are shared between multiple saved states are counted once.
+  /// Nodes of the scene are not counted.
+  unsigned long GetUndoMemorySize();
+
+  /// \brief Get estimated memory used by saved redo states, in kibibytes.
+  /// \sa GetUndoMemorySize()
+  unsigned long GetRedoMemorySize();
+
   /// \brief Write the scene to a MRML scene bundle (.mrb) file.
   /// If thumbnail image is provided then it is saved in the scene's root folder.
   /// If userMessages is not nullptr then the method may add messages to it about issues
@@ -843,6 +906,12 @@ protected:
   void CopyNodeInUndoStack(vtkMRMLNode *node);
   void CopyNodeInRedoStack(vtkMRMLNode *node);
 
+  /// Read data files of storage nodes of \a addedNodes into memory, using
+  /// up to MaximumNumberOfDataReadThreads threads.
+  /// Returns the preloaded storage nodes and the time (in seconds) spent with preloading each.
+  /// \sa vtkMRMLStorageNode::PreloadData()
+  std::map<vtkMRMLStorageNode*, double> PreloadNodesData(vtkCollection* addedNodes);
+
   /// Add a node to the scene without invoking a vtkMRMLScene::NodeAddedEvent event.
   ///
   /// \warning Use with extreme caution as it might unsynchronize observer.
@@ -890,12 +959,72 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// \brief Return the nodes that are of class \a className (or of a subclass)
+  /// in the same order as in the \a Nodes collection.
+  ///
+  /// The list of a class is computed the first time it is requested and is then
+  /// kept up-to-date when nodes are added or removed, therefore
+  /// GetNodesByClass(), GetNumberOfNodesByClass(), GetNthNodeByClass()
+  /// do not need to traverse the whole scene.
+  /// Abstract base classes (e.g., vtkMRMLVolumeNode) are supported.
+  const std::vector<vtkMRMLNode*>& GetNodesByClassFromIndex(const std::string& className);
+
+  /// Discard the class index if \a Nodes was modified without going through
+  /// the scene API (e.g., by directly modifying the collection returned by GetNodes()).
+  void UpdateNodeClassIndex();
+
+  /// Add node to each list of \a NodesByClass that the node is an instance of.
+  void AddNodeToClassIndex(vtkMRMLNode* node);
+
+  /// Remove node from all lists of \a NodesByClass.
+  void RemoveNodeFromClassIndex(vtkMRMLNode* node);
+
+  /// Clear NodesByClass map used to speedup GetNodesByClass() and related methods.
+  void ClearNodeClassIndex();
+
+  /// \brief Synchronize NodesByName map used to speedup GetNodesByName() and
+  /// related methods with the \a Nodes collection.
+  void UpdateNodeNameIndex();
+
+  /// Add node to \a NodesByName map.
+  void AddNodeName(vtkMRMLNode* node);
+
+  /// Remove node from \a NodesByName map, \a name is the name the node was indexed with.
+  void RemoveNodeName(vtkMRMLNode* node, const char* name);
+
+  /// Called by vtkMRMLNode::SetName() to update \a NodesByName map.
+  void NodeNameChanged(vtkMRMLNode* node, const char* oldName);
+
+  /// Sort \a nodes by their position in the scene, using \a NodeSceneOrder.
+  void SortNodesBySceneOrder(std::vector<vtkMRMLNode*>& nodes);
+
+  /// Rebuild \a NodeSceneOrder if \a Nodes was modified without keeping it up-to-date
+  /// (e.g., a node was inserted in the middle of the scene).
+  void UpdateNodeSceneOrder();
+
+  /// Case-insensitive ordering of node names. Nodes that only differ in case
+  /// are neighbors in \a NodesByName, which allows both case sensitive and
+  /// insensitive lookups.
+  struct NodeNameLess
+  {
+    bool operator()(const std::string& name1, const std::string& name2) const;
+  };
+  typedef std::multimap< std::string, vtkMRMLNode*, NodeNameLess > NodeNamesType;
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
-  /// Clean up elements of the undo/redo stack beyond the maximum size
+  /// Clean up elements of the undo/redo stack beyond the maximum size and memory size
   void TrimUndoStack();
 
+  /// Get estimated memory size of nodes in the stack that are not in the scene, in kibibytes
+  unsigned long GetUndoRedoStackMemorySize(const std::list<vtkCollection*>& stack);
+
+  /// Replace \a node by a copy in all saved undo and redo states (except \a skipState).
+  /// Must be called before a node that is stored in a saved state is added to the scene,
+  /// to prevent changes of the node from modifying the other saved states.
+  void DetachNodeFromUndoRedoStacks(vtkMRMLNode* node, vtkCollection* skipState);
+
   /// Reserve all node reference ids for a node
   void ReserveNodeReferenceIDs(vtkMRMLNode* node);
 
@@ -933,6 +1062,22 @@ protected:
   std::list< vtkCollection* >  UndoStack;
   std::list< vtkCollection* >  RedoStack;
 
+  bool UndoCopyOnWrite{false};
+  unsigned long MaximumUndoMemorySize{0};
+
+  /// Most recent copy of each node in the undo stack (indexed by node ID),
+  /// used for sharing copies of unchanged nodes in copy-on-write undo mode.
+  struct UndoNodeCopyInfo
+  {
+    vtkWeakPointer<vtkMRMLNode> SourceNode;
+    vtkWeakPointer<vtkMRMLNode> Copy;
+    vtkMTimeType SourceContentModifiedTime{0};
+    /// Bulk data of the source node and its modified time when the copy was made
+    vtkWeakPointer<vtkDataObject> SourceBulkData;
+    vtkMTimeType SourceBulkDataModifiedTime{0};
+  };
+  std::map<std::string, UndoNodeCopyInfo> LastUndoNodeCopies;
+
   std::string                 URL;
   std::string                 RootDirectory;
 
@@ -947,6 +1092,13 @@ protected:
   NodeReferencesType NodeReferences; // ReferencedIDs (string), ReferencingNodes (node pointer)
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
+  // Nodes of each requested class (including abstract base classes), in scene order.
+  std::map< std::string, std::vector<vtkMRMLNode*> > NodesByClass;
+  // Named nodes of the scene, nodes with the same name are in the order they got that name.
+  NodeNamesType NodesByName;
+  // Increasing number for each node in scene order, used for sorting nodes found by name.
+  std::unordered_map< vtkMRMLNode*, unsigned long long > NodeSceneOrder;
+  unsigned long long NextNodeSceneOrder{0};
 
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
   // a default node is defined for it then the content of the default node will be used to initialize
@@ -961,7 +1113,12 @@ protected:
 
   int ReadDataOnLoad;
 
+  int MaximumNumberOfDataReadThreads{4};
+
   vtkMTimeType  NodeIDsMTime;
+  vtkMTimeType  NodesByClassMTime;
+  vtkMTimeType  NodesByNameMTime;
+  vtkMTimeType  NodeSceneOrderMTime{0};
 
   void RemoveAllNodes(bool removeSingletons);
 
@@ -91,6 +91,27 @@ static const std::string KEY_SEGMENTATION_REFERENCE_IMAGE_EXTENT_OFFSET = "Refer
 static const std::string KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES = "ContainedRepresentationNames";
 
 static const int SINGLE_SEGMENT_INDEX = -1; // used as segment index when there is only a single segment
+
+//----------------------------------------------------------------------------
+// Sparse binary labelmaps are written to file as binary labelmaps
+static bool IsSourceRepresentationLabelmap(vtkSegmentation* segmentation)
+{
+  return segmentation->IsSourceRepresentationImageData()
+    || segmentation->GetSourceRepresentationName() == vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName();
+}
+
+//----------------------------------------------------------------------------
+static void SetLabelmapReaderOptions(vtkITKArchetypeImageSeriesVectorReaderFile* reader, const std::string& path)
+{
+  reader->SetSingleFile(1);
+  reader->SetUseOrientationFromFile(1);
+  reader->ResetFileNames();
+  reader->SetArchetype(path.c_str());
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetUseNativeOriginOn();
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSegmentationStorageNode);
 
@@ -165,7 +186,7 @@ void vtkMRMLSegmentationStorageNode::InitializeSupportedWriteFileTypes()
   if (segmentationNode)
   {
     // restrict write file types to those that are suitable for current source representation
-    masterIsImage = segmentationNode->GetSegmentation()->IsSourceRepresentationImageData();
+    masterIsImage = IsSourceRepresentationLabelmap(segmentationNode->GetSegmentation());
     masterIsPolyData = segmentationNode->GetSegmentation()->IsSourceRepresentationPolyData();
     if (!masterIsImage && !masterIsPolyData)
     {
@@ -224,7 +245,7 @@ const char* vtkMRMLSegmentationStorageNode::GetDefaultWriteFileExtension()
   {
     return nullptr;
   }
-  if (segmentationNode->GetSegmentation()->IsSourceRepresentationImageData())
+  if (IsSourceRepresentationLabelmap(segmentationNode->GetSegmentation()))
   {
     return "seg.nrrd";
   }
@@ -312,6 +333,48 @@ int vtkMRMLSegmentationStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLSegmentationStorageNode::CanPreloadData()
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSegmentationStorageNode::ClearPreloadedData()
+{
+  this->PreloadedReader = nullptr;
+  this->PreloadedFileName.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSegmentationStorageNode::PreloadDataInternal(const std::string& fullName)
+{
+  this->ClearPreloadedData();
+  vtkSmartPointer<vtkITKArchetypeImageSeriesVectorReaderFile> reader = vtkSmartPointer<vtkITKArchetypeImageSeriesVectorReaderFile>::New();
+  SetLabelmapReaderOptions(reader, fullName);
+  if (!reader->CanReadFile(fullName.c_str()))
+  {
+    // Segmentation is not stored as labelmap
+    return false;
+  }
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject&)
+  {
+    // ReadData() reads the file again and reports the error
+    return false;
+  }
+  if (reader->GetErrorCode() != vtkErrorCode::NoError)
+  {
+    return false;
+  }
+  this->PreloadedReader = reader;
+  this->PreloadedFileName = fullName;
+  return true;
+}
+
 #ifdef SUPPORT_4D_SPATIAL_NRRD
 //----------------------------------------------------------------------------
 int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation4DSpatial(vtkMRMLSegmentationNode* segmentationNode, std::string path)
@@ -384,6 +447,9 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation4DSpatial(vt
   // Read contained representation names
   std::string containedRepresentationNames;
   itk::ExposeMetaData<std::string>(metadata, GetSegmentationMetaDataKey(KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES).c_str(), containedRepresentationNames);
+  // Read source representation name
+  std::string sourceRepresentationName;
+  itk::ExposeMetaData<std::string>(metadata, GetSegmentationMetaDataKey(KEY_SEGMENTATION_SOURCE_REPRESENTATION).c_str(), sourceRepresentationName);
 
   // Get image properties
   BinaryLabelmap4DImageType::RegionType itkRegion = allSegmentLabelmapsImage->GetLargestPossibleRegion();
@@ -526,6 +592,7 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation4DSpatial(vt
   }
 
   // Create contained representations now that all the data is loaded
+  this->SetSourceRepresentationFromFile(segmentation, sourceRepresentationName);
   this->CreateRepresentationsBySerializedNames(segmentation, containedRepresentationNames);
 
   return 1;
@@ -559,18 +626,24 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
 
   vtkSmartPointer<vtkImageData> imageData = nullptr;
 
-  vtkNew<vtkITKArchetypeImageSeriesVectorReaderFile> archetypeImageReader;
-  archetypeImageReader->SetSingleFile(1);
-  archetypeImageReader->SetUseOrientationFromFile(1);
-  archetypeImageReader->ResetFileNames();
-  archetypeImageReader->SetArchetype(path.c_str());
-  archetypeImageReader->SetOutputScalarTypeToNative();
-  archetypeImageReader->SetDesiredCoordinateOrientationToNative();
-  archetypeImageReader->SetUseNativeOriginOn();
+  vtkSmartPointer<vtkITKArchetypeImageSeriesVectorReaderFile> archetypeImageReader;
+  if (this->PreloadedReader && this->PreloadedFileName == path)
+  {
+    // File was already read by PreloadData(), the pipeline is up-to-date
+    // therefore the reader does not read the file again.
+    archetypeImageReader = this->PreloadedReader;
+  }
+  else
+  {
+    archetypeImageReader = vtkSmartPointer<vtkITKArchetypeImageSeriesVectorReaderFile>::New();
+    SetLabelmapReaderOptions(archetypeImageReader, path);
+  }
+  this->ClearPreloadedData();
 
   int numberOfSegments = 0;
   std::map<int, std::vector<int> > segmentIndexInLayer;
   std::string containedRepresentationNames;
+  std::string sourceRepresentationName;
   vtkMatrix4x4* rasToFileIjk = nullptr;
   int imageExtentInFile[6] = { 0, -1, 0, -1, 0, -1 };
   int commonGeometryExtent[6] = { 0, -1, 0, -1, 0, -1 };
@@ -664,6 +737,9 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
     // Read contained representation names
     this->GetSegmentationMetaDataFromDicitionary(containedRepresentationNames, dictionary, KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES);
 
+    // Read source representation name, which is different from binary labelmap if it is stored as binary labelmap in the file
+    this->GetSegmentationMetaDataFromDicitionary(sourceRepresentationName, dictionary, KEY_SEGMENTATION_SOURCE_REPRESENTATION);
+
     // Read contained segment layer numbers
     while (dictionary.HasKey(GetSegmentMetaDataKey(numberOfSegments, KEY_SEGMENT_ID)))
     {
@@ -977,6 +1053,7 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
   }
 
   // Create contained representations now that all the data is loaded
+  this->SetSourceRepresentationFromFile(segmentation, sourceRepresentationName);
   this->CreateRepresentationsBySerializedNames(segmentation, containedRepresentationNames);
 
   return 1;
@@ -1212,7 +1289,7 @@ int vtkMRMLSegmentationStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   }
 
   // Write only source representation
-  if (segmentationNode->GetSegmentation()->IsSourceRepresentationImageData())
+  if (IsSourceRepresentationLabelmap(segmentationNode->GetSegmentation()))
   {
     return this->WriteBinaryLabelmapRepresentation(segmentationNode, fullName);
   }
@@ -1237,10 +1314,29 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
     return 0;
   }
   vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  std::string sourceRepresentationName = segmentation->GetSourceRepresentationName();
+  std::string containedRepresentationNames = this->SerializeContainedRepresentationNames(segmentation);
+
+  // Sparse binary labelmaps are written as binary labelmaps. The sparse source representation name is
+  // stored in the file, so that the sparse representation is made the source again when the file is read.
+  vtkSmartPointer<vtkSegmentation> binaryLabelmapSegmentation;
+  if (sourceRepresentationName == vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName())
+  {
+    binaryLabelmapSegmentation = vtkSmartPointer<vtkSegmentation>::New();
+    binaryLabelmapSegmentation->DeepCopy(segmentation);
+    if (!binaryLabelmapSegmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()))
+    {
+      vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation",
+        "Failed to convert sparse binary labelmap representation to binary labelmap");
+      return 0;
+    }
+    binaryLabelmapSegmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
+    segmentation = binaryLabelmapSegmentation;
+  }
   segmentation->CollapseBinaryLabelmaps(false);
 
   // Get and check source representation
-  if (!segmentationNode->GetSegmentation()->IsSourceRepresentationImageData())
+  if (!segmentation->IsSourceRepresentationImageData())
   {
     vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation",
       "Invalid source representation to write as image data");
@@ -1256,7 +1352,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
     std::string currentSegmentID = *segmentIdIt;
     vtkSegment* currentSegment = segmentation->GetSegment(*segmentIdIt);
     vtkSmartPointer<vtkOrientedImageData> currentBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
-      currentSegment->GetRepresentation(segmentationNode->GetSegmentation()->GetSourceRepresentationName()));
+      currentSegment->GetRepresentation(segmentation->GetSourceRepresentationName()));
     if (currentBinaryLabelmap->GetScalarSize() > scalarSize)
     {
       scalarSize = currentBinaryLabelmap->GetScalarSize();
@@ -1324,13 +1420,11 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
   writer->SetIJKToRASMatrix(fileIjkToRas.GetPointer());
 
   // Save source representation name
-  writer->SetAttribute(GetSegmentationMetaDataKey(KEY_SEGMENTATION_SOURCE_REPRESENTATION).c_str(),
-    segmentationNode->GetSegmentation()->GetSourceRepresentationName());
+  writer->SetAttribute(GetSegmentationMetaDataKey(KEY_SEGMENTATION_SOURCE_REPRESENTATION).c_str(), sourceRepresentationName);
   // Save conversion parameters
   std::string conversionParameters = segmentation->SerializeAllConversionParameters();
   writer->SetAttribute(GetSegmentationMetaDataKey(KEY_SEGMENTATION_CONVERSION_PARAMETERS).c_str(), conversionParameters);
   // Save created representation names so that they are re-created when loading
-  std::string containedRepresentationNames = this->SerializeContainedRepresentationNames(segmentation);
   writer->SetAttribute(GetSegmentationMetaDataKey(KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES).c_str(), containedRepresentationNames);
 
   vtkNew<vtkImageAppendComponents> appender;
@@ -1347,7 +1441,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
 
     // Get source representation from segment
     vtkSmartPointer<vtkOrientedImageData> currentBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
-      currentSegment->GetRepresentation(segmentationNode->GetSegmentation()->GetSourceRepresentationName()));
+      currentSegment->GetRepresentation(segmentation->GetSourceRepresentationName()));
     if (!currentBinaryLabelmap)
     {
       vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation",
@@ -1422,7 +1516,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
     labelValueSS << currentSegment->GetLabelValue();
     writer->SetAttribute(GetSegmentMetaDataKey(segmentIndex, KEY_SEGMENT_LABEL_VALUE).c_str(), labelValueSS.str());
 
-    vtkDataObject* originalRepresentation = currentSegment->GetRepresentation(segmentationNode->GetSegmentation()->GetSourceRepresentationName());
+    vtkDataObject* originalRepresentation = currentSegment->GetRepresentation(segmentation->GetSourceRepresentationName());
     if (labelmapLayers.find(originalRepresentation) == labelmapLayers.end())
     {
       labelmapLayers[originalRepresentation] = layerIndex;
@@ -1437,7 +1531,7 @@ int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSeg
   } // For each segment
 
   this->GetUserMessages()->SetObservedObject(writer);
-  if (segmentationNode->GetSegmentation()->GetNumberOfSegments() > 0)
+  if (segmentation->GetNumberOfSegments() > 0)
   {
     appender->Update();
     writer->SetInputConnection(appender->GetOutputPort());
@@ -1658,6 +1752,28 @@ std::string vtkMRMLSegmentationStorageNode::SerializeContainedRepresentationName
   return ssRepresentationNames.str();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSegmentationStorageNode::SetSourceRepresentationFromFile(vtkSegmentation* segmentation, const std::string& sourceRepresentationName)
+{
+  if (!segmentation || sourceRepresentationName.empty() || segmentation->GetSourceRepresentationName() == sourceRepresentationName)
+  {
+    return;
+  }
+  if (sourceRepresentationName != vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName())
+  {
+    // Only sparse binary labelmaps are stored in a different representation than the source representation
+    return;
+  }
+  if (segmentation->GetNumberOfSegments() > 0 && !segmentation->CreateRepresentation(sourceRepresentationName))
+  {
+    vtkWarningToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLSegmentationStorageNode::SetSourceRepresentationFromFile",
+      "Failed to create " << sourceRepresentationName << " representation, binary labelmap is used as source representation");
+    return;
+  }
+  // Binary labelmap representation is removed, it is only re-created if it is listed in the contained representation names
+  segmentation->SetSourceRepresentationName(sourceRepresentationName);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSegmentationStorageNode::CreateRepresentationsBySerializedNames(vtkSegmentation* segmentation, std::string representationNames)
 {
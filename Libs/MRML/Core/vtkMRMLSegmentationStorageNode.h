@@ -28,6 +28,9 @@
 // MRML includes
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 #ifdef SUPPORT_4D_SPATIAL_NRRD
   // ITK includes
   #include <itkImageRegionIteratorWithIndex.h>
@@ -42,6 +45,7 @@ class vtkMRMLSegmentationNode;
 class vtkSegment;
 class vtkInformationStringKey;
 class vtkInformationIntegerVectorKey;
+class vtkITKArchetypeImageSeriesVectorReaderFile;
 
 /// \brief MRML node for segmentation storage on disk.
 ///
@@ -111,6 +115,11 @@ public:
   vtkGetMacro(CropToMinimumExtent, bool);
   vtkBooleanMacro(CropToMinimumExtent, bool);
 
+  /// Segmentations stored as labelmap can be preloaded (read into memory on a worker thread).
+  /// \sa vtkMRMLStorageNode::PreloadData()
+  bool CanPreloadData() override;
+  void ClearPreloadedData() override;
+
 protected:
   /// Initialize all the supported read file types
   void InitializeSupportedReadFileTypes() override;
@@ -133,6 +142,9 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read the file using the labelmap reader
+  bool PreloadDataInternal(const std::string& fullName) override;
+
   /// Read binary labelmap representation from nrrd file (3D spatial + list)
   virtual int ReadBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path);
 
@@ -151,6 +163,10 @@ protected:
   /// Serialize contained representation names in a string
   std::string SerializeContainedRepresentationNames(vtkSegmentation* segmentation);
 
+  /// Make the source representation stored in the file the source representation of the segmentation.
+  /// Sparse binary labelmaps are stored as binary labelmaps, all other representations are stored as is.
+  void SetSourceRepresentationFromFile(vtkSegmentation* segmentation, const std::string& sourceRepresentationName);
+
   /// Create representations based on serialized representation names string
   void CreateRepresentationsBySerializedNames(vtkSegmentation* segmentation, std::string representationNames);
 
@@ -177,6 +193,10 @@ protected:
 protected:
   bool CropToMinimumExtent{false};
 
+  /// Reader that has read the file in PreloadData(), used by the next ReadData() call
+  vtkSmartPointer<vtkITKArchetypeImageSeriesVectorReaderFile> PreloadedReader;
+  std::string PreloadedFileName;
+
 protected:
   vtkMRMLSegmentationStorageNode();
   ~vtkMRMLSegmentationStorageNode() override;
@@ -0,0 +1,46 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLSequenceFrameLoader_h
+#define __vtkMRMLSequenceFrameLoader_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// STD includes
+#include <vector>
+
+class vtkMRMLNode;
+
+/// \brief Interface for loading content of sequence data nodes on demand.
+///
+/// A sequence node that has a frame loader (see vtkMRMLSequenceNode::SetOnDemandFrameLoader)
+/// calls LoadFrame before it returns a data node, which allows storing only the
+/// most recently accessed data nodes in memory.
+/// \sa vtkMRMLVolumeSequenceStorageNode
+class VTK_MRML_EXPORT vtkMRMLSequenceFrameLoader
+{
+public:
+  virtual ~vtkMRMLSequenceFrameLoader() = default;
+
+  /// Make sure that the content of the data node is loaded.
+  /// Returns true if the content of the data node is loaded.
+  virtual bool LoadFrame(vtkMRMLNode* frameNode) = 0;
+
+  /// Start loading content of data nodes that are expected to be accessed soon.
+  virtual void PrefetchFrames(const std::vector<vtkMRMLNode*>& frameNodes) = 0;
+};
+
+#endif
@@ -17,9 +17,12 @@
 
 // MRMLSequence includes
 #include "vtkMRMLLinearTransformSequenceStorageNode.h"
+#include "vtkMRMLSequenceFrameLoader.h"
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLSequenceStorageNode.h"
 #include "vtkMRMLStorableNode.h"
+#include "vtkMRMLVolumeNode.h"
+#include "vtkMRMLVolumeSequenceStorageNode.h"
 
 // MRML includes
 #include <vtkMRMLScene.h>
@@ -27,6 +30,7 @@
 // VTK includes
 #include <vtkNew.h>
 #include <vtkCollection.h>
+#include <vtkImageData.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
 #include <vtkTimerLog.h>
@@ -79,6 +83,9 @@ vtkMRMLSequenceNode::~vtkMRMLSequenceNode()
 void vtkMRMLSequenceNode::RemoveAllDataNodes()
 {
   this->IndexEntries.clear();
+  this->InvalidateIndexValueLookup();
+  this->InvalidateDataNodeItemCounts();
+  this->SetOnDemandFrameLoader(nullptr);
   if (!this->SequenceScene)
   {
     return;
@@ -213,6 +220,8 @@ void vtkMRMLSequenceNode::ReadIndexValues(const std::string& indexText)
 
   if (modified)
   {
+    this->InvalidateIndexValueLookup();
+    this->InvalidateDataNodeItemCounts();
     this->Modified();
   }
 }
@@ -243,6 +252,7 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
     this->SequenceScene->Delete();
   }
   this->SequenceScene=vtkMRMLScene::New();
+  this->SetOnDemandFrameLoader(nullptr);
 
   // Get data node ID in the target scene from the data node ID in the source scene
   std::map< std::string, std::string > sourceToTargetDataNodeID;
@@ -257,6 +267,11 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
         vtkErrorMacro("Invalid node in vtkMRMLSequenceNode");
         continue;
       }
+      if (snode->OnDemandFrameLoader)
+      {
+        // all frames of the copy are kept in memory
+        snode->OnDemandFrameLoader->LoadFrame(node);
+      }
       vtkMRMLNode* targetDataNode = this->DeepCopyNodeToScene(node, this->SequenceScene);
       sourceToTargetDataNodeID[node->GetID()] = targetDataNode->GetID();
     }
@@ -291,6 +306,8 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
     }
     this->IndexEntries.push_back(seqItem);
   }
+  this->InvalidateIndexValueLookup();
+  this->InvalidateDataNodeItemCounts();
   this->Modified();
   this->StorableModifiedTime.Modified();
 
@@ -324,6 +341,8 @@ void vtkMRMLSequenceNode::CopySequenceIndex(vtkMRMLNode *anode)
       seqItem.DataNode = nullptr;
       this->IndexEntries.push_back(seqItem);
     }
+    this->InvalidateIndexValueLookup();
+    this->InvalidateDataNodeItemCounts();
     this->Modified();
   }
   this->EndModify(wasModified);
@@ -366,7 +385,14 @@ bool vtkMRMLSequenceNode::UpdateDataNodeAtValue(vtkMRMLNode* node, const std::st
     vtkErrorMacro("vtkMRMLSequenceNode::UpdateDataNodeAtValue failed, invalid node");
     return false;
   }
-  vtkMRMLNode* nodeToBeUpdated = this->GetDataNodeAtValue(indexValue);
+  int seqItemIndex = this->GetItemNumberFromIndexValue(indexValue);
+  if (seqItemIndex < 0 || !this->SequenceScene)
+  {
+    vtkDebugMacro("vtkMRMLSequenceNode::UpdateDataNodeAtValue failed, indexValue not found");
+    return false;
+  }
+  // Changes must not affect other items that share the same data node
+  vtkMRMLNode* nodeToBeUpdated = this->UnshareNthDataNode(seqItemIndex);
   if (!nodeToBeUpdated)
   {
     vtkDebugMacro("vtkMRMLSequenceNode::UpdateDataNodeAtValue failed, indexValue not found");
@@ -386,7 +412,8 @@ int vtkMRMLSequenceNode::GetInsertPosition(const std::string& indexValue)
   {
     int itemNumber = this->GetItemNumberFromIndexValue(indexValue, false);
     double numericIndexValue = atof(indexValue.c_str());
-    double foundNumericIndexValue = atof(this->IndexEntries[itemNumber].IndexValue.c_str());
+    // lookup table is up-to-date after GetItemNumberFromIndexValue
+    double foundNumericIndexValue = this->NumericIndexValues[itemNumber];
     if (numericIndexValue < foundNumericIndexValue) // Deals with case of index value being smaller than any in the sequence and numeric tolerances
     {
       insertPosition = itemNumber;
@@ -400,7 +427,7 @@ int vtkMRMLSequenceNode::GetInsertPosition(const std::string& indexValue)
 }
 
 //----------------------------------------------------------------------------
-vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue)
+vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue, bool shallowCopy /* = false */)
 {
   if (node == nullptr)
   {
@@ -411,7 +438,35 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
   // Make sure the sequence scene is created
   this->GetSequenceScene();
   // Add a copy of the node to the sequence's scene
-  vtkMRMLNode* newNode = this->DeepCopyNodeToScene(node, this->SequenceScene);
+  vtkMRMLNode* newNode = this->CopyNodeToScene(node, this->SequenceScene, !shallowCopy);
+  this->SetItemDataNode(newNode, indexValue);
+  return newNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValueFromItem(int sourceItemNumber, const std::string& indexValue)
+{
+  if (sourceItemNumber < 0 || sourceItemNumber >= static_cast<int>(this->IndexEntries.size()))
+  {
+    vtkErrorMacro("vtkMRMLSequenceNode::SetDataNodeAtValueFromItem failed: sourceItemNumber "
+      << sourceItemNumber << " is out of range");
+    return nullptr;
+  }
+  vtkMRMLNode* dataNode = this->IndexEntries[sourceItemNumber].DataNode;
+  if (!dataNode || !this->SequenceScene)
+  {
+    vtkErrorMacro("vtkMRMLSequenceNode::SetDataNodeAtValueFromItem failed: data node of item "
+      << sourceItemNumber << " is invalid");
+    return nullptr;
+  }
+  MRMLNodeModifyBlocker blocker(this);
+  this->SetItemDataNode(dataNode, indexValue);
+  return dataNode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::SetItemDataNode(vtkMRMLNode* dataNode, const std::string& indexValue)
+{
   vtkMRMLNode* oldNode = nullptr;
   int seqItemIndex = this->GetItemNumberFromIndexValue(indexValue);
   if (seqItemIndex >= 0)
@@ -426,9 +481,21 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
     IndexEntryType seqItem;
     seqItem.IndexValue = indexValue;
     this->IndexEntries.insert(this->IndexEntries.begin() + seqItemIndex, seqItem);
+    if (this->IndexValueLookupValid && seqItemIndex == static_cast<int>(this->NumericIndexValues.size()))
+    {
+      // Appending items (typical when recording) does not require rebuilding the lookup tables
+      this->NumericIndexValues.push_back(atof(indexValue.c_str()));
+      this->IndexValueToItemNumber.emplace(indexValue, seqItemIndex);
+    }
+    else
+    {
+      this->InvalidateIndexValueLookup();
+    }
   }
-  this->IndexEntries[seqItemIndex].DataNode = newNode;
+  this->IndexEntries[seqItemIndex].DataNode = dataNode;
   this->IndexEntries[seqItemIndex].DataNodeID.clear();
+  this->ChangeDataNodeItemCount(oldNode, -1);
+  this->ChangeDataNodeItemCount(dataNode, 1);
   // Save the sequence data node class namein a node attribute to allow easy access
   // (e.g., for filtering on the GUI).
   if (this->GetNumberOfDataNodes() <= 1)
@@ -436,15 +503,126 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
     this->SetAttribute("DataNodeClassName", this->GetDataNodeClassName().c_str());
   }
 
-  if (oldNode)
+  if (oldNode && oldNode != dataNode && this->GetNumberOfItemsWithDataNode(oldNode) == 0)
   {
-    // Remove the old node from the scene
+    // Remove the old node from the scene (if it is not used by other items)
     this->SequenceScene->RemoveNode(oldNode);
   }
 
   this->Modified();
   this->StorableModifiedTime.Modified();
-  return newNode;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSequenceNode::GetNumberOfItemsWithDataNode(vtkMRMLNode* dataNode)
+{
+  if (!dataNode)
+  {
+    return 0;
+  }
+  this->UpdateDataNodeItemCounts();
+  std::unordered_map<vtkMRMLNode*, int>::iterator countIt = this->DataNodeItemCounts.find(dataNode);
+  return (countIt != this->DataNodeItemCounts.end() ? countIt->second : 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::UpdateDataNodeItemCounts()
+{
+  if (this->DataNodeItemCountsValid)
+  {
+    return;
+  }
+  this->DataNodeItemCounts.clear();
+  for (const IndexEntryType& indexEntry : this->IndexEntries)
+  {
+    if (indexEntry.DataNode)
+    {
+      this->DataNodeItemCounts[indexEntry.DataNode.GetPointer()]++;
+    }
+  }
+  this->DataNodeItemCountsValid = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::InvalidateDataNodeItemCounts()
+{
+  this->DataNodeItemCountsValid = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::ChangeDataNodeItemCount(vtkMRMLNode* dataNode, int delta)
+{
+  if (!dataNode || !this->DataNodeItemCountsValid)
+  {
+    // counts will be rebuilt from IndexEntries when needed
+    return;
+  }
+  int& count = this->DataNodeItemCounts[dataNode];
+  count += delta;
+  if (count <= 0)
+  {
+    this->DataNodeItemCounts.erase(dataNode);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSequenceNode::IsNthDataNodeShared(int itemNumber)
+{
+  if (itemNumber < 0 || itemNumber >= static_cast<int>(this->IndexEntries.size()))
+  {
+    vtkErrorMacro("vtkMRMLSequenceNode::IsNthDataNodeShared failed: itemNumber " << itemNumber << " is out of range");
+    return false;
+  }
+  return this->GetNumberOfItemsWithDataNode(this->IndexEntries[itemNumber].DataNode) > 1;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSequenceNode::IsNthImageDataShared(int itemNumber)
+{
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(this->IndexEntries[itemNumber].DataNode);
+  vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : nullptr;
+  if (!imageData)
+  {
+    return false;
+  }
+  int numberOfItems = static_cast<int>(this->IndexEntries.size());
+  for (int otherItemNumber = 0; otherItemNumber < numberOfItems; otherItemNumber++)
+  {
+    vtkMRMLVolumeNode* otherVolumeNode = vtkMRMLVolumeNode::SafeDownCast(this->IndexEntries[otherItemNumber].DataNode);
+    if (otherVolumeNode && otherVolumeNode != volumeNode && otherVolumeNode->GetImageData() == imageData)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSequenceNode::UnshareNthDataNode(int itemNumber)
+{
+  vtkMRMLNode* dataNode = this->GetNthDataNode(itemNumber);
+  if (!dataNode)
+  {
+    return dataNode;
+  }
+  if (this->IsNthDataNodeShared(itemNumber))
+  {
+    vtkMRMLNode* dataNodeCopy = this->DeepCopyNodeToScene(dataNode, this->SequenceScene);
+    this->IndexEntries[itemNumber].DataNode = dataNodeCopy;
+    this->ChangeDataNodeItemCount(dataNode, -1);
+    this->ChangeDataNodeItemCount(dataNodeCopy, 1);
+    return dataNodeCopy;
+  }
+  if (this->IsNthImageDataShared(itemNumber))
+  {
+    // The volume node is not shared but its voxels are, make sure that changing the voxels
+    // of this item does not change other items.
+    vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(dataNode);
+    vtkNew<vtkImageData> imageDataCopy;
+    imageDataCopy->DeepCopy(volumeNode->GetImageData());
+    volumeNode->SetAndObserveImageData(imageDataCopy);
+  }
+  return dataNode;
 }
 
 //----------------------------------------------------------------------------
@@ -456,17 +634,44 @@ void vtkMRMLSequenceNode::RemoveDataNodeAtValue(const std::string& indexValue)
     vtkWarningMacro("vtkMRMLSequenceNode::RemoveDataNodeAtValue: node was not found at index value "<<indexValue);
     return;
   }
+  this->RemoveNthDataNode(seqItemIndex);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::RemoveNthDataNode(int seqItemIndex)
+{
+  if (seqItemIndex < 0 || seqItemIndex >= static_cast<int>(this->IndexEntries.size()))
+  {
+    vtkWarningMacro("vtkMRMLSequenceNode::RemoveNthDataNode: itemNumber " << seqItemIndex << " is out of range");
+    return;
+  }
   if (!this->SequenceScene)
   {
-    vtkWarningMacro("vtkMRMLSequenceNode::RemoveDataNodeAtValue: internal scene is already empty");
+    vtkWarningMacro("vtkMRMLSequenceNode::RemoveNthDataNode: internal scene is already empty");
     return;
   }
   // TODO: remove associated nodes as well (such as storage node)?
   vtkMRMLNode* dataNode = this->IndexEntries[seqItemIndex].DataNode;
-  if (dataNode)
+  if (dataNode && this->GetNumberOfItemsWithDataNode(dataNode) <= 1)
   {
     this->SequenceScene->RemoveNode(dataNode);
   }
+  this->ChangeDataNodeItemCount(dataNode, -1);
+  if (this->IndexValueLookupValid && seqItemIndex == static_cast<int>(this->NumericIndexValues.size()) - 1)
+  {
+    // Removing the last item does not require rebuilding the lookup tables
+    this->NumericIndexValues.pop_back();
+    std::unordered_map<std::string, int>::iterator itemNumberIt
+      = this->IndexValueToItemNumber.find(this->IndexEntries[seqItemIndex].IndexValue);
+    if (itemNumberIt != this->IndexValueToItemNumber.end() && itemNumberIt->second == seqItemIndex)
+    {
+      this->IndexValueToItemNumber.erase(itemNumberIt);
+    }
+  }
+  else
+  {
+    this->InvalidateIndexValueLookup();
+  }
   this->IndexEntries.erase(this->IndexEntries.begin()+seqItemIndex);
   this->Modified();
   this->StorableModifiedTime.Modified();
@@ -481,6 +686,8 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
     return -1;
   }
 
+  this->UpdateIndexValueLookup();
+
   // Binary search will be faster for numeric index
   if (this->IndexType == NumericIndex)
   {
@@ -489,8 +696,8 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
 
     // Deal with index values not within the range of index values in the Sequence
     double numericIndexValue = atof(indexValue.c_str());
-    double lowerNumericIndexValue = atof(this->IndexEntries[lowerBound].IndexValue.c_str());
-    double upperNumericIndexValue = atof(this->IndexEntries[upperBound].IndexValue.c_str());
+    double lowerNumericIndexValue = this->NumericIndexValues[lowerBound];
+    double upperNumericIndexValue = this->NumericIndexValues[upperBound];
     if (numericIndexValue <= lowerNumericIndexValue + this->NumericIndexValueTolerance)
     {
       if (numericIndexValue < lowerNumericIndexValue - this->NumericIndexValueTolerance && exactMatchRequired)
@@ -518,7 +725,7 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
     {
       // Note that if middle is equal to either lowerBound or upperBound then upperBound - lowerBound <= 1
       int middle = int((lowerBound + upperBound)/2);
-      double middleNumericIndexValue = atof(this->IndexEntries[middle].IndexValue.c_str());
+      double middleNumericIndexValue = this->NumericIndexValues[middle];
       if (fabs(numericIndexValue - middleNumericIndexValue) <= this->NumericIndexValueTolerance)
       {
         return middle;
@@ -538,16 +745,40 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
     }
   }
 
-  // Need linear search for non-numeric index
-  for (int i=0; i<numberOfSeqItems; i++)
+  // Exact match of the index value string
+  std::unordered_map<std::string, int>::iterator itemNumberIt = this->IndexValueToItemNumber.find(indexValue);
+  if (itemNumberIt == this->IndexValueToItemNumber.end())
   {
-    if (this->IndexEntries[i].IndexValue.compare(indexValue)==0)
-    {
-      return i;
-    }
+    return -1;
   }
+  return itemNumberIt->second;
+}
 
-  return -1;
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceNode::InvalidateIndexValueLookup()
+{
+  this->IndexValueLookupValid = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceNode::UpdateIndexValueLookup()
+{
+  if (this->IndexValueLookupValid)
+  {
+    return;
+  }
+  int numberOfSeqItems = static_cast<int>(this->IndexEntries.size());
+  this->NumericIndexValues.resize(numberOfSeqItems);
+  this->IndexValueToItemNumber.clear();
+  this->IndexValueToItemNumber.reserve(numberOfSeqItems);
+  for (int i = 0; i < numberOfSeqItems; i++)
+  {
+    const std::string& indexValue = this->IndexEntries[i].IndexValue;
+    this->NumericIndexValues[i] = atof(indexValue.c_str());
+    // emplace does not overwrite, so the first item is found if index values are not unique
+    this->IndexValueToItemNumber.emplace(indexValue, i);
+  }
+  this->IndexValueLookupValid = true;
 }
 
 //---------------------------------------------------------------------------
@@ -564,7 +795,12 @@ vtkMRMLNode* vtkMRMLSequenceNode::GetDataNodeAtValue(const std::string& indexVal
     // not found
     return nullptr;
   }
-  return this->IndexEntries[seqItemIndex].DataNode;
+  vtkMRMLNode* dataNode = this->IndexEntries[seqItemIndex].DataNode;
+  if (this->OnDemandFrameLoader && dataNode)
+  {
+    this->OnDemandFrameLoader->LoadFrame(dataNode);
+  }
+  return dataNode;
 }
 
 //---------------------------------------------------------------------------
@@ -610,10 +846,12 @@ bool vtkMRMLSequenceNode::UpdateIndexValue(const std::string& oldIndexValue, con
     IndexEntryType movingEntry = this->IndexEntries[oldSeqItemIndex];
     // Remove from current position
     this->IndexEntries.erase(this->IndexEntries.begin() + oldSeqItemIndex);
+    this->InvalidateIndexValueLookup();
     // Insert into new position
     int insertPosition = this->GetInsertPosition(newIndexValue);
     this->IndexEntries.insert(this->IndexEntries.begin() + insertPosition, movingEntry);
   }
+  this->InvalidateIndexValueLookup();
   this->Modified();
   this->StorableModifiedTime.Modified();
   return true;
@@ -661,14 +899,51 @@ std::string vtkMRMLSequenceNode::GetDataNodeTagName()
 }
 
 //-----------------------------------------------------------------------------
-vtkMRMLNode* vtkMRMLSequenceNode::GetNthDataNode(int itemNumber)
+vtkMRMLNode* vtkMRMLSequenceNode::GetNthDataNode(int itemNumber, bool loadOnDemandFrame/*=true*/)
 {
   if (static_cast<int>(this->IndexEntries.size())<=itemNumber)
   {
     vtkErrorMacro("vtkMRMLSequenceNode::GetNthDataNode failed: itemNumber "<<itemNumber<<" is out of range");
     return nullptr;
   }
-  return this->IndexEntries[itemNumber].DataNode;
+  vtkMRMLNode* dataNode = this->IndexEntries[itemNumber].DataNode;
+  if (loadOnDemandFrame && this->OnDemandFrameLoader && dataNode)
+  {
+    this->OnDemandFrameLoader->LoadFrame(dataNode);
+  }
+  return dataNode;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::SetOnDemandFrameLoader(vtkMRMLSequenceFrameLoader* loader)
+{
+  this->OnDemandFrameLoader = loader;
+  this->OnDemandFrameLoaderObject = dynamic_cast<vtkObject*>(loader);
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLSequenceFrameLoader* vtkMRMLSequenceNode::GetOnDemandFrameLoader()
+{
+  return this->OnDemandFrameLoader;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::PrefetchDataNodes(const std::vector<int>& itemNumbers)
+{
+  if (!this->OnDemandFrameLoader)
+  {
+    // data nodes are already in memory
+    return;
+  }
+  std::vector<vtkMRMLNode*> dataNodes;
+  for (int itemNumber : itemNumbers)
+  {
+    if (itemNumber >= 0 && itemNumber < static_cast<int>(this->IndexEntries.size()) && this->IndexEntries[itemNumber].DataNode)
+    {
+      dataNodes.push_back(this->IndexEntries[itemNumber].DataNode);
+    }
+  }
+  this->OnDemandFrameLoader->PrefetchFrames(dataNodes);
 }
 
 //-----------------------------------------------------------------------------
@@ -754,6 +1029,7 @@ void vtkMRMLSequenceNode::UpdateSequenceIndex()
       {
         // clear the ID to remove redundancy in the data
         indexIt->DataNodeID.clear();
+        this->ChangeDataNodeItemCount(indexIt->DataNode, 1);
       }
     }
   }
@@ -800,10 +1076,16 @@ int vtkMRMLSequenceNode::GetIndexTypeFromString(const std::string& indexTypeStri
 
 //-----------------------------------------------------------
 vtkMRMLNode* vtkMRMLSequenceNode::DeepCopyNodeToScene(vtkMRMLNode* source, vtkMRMLScene* scene)
+{
+  return this->CopyNodeToScene(source, scene, true);
+}
+
+//-----------------------------------------------------------
+vtkMRMLNode* vtkMRMLSequenceNode::CopyNodeToScene(vtkMRMLNode* source, vtkMRMLScene* scene, bool deepCopy)
 {
   if (source == nullptr)
   {
-    vtkGenericWarningMacro("vtkMRMLSequenceNode::DeepCopyNodeToScene failed, invalid node");
+    vtkGenericWarningMacro("vtkMRMLSequenceNode::CopyNodeToScene failed, invalid node");
     return nullptr;
   }
   std::string baseName = "Data";
@@ -818,7 +1100,7 @@ vtkMRMLNode* vtkMRMLSequenceNode::DeepCopyNodeToScene(vtkMRMLNode* source, vtkMR
   std::string newNodeName = baseName;
 
   vtkSmartPointer<vtkMRMLNode> target = vtkSmartPointer<vtkMRMLNode>::Take(source->CreateNodeInstance());
-  target->CopyContent(source); // deep-copy
+  target->CopyContent(source, deepCopy);
 
   // Generating unique node names is slow, and makes adding many nodes to a sequence too slow
   // We will instead ensure that all file names for storable nodes are unique when saving
@@ -25,7 +25,10 @@
 // std includes
 #include <deque>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
+class vtkMRMLSequenceFrameLoader;
 
 /// \brief MRML node for representing a sequence of MRML nodes
 ///
@@ -103,17 +106,41 @@ public:
 
   /// Add a copy of the provided node to this sequence as a data node.
   /// If a sequence item is not found by that index, a new item is added.
-  /// Always performs deep-copy.
+  /// Performs deep-copy by default. If shallowCopy is enabled then the new data node
+  /// may share data objects (such as image data) with the provided node.
   /// Returns the data node copy that has just been created.
-  vtkMRMLNode* SetDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue);
+  vtkMRMLNode* SetDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue, bool shallowCopy = false);
+
+  /// Set the data node of an existing item as data node at the specified index value.
+  /// No copy is made, the two items share the same data node. This allows storing
+  /// unchanged content efficiently (for example, during recording).
+  /// If a sequence item is not found by that index, a new item is added.
+  /// Returns the shared data node.
+  /// \sa IsNthDataNodeShared, UnshareNthDataNode
+  vtkMRMLNode* SetDataNodeAtValueFromItem(int sourceItemNumber, const std::string& indexValue);
+
+  /// Returns true if the data node of the n-th item is used by other items as well.
+  bool IsNthDataNodeShared(int itemNumber);
+
+  /// Make sure that the n-th item has its own data node (not shared with any other items)
+  /// by replacing a shared data node with a copy. Returns the data node of the item.
+  /// Volume items may have their own volume node but still share the image data with other items
+  /// (for example, if only the volume geometry changed during recording), in this case
+  /// the image data of the item is replaced by a copy.
+  vtkMRMLNode* UnshareNthDataNode(int itemNumber);
 
   /// Update an existing data node.
+  /// If the data node is shared with other items then the item gets its own copy first.
   /// Return true if a data node was found by that index.
   bool UpdateDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue, bool shallowCopy = false);
 
   /// Remove data node corresponding to the specified index
   void RemoveDataNodeAtValue(const std::string& indexValue);
 
+  /// Remove the n-th data node.
+  /// Faster than RemoveDataNodeAtValue when the item number is already known.
+  void RemoveNthDataNode(int itemNumber);
+
   /// Remove all data nodes from the sequence
   void RemoveAllDataNodes();
 
@@ -121,8 +148,10 @@ public:
   /// If exact match is not required and index is numeric then the best matching data node is returned.
   vtkMRMLNode* GetDataNodeAtValue(const std::string& indexValue, bool exactMatchRequired = true);
 
-  /// Get the data node corresponding to the n-th index value
-  vtkMRMLNode* GetNthDataNode(int itemNumber);
+  /// Get the data node corresponding to the n-th index value.
+  /// If loadOnDemandFrame is false then the content of a data node that is loaded on demand
+  /// is not loaded (for example, image data of a volume frame may be nullptr).
+  vtkMRMLNode* GetNthDataNode(int itemNumber, bool loadOnDemandFrame = true);
 
   /// Index value of n-th data node.
   std::string GetNthIndexValue(int itemNumber);
@@ -160,6 +189,18 @@ public:
   /// Update node IDs in case of node ID conflicts on scene import
   void UpdateScene(vtkMRMLScene *scene) override;
 
+  /// Loader of data node content when data nodes are accessed (for example, a
+  /// vtkMRMLVolumeSequenceStorageNode with OnDemandFrameLoading enabled).
+  /// If set, then GetNthDataNode and GetDataNodeAtValue make sure that the returned
+  /// data node is loaded. Set by the storage node when the sequence is read.
+  /// If the loader is a VTK object then the sequence node keeps a reference to it.
+  void SetOnDemandFrameLoader(vtkMRMLSequenceFrameLoader* loader);
+  vtkMRMLSequenceFrameLoader* GetOnDemandFrameLoader();
+
+  /// Prepare data nodes in the background that are expected to be accessed soon
+  /// (for example, during playback). Only has effect if data nodes are loaded on demand.
+  void PrefetchDataNodes(const std::vector<int>& itemNumbers);
+
   /// Type of the index. Controls the behavior of sorting, finding, etc.
   /// Additional types may be added in the future, such as tag cloud, two-dimensional index, ...
   enum IndexTypes
@@ -181,7 +222,38 @@ protected:
 
   void ReadIndexValues(const std::string& indexText);
 
+  /// Rebuild the index value lookup tables (NumericIndexValues, IndexValueToItemNumber)
+  /// if IndexEntries has been changed since they were last built.
+  void UpdateIndexValueLookup();
+
+  /// Mark the index value lookup tables as outdated.
+  /// Must be called whenever IndexEntries is modified.
+  void InvalidateIndexValueLookup();
+
   vtkMRMLNode* DeepCopyNodeToScene(vtkMRMLNode* source, vtkMRMLScene* scene);
+  vtkMRMLNode* CopyNodeToScene(vtkMRMLNode* source, vtkMRMLScene* scene, bool deepCopy);
+
+  /// Set dataNode (that is already in the sequence scene) as data node of the item at indexValue.
+  /// The item is added if it does not exist yet.
+  void SetItemDataNode(vtkMRMLNode* dataNode, const std::string& indexValue);
+
+  /// Returns the number of items that use the specified data node.
+  int GetNumberOfItemsWithDataNode(vtkMRMLNode* dataNode);
+
+  /// Rebuild DataNodeItemCounts from IndexEntries if the counts are not valid.
+  void UpdateDataNodeItemCounts();
+
+  /// Mark DataNodeItemCounts as outdated.
+  /// Must be called whenever data nodes of IndexEntries are replaced other than
+  /// by SetItemDataNode, RemoveNthDataNode, or UnshareNthDataNode.
+  void InvalidateDataNodeItemCounts();
+
+  /// Change the number of items that use the specified data node by \a delta.
+  void ChangeDataNodeItemCount(vtkMRMLNode* dataNode, int delta);
+
+  /// Returns true if the image data of the n-th item (if it is a volume) is used
+  /// by the volume node of any other item.
+  bool IsNthImageDataShared(int itemNumber);
 
   struct IndexEntryType
   {
@@ -204,6 +276,24 @@ protected:
 
   /// List of data items (the scene may contain some more nodes, such as storage nodes)
   std::deque< IndexEntryType > IndexEntries;
+
+  /// Index values of IndexEntries converted to numbers, for fast search in numeric index
+  std::vector<double> NumericIndexValues;
+  /// Item number of each index value, for fast search of exact match (first item is stored if
+  /// multiple items have the same index value)
+  std::unordered_map<std::string, int> IndexValueToItemNumber;
+  /// NumericIndexValues and IndexValueToItemNumber are up-to-date
+  bool IndexValueLookupValid{false};
+
+  /// Number of items that use each data node, for fast check of data node sharing
+  std::unordered_map<vtkMRMLNode*, int> DataNodeItemCounts;
+  /// DataNodeItemCounts is up-to-date
+  bool DataNodeItemCountsValid{false};
+
+  /// Loads content of data nodes on demand
+  vtkMRMLSequenceFrameLoader* OnDemandFrameLoader{nullptr};
+  /// Keeps the on-demand frame loader alive if it is a VTK object
+  vtkSmartPointer<vtkObject> OnDemandFrameLoaderObject;
 };
 
 #endif
@@ -1308,6 +1308,38 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
   return success;
 }
 
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::PreloadData()
+{
+  // Remote files have to be staged first, which is done by ReadData
+  if (!this->CanPreloadData() || this->GetFileName() == nullptr || this->GetURI() != nullptr)
+  {
+    return false;
+  }
+  if (this->GetScene() && this->GetScene()->GetReadDataOnLoad() == 0)
+  {
+    return false;
+  }
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty() || !vtksys::SystemTools::FileExists(fullName.c_str(), true))
+  {
+    return false;
+  }
+  return this->PreloadDataInternal(fullName);
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::CanPreloadData()
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::PreloadDataInternal(const std::string& vtkNotUsed(fullName))
+{
+  return false;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
 {
@@ -59,6 +59,26 @@ public:
   /// \sa SetFileName(), ReadDataInternal(), GetStoredTime()
   virtual int ReadData(vtkMRMLNode *refNode, bool temporaryFile = false);
 
+  ///
+  /// Read the data file into memory, without modifying the referenced node or any other node.
+  /// This allows decoding files of multiple storage nodes concurrently on worker threads
+  /// (see vtkMRMLScene::Import()). The next ReadData() call uses the preloaded data
+  /// instead of reading the file again.
+  /// Return true if data was preloaded. Return false if preloading is not supported
+  /// or failed. In that case, ReadData() reads the file as usual and reports errors.
+  /// \sa CanPreloadData(), ClearPreloadedData(), PreloadDataInternal()
+  bool PreloadData();
+
+  ///
+  /// Return true if the storage node can preload its data (the data is stored in a local
+  /// file and PreloadDataInternal() is implemented).
+  /// Returns false by default. To be reimplemented in subclasses that support preloading.
+  virtual bool CanPreloadData();
+
+  ///
+  /// Discard data read by PreloadData() that has not been used by ReadData().
+  virtual void ClearPreloadedData() {};
+
   ///
   /// Write data from a  referenced node
   /// Return 1 on success, 0 on failure.
@@ -386,6 +406,13 @@ protected:
   /// To be reimplemented in subclass.
   virtual int ReadDataInternal(vtkMRMLNode* refNode);
 
+  /// Does the actual preloading of the file. Returns true on success.
+  /// It must not access the referenced node, other nodes, or the user messages
+  /// of the storage node, as it may be called from a worker thread.
+  /// Returns false by default (preload not supported).
+  /// To be reimplemented in subclass.
+  virtual bool PreloadDataInternal(const std::string& fullName);
+
   /// Does the actual writing. Returns 1 on success, 0 otherwise.
   /// Returns 0 by default (write not supported).
   /// To be reimplemented in subclass.
@@ -31,6 +31,7 @@
 
 // VTK includes
 #include <vtkCollection.h>
+#include <vtkIdList.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
@@ -41,6 +42,7 @@
 #include <sstream>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 //----------------------------------------------------------------------------
@@ -52,6 +54,9 @@ const std::string vtkMRMLSubjectHierarchyNode::SUBJECTHIERARCHY_VERSION_ATTRIBUT
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSubjectHierarchyNode);
 
+//----------------------------------------------------------------------------
+class vtkSubjectHierarchyItemIndex;
+
 //----------------------------------------------------------------------------
 class vtkSubjectHierarchyItem : public vtkObject
 {
@@ -103,10 +108,13 @@ public:
   /// The ID is resolved to pointer after import ends, and this member is set to INVALID_ITEM_ID.
   vtkIdType TemporaryParentItemID;
 
-  /// Item and data node cache to speed up lookups that are needed many times.
-  /// It can be static as the item IDs are unique in one application session.
-  static std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > ItemCache;
-  static std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > DataNodeCache;
+  /// Lookup tables of the subject hierarchy tree that contains this item.
+  /// Set when the item is added to the tree, nullptr for unresolved items.
+  vtkSubjectHierarchyItemIndex* Index{nullptr};
+
+  /// Position of the children in the Children vector to speed up finding a child.
+  /// Entries are validated when used, and the map is rebuilt if the children vector has changed.
+  std::unordered_map<vtkSubjectHierarchyItem*, int> ChildPositions;
 
 // Get/set functions
 public:
@@ -166,6 +174,9 @@ public:
   /// Items in virtual branches are invalid without the parent item, as they represent the item's data node's content, so
   /// they are removed automatically when the parent item of the virtual branch is removed
   bool IsVirtualBranchParent();
+  /// Determine whether the given item is a child of this item
+  /// \param recursive Flag whether to check only direct children (false) or the whole branch (true)
+  bool HasChild(vtkSubjectHierarchyItem* item, bool recursive);
   /// Find child by ID
   /// \param itemID ID to find
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
@@ -214,6 +225,16 @@ public:
   /// Get child item by position
   /// \return ID of child item found in given position. Invalid if no item found at that position
   vtkIdType GetChildByPositionUnderParent(int position);
+  /// Get position of a direct child in the Children vector
+  /// \return Position of the child. -1 if not found.
+  int GetChildPosition(vtkSubjectHierarchyItem* child);
+
+  /// Add item to the end of the children vector. Parent of the child is not changed.
+  void AppendChild(vtkSubjectHierarchyItem* child);
+  /// Insert item into the children vector at the given position. Parent of the child is not changed.
+  void InsertChild(int position, vtkSubjectHierarchyItem* child);
+  /// Remove item from the children vector at the given position
+  void EraseChild(int position);
 
   /// Remove given item from children by item pointer
   /// \return Success flag
@@ -252,16 +273,92 @@ private:
   void operator=(const vtkSubjectHierarchyItem&) = delete;
 };
 
+//----------------------------------------------------------------------------
+/// Item, data node, and UID lookup tables of a subject hierarchy tree to speed up
+/// lookups that are needed many times. Owned by the subject hierarchy node, and
+/// shared by all the items that are in its tree.
+class vtkSubjectHierarchyItemIndex
+{
+public:
+  typedef std::vector<vtkWeakPointer<vtkSubjectHierarchyItem> > ItemList;
+
+  /// Add item with its data node and UIDs
+  void AddItem(vtkSubjectHierarchyItem* item)
+  {
+    this->Items[item->ID] = item;
+    if (item->DataNode)
+    {
+      this->DataNodes[item->DataNode] = item;
+    }
+    for (std::map<std::string, std::string>::iterator uidIt = item->UIDs.begin(); uidIt != item->UIDs.end(); ++uidIt)
+    {
+      this->AddUID(item, uidIt->first, uidIt->second);
+    }
+  }
+
+  /// Remove item with its data node and UIDs
+  void RemoveItem(vtkSubjectHierarchyItem* item)
+  {
+    this->Items.erase(item->ID);
+    if (item->DataNode)
+    {
+      auto dataNodeIt = this->DataNodes.find(item->DataNode);
+      if (dataNodeIt != this->DataNodes.end() && dataNodeIt->second.GetPointer() == item)
+      {
+        this->DataNodes.erase(dataNodeIt);
+      }
+    }
+    for (std::map<std::string, std::string>::iterator uidIt = item->UIDs.begin(); uidIt != item->UIDs.end(); ++uidIt)
+    {
+      this->RemoveUID(item, uidIt->first, uidIt->second);
+    }
+  }
+
+  void AddUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+  {
+    if (uidValue.empty())
+    {
+      return;
+    }
+    this->UIDs[uidName][uidValue].push_back(item);
+  }
+
+  void RemoveUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+  {
+    auto nameIt = this->UIDs.find(uidName);
+    if (nameIt == this->UIDs.end())
+    {
+      return;
+    }
+    auto valueIt = nameIt->second.find(uidValue);
+    if (valueIt == nameIt->second.end())
+    {
+      return;
+    }
+    ItemList& items = valueIt->second;
+    items.erase(std::remove_if(items.begin(), items.end(),
+      [item](const vtkWeakPointer<vtkSubjectHierarchyItem>& indexedItem)
+        { return indexedItem.GetPointer() == item || indexedItem.GetPointer() == nullptr; }),
+      items.end());
+    if (items.empty())
+    {
+      nameIt->second.erase(valueIt);
+    }
+  }
+
+  /// Items by ID
+  std::unordered_map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > Items;
+  /// Items by associated data node
+  std::unordered_map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > DataNodes;
+  /// Items by UID name then UID value. Multiple items may have the same UID.
+  std::unordered_map<std::string, std::unordered_map<std::string, ItemList> > UIDs;
+};
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSubjectHierarchyItem);
 
 vtkIdType vtkSubjectHierarchyItem::NextSubjectHierarchyItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID + 1;
 
-std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarchyItem::ItemCache =
-  std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> >();
-std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarchyItem::DataNodeCache =
-  std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> >();
-
 //---------------------------------------------------------------------------
 // vtkSubjectHierarchyItem methods
 
@@ -309,14 +406,13 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
   if (parent)
   {
     // Add under parent
-    vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
-    this->Parent->Children.push_back(childPointer);
+    this->Parent->AppendChild(this);
 
-    // Add to cache
-    vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
-    if (dataNode)
+    // Add to index
+    this->Index = parent->Index;
+    if (this->Index)
     {
-      vtkSubjectHierarchyItem::DataNodeCache[dataNode] = this;
+      this->Index->AddItem(this);
     }
   }
   else
@@ -350,18 +446,21 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
   if (parent)
   {
     // Add under parent
-    vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
     if (positionUnderParent < 0 || positionUnderParent >= static_cast<int>(this->Parent->Children.size()))
     {
-      this->Parent->Children.push_back(childPointer);
+      this->Parent->AppendChild(this);
     }
     else
     {
-      this->Parent->Children.insert(this->Parent->Children.begin() + positionUnderParent, childPointer);
+      this->Parent->InsertChild(positionUnderParent, this);
     }
 
-    // Add to cache (DataNode is nullptr, so no need to add to node cache)
-    vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    // Add to index
+    this->Index = parent->Index;
+    if (this->Index)
+    {
+      this->Index->AddItem(this);
+    }
   }
   else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
             || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
@@ -691,7 +790,7 @@ void vtkSubjectHierarchyItem::DeepCopy(vtkSubjectHierarchyItem* item, bool copyC
     {
       vtkSmartPointer<vtkSubjectHierarchyItem> copiedChildItem = vtkSmartPointer<vtkSubjectHierarchyItem>::New();
       copiedChildItem->DeepCopy(childIt->GetPointer(), true);
-      this->Children.push_back(copiedChildItem);
+      this->AppendChild(copiedChildItem);
       copiedChildItem->Parent = this;
     }
   }
@@ -720,6 +819,27 @@ bool vtkSubjectHierarchyItem::IsVirtualBranchParent()
     vtkMRMLSubjectHierarchyConstants::GetSubjectHierarchyVirtualBranchAttributeName() ).empty();
 }
 
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::HasChild(vtkSubjectHierarchyItem* item, bool recursive)
+{
+  if (!item)
+  {
+    return false;
+  }
+  if (!recursive)
+  {
+    return item->Parent == this;
+  }
+  for (vtkSubjectHierarchyItem* ancestor = item->Parent; ancestor; ancestor = ancestor->Parent)
+  {
+    if (ancestor == this)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 //---------------------------------------------------------------------------
 vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByID(vtkIdType itemID, bool recursive/*=true*/)
 {
@@ -729,19 +849,19 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByID(vtkIdType itemID
     return nullptr;
   }
 
-  // Try to find item in cache
-  std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> >::iterator itemIt = vtkSubjectHierarchyItem::ItemCache.find(itemID);
-  if (itemIt != vtkSubjectHierarchyItem::ItemCache.end())
+  // Try to find item in index
+  if (this->Index)
   {
-    if (itemIt->second != nullptr)
+    auto itemIt = this->Index->Items.find(itemID);
+    if (itemIt != this->Index->Items.end() && this->HasChild(itemIt->second, recursive))
     {
       return itemIt->second;
     }
   }
-  // It is not an error if item is not found in cache. It happens normally when
+  // It is not an error if item is not found in the index. It happens normally when
   // scene has just been closed and widgets are updating themselves and trying to look up their selected item.
 
-  // On failure to look up in cache (should not happen), traverse tree to find item
+  // On failure to look up in index (should not happen), traverse tree to find item
   ChildVector::iterator childIt;
   vtkSubjectHierarchyItem* foundItem = nullptr;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
@@ -762,9 +882,9 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByID(vtkIdType itemID
       }
     }
   }
-  if (foundItem)
+  if (foundItem && this->Index)
   {
-    vtkSubjectHierarchyItem::ItemCache[itemID] = this;
+    this->Index->Items[itemID] = foundItem;
   }
 
   return foundItem;
@@ -778,6 +898,17 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByDataNode(vtkMRMLNod
     return nullptr;
   }
 
+  // Try to find item in index
+  if (this->Index)
+  {
+    auto itemIt = this->Index->DataNodes.find(dataNode);
+    if ( itemIt != this->Index->DataNodes.end() && itemIt->second
+      && itemIt->second->DataNode == dataNode && this->HasChild(itemIt->second, recursive) )
+    {
+      return itemIt->second;
+    }
+  }
+
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
   {
@@ -805,6 +936,30 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
   {
     return nullptr;
   }
+
+  // All items in the tree are indexed by UID, so no need to traverse the tree
+  if (this->Index)
+  {
+    auto nameIt = this->Index->UIDs.find(uidName);
+    if (nameIt == this->Index->UIDs.end())
+    {
+      return nullptr;
+    }
+    auto valueIt = nameIt->second.find(uidValue);
+    if (valueIt == nameIt->second.end())
+    {
+      return nullptr;
+    }
+    for (vtkSubjectHierarchyItem* item : valueIt->second)
+    {
+      if (this->HasChild(item, recursive))
+      {
+        return item;
+      }
+    }
+    return nullptr;
+  }
+
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
   {
@@ -970,16 +1125,9 @@ bool vtkSubjectHierarchyItem::Reparent(vtkSubjectHierarchyItem* newParentItem)
     return true;
   }
 
-  // Remove item from former parent
-  vtkSubjectHierarchyItem::ChildVector::iterator childIt;
-  for (childIt=formerParentItem->Children.begin(); childIt!=formerParentItem->Children.end(); ++childIt)
-  {
-    if (this == childIt->GetPointer())
-    {
-      break;
-    }
-  }
-  if (childIt == formerParentItem->Children.end())
+  // Find item in former parent
+  int position = formerParentItem->GetChildPosition(this);
+  if (position < 0)
   {
     vtkErrorMacro("Reparent: Subject hierarchy item '" << this->GetName() << "' not found under item '" << formerParentItem->GetName() << "'");
     return false;
@@ -989,11 +1137,11 @@ bool vtkSubjectHierarchyItem::Reparent(vtkSubjectHierarchyItem* newParentItem)
   vtkSmartPointer<vtkSubjectHierarchyItem> thisPointer = this;
 
   // Remove item from former parent
-  formerParentItem->Children.erase(childIt);
+  formerParentItem->EraseChild(position);
 
   // Add item to new parent
   this->Parent = newParentItem;
-  newParentItem->Children.push_back(thisPointer);
+  newParentItem->AppendChild(this);
 
   // Invoke modified events on all affected items
   formerParentItem->Modified();
@@ -1016,50 +1164,44 @@ bool vtkSubjectHierarchyItem::Move(vtkSubjectHierarchyItem* beforeItem)
     return true;
   }
 
-  // Remove item from parent
-  ChildVector::iterator removedIt;
-  for (removedIt=this->Parent->Children.begin(); removedIt!=this->Parent->Children.end(); ++removedIt)
-  {
-    if (this == removedIt->GetPointer())
-    {
-      break;
-    }
-  }
-  if (removedIt == this->Parent->Children.end())
+  int removedPosition = this->Parent->GetChildPosition(this);
+  if (removedPosition < 0)
   {
     vtkErrorMacro("Move: Failed to find subject hierarchy item '" << this->GetName()
       << "' in its parent '" << this->Parent->GetName() << "'");
     return false;
   }
+  int beforePosition = -1;
+  if (beforeItem)
+  {
+    beforePosition = this->Parent->GetChildPosition(beforeItem);
+    if (beforePosition < 0)
+    {
+      vtkErrorMacro("Move: Failed to find subject hierarchy item '" << beforeItem->GetName()
+        << "' as insertion position in item '" << this->Parent->GetName() << "'");
+      return false;
+    }
+  }
 
   // Prevent deletion of the item from memory until the events are processed
   vtkSmartPointer<vtkSubjectHierarchyItem> thisPointer = this;
 
   // Remove from parent before re-adding in new position
-  this->Parent->Children.erase(removedIt);
+  this->Parent->EraseChild(removedPosition);
 
   // Re-insert item to the requested position (before beforeItem)
   if (!beforeItem)
   {
-    this->Parent->Children.push_back(thisPointer);
+    this->Parent->AppendChild(this);
     return true;
   }
 
-  ChildVector::iterator beforeIt;
-  for (beforeIt=this->Parent->Children.begin(); beforeIt!=this->Parent->Children.end(); ++beforeIt)
+  if (beforePosition > removedPosition)
   {
-    if (beforeItem == beforeIt->GetPointer())
-    {
-      break;
-    }
-  }
-  if (beforeIt == this->Parent->Children.end())
-  {
-    vtkErrorMacro("Move: Failed to find subject hierarchy item '" << beforeItem->GetName()
-      << "' as insertion position in item '" << this->Parent->GetName() << "'");
-    return false;
+    // Position of items after the removed item has decreased
+    --beforePosition;
   }
-  this->Parent->Children.insert(beforeIt, thisPointer);
+  this->Parent->InsertChild(beforePosition, this);
   this->Parent->Modified();
 
   return true;
@@ -1074,18 +1216,13 @@ int vtkSubjectHierarchyItem::GetPositionUnderParent()
     return 0;
   }
 
-  int position = 0;
-  ChildVector::iterator childIt;
-  for (childIt=this->Parent->Children.begin(); childIt!=this->Parent->Children.end(); ++childIt, ++position)
+  int position = this->Parent->GetChildPosition(this);
+  if (position < 0)
   {
-    if (childIt->GetPointer() == this)
-    {
-      return position;
-    }
+    // Failed to find item
+    vtkErrorMacro("GetPositionUnderParent: Failed to find subject hierarchy item " << this->Name << " under its parent");
   }
-  // Failed to find item
-  vtkErrorMacro("GetPositionUnderParent: Failed to find subject hierarchy item " << this->Name << " under its parent");
-  return -1;
+  return position;
 }
 
 //---------------------------------------------------------------------------
@@ -1100,78 +1237,75 @@ vtkIdType vtkSubjectHierarchyItem::GetChildByPositionUnderParent(int position)
 }
 
 //---------------------------------------------------------------------------
-bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
+int vtkSubjectHierarchyItem::GetChildPosition(vtkSubjectHierarchyItem* child)
 {
-  if (!item)
+  auto positionIt = this->ChildPositions.find(child);
+  if ( positionIt != this->ChildPositions.end()
+    && positionIt->second < static_cast<int>(this->Children.size())
+    && this->Children[positionIt->second].GetPointer() == child )
   {
-    vtkErrorMacro("RemoveChild: Invalid subject hierarchy item given to remove from item '" << this->GetName() << "'");
-    return false;
+    return positionIt->second;
   }
 
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  // Children vector has changed since the positions were stored, rebuild position map
+  this->ChildPositions.clear();
+  int foundPosition = -1;
+  for (int position = 0; position < static_cast<int>(this->Children.size()); ++position)
   {
-    if (item == childIt->GetPointer())
+    vtkSubjectHierarchyItem* currentItem = this->Children[position].GetPointer();
+    this->ChildPositions[currentItem] = position;
+    if (currentItem == child)
     {
-      break;
+      foundPosition = position;
     }
   }
-  if (childIt == this->Children.end())
-  {
-    vtkErrorMacro("RemoveChild: Subject hierarchy item '" << item->GetName() << "' not found in item '" << this->GetName() << "'");
-    return false;
-  }
-
-  // Prevent deletion of the item from memory until the events are processed
-  vtkSmartPointer<vtkSubjectHierarchyItem> removedItem = (*childIt);
-
-  // If child is a virtual branch (meaning that its children are invalid without the item,
-  // as they represent the item's data node's content), then remove virtual branch
-  if (removedItem->IsVirtualBranchParent())
-  {
-    removedItem->RemoveAllChildren();
-  }
+  return foundPosition;
+}
 
-  // Remove child
-  this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAboutToBeRemovedEvent, item);
-  this->Children.erase(childIt);
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AppendChild(vtkSubjectHierarchyItem* child)
+{
+  this->Children.push_back(child);
+  this->ChildPositions[child] = static_cast<int>(this->Children.size()) - 1;
+}
 
-  // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
-  removedItem->ReparentChildrenToParent();
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::InsertChild(int position, vtkSubjectHierarchyItem* child)
+{
+  this->Children.insert(this->Children.begin() + position, child);
+  // Positions of the following children have changed, the map is rebuilt at next lookup
+  this->ChildPositions.clear();
+}
 
-  // Remove from cache
-  vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
-  if (removedItem->DataNode)
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::EraseChild(int position)
+{
+  this->ChildPositions.erase(this->Children[position].GetPointer());
+  this->Children.erase(this->Children.begin() + position);
+  if (position < static_cast<int>(this->Children.size()))
   {
-    vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
+    // Positions of the following children have changed, the map is rebuilt at next lookup
+    this->ChildPositions.clear();
   }
-
-  // Invoke events
-  this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, item);
-  this->Modified();
-
-  return true;
 }
 
 //---------------------------------------------------------------------------
-bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
+bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
 {
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  if (!item)
   {
-    if (itemID == (*childIt)->ID)
-    {
-      break;
-    }
+    vtkErrorMacro("RemoveChild: Invalid subject hierarchy item given to remove from item '" << this->GetName() << "'");
+    return false;
   }
-  if (childIt == this->Children.end())
+
+  if (this->GetChildPosition(item) < 0)
   {
-    vtkErrorMacro("RemoveChild: Subject hierarchy item with ID " << itemID << " not found in item '" << this->GetName() << "'");
+    vtkErrorMacro("RemoveChild: Subject hierarchy item '" << item->GetName() << "' not found in item '" << this->GetName() << "'");
     return false;
   }
 
   // Prevent deletion of the item from memory until the events are processed
-  vtkSmartPointer<vtkSubjectHierarchyItem> removedItem = (*childIt);
+  vtkSmartPointer<vtkSubjectHierarchyItem> removedItem = item;
 
   // If child is a virtual branch (meaning that its children are invalid without the item,
   // as they represent the item's data node's content), then remove virtual branch
@@ -1183,29 +1317,22 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   // Remove child
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAboutToBeRemovedEvent, removedItem.GetPointer());
 
-  // The iterator may be invalidated by operations in callback functions (for example, a module may
-  // delete some related items when this item is deleted), therefore we need to retrieve the item again.
-  for (childIt = this->Children.begin(); childIt != this->Children.end(); ++childIt)
+  // The position may be changed by operations in callback functions (for example, a module may
+  // delete some related items when this item is deleted), therefore we need to retrieve the position again.
+  int position = this->GetChildPosition(removedItem);
+  if (position >= 0)
   {
-    if (itemID == (*childIt)->ID)
-    {
-      // item found
-      break;
-    }
-  }
-  if (childIt != this->Children.end())
-  {
-    this->Children.erase(childIt);
+    this->EraseChild(position);
   }
 
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
   removedItem->ReparentChildrenToParent();
 
-  // Remove from cache
-  vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
-  if (removedItem->DataNode)
+  // Remove from index
+  if (removedItem->Index)
   {
-    vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
+    removedItem->Index->RemoveItem(removedItem);
+    removedItem->Index = nullptr;
   }
 
   // Invoke events
@@ -1215,6 +1342,18 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   return true;
 }
 
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
+{
+  vtkSubjectHierarchyItem* item = this->FindChildByID(itemID, false);
+  if (!item)
+  {
+    vtkErrorMacro("RemoveChild: Subject hierarchy item with ID " << itemID << " not found in item '" << this->GetName() << "'");
+    return false;
+  }
+  return this->RemoveChild(item);
+}
+
 //---------------------------------------------------------------------------
 void vtkSubjectHierarchyItem::ReparentChildrenToParent()
 {
@@ -1224,29 +1363,24 @@ void vtkSubjectHierarchyItem::ReparentChildrenToParent()
     return;
   }
 
-  // Use item IDs because the children vector is changing within the for loop
-  std::vector<vtkIdType> childIDs;
-  std::vector<vtkIdType>::iterator childIDIt;
-  this->GetDirectChildren(childIDs);
-  for (childIDIt=childIDs.begin(); childIDIt!=childIDs.end(); ++childIDIt)
+  // Use a copy of the children vector because the children vector is changing within the for loop.
+  // Smart pointers prevent deletion of the items from memory until the events are processed.
+  ChildVector children = this->Children;
+  for (ChildVector::iterator childIt=children.begin(); childIt!=children.end(); ++childIt)
   {
-    vtkSubjectHierarchyItem::ChildVector::iterator childIt;
-    for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+    vtkSubjectHierarchyItem* childItem = *childIt;
+    int position = this->GetChildPosition(childItem);
+    if (position < 0)
     {
-      vtkSubjectHierarchyItem* childItem = (*childIt);
-      if (childIt->GetPointer()->ID == (*childIDIt))
-      {
-        // Prevent deletion of the item from memory until the events are processed
-        vtkSmartPointer<vtkSubjectHierarchyItem> childSmartPointer = childItem;
-        // Remove child from this item
-        this->Children.erase(childIt);
-        // Add child item to this item's parent
-        childItem->Parent = this->Parent;
-        this->Parent->Children.push_back(childSmartPointer);
-        childItem->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, childItem);
-        break;
-      }
+      // Child has been removed in the meantime
+      continue;
     }
+    // Remove child from this item
+    this->EraseChild(position);
+    // Add child item to this item's parent
+    childItem->Parent = this->Parent;
+    this->Parent->AppendChild(childItem);
+    childItem->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, childItem);
   }
 
   this->Parent->Modified();
@@ -1304,6 +1438,14 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
         << "' with value '" << it->second << "'. Replacing it with value '" << uidValue << "'" );
     }
   }
+  if (this->Index)
+  {
+    if (it != this->UIDs.end())
+    {
+      this->Index->RemoveUID(this, uidName, it->second);
+    }
+    this->Index->AddUID(this, uidName, uidValue);
+  }
   this->UIDs[uidName] = uidValue;
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
@@ -1320,6 +1462,10 @@ bool vtkSubjectHierarchyItem::RemoveUID(std::string uidName)
   }
 
   // Use the find function to prevent adding an empty UID to the map
+  if (this->Index)
+  {
+    this->Index->RemoveUID(this, uidName, it->second);
+  }
   this->UIDs.erase(it);
   this->Modified();
   return true;
@@ -1509,6 +1655,9 @@ public:
   void AddItemObservers(vtkSubjectHierarchyItem* item);
 
 public:
+  /// Lookup tables of the items in the tree under the scene item
+  vtkSubjectHierarchyItemIndex ItemIndex;
+
   /// Scene subject hierarchy item. This is the ancestor of all subject hierarchy items in the tree
   vtkSubjectHierarchyItem* SceneItem;
   /// ID of the scene subject hierarchy item. It is used to access the item from outside the node
@@ -1526,6 +1675,11 @@ public:
   /// Flag indicating whether resolving unresolved items is underway (after scene import or restore)
   bool IsResolving;
 
+  /// Number of nested StartItemBatchModify calls
+  int ItemBatchModifyCount{0};
+  /// Items that changed since the outermost StartItemBatchModify call
+  std::set<vtkIdType> BatchModifiedItemIDs;
+
 private:
   vtkMRMLSubjectHierarchyNode* External;
 };
@@ -1542,6 +1696,7 @@ vtkMRMLSubjectHierarchyNode::vtkInternal::vtkInternal(vtkMRMLSubjectHierarchyNod
   // Create scene item
   this->SceneItem = vtkSubjectHierarchyItem::New();
   this->SceneItemID = this->SceneItem->AddToTree(nullptr, "Scene", "Scene");
+  this->SceneItem->Index = &this->ItemIndex;
 
   // Create mock item containing unresolved items
   this->UnresolvedItems = vtkSubjectHierarchyItem::New();
@@ -1553,6 +1708,9 @@ vtkMRMLSubjectHierarchyNode::vtkInternal::~vtkInternal()
 {
   if (this->SceneItem)
   {
+    // Remove items while the index is still valid
+    this->SceneItem->RemoveAllChildren();
+    this->SceneItem->Index = nullptr;
     this->SceneItem->Delete();
     this->SceneItem = nullptr;
   }
@@ -1812,7 +1970,7 @@ void vtkMRMLSubjectHierarchyNode::vtkInternal::CopyAsUnresolved(vtkMRMLSubjectHi
         : otherShNode->Internal->SceneItem->FindChildByID(*otherItemIt) );
     vtkSmartPointer<vtkSubjectHierarchyItem> copiedItem = vtkSmartPointer<vtkSubjectHierarchyItem>::New();
     copiedItem->DeepCopy(currentOtherItem, false); // Do not copy children, only properties
-    this->UnresolvedItems->Children.push_back(copiedItem);
+    this->UnresolvedItems->AppendChild(copiedItem);
     copiedItem->Parent = this->UnresolvedItems;
   }
 }
@@ -2031,7 +2189,7 @@ void vtkMRMLSubjectHierarchyNode::ReadItemFromXML(const char** atts)
   // These items will be resolved (item ID, parent and children item pointers, data node ID and pointer)
   // after scene import, and moved to the proper position in the tree contained by the already existing
   // singleton subject hierarchy node in vtkInternal::ResolveUnresolvedItems
-  this->Internal->UnresolvedItems->Children.push_back(item);
+  this->Internal->UnresolvedItems->AppendChild(item);
   item->Parent = this->Internal->UnresolvedItems;
 }
 
@@ -2126,22 +2284,18 @@ void vtkMRMLSubjectHierarchyNode::SetItemDataNode(vtkIdType itemID, vtkMRMLNode*
     return;
   }
 
-  // Remove old cached node
+  // Remove old node from index
   if (item->DataNode)
   {
-    auto itemIt = vtkSubjectHierarchyItem::DataNodeCache.find(item->DataNode);
-    if (itemIt != vtkSubjectHierarchyItem::DataNodeCache.end())
-    {
-      vtkSubjectHierarchyItem::DataNodeCache.erase(itemIt);
-    }
+    this->Internal->ItemIndex.DataNodes.erase(item->DataNode);
   }
 
   item->DataNode = dataNode;
 
-  // Add new node to cache
+  // Add new node to index
   if (item->DataNode)
   {
-    vtkSubjectHierarchyItem::DataNodeCache[item->DataNode] = item;
+    this->Internal->ItemIndex.DataNodes[item->DataNode] = item;
   }
 
   // Add observers for data node
@@ -3068,20 +3222,21 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByDataNode(vtkMRMLNode* dataNode)
     return INVALID_ITEM_ID;
   }
 
-  auto itemIt = vtkSubjectHierarchyItem::DataNodeCache.find(dataNode);
-  if (itemIt != vtkSubjectHierarchyItem::DataNodeCache.end())
+  std::unordered_map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> >& dataNodeIndex = this->Internal->ItemIndex.DataNodes;
+  auto itemIt = dataNodeIndex.find(dataNode);
+  if (itemIt != dataNodeIndex.end())
   {
     if (itemIt->second)
     {
       if (itemIt->second->DataNode == dataNode)
       {
-        // found it in cache
+        // found it in index
         return itemIt->second->ID;
       }
       else
       {
-        vtkErrorMacro("vtkSubjectHierarchyItem::DataNodeCache inconsistency found");
-        vtkSubjectHierarchyItem::DataNodeCache.erase(itemIt);
+        vtkErrorMacro("GetItemByDataNode: data node index inconsistency found");
+        dataNodeIndex.erase(itemIt);
       }
     }
   }
@@ -3089,9 +3244,9 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByDataNode(vtkMRMLNode* dataNode)
   vtkSubjectHierarchyItem* item = this->Internal->SceneItem->FindChildByDataNode(dataNode);
   if (item)
   {
-    // item was not in the cache, add it now
-    vtkErrorMacro("vtkSubjectHierarchyItem::DataNodeCache item was missing");
-    vtkSubjectHierarchyItem::DataNodeCache[dataNode] = item;
+    // item was not in the index, add it now
+    vtkErrorMacro("GetItemByDataNode: item was missing from data node index");
+    dataNodeIndex[dataNode] = item;
   }
   return (item ? item->ID : INVALID_ITEM_ID);
 }
@@ -3685,6 +3840,52 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
     return;
   }
 
+  // Collect item changes instead of invoking events for them during batch modify
+  if (self->Internal->ItemBatchModifyCount > 0)
+  {
+    vtkIdType itemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
+    switch (eid)
+    {
+      case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
+      {
+        vtkSubjectHierarchyItem* item = reinterpret_cast<vtkSubjectHierarchyItem*>(callData);
+        if (item)
+        {
+          itemID = item->ID;
+          self->Modified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
+        }
+      }
+        break;
+
+      case vtkCommand::ModifiedEvent:
+      case vtkMRMLTransformableNode::TransformModifiedEvent:
+      case vtkMRMLDisplayableNode::DisplayModifiedEvent:
+      {
+        vtkSubjectHierarchyItem* item = vtkSubjectHierarchyItem::SafeDownCast(caller);
+        vtkMRMLNode* dataNode = vtkMRMLNode::SafeDownCast(caller);
+        if (item)
+        {
+          itemID = item->ID;
+          self->Modified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
+        }
+        else if (dataNode)
+        {
+          itemID = self->GetItemByDataNode(dataNode);
+        }
+      }
+        break;
+
+      default:
+        // Added and removed items are not collected
+        break;
+    }
+    if (itemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+    {
+      self->Internal->BatchModifiedItemIDs.insert(itemID);
+      return;
+    }
+  }
+
   // Invoke event from node with item ID
   switch (eid)
   {
@@ -3784,3 +3985,49 @@ void vtkMRMLSubjectHierarchyNode::ShowItemsInView(vtkIdList* itemIDs, vtkMRMLAbs
   this->InvokeEvent(SubjectHierarchyItemsShowInViewRequestedEvent, &eventData);
   // The event will be processed by qSlicerSubjectHierarchyPluginHandler
 }
+
+//----------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNode::StartItemBatchModify()
+{
+  return this->Internal->ItemBatchModifyCount++;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNode::EndItemBatchModify()
+{
+  if (this->Internal->ItemBatchModifyCount <= 0)
+  {
+    vtkErrorMacro("EndItemBatchModify: No batch modify is in progress");
+    return 0;
+  }
+  if (--this->Internal->ItemBatchModifyCount > 0)
+  {
+    return this->Internal->ItemBatchModifyCount;
+  }
+  if (this->Internal->BatchModifiedItemIDs.empty())
+  {
+    return 0;
+  }
+
+  // Only report items that still exist
+  vtkNew<vtkIdList> modifiedItemIDs;
+  for (vtkIdType itemID : this->Internal->BatchModifiedItemIDs)
+  {
+    if (this->Internal->FindItemByID(itemID))
+    {
+      modifiedItemIDs->InsertNextId(itemID);
+    }
+  }
+  this->Internal->BatchModifiedItemIDs.clear();
+  if (modifiedItemIDs->GetNumberOfIds() > 0)
+  {
+    this->InvokeCustomModifiedEvent(SubjectHierarchyItemsBatchModifiedEvent, modifiedItemIDs.GetPointer());
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSubjectHierarchyNode::IsItemBatchModifyInProgress()
+{
+  return this->Internal->ItemBatchModifyCount > 0;
+}
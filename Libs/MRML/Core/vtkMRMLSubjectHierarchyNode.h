@@ -90,6 +90,10 @@ public:
     /// Use vtkMRMLSubjectHierarchyNode::ShowItemsInView or qSlicerSubjectHierarchyPluginHandler::showItemsInView
     /// method to request view of subject hierarchy items in a view.
     SubjectHierarchyItemsShowInViewRequestedEvent,
+    /// Event invoked by EndItemBatchModify with the list of item IDs (vtkIdList*) that
+    /// have been modified, reparented, or their data node display or transform modified
+    /// since StartItemBatchModify. The individual events are not invoked for these items.
+    SubjectHierarchyItemsBatchModifiedEvent,
   };
 
   /// Event data used with SubjectHierarchyItemsShowInViewRequestedEvent.
@@ -285,6 +289,7 @@ public:
   /// Find subject hierarchy item according to a UID (by exact match)
   /// \param uidName UID string to lookup
   /// \param uidValue UID string that needs to _exactly match_ the UID string of the subject hierarchy item
+  /// If multiple items have the same UID then the item that got the UID first is returned.
   /// \sa GetUID()
   vtkIdType GetItemByUID(const char* uidName, const char* uidValue);
 
@@ -420,6 +425,21 @@ public:
   /// Show items in selected view (used for drag&drop of subject hierarchy items into the viewer)
   void ShowItemsInView(vtkIdList* itemIDs, vtkMRMLAbstractViewNode* viewNode);
 
+  /// Start collecting item changes instead of invoking an event for each of them.
+  /// SubjectHierarchyItemModifiedEvent, SubjectHierarchyItemReparentedEvent,
+  /// SubjectHierarchyItemDisplayModifiedEvent and SubjectHierarchyItemTransformModifiedEvent
+  /// are not invoked until the matching EndItemBatchModify call, which invokes a single
+  /// SubjectHierarchyItemsBatchModifiedEvent with the list of affected items.
+  /// Item added and removed events are still invoked immediately.
+  /// Calls can be nested, the event is invoked when the outermost batch ends.
+  /// \return Number of batches in progress before this call
+  int StartItemBatchModify();
+  /// End collecting item changes started by StartItemBatchModify
+  /// \return Number of batches still in progress
+  int EndItemBatchModify();
+  /// Return true if item changes are being collected
+  bool IsItemBatchModifyInProgress();
+
 protected:
   /// Callback function for all events from the subject hierarchy items
   static void ItemEventCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
@@ -281,8 +281,86 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
     }
   }
 }
+
+//----------------------------------------------------------------------------
+void SetReaderFileNamesAndOptions(vtkMRMLVolumeArchetypeStorageNode* storageNode,
+                                  vtkITKArchetypeImageSeriesReader* reader,
+                                  const std::string& fullName)
+{
+  // Set the list of file names on the reader
+  reader->ResetFileNames();
+  reader->SetArchetype(fullName.c_str());
+
+  // Workaround
+  ApplyImageSeriesReaderWorkaround(storageNode, reader, fullName);
+
+  // Center image
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  if (storageNode->GetCenterImage())
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+}
 } // end of anonymous namespace
 
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::CanPreloadData()
+{
+  if (this->GetWriteState() == SkippedNoData || !this->GetScene())
+  {
+    return false;
+  }
+  // Vector and tensor volumes use different readers, they are not preloaded
+  std::vector<vtkMRMLNode*> referencingNodes;
+  this->GetScene()->GetReferencingNodes(this, referencingNodes);
+  for (vtkMRMLNode* referencingNode : referencingNodes)
+  {
+    if (referencingNode->IsA("vtkMRMLVectorVolumeNode") || referencingNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeArchetypeStorageNode::ClearPreloadedData()
+{
+  this->PreloadedReader = nullptr;
+  this->PreloadedFileName.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::PreloadDataInternal(const std::string& fullName)
+{
+  this->ClearPreloadedData();
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader = vtkSmartPointer<vtkITKArchetypeImageSeriesScalarReader>::New();
+  reader->SetSingleFile(this->GetSingleFile());
+  reader->SetUseOrientationFromFile(this->GetUseOrientationFromFile());
+  SetReaderFileNamesAndOptions(this, reader, fullName);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject&)
+  {
+    // ReadData() reads the file again and reports the error
+    return false;
+  }
+  if (reader->GetErrorCode() != vtkErrorCode::NoError)
+  {
+    return false;
+  }
+  this->PreloadedReader = reader;
+  this->PreloadedFileName = fullName;
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -328,8 +406,17 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   }
 
   vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  bool preloaded = false;
 
-  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
+  if (this->PreloadedReader && this->PreloadedFileName == fullName
+    && !refNode->IsA("vtkMRMLVectorVolumeNode") && !refNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+  {
+    // File was already read by PreloadData(), the pipeline is up-to-date
+    // therefore the reader does not read the file again.
+    reader = this->PreloadedReader;
+    preloaded = true;
+  }
+  else if (refNode->IsA("vtkMRMLVectorVolumeNode"))
   {
     reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
   }
@@ -345,6 +432,7 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     reader->SetSingleFile( this->GetSingleFile() );
     reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
   }
+  this->ClearPreloadedData();
 
   if (reader.GetPointer() == nullptr)
   {
@@ -360,23 +448,9 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     volNode->SetAndObserveImageData(nullptr);
   }
 
-  // Set the list of file names on the reader
-  reader->ResetFileNames();
-  reader->SetArchetype(fullName.c_str());
-
-  // Workaround
-  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
-
-  // Center image
-  reader->SetOutputScalarTypeToNative();
-  reader->SetDesiredCoordinateOrientationToNative();
-  if (this->CenterImage)
+  if (!preloaded)
   {
-    reader->SetUseNativeOriginOff();
-  }
-  else
-  {
-    reader->SetUseNativeOriginOn();
+    SetReaderFileNamesAndOptions(this, reader, fullName);
   }
 
   bool readingWorked = true;
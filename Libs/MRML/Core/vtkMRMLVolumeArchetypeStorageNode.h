@@ -17,6 +17,9 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
 class vtkMRMLVolumeNode;
@@ -85,6 +88,12 @@ public:
   /// instance to turn off compression.
   void ConfigureForDataExchange() override;
 
+  /// Scalar volumes can be preloaded (read into memory on a worker thread).
+  /// Vector and tensor volumes are read by ReadData().
+  /// \sa vtkMRMLStorageNode::PreloadData()
+  bool CanPreloadData() override;
+  void ClearPreloadedData() override;
+
   ///
   /// Provide a uniform way to populate the volume nodes's itk
   /// metadatadictionary from the reader.  Since itk::MetaDataDictionary
@@ -111,10 +120,17 @@ protected:
   /// Write data from a referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read the file using a scalar volume reader
+  bool PreloadDataInternal(const std::string& fullName) override;
+
   int CenterImage;
   int SingleFile;
   int UseOrientationFromFile;
 
+  /// Reader that has read the file in PreloadData(), used by the next ReadData() call
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> PreloadedReader;
+  std::string PreloadedFileName;
+
 };
 
 #endif
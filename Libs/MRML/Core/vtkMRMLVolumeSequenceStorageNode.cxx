@@ -8,6 +8,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 =========================================================================auto=*/
 
 #include <algorithm>
+#include <chrono>
 
 #include <vtkAddonMathUtilities.h>
 
@@ -28,9 +29,38 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #endif
 #include "vtkImageExtractComponents.h"
 #include "vtkNew.h"
+#include "vtkPointData.h"
 #include "vtkStringArray.h"
 #include "vtksys/SystemTools.hxx"
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string GetFrameIndexValue(const std::vector<std::string>& indexValues, int frameIndex)
+{
+  std::ostringstream indexStr;
+  if (static_cast<int>(indexValues.size()) > frameIndex)
+  {
+    indexStr << indexValues[frameIndex];
+  }
+  else
+  {
+    indexStr << frameIndex;
+  }
+  return indexStr.str();
+}
+
+//----------------------------------------------------------------------------
+std::string GetFrameName(vtkMRMLNode* sequenceNode, int frameIndex)
+{
+  std::ostringstream nameStr;
+  nameStr << sequenceNode->GetName() << "_" << std::setw(4) << std::setfill('0') << frameIndex;
+  return nameStr.str();
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLVolumeSequenceStorageNode);
 
@@ -38,7 +68,67 @@ vtkMRMLNodeNewMacro(vtkMRMLVolumeSequenceStorageNode);
 vtkMRMLVolumeSequenceStorageNode::vtkMRMLVolumeSequenceStorageNode() = default;
 
 //----------------------------------------------------------------------------
-vtkMRMLVolumeSequenceStorageNode::~vtkMRMLVolumeSequenceStorageNode() = default;
+vtkMRMLVolumeSequenceStorageNode::~vtkMRMLVolumeSequenceStorageNode()
+{
+  this->ClearOnDemandFrames();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(OnDemandFrameLoading);
+  vtkMRMLPrintIntMacro(MaximumFrameCacheMemorySize);
+  vtkMRMLPrintIntMacro(FrameCacheMemorySize);
+  vtkMRMLPrintEndMacro();
+  os << indent << "Number of frames loaded on demand: " << this->LoadedFrames.size()
+    << " of " << this->OnDemandFrames.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ReadXMLAttributes(const char** atts)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(onDemandFrameLoading, OnDemandFrameLoading);
+  vtkMRMLReadXMLIntMacro(maximumFrameCacheMemorySize, MaximumFrameCacheMemorySize);
+  vtkMRMLReadXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(onDemandFrameLoading, OnDemandFrameLoading);
+  vtkMRMLWriteXMLIntMacro(maximumFrameCacheMemorySize, MaximumFrameCacheMemorySize);
+  vtkMRMLWriteXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::Copy(vtkMRMLNode *anode)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::Copy(anode);
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyBooleanMacro(OnDemandFrameLoading);
+  vtkMRMLCopyIntMacro(MaximumFrameCacheMemorySize);
+  vtkMRMLCopyEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::SetMaximumFrameCacheMemorySize(unsigned long sizeInKiB)
+{
+  if (this->MaximumFrameCacheMemorySize == sizeInKiB)
+  {
+    return;
+  }
+  this->MaximumFrameCacheMemorySize = sizeInKiB;
+  this->TrimFrameCache();
+  this->Modified();
+}
 
 //----------------------------------------------------------------------------
 bool vtkMRMLVolumeSequenceStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
@@ -106,7 +196,7 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
   int frameAxis = 0;
   for ( KeyVector::iterator kit = keys.begin(); kit != keys.end(); ++kit)
   {
-#ifdef NRRD_CHUNK_IO_AVAILABLE
+    // Frames are stored along the first axis, or along the last axis if each frame is stored contiguously
     if (*kit == "axis 0 index type")
     {
       volSequenceNode->SetIndexTypeFromString(reader->GetHeaderValue(kit->c_str()));
@@ -118,20 +208,6 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
       frameAxis = 3;
     }
     else if (*kit == "axis 0 index values" || *kit == "axis 3 index values")
-      {
-      std::string indexValue;
-      for (std::istringstream indexValueList(reader->GetHeaderValue(kit->c_str()));
-        indexValueList >> indexValue;)
-      {
-        // Encode string to make sure there are no spaces in the serialized index value (space is used as separator)
-        indexValues.push_back(vtkMRMLNode::URLDecodeString(indexValue.c_str()));
-      }
-#else
-    if (*kit == "axis 0 index type")
-    {
-      volSequenceNode->SetIndexTypeFromString(reader->GetHeaderValue(kit->c_str()));
-    }
-    else if (*kit == "axis 0 index values")
     {
       std::string indexValue;
       for (std::istringstream indexValueList(reader->GetHeaderValue(kit->c_str()));
@@ -140,7 +216,6 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
         // Encode string to make sure there are no spaces in the serialized index value (space is used as separator)
         indexValues.push_back(vtkMRMLNode::URLDecodeString(indexValue.c_str()));
       }
-#endif
     }
     else
     {
@@ -153,6 +228,35 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
   const char* sequenceAxisUnit = reader->GetAxisUnit(frameAxis);
   volSequenceNode->SetIndexUnit(sequenceAxisUnit ? sequenceAxisUnit : "");
 
+  this->ClearOnDemandFrames();
+  volSequenceNode->SetOnDemandFrameLoader(nullptr);
+  if (this->OnDemandFrameLoading)
+  {
+    int numberOfFrames = reader->ReadFrameDirectory();
+    if (numberOfFrames > 0)
+    {
+      // Only create the frame volume nodes, image data is loaded in LoadFrame
+      vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: Starting reading sequence frame directory. ");
+      this->FrameReader = reader.GetPointer();
+      for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+      {
+        vtkNew<vtkMRMLScalarVolumeNode> frameVolume;
+        frameVolume->SetRASToIJKMatrix(reader->GetRasToIjkMatrix());
+        frameVolume->SetName(GetFrameName(refNode, frameIndex).c_str());
+        vtkMRMLNode* frameNode = volSequenceNode->SetDataNodeAtValue(frameVolume, GetFrameIndexValue(indexValues, frameIndex));
+        OnDemandFrameType& frame = this->OnDemandFrames[frameNode];
+        frame.FrameIndex = frameIndex;
+        frame.Node = vtkMRMLVolumeNode::SafeDownCast(frameNode);
+        frame.LoadedFramesIt = this->LoadedFrames.end();
+      }
+      volSequenceNode->SetOnDemandFrameLoader(this);
+      return 1;
+    }
+    vtkWarningMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: frames of " << fullName << " cannot be loaded on demand,"
+      << " the entire sequence is loaded into memory. Frames must be stored contiguously in an uncompressed"
+      << " or parallel-compressed .nrrd file.");
+  }
+
   // Read and copy the data to sequence of volume nodes
 #ifdef NRRD_CHUNK_IO_AVAILABLE
   int numberOfFrames = reader->GetNumberOfImages();
@@ -221,21 +325,8 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     frameVolume->SetAndObserveImageData(frameVoxels.GetPointer());
 #endif
     frameVolume->SetRASToIJKMatrix(reader->GetRasToIjkMatrix());
-
-    std::ostringstream indexStr;
-    if (static_cast<int>(indexValues.size()) > frameIndex)
-    {
-      indexStr << indexValues[frameIndex] << std::ends;
-    }
-    else
-    {
-      indexStr << frameIndex << std::ends;
-    }
-
-    std::ostringstream nameStr;
-    nameStr << refNode->GetName() << "_" << std::setw(4) << std::setfill('0') << frameIndex << std::ends;
-    frameVolume->SetName( nameStr.str().c_str() );
-    volSequenceNode->SetDataNodeAtValue(frameVolume.GetPointer(), indexStr.str().c_str() );
+    frameVolume->SetName(GetFrameName(refNode, frameIndex).c_str());
+    volSequenceNode->SetDataNodeAtValue(frameVolume.GetPointer(), GetFrameIndexValue(indexValues, frameIndex));
   }
 
   vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: sequence successfully read. ");
@@ -253,7 +344,30 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
     this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Data node must be a sequence node."));
     return false;
   }
-  vtkMRMLVolumeNode* firstFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(0));
+  // Frames that are loaded on demand are checked using the frame directory of the file that they are loaded from,
+  // without loading them.
+  vtkMRMLVolumeSequenceStorageNode* frameLoader = dynamic_cast<vtkMRMLVolumeSequenceStorageNode*>(
+    volSequenceNode->GetOnDemandFrameLoader());
+  auto getFrameImageInformation = [frameLoader](vtkMRMLVolumeNode* frameVolume,
+    int extent[6], int& scalarType, int& numberOfComponents)
+  {
+    vtkImageData* imageData = frameVolume->GetImageData();
+    if (imageData)
+    {
+      imageData->GetExtent(extent);
+      scalarType = imageData->GetScalarType();
+      numberOfComponents = imageData->GetNumberOfScalarComponents();
+      return true;
+    }
+    if (frameLoader && frameLoader->GetOnDemandFrameImageInformation(frameVolume, extent, scalarType))
+    {
+      numberOfComponents = 1;
+      return true;
+    }
+    return false;
+  };
+
+  vtkMRMLVolumeNode* firstFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(0, false));
   if (firstFrameVolume == nullptr)
   {
     this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Only volume nodes can be written."));
@@ -263,17 +377,12 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
   int firstFrameVolumeExtent[6] = { 0, -1, 0, -1, 0, -1 };
   int firstFrameVolumeScalarType = VTK_VOID;
   int firstFrameVolumeNumberOfComponents = 0;
-  if (firstFrameVolume->GetImageData())
+  // VTK NRRD writer only supports 4D volumes (writing a 3D color volume sequence would require 5D)
+  if (getFrameImageInformation(firstFrameVolume, firstFrameVolumeExtent, firstFrameVolumeScalarType, firstFrameVolumeNumberOfComponents)
+    && firstFrameVolumeNumberOfComponents != 1)
   {
-    firstFrameVolume->GetImageData()->GetExtent(firstFrameVolumeExtent);
-    firstFrameVolumeScalarType = firstFrameVolume->GetImageData()->GetScalarType();
-    firstFrameVolumeNumberOfComponents = firstFrameVolume->GetImageData()->GetNumberOfScalarComponents();
-    // VTK NRRD writer only supports 4D volumes (writing a 3D color volume sequence would require 5D)
-    if (firstFrameVolumeNumberOfComponents != 1)
-    {
-      this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Only single scalar component volumes can be written in this format."));
-      return false;
-    }
+    this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Only single scalar component volumes can be written in this format."));
+    return false;
   }
   vtkNew<vtkMatrix4x4> firstVolumeIjkToRas;
   firstFrameVolume->GetIJKToRASMatrix(firstVolumeIjkToRas.GetPointer());
@@ -281,7 +390,7 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
   int numberOfFrameVolumes = volSequenceNode->GetNumberOfDataNodes();
   for (int frameIndex = 1; frameIndex<numberOfFrameVolumes; frameIndex++)
   {
-    vtkMRMLVolumeNode* currentFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(frameIndex));
+    vtkMRMLVolumeNode* currentFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(frameIndex, false));
     if (currentFrameVolume == nullptr)
     {
       vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: only volume nodes can be written (frame "<<frameIndex<<")");
@@ -301,12 +410,7 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
     int currentFrameVolumeExtent[6] = { 0, -1, 0, -1, 0, -1 };
     int currentFrameVolumeScalarType = VTK_VOID;
     int currentFrameVolumeNumberOfComponents = 0;
-    if (currentFrameVolume->GetImageData())
-    {
-      currentFrameVolume->GetImageData()->GetExtent(currentFrameVolumeExtent);
-      currentFrameVolumeScalarType = currentFrameVolume->GetImageData()->GetScalarType();
-      currentFrameVolumeNumberOfComponents = currentFrameVolume->GetImageData()->GetNumberOfScalarComponents();
-    }
+    getFrameImageInformation(currentFrameVolume, currentFrameVolumeExtent, currentFrameVolumeScalarType, currentFrameVolumeNumberOfComponents);
     for (int i = 0; i < 6; i++)
     {
       if (firstFrameVolumeExtent[i] != currentFrameVolumeExtent[i])
@@ -344,6 +448,28 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName == std::string(""))
+  {
+    this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("File name not specified."));
+    return 0;
+  }
+
+  // Frames that are not loaded yet would be read from the file while it is being overwritten,
+  // therefore all frames are loaded before writing the file that frames are loaded from.
+  bool overwriteOnDemandFramesFile = (volSequenceNode->GetOnDemandFrameLoader() == this
+    && this->FrameReader && this->FrameReader->GetFileName()
+    && vtksys::SystemTools::SameFile(this->FrameReader->GetFileName(), fullName));
+  if (overwriteOnDemandFramesFile)
+  {
+    volSequenceNode->SetOnDemandFrameLoader(nullptr);
+    if (!this->LoadAllOnDemandFrames())
+    {
+      this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Failed to load all frames of the sequence."));
+      return 0;
+    }
+  }
+
   vtkNew<vtkMatrix4x4> firstVolumeIjkToRas;
   int frameVolumeDimensions[3] = {0};
   int frameVolumeScalarType = VTK_VOID;
@@ -416,12 +542,6 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   }
 #endif
 
-  std::string fullName = this->GetFullNameFromFileName();
-  if (fullName == std::string(""))
-  {
-    this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("File name not specified."));
-    return 0;
-  }
   // Use here the NRRD Writer
   vtkNew<vtkTeemNRRDWriter> writer;
   // ForceRangeAxis needs to be enabled for the writer to correctly write image sequences that contain only a single frame.
@@ -434,9 +554,14 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 #ifdef NRRD_CHUNK_IO_AVAILABLE
   // Set Write Multiple Images on
   writer->WriteMultipleImagesAsImageListsOn();
+#else
+  // Store each frame contiguously so that frames can be loaded on demand
+  writer->SetRangeAxisLast(this->OnDemandFrameLoading);
 #endif
 
   writer->SetUseCompression(this->GetUseCompression());
+  writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
+  writer->SetParallelCompression(this->IsParallelCompressionParameter(this->CompressionParameter));
 
   // Set volume attributes
   writer->SetIJKToRASMatrix(firstVolumeIjkToRas.GetPointer());
@@ -450,9 +575,10 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   axisType = "axis 3 index type";
   axisValues = "axis 3 index values";
 #else
+  // Axis information is set before the range axis is moved to the last position
   axisIndex = 0;
-  axisType = "axis 0 index type";
-  axisValues = "axis 0 index values";
+  axisType = (this->OnDemandFrameLoading ? "axis 3 index type" : "axis 0 index type");
+  axisValues = (this->OnDemandFrameLoading ? "axis 3 index values" : "axis 0 index values");
 #endif
 
   if (!volSequenceNode->GetIndexName().empty())
@@ -581,10 +707,301 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   this->StageWriteData(refNode);
 #endif
 
+  if (overwriteOnDemandFramesFile && writeFlag && this->OnDemandFrameLoading)
+  {
+    // Frame locations have changed, unload frames and load them from the new file on demand
+    this->ReadOnDemandFrameDirectory(volSequenceNode, fullName);
+  }
+
   vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::WriteDataInternal: sequence successfully written. ");
   return writeFlag;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::LoadFrame(vtkMRMLNode* frameNode)
+{
+  std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.find(frameNode);
+  if (frameIt == this->OnDemandFrames.end())
+  {
+    return false;
+  }
+  OnDemandFrameType& frame = frameIt->second;
+  if (frame.Node.GetPointer() != frameNode)
+  {
+    // The frame node has been deleted and this is a different node at the same address
+    this->RemoveLoadedFrame(frame, false);
+    this->OnDemandFrames.erase(frameIt);
+    return false;
+  }
+
+  if (frame.LoadedFramesIt != this->LoadedFrames.end())
+  {
+    vtkImageData* imageData = frame.Node->GetImageData();
+    if (imageData != frame.LoadedImageData.GetPointer()
+      || !imageData->GetPointData()->GetScalars()
+      || imageData->GetPointData()->GetScalars()->GetMTime() != frame.LoadedScalarsMTime)
+    {
+      // The frame has been modified, it must not be unloaded anymore
+      this->RemoveLoadedFrame(frame, false);
+      this->OnDemandFrames.erase(frameIt);
+      return true;
+    }
+    // Mark as most recently used
+    this->LoadedFrames.splice(this->LoadedFrames.begin(), this->LoadedFrames, frame.LoadedFramesIt);
+    return true;
+  }
+
+  vtkSmartPointer<vtkImageData> imageData;
+  if (frame.PrefetchResult.valid())
+  {
+    // Frame has been prefetched, wait for the background read to complete
+    if (frame.PrefetchResult.get())
+    {
+      imageData = frame.PrefetchedImageData;
+    }
+    frame.PrefetchedImageData = nullptr;
+  }
+  if (!imageData)
+  {
+    imageData = vtkSmartPointer<vtkImageData>::New();
+    if (!this->FrameReader || !this->FrameReader->ReadFrame(frame.FrameIndex, imageData))
+    {
+      vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::LoadFrame failed to load frame " << frame.FrameIndex);
+      return false;
+    }
+  }
+  frame.Node->SetAndObserveImageData(imageData);
+  frame.LoadedImageData = imageData;
+  frame.LoadedScalarsMTime = imageData->GetPointData()->GetScalars()->GetMTime();
+  frame.LoadedMemorySize = imageData->GetActualMemorySize();
+  this->LoadedFrames.push_front(frameNode);
+  frame.LoadedFramesIt = this->LoadedFrames.begin();
+  this->FrameCacheMemorySize += frame.LoadedMemorySize;
+
+  this->TrimFrameCache();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::PrefetchFrames(const std::vector<vtkMRMLNode*>& frameNodes)
+{
+  if (!this->FrameReader)
+  {
+    return;
+  }
+  // Discard completed prefetches that are not needed anymore.
+  // Pending reads are left to complete, they are discarded in a later call if they are still not needed.
+  for (std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.begin();
+    frameIt != this->OnDemandFrames.end(); ++frameIt)
+  {
+    OnDemandFrameType& frame = frameIt->second;
+    if (frame.PrefetchResult.valid()
+      && std::find(frameNodes.begin(), frameNodes.end(), frameIt->first) == frameNodes.end()
+      && frame.PrefetchResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      frame.PrefetchResult = std::future<bool>();
+      frame.PrefetchedImageData = nullptr;
+    }
+  }
+
+  vtkTeemNRRDReader* reader = this->FrameReader;
+  for (vtkMRMLNode* frameNode : frameNodes)
+  {
+    std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.find(frameNode);
+    if (frameIt == this->OnDemandFrames.end())
+    {
+      continue;
+    }
+    OnDemandFrameType& frame = frameIt->second;
+    if (frame.LoadedFramesIt != this->LoadedFrames.end() || frame.PrefetchResult.valid()
+      || frame.Node.GetPointer() != frameNode)
+    {
+      // already loaded or being loaded
+      continue;
+    }
+    // The image data object is only accessed by the background thread until LoadFrame retrieves the result.
+    // Scalar range is computed in advance, as it is needed for displaying the volume.
+    vtkImageData* imageData = vtkImageData::New();
+    frame.PrefetchedImageData = vtkSmartPointer<vtkImageData>::Take(imageData);
+    int frameIndex = frame.FrameIndex;
+    frame.PrefetchResult = std::async(std::launch::async, [reader, frameIndex, imageData]()
+      {
+        if (!reader->ReadFrame(frameIndex, imageData))
+        {
+          return false;
+        }
+        imageData->GetScalarRange();
+        return true;
+      });
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::RemoveLoadedFrame(OnDemandFrameType& frame, bool unload)
+{
+  if (frame.LoadedFramesIt == this->LoadedFrames.end())
+  {
+    // not loaded
+    return false;
+  }
+  bool unloaded = false;
+  vtkImageData* imageData = (frame.Node ? frame.Node->GetImageData() : nullptr);
+  if (unload && imageData && imageData == frame.LoadedImageData.GetPointer()
+    && imageData->GetPointData()->GetScalars()
+    && imageData->GetPointData()->GetScalars()->GetMTime() == frame.LoadedScalarsMTime)
+  {
+    frame.Node->SetAndObserveImageData(nullptr);
+    unloaded = true;
+  }
+  this->LoadedFrames.erase(frame.LoadedFramesIt);
+  frame.LoadedFramesIt = this->LoadedFrames.end();
+  frame.LoadedImageData = nullptr;
+  this->FrameCacheMemorySize -= std::min(this->FrameCacheMemorySize, frame.LoadedMemorySize);
+  frame.LoadedMemorySize = 0;
+  return unloaded;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::GetOnDemandFrameImageInformation(vtkMRMLNode* frameNode, int extent[6], int& scalarType)
+{
+  std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.find(frameNode);
+  if (frameIt == this->OnDemandFrames.end() || frameIt->second.Node.GetPointer() != frameNode || !this->FrameReader)
+  {
+    return false;
+  }
+  // Frames are read with zero origin, see vtkTeemNRRDReader::ReadFrame
+  int* dimensions = this->FrameReader->GetFrameDimensions();
+  for (int i = 0; i < 3; i++)
+  {
+    extent[2 * i] = 0;
+    extent[2 * i + 1] = dimensions[i] - 1;
+  }
+  scalarType = this->FrameReader->GetFrameDataType();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::TrimFrameCache()
+{
+  if (this->MaximumFrameCacheMemorySize == 0)
+  {
+    // no limit
+    return;
+  }
+  while (this->FrameCacheMemorySize > this->MaximumFrameCacheMemorySize && this->LoadedFrames.size() > 1)
+  {
+    std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.find(this->LoadedFrames.back());
+    if (frameIt == this->OnDemandFrames.end())
+    {
+      // should not happen, but make sure the loop terminates
+      this->LoadedFrames.pop_back();
+      continue;
+    }
+    if (!this->RemoveLoadedFrame(frameIt->second, true))
+    {
+      // The frame has been modified, it must not be reloaded from file anymore
+      this->OnDemandFrames.erase(frameIt);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ClearOnDemandFrames()
+{
+  // Loaded frames are kept loaded, as the sequence node may still use them.
+  // Pending prefetches are waited for before the frame reader is released.
+  this->OnDemandFrames.clear();
+  this->LoadedFrames.clear();
+  this->FrameCacheMemorySize = 0;
+  this->FrameReader = nullptr;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::LoadAllOnDemandFrames()
+{
+  for (std::map<vtkMRMLNode*, OnDemandFrameType>::iterator frameIt = this->OnDemandFrames.begin();
+    frameIt != this->OnDemandFrames.end(); ++frameIt)
+  {
+    OnDemandFrameType& frame = frameIt->second;
+    if (frame.Node.GetPointer() != frameIt->first || frame.LoadedFramesIt != this->LoadedFrames.end())
+    {
+      // deleted or already loaded
+      continue;
+    }
+    // Frames are not added to the frame cache, as they must not be unloaded anymore
+    vtkSmartPointer<vtkImageData> imageData;
+    if (frame.PrefetchResult.valid())
+    {
+      if (frame.PrefetchResult.get())
+      {
+        imageData = frame.PrefetchedImageData;
+      }
+      frame.PrefetchedImageData = nullptr;
+    }
+    if (!imageData)
+    {
+      imageData = vtkSmartPointer<vtkImageData>::New();
+      if (!this->FrameReader || !this->FrameReader->ReadFrame(frame.FrameIndex, imageData))
+      {
+        vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::LoadAllOnDemandFrames failed to load frame " << frame.FrameIndex);
+        return false;
+      }
+    }
+    frame.Node->SetAndObserveImageData(imageData);
+  }
+  this->ClearOnDemandFrames();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ReadOnDemandFrameDirectory(vtkMRMLSequenceNode* sequenceNode, const std::string& fileName)
+{
+  this->ClearOnDemandFrames();
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  if (this->CenterImage)
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+  reader->UpdateInformation();
+  int numberOfFrames = sequenceNode->GetNumberOfDataNodes();
+  if (numberOfFrames == 0 || reader->ReadFrameDirectory() != numberOfFrames)
+  {
+    // frames remain in memory
+    return;
+  }
+  this->FrameReader = reader.GetPointer();
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    vtkMRMLVolumeNode* frameVolume = vtkMRMLVolumeNode::SafeDownCast(sequenceNode->GetNthDataNode(frameIndex));
+    if (!frameVolume || this->OnDemandFrames.find(frameVolume) != this->OnDemandFrames.end())
+    {
+      // not a volume or the frame node is shared with a previous item
+      continue;
+    }
+    OnDemandFrameType& frame = this->OnDemandFrames[frameVolume];
+    frame.FrameIndex = frameIndex;
+    frame.Node = frameVolume;
+    frame.LoadedFramesIt = this->LoadedFrames.end();
+    vtkImageData* imageData = frameVolume->GetImageData();
+    if (imageData && imageData->GetPointData()->GetScalars())
+    {
+      // Voxels are stored in the file now, so they can be unloaded
+      frame.LoadedImageData = imageData;
+      frame.LoadedScalarsMTime = imageData->GetPointData()->GetScalars()->GetMTime();
+      frame.LoadedMemorySize = imageData->GetActualMemorySize();
+      frame.LoadedFramesIt = this->LoadedFrames.insert(this->LoadedFrames.end(), frameVolume);
+      this->FrameCacheMemorySize += frame.LoadedMemorySize;
+    }
+  }
+  sequenceNode->SetOnDemandFrameLoader(this);
+  this->TrimFrameCache();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeSequenceStorageNode::InitializeSupportedReadFileTypes()
 {
@@ -16,9 +16,25 @@
 #include "vtkMRML.h"
 
 #include "vtkMRMLNRRDStorageNode.h"
+#include "vtkMRMLSequenceFrameLoader.h"
+
+// VTK includes
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <future>
+#include <list>
+#include <map>
 #include <string>
+#include <vector>
+
+class vtkImageData;
+class vtkMRMLSequenceNode;
+class vtkMRMLVolumeNode;
+class vtkTeemNRRDReader;
 
-class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStorageNode
+class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStorageNode,
+  public vtkMRMLSequenceFrameLoader
 {
   public:
 
@@ -27,6 +43,17 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
 
   vtkMRMLNode* CreateNodeInstance() override;
 
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Read node attributes from XML file
+  void ReadXMLAttributes( const char** atts) override;
+
+  /// Write this node's information to a MRML file in XML format.
+  void WriteXML(ostream& of, int indent) override;
+
+  /// Copy the node's attributes to this object
+  void Copy(vtkMRMLNode *node) override;
+
   ///
   /// Get node XML tag name (like Storage, Model)
   const char* GetNodeTagName() override {return "VolumeSequenceStorage";};
@@ -34,10 +61,16 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
   /// Return true if the node can be read in.
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Sequences are read by a custom reader, preloading is not supported
+  bool CanPreloadData() override { return false; };
+
   /// Return true if the node can be written by using the writer.
   bool CanWriteFromReferenceNode(vtkMRMLNode* refNode) override;
 
   /// Write the data. Returns 1 on success, 0 otherwise.
+  /// If frames of the sequence are loaded on demand from the file that is written,
+  /// then all frames are loaded before the file is overwritten, and frames are
+  /// loaded on demand from the new file after it is written.
   ///
 #ifdef NRRD_CHUNK_IO_AVAILABLE
   /// The nrrd file will be formatted such as:
@@ -54,6 +87,42 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
   /// Return a default file extension for writing
   const char* GetDefaultWriteFileExtension() override;
 
+  /// Load image data of frames only when they are accessed, instead of reading
+  /// the entire volume sequence into memory.
+  /// When the sequence is read, only the location of each frame in the file is read,
+  /// and the image data of a frame is loaded when it is accessed by
+  /// vtkMRMLSequenceNode::GetNthDataNode or GetDataNodeAtValue.
+  /// Least recently used frames are unloaded when MaximumFrameCacheMemorySize is exceeded.
+  /// This requires each frame to be stored contiguously in an uncompressed or parallel-compressed
+  /// .nrrd file. Sequences are written this way when this option is enabled. Other files
+  /// are read entirely into memory.
+  /// Disabled by default.
+  vtkSetMacro(OnDemandFrameLoading, bool);
+  vtkGetMacro(OnDemandFrameLoading, bool);
+  vtkBooleanMacro(OnDemandFrameLoading, bool);
+
+  /// Maximum memory size of frames loaded on demand, in KiB.
+  /// The most recently accessed frame is always kept, even if it is larger than this limit.
+  /// 0 means there is no limit. Default is 2 GiB.
+  void SetMaximumFrameCacheMemorySize(unsigned long sizeInKiB);
+  vtkGetMacro(MaximumFrameCacheMemorySize, unsigned long);
+
+  /// Get memory size of frames that are currently loaded on demand, in KiB.
+  vtkGetMacro(FrameCacheMemorySize, unsigned long);
+
+  /// Load image data of a frame that was read in on-demand frame loading mode.
+  /// Called by vtkMRMLSequenceNode when the frame is accessed.
+  /// Frames that have been modified since they were loaded are not managed
+  /// by the cache anymore (they are never unloaded).
+  /// Returns true if image data of the frame is loaded.
+  bool LoadFrame(vtkMRMLNode* frameNode) override;
+
+  /// Start loading image data of frames in background threads, so that a subsequent
+  /// LoadFrame call does not have to wait for reading and decompressing the frame.
+  /// Prefetched frames that are not listed in frameNodes and have not been loaded yet are discarded.
+  /// Prefetched frames are not counted in FrameCacheMemorySize until they are loaded.
+  void PrefetchFrames(const std::vector<vtkMRMLNode*>& frameNodes) override;
+
 protected:
   vtkMRMLVolumeSequenceStorageNode();
   ~vtkMRMLVolumeSequenceStorageNode() override;
@@ -79,6 +148,57 @@ protected:
 
   /// Initialize all the supported write file types
   void InitializeSupportedWriteFileTypes() override;
+
+  /// Forget all frames that were read in on-demand frame loading mode
+  void ClearOnDemandFrames();
+
+  /// Load image data of all frames that are not loaded yet and stop loading frames on demand.
+  /// Returns false if image data of a frame could not be loaded.
+  bool LoadAllOnDemandFrames();
+
+  /// Read the frame directory of the specified file and load frames of the sequence
+  /// on demand from this file. All frames of the sequence must be stored in the file.
+  /// Frames remain in memory if frames cannot be read individually from the file.
+  void ReadOnDemandFrameDirectory(vtkMRMLSequenceNode* sequenceNode, const std::string& fileName);
+
+  /// Get extent and scalar type of a frame that is loaded on demand, without loading it.
+  /// Returns false if the frame is not loaded on demand by this storage node.
+  bool GetOnDemandFrameImageInformation(vtkMRMLNode* frameNode, int extent[6], int& scalarType);
+
+  /// Unload least recently used frames until memory usage is below the limit
+  void TrimFrameCache();
+
+  struct OnDemandFrameType
+  {
+    int FrameIndex{-1};
+    vtkWeakPointer<vtkMRMLVolumeNode> Node;
+    /// Image data that was loaded into the node, nullptr if the frame is not loaded
+    vtkWeakPointer<vtkImageData> LoadedImageData;
+    /// Modified time of the loaded voxels, used for detecting changes
+    vtkMTimeType LoadedScalarsMTime{0};
+    /// Memory size of loaded image data in KiB
+    unsigned long LoadedMemorySize{0};
+    /// Position in LoadedFrames
+    std::list<vtkMRMLNode*>::iterator LoadedFramesIt;
+    /// Image data that is read in a background thread, valid until LoadFrame is called
+    vtkSmartPointer<vtkImageData> PrefetchedImageData;
+    std::future<bool> PrefetchResult;
+  };
+
+  /// Remove a frame from the loaded frames list. Image data is unloaded if unload is true and the frame is not modified.
+  /// Returns true if the image data was unloaded.
+  bool RemoveLoadedFrame(OnDemandFrameType& frame, bool unload);
+
+  bool OnDemandFrameLoading{false};
+  unsigned long MaximumFrameCacheMemorySize{2 * 1024 * 1024};
+  unsigned long FrameCacheMemorySize{0};
+
+  /// Reader that has the frame directory of the file
+  vtkSmartPointer<vtkTeemNRRDReader> FrameReader;
+  /// Frames that can be loaded on demand
+  std::map<vtkMRMLNode*, OnDemandFrameType> OnDemandFrames;
+  /// Currently loaded frames, most recently used first
+  std::list<vtkMRMLNode*> LoadedFrames;
 };
 
 #endif
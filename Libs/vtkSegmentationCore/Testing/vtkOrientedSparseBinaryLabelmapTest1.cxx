@@ -0,0 +1,303 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// Get CHECK_INT from vtkAddonTestingMacros.h to avoid dependency on vtkAddon
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool CheckInt(int line, const std::string& description, vtkIdType current, vtkIdType expected)
+{
+  if (current == expected)
+  {
+    return EXIT_SUCCESS;
+  }
+  std::cerr << "\nLine " << line << " - " << description.c_str() << " : test failed"
+    << "\n\tcurrent :" << current
+    << "\n\texpected:" << expected
+    << std::endl;
+  return EXIT_FAILURE;
+}
+
+// Use a macro to be able to print the evaluated expression and the line number
+#define CHECK_INT(actual, expected) \
+{ \
+  if (CheckInt(__LINE__,#actual " != " #expected, (actual), (expected)) != EXIT_SUCCESS) \
+  { \
+    return EXIT_FAILURE; \
+  } \
+}
+
+}
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverterFactory.h"
+#include "vtkSegmentationModifier.h"
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkSparseBinaryLabelmapToClosedSurfaceConversionRule.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Create an image that contains a sphere with the specified label value and
+/// a slab with a different label value
+void CreateSphereLabelmap(vtkOrientedImageData* image, int size, int labelValue)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, size - 1);
+  image->SetSpacing(0.5, 0.5, 1.5);
+  image->SetOrigin(10.0, -20.0, 5.0);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* voxelPtr = static_cast<unsigned char*>(image->GetScalarPointer());
+  double center = (size - 1) * 0.45;
+  double radius2 = (size * 0.35) * (size * 0.35);
+  for (int k = 0; k < size; ++k)
+  {
+    for (int j = 0; j < size; ++j)
+    {
+      for (int i = 0; i < size; ++i, ++voxelPtr)
+      {
+        double distance2 = (i - center) * (i - center) + (j - center) * (j - center) + (k - center) * (k - center);
+        if (distance2 < radius2)
+        {
+          *voxelPtr = static_cast<unsigned char>(labelValue);
+        }
+        else
+        {
+          *voxelPtr = (k == size - 1 ? labelValue + 1 : 0);
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetNumberOfVoxels(vtkImageData* image, int labelValue)
+{
+  vtkIdType numberOfVoxels = 0;
+  unsigned char* voxelPtr = static_cast<unsigned char*>(image->GetScalarPointer());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    if (voxelPtr[i] == labelValue)
+    {
+      ++numberOfVoxels;
+    }
+  }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+/// Compare each voxel of the labelmap to the image in the image extent
+int CheckVoxels(vtkOrientedSparseBinaryLabelmap* labelmap, vtkOrientedImageData* image, int labelValue)
+{
+  int* extent = image->GetExtent();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+  {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+    {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+      {
+        bool inside = (*static_cast<unsigned char*>(image->GetScalarPointer(i, j, k)) == labelValue);
+        if (labelmap->GetVoxel(i, j, k) != inside)
+        {
+          std::cerr << "Voxel mismatch at (" << i << ", " << j << ", " << k << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void CreateModifier(vtkOrientedImageData* modifier, vtkOrientedImageData* geometryImage, const int extent[6], unsigned char value)
+{
+  modifier->CopyDirections(geometryImage);
+  modifier->SetOrigin(geometryImage->GetOrigin());
+  modifier->SetSpacing(geometryImage->GetSpacing());
+  modifier->SetExtent(const_cast<int*>(extent));
+  modifier->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  modifier->GetPointData()->GetScalars()->Fill(value);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkOrientedSparseBinaryLabelmapTest1(int argc, char* argv[])
+{
+  int size = 120;
+  if (argc > 1)
+  {
+    size = atoi(argv[1]);
+  }
+  const int labelValue = 3;
+
+  vtkNew<vtkOrientedImageData> image;
+  CreateSphereLabelmap(image, size, labelValue);
+  vtkIdType numberOfVoxelsInSphere = GetNumberOfVoxels(image, labelValue);
+
+  // Conversion from dense image
+  vtkNew<vtkTimerLog> timer;
+  vtkNew<vtkOrientedSparseBinaryLabelmap> labelmap;
+  timer->StartTimer();
+  labelmap->SetFromImage(image, labelValue);
+  timer->StopTimer();
+  std::cout << "Sparse labelmap created in " << timer->GetElapsedTime() * 1000.0 << "ms: "
+    << labelmap->GetNumberOfTiles(vtkOrientedSparseBinaryLabelmap::TileFull) << " full tiles, "
+    << labelmap->GetNumberOfTiles(vtkOrientedSparseBinaryLabelmap::TileMixed) << " mixed tiles, "
+    << labelmap->GetActualMemorySize() << "kB (dense image: " << image->GetActualMemorySize() << "kB)" << std::endl;
+  CHECK_INT(labelmap->IsGeometryMatching(image), true);
+  CHECK_INT(labelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere);
+  CHECK_INT(labelmap->GetNumberOfTiles(vtkOrientedSparseBinaryLabelmap::TileFull) > 0, true);
+  CHECK_INT(labelmap->GetActualMemorySize() < image->GetActualMemorySize(), true);
+  CHECK_INT(CheckVoxels(labelmap, image, labelValue), EXIT_SUCCESS);
+
+  // Conversion to dense image
+  int expectedEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  vtkNew<vtkOrientedImageData> sphereImage;
+  labelmap->GetImage(sphereImage, labelValue, image->GetExtent());
+  CHECK_INT(vtkOrientedImageDataResample::DoGeometriesMatch(sphereImage, image), true);
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(sphereImage, expectedEffectiveExtent);
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  CHECK_INT(labelmap->GetEffectiveExtent(effectiveExtent), true);
+  for (int i = 0; i < 6; ++i)
+  {
+    CHECK_INT(effectiveExtent[i], expectedEffectiveExtent[i]);
+  }
+  vtkNew<vtkOrientedImageData> denseImage;
+  labelmap->GetImage(denseImage, labelValue);
+  CHECK_INT(GetNumberOfVoxels(denseImage, labelValue), numberOfVoxelsInSphere);
+  CHECK_INT(denseImage->GetExtent()[0], expectedEffectiveExtent[0]);
+  CHECK_INT(denseImage->GetExtent()[5], expectedEffectiveExtent[5]);
+  CHECK_INT(CheckVoxels(labelmap, denseImage, labelValue), EXIT_SUCCESS);
+
+  // Adding voxels outside the original extent (negative indices)
+  int addedExtent[6] = { -20, -5, -3, 2, 0, 17 };
+  vtkNew<vtkOrientedImageData> modifier;
+  CreateModifier(modifier, image, addedExtent, 1);
+  bool modified = false;
+  CHECK_INT(labelmap->ModifyImage(modifier, vtkOrientedImageDataResample::OPERATION_MAXIMUM, nullptr, 0.0, 1.0, &modified), true);
+  CHECK_INT(modified, true);
+  vtkIdType numberOfAddedVoxels = 16 * 6 * 18;
+  CHECK_INT(labelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere + numberOfAddedVoxels);
+  CHECK_INT(labelmap->GetVoxel(-20, -3, 0), true);
+  CHECK_INT(labelmap->GetVoxel(-21, -3, 0), false);
+  labelmap->GetEffectiveExtent(effectiveExtent);
+  CHECK_INT(effectiveExtent[0], -20);
+  CHECK_INT(effectiveExtent[2], -3);
+
+  // Adding the same voxels again does not change the labelmap
+  CHECK_INT(vtkOrientedImageDataResample::ModifyImage(labelmap, modifier, vtkOrientedImageDataResample::OPERATION_MAXIMUM), true);
+  labelmap->ModifyImage(modifier, vtkOrientedImageDataResample::OPERATION_MAXIMUM, nullptr, 0.0, 1.0, &modified);
+  CHECK_INT(modified, false);
+
+  // Removing voxels by masking, restricted to an extent
+  int maskedExtent[6] = { -20, -5, -3, 2, 0, 8 };
+  CHECK_INT(labelmap->ModifyImage(modifier, vtkOrientedImageDataResample::OPERATION_MASKING, maskedExtent, 0.0, 0.0), true);
+  CHECK_INT(labelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere + 16 * 6 * 9);
+
+  // Minimum operation removes voxels where the modifier is empty
+  int clearedExtent[6] = { -30, 0, -10, 10, 0, 20 };
+  vtkNew<vtkOrientedImageData> emptyModifier;
+  CreateModifier(emptyModifier, image, clearedExtent, 0);
+  vtkNew<vtkOrientedSparseBinaryLabelmap> mergedLabelmap;
+  CHECK_INT(vtkOrientedImageDataResample::MergeImage(labelmap, emptyModifier, mergedLabelmap,
+    vtkOrientedImageDataResample::OPERATION_MINIMUM, nullptr, 0, 1, &modified), true);
+  CHECK_INT(modified, true);
+  CHECK_INT(mergedLabelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere);
+  CHECK_INT(CheckVoxels(mergedLabelmap, image, labelValue), EXIT_SUCCESS);
+  // Input of merge is not changed
+  CHECK_INT(labelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere + 16 * 6 * 9);
+
+  // Filling and clearing extents
+  int fillExtent[6] = { -100, -69, -100, -85, -100, -98 };
+  mergedLabelmap->FillExtent(fillExtent, true);
+  CHECK_INT(mergedLabelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere + 32 * 16 * 3);
+  mergedLabelmap->SetVoxel(-90, -90, -99, false);
+  CHECK_INT(mergedLabelmap->GetVoxel(-90, -90, -99), false);
+  CHECK_INT(mergedLabelmap->GetVoxel(-89, -90, -99), true);
+  mergedLabelmap->FillExtent(fillExtent, false);
+  CHECK_INT(mergedLabelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere);
+  mergedLabelmap->Initialize();
+  CHECK_INT(mergedLabelmap->IsEmpty(), true);
+  CHECK_INT(mergedLabelmap->GetEffectiveExtent(effectiveExtent), false);
+
+  // Segmentation with sparse binary labelmap source representation
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule>::New());
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule>::New());
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseBinaryLabelmapToClosedSurfaceConversionRule>::New());
+
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+  std::string segmentID = segmentation->AddEmptySegment("sphere");
+  vtkSegment* segment = segmentation->GetSegment(segmentID);
+  vtkOrientedSparseBinaryLabelmap* segmentLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName()));
+  CHECK_INT(segmentLabelmap != nullptr, true);
+
+  vtkNew<vtkOrientedImageData> binarySphere;
+  labelmap->GetImage(binarySphere, 1.0, denseImage->GetExtent());
+  timer->StartTimer();
+  CHECK_INT(vtkSegmentationModifier::ModifyBinaryLabelmap(binarySphere, segmentation, segmentID,
+    vtkSegmentationModifier::MODE_MERGE_MAX), true);
+  timer->StopTimer();
+  std::cout << "Segment modified in " << timer->GetElapsedTime() * 1000.0 << "ms" << std::endl;
+  CHECK_INT(segmentLabelmap->GetNumberOfVoxelsInside(), numberOfVoxelsInSphere);
+
+  // Masking with a cube keeps the part of the cube inside the segment
+  int cubeExtent[6] = { 0, 9, 0, 9, 0, 9 };
+  vtkNew<vtkOrientedImageData> cubeModifier;
+  CreateModifier(cubeModifier, image, cubeExtent, 1);
+  CHECK_INT(vtkSegmentationModifier::ModifyBinaryLabelmap(cubeModifier, segmentation, segmentID,
+    vtkSegmentationModifier::MODE_MERGE_MASK), true);
+  CHECK_INT(segmentLabelmap->GetVoxel(0, 0, 0), true);
+  CHECK_INT(vtkSegmentationModifier::ModifyBinaryLabelmap(cubeModifier, segmentation, segmentID,
+    vtkSegmentationModifier::MODE_REPLACE), true);
+  CHECK_INT(segmentLabelmap->GetNumberOfVoxelsInside(), 1000);
+
+  // Conversion to binary labelmap and closed surface
+  CHECK_INT(vtkSegmentationModifier::ModifyBinaryLabelmap(binarySphere, segmentation, segmentID,
+    vtkSegmentationModifier::MODE_REPLACE), true);
+  CHECK_INT(segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()), true);
+  vtkOrientedImageData* segmentBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+  CHECK_INT(segmentBinaryLabelmap != nullptr, true);
+  CHECK_INT(GetNumberOfVoxels(segmentBinaryLabelmap, segment->GetLabelValue()), numberOfVoxelsInSphere);
+
+  CHECK_INT(segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()), true);
+  vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()));
+  CHECK_INT(closedSurface != nullptr, true);
+  CHECK_INT(closedSurface->GetNumberOfPolys() > 0, true);
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
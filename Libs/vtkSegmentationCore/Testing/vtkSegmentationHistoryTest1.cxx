@@ -243,6 +243,71 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
   // restoring previous state saves the current modified state
   CHECK_INT(history->GetNumberOfStates(), 3);
 
+  /////////////////////////////////////////////////
+  // Test that only modified bricks are stored
+  /////////////////////////////////////////////////
+
+  vtkNew<vtkOrientedImageData> largeLabelmap;
+  largeLabelmap->SetExtent(0, 63, 0, 63, 0, 63);
+  largeLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* largeLabelmapPtr = static_cast<unsigned char*>(largeLabelmap->GetScalarPointer());
+  for (vtkIdType i = 0; i < largeLabelmap->GetNumberOfPoints(); ++i)
+  {
+    // Pattern that cannot be compressed well by run-length encoding
+    largeLabelmapPtr[i] = static_cast<unsigned char>(i % 3);
+  }
+  vtkNew<vtkSegment> largeSegment;
+  largeSegment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), largeLabelmap);
+  vtkNew<vtkSegmentation> largeSegmentation;
+  largeSegmentation->AddSegment(largeSegment, "Large");
+
+  vtkNew<vtkSegmentationHistory> largeHistory;
+  largeHistory->SetSegmentation(largeSegmentation);
+  largeHistory->SaveState();
+  vtkTypeUInt64 initialMemorySize = largeHistory->GetMemorySize();
+
+  // Modify a single voxel, only one brick has to be stored
+  largeLabelmap->SetScalarComponentFromDouble(5, 5, 5, 0, 2.0);
+  largeLabelmap->Modified();
+  largeHistory->SaveState();
+  CHECK_INT(largeHistory->GetNumberOfStates(), 2);
+  vtkTypeUInt64 modifiedMemorySize = largeHistory->GetMemorySize();
+  if (modifiedMemorySize - initialMemorySize > initialMemorySize / 4)
+  {
+    std::cerr << "Saving a single-voxel change took too much memory: initial size " << initialMemorySize
+      << " bytes, size after the change " << modifiedMemorySize << " bytes" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Modify another voxel and undo it
+  largeLabelmap->SetScalarComponentFromDouble(20, 40, 60, 0, 1.0);
+  largeLabelmap->Modified();
+  largeHistory->RestorePreviousState();
+  CHECK_INT(largeHistory->GetNumberOfStates(), 3);
+  vtkOrientedImageData* restoredLargeLabelmap = vtkOrientedImageData::SafeDownCast(
+    largeSegment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int restoredExtent[6] = { 0 };
+  restoredLargeLabelmap->GetExtent(restoredExtent);
+  CHECK_INT(restoredExtent[1], 63);
+  CHECK_INT(restoredExtent[5], 63);
+  unsigned char* restoredLargeLabelmapPtr = static_cast<unsigned char*>(restoredLargeLabelmap->GetScalarPointer());
+  vtkIdType modifiedVoxelIndex = 5 + 5 * 64 + 5 * 64 * 64;
+  for (vtkIdType i = 0; i < restoredLargeLabelmap->GetNumberOfPoints(); ++i)
+  {
+    CHECK_INT(restoredLargeLabelmapPtr[i], (i == modifiedVoxelIndex) ? 2 : i % 3);
+  }
+
+  // Redo
+  largeHistory->RestoreNextState();
+  restoredLargeLabelmap = vtkOrientedImageData::SafeDownCast(
+    largeSegment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  CHECK_INT(static_cast<int>(restoredLargeLabelmap->GetScalarComponentAsDouble(5, 5, 5, 0)), 2);
+  CHECK_INT(static_cast<int>(restoredLargeLabelmap->GetScalarComponentAsDouble(20, 40, 60, 0)), 1);
+
+  // Old states are removed if the memory limit is exceeded
+  largeHistory->SetMaximumMemorySize(1);
+  CHECK_INT(largeHistory->GetNumberOfStates(), 1);
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
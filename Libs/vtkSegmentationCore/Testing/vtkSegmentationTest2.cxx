@@ -19,6 +19,9 @@
 ==============================================================================*/
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkIdList.h>
 #include <vtkNew.h>
 #include <vtkVersion.h>
 #include <vtkPointData.h>
@@ -37,11 +40,22 @@
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 void CreateSpherePolyData(vtkPolyData* polyData, double center[3], double radius);
 int CreateCubeLabelmap(vtkOrientedImageData* imageData, int extent[6]);
 
 void SetReferenceGeometry(vtkSegmentation*);
 
+void CountProgressEvents(vtkObject*, unsigned long, void* clientData, void*)
+{
+  int* counter = reinterpret_cast<int*>(clientData);
+  (*counter)++;
+}
+
 bool TestSharedLabelmapConversion()
 {
   // Generate sphere models
@@ -314,6 +328,278 @@ bool TestSharedLabelmapCasting()
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool TestParallelConversion()
+{
+  // Shared labelmap with one slab per label
+  const int numberOfSegments = 12;
+  vtkNew<vtkOrientedImageData> sharedLabelmap;
+  sharedLabelmap->SetExtent(0, 19, 0, 19, 0, 4 * numberOfSegments - 1);
+  sharedLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  sharedLabelmap->GetPointData()->GetScalars()->Fill(0);
+  for (int k = 0; k < 4 * numberOfSegments; ++k)
+  {
+    if (k % 4 == 0)
+    {
+      continue;
+    }
+    for (int j = 2; j < 18; ++j)
+    {
+      for (int i = 2; i < 18; ++i)
+      {
+        *static_cast<unsigned char*>(sharedLabelmap->GetScalarPointer(i, j, k)) = static_cast<unsigned char>(k / 4 + 1);
+      }
+    }
+  }
+
+  std::vector<int> numberOfPoints[2];
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    vtkNew<vtkSegmentation> segmentation;
+    segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+    segmentation->SetParallelConversion(parallel != 0);
+    for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+    {
+      vtkNew<vtkSegment> segment;
+      segment->SetLabelValue(segmentIndex + 1);
+      segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), sharedLabelmap);
+      segmentation->AddSegment(segment);
+    }
+
+    int numberOfProgressEvents = 0;
+    vtkNew<vtkCallbackCommand> progressCallback;
+    progressCallback->SetCallback(CountProgressEvents);
+    progressCallback->SetClientData(&numberOfProgressEvents);
+    segmentation->AddObserver(vtkCommand::ProgressEvent, progressCallback);
+
+    if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName()))
+    {
+      std::cerr << __LINE__ << ": Failed to create closed surface representation" << std::endl;
+      return false;
+    }
+    if (numberOfProgressEvents != numberOfSegments)
+    {
+      std::cerr << __LINE__ << ": Invalid number of progress events " << numberOfProgressEvents
+        << " should be " << numberOfSegments << std::endl;
+      return false;
+    }
+
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+    for (const std::string& segmentID : segmentIDs)
+    {
+      vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentID)->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!closedSurface || closedSurface->GetNumberOfPoints() == 0)
+      {
+        std::cerr << __LINE__ << ": Missing closed surface for segment " << segmentID << std::endl;
+        return false;
+      }
+      numberOfPoints[parallel].push_back(closedSurface->GetNumberOfPoints());
+    }
+  }
+
+  // Parallel conversion gives the same result as sequential conversion
+  if (numberOfPoints[0] != numberOfPoints[1])
+  {
+    std::cerr << __LINE__ << ": Parallel conversion result differs from sequential conversion result" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void GetSurfaceCells(vtkPolyData* surface, std::vector<std::vector<double> >& cells)
+{
+  // Cells are described by their sorted point coordinates, so that surfaces can be compared
+  // regardless of point and cell ordering.
+  cells.clear();
+  vtkNew<vtkIdList> pointIds;
+  for (vtkIdType cellId = 0; cellId < surface->GetNumberOfCells(); ++cellId)
+  {
+    surface->GetCellPoints(cellId, pointIds);
+    std::vector<std::array<double, 3> > cellPoints(pointIds->GetNumberOfIds());
+    for (vtkIdType pointIndex = 0; pointIndex < pointIds->GetNumberOfIds(); ++pointIndex)
+    {
+      surface->GetPoint(pointIds->GetId(pointIndex), cellPoints[pointIndex].data());
+    }
+    std::sort(cellPoints.begin(), cellPoints.end());
+    std::vector<double> cell;
+    for (const std::array<double, 3>& point : cellPoints)
+    {
+      cell.insert(cell.end(), point.begin(), point.end());
+    }
+    cells.push_back(cell);
+  }
+  std::sort(cells.begin(), cells.end());
+}
+
+//----------------------------------------------------------------------------
+bool IsSurfaceEqual(vtkPolyData* surface, vtkPolyData* expectedSurface)
+{
+  if (!surface || !expectedSurface)
+  {
+    return false;
+  }
+  if (surface->GetNumberOfPoints() != expectedSurface->GetNumberOfPoints()
+    || surface->GetNumberOfPolys() != expectedSurface->GetNumberOfPolys())
+  {
+    return false;
+  }
+  std::vector<std::vector<double> > cells;
+  std::vector<std::vector<double> > expectedCells;
+  GetSurfaceCells(surface, cells);
+  GetSurfaceCells(expectedSurface, expectedCells);
+  if (cells.size() != expectedCells.size())
+  {
+    return false;
+  }
+  for (size_t cellIndex = 0; cellIndex < cells.size(); ++cellIndex)
+  {
+    if (cells[cellIndex].size() != expectedCells[cellIndex].size())
+    {
+      return false;
+    }
+    for (size_t coordinateIndex = 0; coordinateIndex < cells[cellIndex].size(); ++coordinateIndex)
+    {
+      if (std::abs(cells[cellIndex][coordinateIndex] - expectedCells[cellIndex][coordinateIndex]) > 1e-6)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void CreateSinglePassTestSegmentation(vtkSegmentation* segmentation, vtkOrientedImageData* sharedLabelmap,
+  int numberOfSegments, bool singlePass)
+{
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetConversionMethodParameterName(),
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS);
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0.0");
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSinglePassExtractionParameterName(),
+    singlePass ? "1" : "0");
+  for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+  {
+    vtkNew<vtkSegment> segment;
+    segment->SetLabelValue(segmentIndex + 1);
+    segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), sharedLabelmap);
+    segmentation->AddSegment(segment);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool TestSinglePassExtraction()
+{
+  // Shared labelmap with adjacent blocks of different labels
+  const int numberOfSegments = 4;
+  vtkNew<vtkOrientedImageData> sharedLabelmap;
+  sharedLabelmap->SetExtent(0, 5 * numberOfSegments + 3, 0, 13, 0, 13);
+  sharedLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  sharedLabelmap->GetPointData()->GetScalars()->Fill(0);
+  for (int k = 2; k < 12; ++k)
+  {
+    for (int j = 2; j < 12; ++j)
+    {
+      for (int i = 2; i < 5 * numberOfSegments + 2; ++i)
+      {
+        *static_cast<unsigned char*>(sharedLabelmap->GetScalarPointer(i, j, k)) = static_cast<unsigned char>((i - 2) / 5 + 1);
+      }
+    }
+  }
+
+  std::vector<vtkSmartPointer<vtkPolyData> > closedSurfaces[2];
+  for (int singlePass = 0; singlePass < 2; ++singlePass)
+  {
+    vtkNew<vtkSegmentation> segmentation;
+    CreateSinglePassTestSegmentation(segmentation, sharedLabelmap, numberOfSegments, singlePass);
+    if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName()))
+    {
+      std::cerr << __LINE__ << ": Failed to create closed surface representation" << std::endl;
+      return false;
+    }
+
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+    for (const std::string& segmentID : segmentIDs)
+    {
+      vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentID)->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!closedSurface || closedSurface->GetNumberOfPolys() == 0)
+      {
+        std::cerr << __LINE__ << ": Missing closed surface for segment " << segmentID << std::endl;
+        return false;
+      }
+      closedSurfaces[singlePass].push_back(closedSurface);
+    }
+  }
+
+  // Each segment gets the same points and faces as when it is extracted separately
+  for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+  {
+    if (!IsSurfaceEqual(closedSurfaces[1][segmentIndex], closedSurfaces[0][segmentIndex]))
+    {
+      std::cerr << __LINE__ << ": Single pass extraction result differs from per-segment extraction result"
+        << " for segment " << segmentIndex << std::endl;
+      return false;
+    }
+  }
+
+  // Converting a single segment of the layer gives the same result as per-segment extraction,
+  // both with a single segment conversion and with a conversion of a list containing one segment.
+  for (int useSegmentList = 0; useSegmentList < 2; ++useSegmentList)
+  {
+    vtkNew<vtkSegmentation> segmentation;
+    CreateSinglePassTestSegmentation(segmentation, sharedLabelmap, numberOfSegments, true);
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+    const int convertedSegmentIndex = 2;
+    std::string convertedSegmentID = segmentIDs[convertedSegmentIndex];
+    if (useSegmentList)
+    {
+      vtkNew<vtkSegmentationConversionPaths> paths;
+      segmentation->GetPossibleConversions(vtkSegmentationConverter::GetClosedSurfaceRepresentationName(), paths);
+      vtkSegmentationConversionPath* path = vtkSegmentationConverter::GetCheapestPath(paths);
+      if (!path || !segmentation->ConvertSegmentsUsingPath({ convertedSegmentID }, path, true))
+      {
+        std::cerr << __LINE__ << ": Failed to convert segment " << convertedSegmentID << std::endl;
+        return false;
+      }
+    }
+    else if (!segmentation->ConvertSingleSegment(convertedSegmentID, vtkSegmentationConverter::GetClosedSurfaceRepresentationName()))
+    {
+      std::cerr << __LINE__ << ": Failed to convert segment " << convertedSegmentID << std::endl;
+      return false;
+    }
+
+    for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+    {
+      vtkPolyData* closedSurface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentIDs[segmentIndex])->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (segmentIndex != convertedSegmentIndex)
+      {
+        // Other segments of the layer are not converted
+        if (closedSurface)
+        {
+          std::cerr << __LINE__ << ": Unexpected closed surface for segment " << segmentIDs[segmentIndex] << std::endl;
+          return false;
+        }
+        continue;
+      }
+      if (!IsSurfaceEqual(closedSurface, closedSurfaces[0][segmentIndex]))
+      {
+        std::cerr << __LINE__ << ": Single segment conversion result differs from per-segment extraction result" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -338,6 +624,16 @@ int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
   }
 
+  if (!TestParallelConversion())
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!TestSinglePassExtraction())
+  {
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Segmentation test 2 passed." << std::endl;
   return EXIT_SUCCESS;
 }
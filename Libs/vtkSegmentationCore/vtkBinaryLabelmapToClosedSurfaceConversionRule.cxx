@@ -61,6 +61,13 @@
 #include <vtkInformation.h>
 #include <vtkExtractSelection.h>
 #include <vtkSelectionSource.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkCellData.h>
+
+// STD includes
+#include <algorithm>
+#include <unordered_map>
 
 //----------------------------------------------------------------------------
 const std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES = std::string("0");
@@ -88,6 +95,10 @@ vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurface
     "1 = Smoothing done in surface nets filter.");
   this->ConversionParameters->SetParameter(GetJointSmoothingParameterName(), "0",
     "Perform joint smoothing.");
+  this->ConversionParameters->SetParameter(GetSinglePassExtractionParameterName(), "1",
+    "Extract surfaces of segments in a shared labelmap in one pass. 1 (default) = enabled, 0 = disabled."
+    " Only used if vtkSurfaceNets3D is used without internal smoothing and several segments of the same"
+    " labelmap are converted together.");
 }
 
 //----------------------------------------------------------------------------
@@ -159,38 +170,32 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
     return false;
   }
 
+  // Segments of the same layer share the labelmap and they may be converted concurrently.
+  // Running a pipeline on the labelmap sets its producer and pipeline information, therefore
+  // pipelines only use a shallow copy that is owned by this call. The shared labelmap is
+  // still used as key of the caches.
+  vtkNew<vtkOrientedImageData> inputLabelmap;
+  {
+    std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
+    inputLabelmap->ShallowCopy(orientedBinaryLabelmap);
+  }
+
   double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
   int jointSmoothing = this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName());
 
   if (jointSmoothing > 0 && smoothingFactor > 0)
   {
+    // The shared labelmap and the cached surface are used by all segments in the layer,
+    // which may be converted concurrently. The surface is created once and extracting
+    // a segment from it is fast, so the whole step is serialized.
+    std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
     if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
     {
-      double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
-      int lowLabel = (int)(floor(scalarRange[0]));
-      int highLabel = (int)(ceil(scalarRange[1]));
-
-      vtkNew<vtkImageAccumulate> imageAccumulate;
-      imageAccumulate->SetInputData(orientedBinaryLabelmap);
-      imageAccumulate->IgnoreZeroOn();
-      imageAccumulate->SetComponentOrigin(0, 0, 0);
-      imageAccumulate->SetComponentSpacing(1, 1, 1);
-      imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
-      imageAccumulate->Update();
-
       std::vector<int> labelValues;
-      for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
-      {
-        // Add a new threshold for every level in the labelmap
-        double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
-        if (numberOfVoxels > 0.0)
-        {
-          labelValues.push_back(labelValue);
-        }
-      }
+      this->GetLabelValues(inputLabelmap, labelValues);
 
       vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
-      this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
+      this->CreateClosedSurface(inputLabelmap, jointSmoothedSurface, labelValues);
       this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
     }
 
@@ -218,10 +223,46 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
     vtkPolyData* thresholdedSurface = geometry->GetOutput();
     closedSurfacePolyData->ShallowCopy(thresholdedSurface);
   }
+  else if (this->IsSinglePassExtraction(orientedBinaryLabelmap))
+  {
+    // Surfaces of all converted segments in the layer are extracted in one pass, the first segment
+    // that is converted creates them. Smoothing and decimation are done per segment.
+    vtkSmartPointer<vtkPolyData> labelSurface;
+    {
+      std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
+      auto labelSurfacesIt = this->LabelSurfaceCache.find(orientedBinaryLabelmap);
+      if (labelSurfacesIt == this->LabelSurfaceCache.end())
+      {
+        const std::vector<int>& labelValues = this->SinglePassLabelValues[orientedBinaryLabelmap];
+        vtkNew<vtkPolyData> multiLabelSurface;
+        if (!this->ExtractLabelmapSurface(inputLabelmap, multiLabelSurface, labelValues))
+        {
+          return false;
+        }
+        labelSurfacesIt = this->LabelSurfaceCache.insert(
+          std::make_pair(orientedBinaryLabelmap, std::map<int, vtkSmartPointer<vtkPolyData> >())).first;
+        SplitSurfaceByLabel(multiLabelSurface, labelValues, labelSurfacesIt->second);
+      }
+      auto labelSurfaceIt = labelSurfacesIt->second.find(segment->GetLabelValue());
+      if (labelSurfaceIt != labelSurfacesIt->second.end())
+      {
+        labelSurface = labelSurfaceIt->second;
+      }
+    }
+    if (!labelSurface)
+    {
+      // Segment is empty
+      closedSurfacePolyData->Initialize();
+    }
+    else if (!this->PostProcessLabelmapSurface(inputLabelmap, labelSurface, closedSurfacePolyData))
+    {
+      return false;
+    }
+  }
   else
   {
     std::vector<int> labelValue = { segment->GetLabelValue() };
-    this->CreateClosedSurface(orientedBinaryLabelmap, closedSurfacePolyData, labelValue);
+    this->CreateClosedSurface(inputLabelmap, closedSurfacePolyData, labelValue);
   }
 
   // Remove "ImageScalars" array because having a scalar in a model would get that
@@ -252,6 +293,145 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     return false;
   }
 
+  vtkNew<vtkPolyData> labelmapSurface;
+  if (!this->ExtractLabelmapSurface(orientedBinaryLabelmap, labelmapSurface, labelValues))
+  {
+    return false;
+  }
+  return this->PostProcessLabelmapSurface(orientedBinaryLabelmap, labelmapSurface, closedSurfacePolyData);
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::IsSinglePassExtraction(vtkOrientedImageData* labelmap)
+{
+  if (!this->IsSinglePassExtractionEnabled())
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
+  return this->SinglePassLabelValues.find(labelmap) != this->SinglePassLabelValues.end();
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::IsSinglePassExtractionEnabled()
+{
+  // Internal smoothing of surface nets would smooth the segments jointly,
+  // and flying edges extracts each label separately anyway
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  int surfaceNetsSmoothing = this->ConversionParameters->GetValueAsInt(GetSurfaceNetInternalSmoothingParameterName());
+  int singlePassExtraction = this->ConversionParameters->GetValueAsInt(GetSinglePassExtractionParameterName());
+  return singlePassExtraction > 0
+    && conversionMethod == vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS
+    && surfaceNetsSmoothing == 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::GetLabelValues(vtkOrientedImageData* labelmap, std::vector<int>& labelValues)
+{
+  labelValues.clear();
+  double* scalarRange = labelmap->GetScalarRange();
+  int lowLabel = (int)(floor(scalarRange[0]));
+  int highLabel = (int)(ceil(scalarRange[1]));
+
+  vtkNew<vtkImageAccumulate> imageAccumulate;
+  imageAccumulate->SetInputData(labelmap);
+  imageAccumulate->IgnoreZeroOn();
+  imageAccumulate->SetComponentOrigin(0, 0, 0);
+  imageAccumulate->SetComponentSpacing(1, 1, 1);
+  imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
+  imageAccumulate->Update();
+
+  for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
+  {
+    // Add a new threshold for every level in the labelmap
+    double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
+    if (numberOfVoxels > 0.0)
+    {
+      labelValues.push_back(labelValue);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::SplitSurfaceByLabel(vtkPolyData* multiLabelSurface,
+  const std::vector<int>& labelValues, std::map<int, vtkSmartPointer<vtkPolyData> >& labelSurfaces)
+{
+  labelSurfaces.clear();
+  vtkDataArray* boundaryLabels = multiLabelSurface->GetCellData()->GetArray("BoundaryLabels");
+  vtkPoints* multiLabelPoints = multiLabelSurface->GetPoints();
+  if (!boundaryLabels || boundaryLabels->GetNumberOfComponents() != 2 || !multiLabelPoints)
+  {
+    return;
+  }
+
+  struct LabelSurfaceBuilder
+  {
+    std::unordered_map<vtkIdType, vtkIdType> PointIdMap;
+    vtkSmartPointer<vtkPoints> Points;
+    vtkSmartPointer<vtkCellArray> Polys;
+  };
+  std::map<int, LabelSurfaceBuilder> builders;
+  for (int labelValue : labelValues)
+  {
+    LabelSurfaceBuilder& builder = builders[labelValue];
+    builder.Points = vtkSmartPointer<vtkPoints>::New();
+    builder.Points->SetDataType(multiLabelPoints->GetDataType());
+    builder.Polys = vtkSmartPointer<vtkCellArray>::New();
+  }
+
+  // Each boundary face is added to the surface of the labels on both sides of it.
+  // Faces are oriented towards the first label, so they are reversed for the second one.
+  std::vector<vtkIdType> cellPointIds;
+  vtkSmartPointer<vtkCellArrayIterator> polysIt = vtk::TakeSmartPointer(multiLabelSurface->GetPolys()->NewIterator());
+  vtkIdType cellId = multiLabelSurface->GetNumberOfVerts() + multiLabelSurface->GetNumberOfLines();
+  for (polysIt->GoToFirstCell(); !polysIt->IsDoneWithTraversal(); polysIt->GoToNextCell(), ++cellId)
+  {
+    vtkIdType numberOfCellPoints = 0;
+    const vtkIdType* multiLabelPointIds = nullptr;
+    polysIt->GetCurrentCell(numberOfCellPoints, multiLabelPointIds);
+    for (int side = 0; side < 2; ++side)
+    {
+      int labelValue = static_cast<int>(boundaryLabels->GetComponent(cellId, side));
+      auto builderIt = builders.find(labelValue);
+      if (builderIt == builders.end())
+      {
+        // Background
+        continue;
+      }
+      LabelSurfaceBuilder& builder = builderIt->second;
+      cellPointIds.resize(numberOfCellPoints);
+      for (vtkIdType cellPointIndex = 0; cellPointIndex < numberOfCellPoints; ++cellPointIndex)
+      {
+        vtkIdType multiLabelPointId = multiLabelPointIds[side == 0 ? cellPointIndex : numberOfCellPoints - 1 - cellPointIndex];
+        auto pointIdIt = builder.PointIdMap.find(multiLabelPointId);
+        if (pointIdIt == builder.PointIdMap.end())
+        {
+          vtkIdType pointId = builder.Points->InsertNextPoint(multiLabelPoints->GetPoint(multiLabelPointId));
+          pointIdIt = builder.PointIdMap.insert(std::make_pair(multiLabelPointId, pointId)).first;
+        }
+        cellPointIds[cellPointIndex] = pointIdIt->second;
+      }
+      builder.Polys->InsertNextCell(numberOfCellPoints, cellPointIds.data());
+    }
+  }
+
+  for (auto& labelBuilder : builders)
+  {
+    if (labelBuilder.second.Polys->GetNumberOfCells() == 0)
+    {
+      continue;
+    }
+    vtkSmartPointer<vtkPolyData> labelSurface = vtkSmartPointer<vtkPolyData>::New();
+    labelSurface->SetPoints(labelBuilder.second.Points);
+    labelSurface->SetPolys(labelBuilder.second.Polys);
+    labelSurfaces[labelBuilder.first] = labelSurface;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::ExtractLabelmapSurface(vtkOrientedImageData* orientedBinaryLabelmap,
+  vtkPolyData* labelmapSurface, const std::vector<int>& labelValues)
+{
   vtkSmartPointer<vtkImageData> binaryLabelmap = orientedBinaryLabelmap;
   if (!binaryLabelmap)
   {
@@ -267,7 +447,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   {
     // empty labelmap
     vtkDebugMacro("Convert: No polygons can be created, input image extent is empty");
-    closedSurfacePolyData->Initialize();
+    labelmapSurface->Initialize();
     return true;
   }
 
@@ -294,9 +474,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   binaryLabelmapWithIdentityGeometry->SetSpacing(1.0, 1.0, 1.0);
 
   // Get conversion parameters
-  double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
   double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
-  int computeSurfaceNormals = this->ConversionParameters->GetValueAsInt(GetComputeSurfaceNormalsParameterName());
 
   // Conversion method
   std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
@@ -379,20 +557,31 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     vtkErrorMacro("Conversion Rule: Unknown surface generation method");
   }
 
-  vtkSmartPointer<vtkPolyData> convertedSegment = vtkSmartPointer<vtkPolyData>::New();
+  labelmapSurface->ShallowCopy(processingResult);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostProcessLabelmapSurface(vtkOrientedImageData* orientedBinaryLabelmap,
+  vtkPolyData* labelmapSurface, vtkPolyData* closedSurfacePolyData)
+{
+  // Get conversion parameters
+  double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  int computeSurfaceNormals = this->ConversionParameters->GetValueAsInt(GetComputeSurfaceNormalsParameterName());
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  int surfaceNetsSmoothing = this->ConversionParameters->GetValueAsInt(GetSurfaceNetInternalSmoothingParameterName());
 
-  if (processingResult->GetNumberOfPolys() == 0)
+  if (labelmapSurface->GetNumberOfPolys() == 0)
   {
     vtkDebugMacro("Convert: No polygons can be created, probably all voxels are empty");
-    convertedSegment = nullptr;
     closedSurfacePolyData->Initialize();
-  }
-
-  if (!convertedSegment)
-  {
     return true;
   }
 
+  vtkSmartPointer<vtkPolyData> processingResult = labelmapSurface;
+  vtkSmartPointer<vtkPolyData> convertedSegment = vtkSmartPointer<vtkPolyData>::New();
+
   // Decimate
   if (decimationFactor > 0.0)
   {
@@ -458,10 +647,51 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PreConvertSegments(vtkSegmentation* segmentation,
+  const std::vector<vtkSegment*>& segmentsToConvert)
+{
+  std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
+  this->SinglePassLabelValues.clear();
+  if (!this->IsSinglePassExtractionEnabled())
+  {
+    return this->PreConvert(segmentation);
+  }
+
+  // Extracting the surfaces in one pass only pays off if more than one segment of the labelmap is converted
+  std::map<vtkOrientedImageData*, std::vector<int> > labelValuesByLabelmap;
+  for (vtkSegment* segment : segmentsToConvert)
+  {
+    vtkOrientedImageData* labelmap = segment ?
+      vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(this->GetSourceRepresentationName())) : nullptr;
+    if (!labelmap)
+    {
+      continue;
+    }
+    std::vector<int>& labelValues = labelValuesByLabelmap[labelmap];
+    if (std::find(labelValues.begin(), labelValues.end(), segment->GetLabelValue()) == labelValues.end())
+    {
+      labelValues.push_back(segment->GetLabelValue());
+    }
+  }
+  for (auto& labelmapLabelValues : labelValuesByLabelmap)
+  {
+    if (labelmapLabelValues.second.size() > 1)
+    {
+      std::sort(labelmapLabelValues.second.begin(), labelmapLabelValues.second.end());
+      this->SinglePassLabelValues[labelmapLabelValues.first] = labelmapLabelValues.second;
+    }
+  }
+  return this->PreConvert(segmentation);
+}
+
 //----------------------------------------------------------------------------
 bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostConvert(vtkSegmentation* vtkNotUsed(segmentation))
 {
+  std::lock_guard<std::mutex> lock(this->JointSmoothCacheMutex);
   this->JointSmoothCache.clear();
+  this->LabelSurfaceCache.clear();
+  this->SinglePassLabelValues.clear();
   return true;
 }
 
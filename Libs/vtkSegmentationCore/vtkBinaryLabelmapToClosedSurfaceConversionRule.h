@@ -30,6 +30,11 @@
 // VTK includes
 #include <vtkPolyData.h>
 
+// STD includes
+#include <map>
+#include <mutex>
+#include <vector>
+
 /// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
 ///   closed surface representation (vtkPolyData type). The conversion algorithm
 ///   performs a marching cubes operation on the image data followed by an optional
@@ -54,6 +59,10 @@ public:
   /// If joint smoothing is enabled, surfaces will be created and smoothed as one vtkPolyData.
   /// Joint smoothing converts all segments in shared labelmap together, reducing smoothing artifacts.
   static const std::string GetJointSmoothingParameterName() { return "Joint smoothing"; };
+  /// Conversion parameter: single pass extraction
+  /// If enabled and surface nets are used without internal smoothing, then the surfaces of all segments
+  /// in a shared labelmap are extracted in one pass and split by label value.
+  static const std::string GetSinglePassExtractionParameterName() { return "Single pass extraction"; };
 
   // Conversion methods
   static const std::string CONVERSION_METHOD_FLYING_EDGES;
@@ -77,13 +86,26 @@ public:
   /// Perform the actual binary labelmap to closed surface conversion
   bool CreateClosedSurface(vtkOrientedImageData* inputImage, vtkPolyData* outputPolydata, std::vector<int> values);
 
+  /// Split a multi-label surface nets output into surfaces of each label.
+  /// Faces on the boundary of two labels are added to both surfaces.
+  static void SplitSurfaceByLabel(vtkPolyData* multiLabelSurface, const std::vector<int>& labelValues,
+    std::map<int, vtkSmartPointer<vtkPolyData> >& labelSurfaces);
+
+  /// Determine the shared labelmaps that are used by several of the converted segments.
+  /// Surfaces of these segments are extracted in one pass if single pass extraction is enabled.
+  bool PreConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& segmentsToConvert) override;
+
   /// Update the target representation based on the source representation
   bool Convert(vtkSegment* segment) override;
 
   /// Perform postprocessing steps on the output
-  /// Clears the joint smoothing cache
+  /// Clears the joint smoothing and single pass extraction caches
   bool PostConvert(vtkSegmentation* segmentation) override;
 
+  /// Segments can be converted concurrently: the caches are protected by a lock and
+  /// pipelines run on a shallow copy of the (possibly shared) source labelmap
+  bool IsConvertThreadSafe() override { return true; };
+
   /// Get the cost of the conversion.
   unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
 
@@ -101,6 +123,23 @@ protected:
   /// This function checks whether this is the case.
   bool IsLabelmapPaddingNecessary(vtkImageData* binaryLabelMap);
 
+  /// Generate the surface of the given label values in the labelmap IJK coordinate system
+  bool ExtractLabelmapSurface(vtkOrientedImageData* orientedBinaryLabelmap, vtkPolyData* labelmapSurface,
+    const std::vector<int>& labelValues);
+
+  /// Decimate, smooth, and transform surface from labelmap IJK to world coordinate system
+  bool PostProcessLabelmapSurface(vtkOrientedImageData* orientedBinaryLabelmap, vtkPolyData* labelmapSurface,
+    vtkPolyData* closedSurfacePolyData);
+
+  /// Get all label values that are present in the labelmap
+  void GetLabelValues(vtkOrientedImageData* labelmap, std::vector<int>& labelValues);
+
+  /// Return true if the surfaces of the segments in a shared labelmap can be extracted in one pass
+  bool IsSinglePassExtractionEnabled();
+
+  /// Return true if the surfaces of the converted segments in the labelmap are extracted in one pass
+  bool IsSinglePassExtraction(vtkOrientedImageData* labelmap);
+
 protected:
   vtkBinaryLabelmapToClosedSurfaceConversionRule();
   ~vtkBinaryLabelmapToClosedSurfaceConversionRule() override;
@@ -109,6 +148,13 @@ protected:
   /// Cache for storing merged closed surfaces that have been joint smoothed
   /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation
   std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> > JointSmoothCache;
+  /// Cache for storing surfaces extracted in one pass from a shared labelmap, split by label value
+  std::map<vtkOrientedImageData*, std::map<int, vtkSmartPointer<vtkPolyData> > > LabelSurfaceCache;
+  /// Label values of the converted segments in shared labelmaps that are used by more than one converted segment.
+  /// Only these labelmaps are extracted in one pass, and only the listed label values are extracted.
+  std::map<vtkOrientedImageData*, std::vector<int> > SinglePassLabelValues;
+  /// Lock for accessing the surface caches and the cached surfaces
+  std::mutex JointSmoothCacheMutex;
 
 private:
   vtkBinaryLabelmapToClosedSurfaceConversionRule(const vtkBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
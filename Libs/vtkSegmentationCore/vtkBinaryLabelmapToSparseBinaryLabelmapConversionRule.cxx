@@ -0,0 +1,99 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkSegment.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::~vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::GetConversionCost(
+    vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+    vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms)
+  return 50;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+  }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkOrientedImageData"))
+  {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+  }
+  else if (!className.compare("vtkOrientedSparseBinaryLabelmap"))
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!binaryLabelmap)
+  {
+    vtkErrorMacro("Convert: Source representation is not oriented image data");
+    return false;
+  }
+  vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!sparseLabelmap)
+  {
+    vtkErrorMacro("Convert: Target representation is not a sparse binary labelmap");
+    return false;
+  }
+
+  // The binary labelmap may be shared with other segments, only voxels of this segment are used
+  return sparseLabelmap->SetFromImage(binaryLabelmap, segment->GetLabelValue());
+}
@@ -0,0 +1,73 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule_h
+#define __vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule_h
+
+// SegmentationCore includes
+#include "vtkSegmentationConverterRule.h"
+#include "vtkSegmentationConverter.h"
+
+#include "vtkSegmentationCoreConfigure.h"
+
+/// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
+///   sparse binary labelmap representation (vtkOrientedSparseBinaryLabelmap type).
+///   Voxels of the shared labelmap that are equal to the segment label value are inside.
+class vtkSegmentationCore_EXPORT vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule
+  : public vtkSegmentationConverterRule
+{
+public:
+  static vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule* New();
+  vtkTypeMacro(vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule, vtkSegmentationConverterRule);
+  vtkSegmentationConverterRule* CreateRuleInstance() override;
+
+  /// Constructs representation object from representation name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByRepresentation(std::string representationName) override;
+
+  /// Constructs representation object from class name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
+
+  /// Update the target representation based on the source representation
+  bool Convert(vtkSegment* segment) override;
+
+  /// Segments are converted independently from each other
+  bool IsConvertThreadSafe() override { return true; };
+
+  /// Get the cost of the conversion.
+  unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
+
+  /// Human-readable name of the converter rule
+  const char* GetName() override { return "Binary labelmap to sparse binary labelmap"; };
+
+  /// Human-readable name of the source representation
+  const char* GetSourceRepresentationName() override { return vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(); };
+
+  /// Human-readable name of the target representation
+  const char* GetTargetRepresentationName() override { return vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName(); };
+
+protected:
+  vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule();
+  ~vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule() override;
+
+private:
+  vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule(const vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule&) = delete;
+  void operator=(const vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule&) = delete;
+};
+
+#endif
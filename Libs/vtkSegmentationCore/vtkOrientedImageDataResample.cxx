@@ -22,6 +22,7 @@
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverter.h"
 #include "vtkOrientedImageData.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
 
 // VTK includes
 #include <vtkAppendPolyData.h>
@@ -1187,6 +1188,53 @@ bool vtkOrientedImageDataResample::ModifyImage(
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::MergeImage(
+    vtkOrientedSparseBinaryLabelmap* inputLabelmap,
+    vtkOrientedImageData* imageToAppend,
+    vtkOrientedSparseBinaryLabelmap* outputLabelmap,
+    int operation,
+    const int extent[6]/*=nullptr*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/,
+    bool *outputModified /*=nullptr*/)
+{
+  if (outputModified != nullptr)
+  {
+    (*outputModified) = false;
+  }
+  if (!inputLabelmap || !imageToAppend || !outputLabelmap)
+  {
+    return false;
+  }
+  if (!inputLabelmap->IsGeometryMatching(imageToAppend))
+  {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage failed: geometry mismatch between inputLabelmap and imageToAppend");
+    return false;
+  }
+  if (outputLabelmap != inputLabelmap)
+  {
+    outputLabelmap->DeepCopy(inputLabelmap);
+  }
+  return outputLabelmap->ModifyImage(imageToAppend, operation, extent, maskThreshold, fillValue, outputModified);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::ModifyImage(
+    vtkOrientedSparseBinaryLabelmap* inputLabelmap,
+    vtkOrientedImageData* modifierImage,
+    int operation,
+    const int extent[6]/*=nullptr*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/)
+{
+  if (!inputLabelmap || !modifierImage)
+  {
+    return false;
+  }
+  return inputLabelmap->ModifyImage(modifierImage, operation, extent, maskThreshold, fillValue);
+}
+
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]/*=0*/)
 {
@@ -34,6 +34,7 @@
 class vtkImageData;
 class vtkMatrix4x4;
 class vtkOrientedImageData;
+class vtkOrientedSparseBinaryLabelmap;
 class vtkTransform;
 class vtkAbstractTransform;
 
@@ -94,6 +95,17 @@ public:
   static bool ModifyImage(vtkOrientedImageData* inputImage, vtkOrientedImageData* modifierImage, int operation,
     const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
 
+  /// Combines a sparse labelmap and imageToAppend into outputLabelmap, the same way as for oriented image data.
+  /// Sparse labelmaps have unbounded extent, therefore no padding is needed and only the tiles
+  /// that imageToAppend overlaps are processed. inputLabelmap and outputLabelmap may be the same object.
+  static bool MergeImage(vtkOrientedSparseBinaryLabelmap* inputLabelmap, vtkOrientedImageData* imageToAppend,
+    vtkOrientedSparseBinaryLabelmap* outputLabelmap, int operation, const int extent[6] = nullptr,
+    double maskThreshold = 0, double fillValue = 1, bool* outputModified = nullptr);
+
+  /// Modifies a sparse labelmap in-place by combining with modifierImage, the same way as for oriented image data.
+  static bool ModifyImage(vtkOrientedSparseBinaryLabelmap* inputLabelmap, vtkOrientedImageData* modifierImage, int operation,
+    const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
+
   /// Copy image with clipping to the specified extent
   static bool CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]=nullptr);
 
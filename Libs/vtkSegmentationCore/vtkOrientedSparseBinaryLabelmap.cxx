@@ -0,0 +1,809 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+vtkStandardNewMacro(vtkOrientedSparseBinaryLabelmap);
+
+namespace
+{
+
+/// Each row of a tile (TileSize voxels along the i axis) is stored in one integer
+typedef vtkTypeUInt16 RowType;
+static_assert(sizeof(RowType) * 8 == vtkOrientedSparseBinaryLabelmap::TileSize, "Tile row type must have one bit per voxel");
+
+const int TILE_SIZE = vtkOrientedSparseBinaryLabelmap::TileSize;
+const int ROWS_PER_TILE = TILE_SIZE * TILE_SIZE;
+const int VOXELS_PER_TILE = ROWS_PER_TILE * TILE_SIZE;
+const RowType FULL_ROW = 0xFFFF;
+
+/// Tile indices are offset by this value to make them non-negative in the tile key
+const int TILE_INDEX_OFFSET = 1 << 20;
+const vtkTypeUInt64 TILE_INDEX_MASK = (vtkTypeUInt64(1) << 21) - 1;
+
+//----------------------------------------------------------------------------
+int GetTileIndex(int voxelIndex)
+{
+  // Round towards negative infinity
+  return voxelIndex >= 0 ? voxelIndex / TILE_SIZE : -((-voxelIndex + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 GetTileKey(int ti, int tj, int tk)
+{
+  return vtkTypeUInt64(ti + TILE_INDEX_OFFSET)
+    | (vtkTypeUInt64(tj + TILE_INDEX_OFFSET) << 21)
+    | (vtkTypeUInt64(tk + TILE_INDEX_OFFSET) << 42);
+}
+
+//----------------------------------------------------------------------------
+void GetTileExtentFromKey(vtkTypeUInt64 key, int tileExtent[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    int tileIndex = static_cast<int>((key >> (21 * axis)) & TILE_INDEX_MASK) - TILE_INDEX_OFFSET;
+    tileExtent[axis * 2] = tileIndex * TILE_SIZE;
+    tileExtent[axis * 2 + 1] = tileIndex * TILE_SIZE + TILE_SIZE - 1;
+  }
+}
+
+//----------------------------------------------------------------------------
+void GetTileExtent(int ti, int tj, int tk, int tileExtent[6])
+{
+  tileExtent[0] = ti * TILE_SIZE;
+  tileExtent[1] = ti * TILE_SIZE + TILE_SIZE - 1;
+  tileExtent[2] = tj * TILE_SIZE;
+  tileExtent[3] = tj * TILE_SIZE + TILE_SIZE - 1;
+  tileExtent[4] = tk * TILE_SIZE;
+  tileExtent[5] = tk * TILE_SIZE + TILE_SIZE - 1;
+}
+
+//----------------------------------------------------------------------------
+bool IsExtentEmpty(const int extent[6])
+{
+  return extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5];
+}
+
+//----------------------------------------------------------------------------
+void IntersectExtent(const int extentA[6], const int extentB[6], int intersection[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    intersection[axis * 2] = std::max(extentA[axis * 2], extentB[axis * 2]);
+    intersection[axis * 2 + 1] = std::min(extentA[axis * 2 + 1], extentB[axis * 2 + 1]);
+  }
+}
+
+//----------------------------------------------------------------------------
+void GetTileRange(const int extent[6], int tileRange[6])
+{
+  for (int i = 0; i < 6; ++i)
+  {
+    tileRange[i] = GetTileIndex(extent[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Row with bits firstBit..lastBit (inclusive) set
+RowType GetRowMask(int firstBit, int lastBit)
+{
+  return static_cast<RowType>(((1u << (lastBit + 1)) - 1u) & ~((1u << firstBit) - 1u));
+}
+
+//----------------------------------------------------------------------------
+int GetRowIndex(int j, int k, const int tileExtent[6])
+{
+  return (j - tileExtent[2]) + TILE_SIZE * (k - tileExtent[4]);
+}
+
+//----------------------------------------------------------------------------
+int CountBits(RowType row)
+{
+  int count = 0;
+  for (; row; row &= row - 1)
+  {
+    ++count;
+  }
+  return count;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkOrientedSparseBinaryLabelmap::vtkInternal
+{
+public:
+  struct Tile
+  {
+    /// Voxels of the tile: bit (i - tileExtent[0]) of Rows[GetRowIndex(j, k)].
+    /// Empty if all voxels of the tile are inside.
+    std::vector<RowType> Rows;
+  };
+  typedef std::unordered_map<vtkTypeUInt64, Tile> TileMap;
+
+  /// Set and clear voxels of a tile using row masks.
+  /// Tiles are kept in canonical form: tiles without voxels inside are removed,
+  /// and tiles with all voxels inside do not store rows.
+  /// \return True if any voxel has changed
+  bool ModifyTile(vtkTypeUInt64 key, const RowType* setRows, const RowType* clearRows);
+
+  TileMap Tiles;
+  vtkNew<vtkMatrix4x4> ImageToWorldMatrix;
+};
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::vtkInternal::ModifyTile(vtkTypeUInt64 key, const RowType* setRows, const RowType* clearRows)
+{
+  RowType rows[ROWS_PER_TILE];
+  TileMap::iterator tileIt = this->Tiles.find(key);
+  if (tileIt == this->Tiles.end())
+  {
+    std::fill(rows, rows + ROWS_PER_TILE, RowType(0));
+  }
+  else if (tileIt->second.Rows.empty())
+  {
+    std::fill(rows, rows + ROWS_PER_TILE, FULL_ROW);
+  }
+  else
+  {
+    std::copy(tileIt->second.Rows.begin(), tileIt->second.Rows.end(), rows);
+  }
+
+  bool changed = false;
+  bool allInside = true;
+  bool allOutside = true;
+  for (int rowIndex = 0; rowIndex < ROWS_PER_TILE; ++rowIndex)
+  {
+    RowType row = static_cast<RowType>((rows[rowIndex] | setRows[rowIndex]) & ~clearRows[rowIndex]);
+    changed = changed || (row != rows[rowIndex]);
+    allInside = allInside && (row == FULL_ROW);
+    allOutside = allOutside && (row == 0);
+    rows[rowIndex] = row;
+  }
+  if (!changed)
+  {
+    return false;
+  }
+
+  if (allOutside)
+  {
+    this->Tiles.erase(key);
+  }
+  else if (allInside)
+  {
+    this->Tiles[key].Rows = std::vector<RowType>();
+  }
+  else
+  {
+    this->Tiles[key].Rows.assign(rows, rows + ROWS_PER_TILE);
+  }
+  return true;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+template <class T, class TileMapType>
+void SetTilesFromImageGeneric(vtkImageData* image, double labelValue, TileMapType& tiles)
+{
+  if (labelValue < static_cast<double>(std::numeric_limits<T>::lowest())
+    || labelValue > static_cast<double>(std::numeric_limits<T>::max())
+    || static_cast<double>(static_cast<T>(labelValue)) != labelValue)
+  {
+    // Label value cannot be stored in the image, therefore no voxels are inside
+    return;
+  }
+  T value = static_cast<T>(labelValue);
+  int* extent = image->GetExtent();
+  int numberOfComponents = image->GetNumberOfScalarComponents();
+  int tileRange[6] = { 0, -1, 0, -1, 0, -1 };
+  GetTileRange(extent, tileRange);
+
+  RowType rows[ROWS_PER_TILE];
+  for (int tk = tileRange[4]; tk <= tileRange[5]; ++tk)
+  {
+    for (int tj = tileRange[2]; tj <= tileRange[3]; ++tj)
+    {
+      for (int ti = tileRange[0]; ti <= tileRange[1]; ++ti)
+      {
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        GetTileExtent(ti, tj, tk, tileExtent);
+        int voxelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtent(tileExtent, extent, voxelExtent);
+
+        std::fill(rows, rows + ROWS_PER_TILE, RowType(0));
+        bool anyInside = false;
+        bool allInside = true;
+        for (int k = voxelExtent[4]; k <= voxelExtent[5]; ++k)
+        {
+          for (int j = voxelExtent[2]; j <= voxelExtent[3]; ++j)
+          {
+            T* voxelPtr = static_cast<T*>(image->GetScalarPointer(voxelExtent[0], j, k));
+            RowType row = 0;
+            for (int i = voxelExtent[0]; i <= voxelExtent[1]; ++i, voxelPtr += numberOfComponents)
+            {
+              if (*voxelPtr == value)
+              {
+                row |= static_cast<RowType>(1u << (i - tileExtent[0]));
+              }
+            }
+            rows[GetRowIndex(j, k, tileExtent)] = row;
+            anyInside = anyInside || (row != 0);
+            allInside = allInside && (row == FULL_ROW);
+          }
+        }
+        if (!anyInside)
+        {
+          continue;
+        }
+        auto& tile = tiles[GetTileKey(ti, tj, tk)];
+        // Tiles that are partially outside the image extent are never full
+        bool tileInsideImage = std::equal(tileExtent, tileExtent + 6, voxelExtent);
+        if (!allInside || !tileInsideImage)
+        {
+          tile.Rows.assign(rows, rows + ROWS_PER_TILE);
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T, class TileMapType>
+void FillImageFromTilesGeneric(const TileMapType& tiles, vtkImageData* image, double labelValue)
+{
+  T value = static_cast<T>(labelValue);
+  int* extent = image->GetExtent();
+  for (const auto& keyAndTile : tiles)
+  {
+    int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    GetTileExtentFromKey(keyAndTile.first, tileExtent);
+    int voxelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    IntersectExtent(tileExtent, extent, voxelExtent);
+    if (IsExtentEmpty(voxelExtent))
+    {
+      continue;
+    }
+    const std::vector<RowType>& rows = keyAndTile.second.Rows;
+    for (int k = voxelExtent[4]; k <= voxelExtent[5]; ++k)
+    {
+      for (int j = voxelExtent[2]; j <= voxelExtent[3]; ++j)
+      {
+        RowType row = rows.empty() ? FULL_ROW : rows[GetRowIndex(j, k, tileExtent)];
+        if (!row)
+        {
+          continue;
+        }
+        T* voxelPtr = static_cast<T*>(image->GetScalarPointer(voxelExtent[0], j, k));
+        for (int i = voxelExtent[0]; i <= voxelExtent[1]; ++i, ++voxelPtr)
+        {
+          if ((row >> (i - tileExtent[0])) & 1u)
+          {
+            *voxelPtr = value;
+          }
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T, class InternalType>
+bool ModifyTilesGeneric(InternalType* internal, vtkImageData* modifierImage,
+  const int updateExtent[6], int operation, double maskThreshold, bool fillInside)
+{
+  int numberOfComponents = modifierImage->GetNumberOfScalarComponents();
+  int tileRange[6] = { 0, -1, 0, -1, 0, -1 };
+  GetTileRange(updateExtent, tileRange);
+
+  bool modified = false;
+  RowType setRows[ROWS_PER_TILE];
+  RowType clearRows[ROWS_PER_TILE];
+  for (int tk = tileRange[4]; tk <= tileRange[5]; ++tk)
+  {
+    for (int tj = tileRange[2]; tj <= tileRange[3]; ++tj)
+    {
+      for (int ti = tileRange[0]; ti <= tileRange[1]; ++ti)
+      {
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        GetTileExtent(ti, tj, tk, tileExtent);
+        int voxelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtent(tileExtent, updateExtent, voxelExtent);
+
+        std::fill(setRows, setRows + ROWS_PER_TILE, RowType(0));
+        std::fill(clearRows, clearRows + ROWS_PER_TILE, RowType(0));
+        bool anyChange = false;
+        for (int k = voxelExtent[4]; k <= voxelExtent[5]; ++k)
+        {
+          for (int j = voxelExtent[2]; j <= voxelExtent[3]; ++j)
+          {
+            T* voxelPtr = static_cast<T*>(modifierImage->GetScalarPointer(voxelExtent[0], j, k));
+            RowType selectedVoxels = 0;
+            for (int i = voxelExtent[0]; i <= voxelExtent[1]; ++i, voxelPtr += numberOfComponents)
+            {
+              bool selected = false;
+              switch (operation)
+              {
+                case vtkOrientedImageDataResample::OPERATION_MAXIMUM: selected = (*voxelPtr > 0); break;
+                case vtkOrientedImageDataResample::OPERATION_MINIMUM: selected = (*voxelPtr <= 0); break;
+                default: selected = (static_cast<double>(*voxelPtr) > maskThreshold); break;
+              }
+              if (selected)
+              {
+                selectedVoxels |= static_cast<RowType>(1u << (i - tileExtent[0]));
+              }
+            }
+            if (!selectedVoxels)
+            {
+              continue;
+            }
+            anyChange = true;
+            bool setSelectedVoxels = (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM
+              || (operation == vtkOrientedImageDataResample::OPERATION_MASKING && fillInside));
+            (setSelectedVoxels ? setRows : clearRows)[GetRowIndex(j, k, tileExtent)] = selectedVoxels;
+          }
+        }
+        if (anyChange && internal->ModifyTile(GetTileKey(ti, tj, tk), setRows, clearRows))
+        {
+          modified = true;
+        }
+      }
+    }
+  }
+  return modified;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkOrientedSparseBinaryLabelmap::vtkOrientedSparseBinaryLabelmap()
+{
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkOrientedSparseBinaryLabelmap::~vtkOrientedSparseBinaryLabelmap()
+{
+  delete this->Internal;
+  this->Internal = nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ImageToWorldMatrix:\n";
+  this->Internal->ImageToWorldMatrix->PrintSelf(os, indent.GetNextIndent());
+  os << indent << "TileSize: " << TileSize << "\n";
+  os << indent << "NumberOfFullTiles: " << this->GetNumberOfTiles(TileFull) << "\n";
+  os << indent << "NumberOfMixedTiles: " << this->GetNumberOfTiles(TileMixed) << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::Initialize()
+{
+  this->Superclass::Initialize();
+  if (this->Internal)
+  {
+    this->Internal->Tiles.clear();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::ShallowCopy(vtkDataObject* src)
+{
+  this->DeepCopy(src);
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::DeepCopy(vtkDataObject* src)
+{
+  this->Superclass::DeepCopy(src);
+  vtkOrientedSparseBinaryLabelmap* sourceLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(src);
+  if (!sourceLabelmap || sourceLabelmap == this)
+  {
+    return;
+  }
+  this->Internal->Tiles = sourceLabelmap->Internal->Tiles;
+  this->Internal->ImageToWorldMatrix->DeepCopy(sourceLabelmap->Internal->ImageToWorldMatrix);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkOrientedSparseBinaryLabelmap::GetActualMemorySize()
+{
+  size_t numberOfBytes = this->Internal->Tiles.bucket_count() * sizeof(void*)
+    + this->Internal->Tiles.size() * (sizeof(vtkInternal::TileMap::value_type) + 2 * sizeof(void*))
+    + this->GetNumberOfTiles(TileMixed) * ROWS_PER_TILE * sizeof(RowType);
+  return this->Superclass::GetActualMemorySize() + static_cast<unsigned long>((numberOfBytes + 1023) / 1024);
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::GetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  if (!mat)
+  {
+    return;
+  }
+  mat->DeepCopy(this->Internal->ImageToWorldMatrix);
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::SetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  if (!mat || vtkOrientedImageDataResample::IsEqual(mat, this->Internal->ImageToWorldMatrix))
+  {
+    return;
+  }
+  this->Internal->ImageToWorldMatrix->DeepCopy(mat);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::CopyGeometry(vtkOrientedImageData* image)
+{
+  if (!image)
+  {
+    return;
+  }
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  image->GetImageToWorldMatrix(imageToWorldMatrix);
+  this->SetImageToWorldMatrix(imageToWorldMatrix);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::IsGeometryMatching(vtkOrientedImageData* image)
+{
+  if (!image)
+  {
+    return false;
+  }
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  image->GetImageToWorldMatrix(imageToWorldMatrix);
+  return vtkOrientedImageDataResample::IsEqual(imageToWorldMatrix, this->Internal->ImageToWorldMatrix);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::SetFromImage(vtkOrientedImageData* image, double labelValue/*=1.0*/)
+{
+  if (!image)
+  {
+    vtkErrorMacro("SetFromImage: Invalid input image");
+    return false;
+  }
+  this->Internal->Tiles.clear();
+  this->CopyGeometry(image);
+  if (!image->IsEmpty() && image->GetPointData()->GetScalars())
+  {
+    switch (image->GetScalarType())
+    {
+      vtkTemplateMacro(SetTilesFromImageGeneric<VTK_TT>(image, labelValue, this->Internal->Tiles));
+      default:
+        vtkErrorMacro("SetFromImage: Unknown scalar type");
+        this->Modified();
+        return false;
+    }
+  }
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::GetImage(vtkOrientedImageData* image, double labelValue/*=1.0*/, const int extent[6]/*=nullptr*/)
+{
+  if (!image)
+  {
+    vtkErrorMacro("GetImage: Invalid output image");
+    return false;
+  }
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (extent)
+  {
+    std::copy(extent, extent + 6, outputExtent);
+  }
+  else
+  {
+    this->GetEffectiveExtent(outputExtent);
+  }
+
+  int scalarType = VTK_UNSIGNED_CHAR;
+  if (labelValue < VTK_UNSIGNED_CHAR_MIN || labelValue > VTK_UNSIGNED_CHAR_MAX)
+  {
+    scalarType = (labelValue >= VTK_SHORT_MIN && labelValue <= VTK_SHORT_MAX) ? VTK_SHORT : VTK_INT;
+  }
+
+  image->Initialize();
+  image->SetImageToWorldMatrix(this->Internal->ImageToWorldMatrix);
+  image->SetExtent(outputExtent);
+  image->AllocateScalars(scalarType, 1);
+  if (IsExtentEmpty(outputExtent))
+  {
+    return true;
+  }
+  vtkOrientedImageDataResample::FillImage(image, 0.0);
+  switch (scalarType)
+  {
+    vtkTemplateMacro(FillImageFromTilesGeneric<VTK_TT>(this->Internal->Tiles, image, labelValue));
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::ModifyImage(vtkOrientedImageData* modifierImage, int operation,
+  const int extent[6]/*=nullptr*/, double maskThreshold/*=0.0*/, double fillValue/*=1.0*/, bool* modified/*=nullptr*/)
+{
+  if (modified)
+  {
+    *modified = false;
+  }
+  if (!modifierImage || !modifierImage->GetPointData()->GetScalars())
+  {
+    vtkErrorMacro("ModifyImage: Invalid modifier image");
+    return false;
+  }
+  if (!this->IsGeometryMatching(modifierImage))
+  {
+    vtkWarningMacro("ModifyImage failed: geometry mismatch between labelmap and modifier image");
+    return false;
+  }
+
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  modifierImage->GetExtent(updateExtent);
+  if (extent)
+  {
+    IntersectExtent(updateExtent, extent, updateExtent);
+  }
+  if (IsExtentEmpty(updateExtent))
+  {
+    return true;
+  }
+
+  bool labelmapModified = false;
+  switch (modifierImage->GetScalarType())
+  {
+    vtkTemplateMacro(labelmapModified = ModifyTilesGeneric<VTK_TT>(this->Internal, modifierImage,
+      updateExtent, operation, maskThreshold, fillValue != 0.0));
+    default:
+      vtkErrorMacro("ModifyImage: Unknown scalar type");
+      return false;
+  }
+  if (labelmapModified)
+  {
+    this->Modified();
+  }
+  if (modified)
+  {
+    *modified = labelmapModified;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::FillExtent(const int extent[6], bool inside)
+{
+  if (!extent || IsExtentEmpty(extent))
+  {
+    return;
+  }
+  int tileRange[6] = { 0, -1, 0, -1, 0, -1 };
+  GetTileRange(extent, tileRange);
+
+  bool modified = false;
+  RowType noRows[ROWS_PER_TILE];
+  std::fill(noRows, noRows + ROWS_PER_TILE, RowType(0));
+  RowType selectedRows[ROWS_PER_TILE];
+  for (int tk = tileRange[4]; tk <= tileRange[5]; ++tk)
+  {
+    for (int tj = tileRange[2]; tj <= tileRange[3]; ++tj)
+    {
+      for (int ti = tileRange[0]; ti <= tileRange[1]; ++ti)
+      {
+        vtkTypeUInt64 key = GetTileKey(ti, tj, tk);
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        GetTileExtent(ti, tj, tk, tileExtent);
+        int voxelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtent(tileExtent, extent, voxelExtent);
+        if (std::equal(tileExtent, tileExtent + 6, voxelExtent))
+        {
+          // The whole tile is filled, no need to look at the voxels
+          vtkInternal::TileMap::iterator tileIt = this->Internal->Tiles.find(key);
+          if (inside && (tileIt == this->Internal->Tiles.end() || !tileIt->second.Rows.empty()))
+          {
+            this->Internal->Tiles[key].Rows = std::vector<RowType>();
+            modified = true;
+          }
+          else if (!inside && tileIt != this->Internal->Tiles.end())
+          {
+            this->Internal->Tiles.erase(tileIt);
+            modified = true;
+          }
+          continue;
+        }
+        std::fill(selectedRows, selectedRows + ROWS_PER_TILE, RowType(0));
+        RowType rowMask = GetRowMask(voxelExtent[0] - tileExtent[0], voxelExtent[1] - tileExtent[0]);
+        for (int k = voxelExtent[4]; k <= voxelExtent[5]; ++k)
+        {
+          for (int j = voxelExtent[2]; j <= voxelExtent[3]; ++j)
+          {
+            selectedRows[GetRowIndex(j, k, tileExtent)] = rowMask;
+          }
+        }
+        if (this->Internal->ModifyTile(key, inside ? selectedRows : noRows, inside ? noRows : selectedRows))
+        {
+          modified = true;
+        }
+      }
+    }
+  }
+  if (modified)
+  {
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::GetVoxel(int i, int j, int k)
+{
+  int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  GetTileExtent(GetTileIndex(i), GetTileIndex(j), GetTileIndex(k), tileExtent);
+  vtkInternal::TileMap::iterator tileIt = this->Internal->Tiles.find(
+    GetTileKey(GetTileIndex(i), GetTileIndex(j), GetTileIndex(k)));
+  if (tileIt == this->Internal->Tiles.end())
+  {
+    return false;
+  }
+  if (tileIt->second.Rows.empty())
+  {
+    return true;
+  }
+  return (tileIt->second.Rows[GetRowIndex(j, k, tileExtent)] >> (i - tileExtent[0])) & 1u;
+}
+
+//----------------------------------------------------------------------------
+void vtkOrientedSparseBinaryLabelmap::SetVoxel(int i, int j, int k, bool inside)
+{
+  int voxelExtent[6] = { i, i, j, j, k, k };
+  this->FillExtent(voxelExtent, inside);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::GetEffectiveExtent(int extent[6])
+{
+  int effectiveExtent[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+  for (const auto& keyAndTile : this->Internal->Tiles)
+  {
+    int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    GetTileExtentFromKey(keyAndTile.first, tileExtent);
+    int voxelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    const std::vector<RowType>& rows = keyAndTile.second.Rows;
+    if (rows.empty())
+    {
+      std::copy(tileExtent, tileExtent + 6, voxelExtent);
+    }
+    else
+    {
+      RowType allRows = 0;
+      voxelExtent[2] = tileExtent[3];
+      voxelExtent[3] = tileExtent[2];
+      voxelExtent[4] = tileExtent[5];
+      voxelExtent[5] = tileExtent[4];
+      for (int k = tileExtent[4]; k <= tileExtent[5]; ++k)
+      {
+        for (int j = tileExtent[2]; j <= tileExtent[3]; ++j)
+        {
+          RowType row = rows[GetRowIndex(j, k, tileExtent)];
+          if (!row)
+          {
+            continue;
+          }
+          allRows |= row;
+          voxelExtent[2] = std::min(voxelExtent[2], j);
+          voxelExtent[3] = std::max(voxelExtent[3], j);
+          voxelExtent[4] = std::min(voxelExtent[4], k);
+          voxelExtent[5] = std::max(voxelExtent[5], k);
+        }
+      }
+      int firstBit = 0;
+      while (!((allRows >> firstBit) & 1u))
+      {
+        ++firstBit;
+      }
+      int lastBit = TILE_SIZE - 1;
+      while (!((allRows >> lastBit) & 1u))
+      {
+        --lastBit;
+      }
+      voxelExtent[0] = tileExtent[0] + firstBit;
+      voxelExtent[1] = tileExtent[0] + lastBit;
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      effectiveExtent[axis * 2] = std::min(effectiveExtent[axis * 2], voxelExtent[axis * 2]);
+      effectiveExtent[axis * 2 + 1] = std::max(effectiveExtent[axis * 2 + 1], voxelExtent[axis * 2 + 1]);
+    }
+  }
+
+  if (this->Internal->Tiles.empty())
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      extent[axis * 2] = 0;
+      extent[axis * 2 + 1] = -1;
+    }
+    return false;
+  }
+  std::copy(effectiveExtent, effectiveExtent + 6, extent);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedSparseBinaryLabelmap::IsEmpty()
+{
+  // Tiles without voxels inside are never stored
+  return this->Internal->Tiles.empty();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkOrientedSparseBinaryLabelmap::GetNumberOfTiles(int state)
+{
+  if (state != TileFull && state != TileMixed)
+  {
+    return 0;
+  }
+  vtkIdType numberOfTiles = 0;
+  for (const auto& keyAndTile : this->Internal->Tiles)
+  {
+    if (keyAndTile.second.Rows.empty() == (state == TileFull))
+    {
+      ++numberOfTiles;
+    }
+  }
+  return numberOfTiles;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkOrientedSparseBinaryLabelmap::GetNumberOfVoxelsInside()
+{
+  vtkIdType numberOfVoxels = 0;
+  for (const auto& keyAndTile : this->Internal->Tiles)
+  {
+    if (keyAndTile.second.Rows.empty())
+    {
+      numberOfVoxels += VOXELS_PER_TILE;
+      continue;
+    }
+    for (RowType row : keyAndTile.second.Rows)
+    {
+      numberOfVoxels += CountBits(row);
+    }
+  }
+  return numberOfVoxels;
+}
@@ -0,0 +1,145 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkOrientedSparseBinaryLabelmap_h
+#define __vtkOrientedSparseBinaryLabelmap_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkDataObject.h>
+
+class vtkMatrix4x4;
+class vtkOrientedImageData;
+
+/// \brief Binary labelmap stored as a sparse set of tiles
+///
+/// The voxel grid is defined the same way as in vtkOrientedImageData (origin, spacing,
+/// and directions), but the extent is unbounded: voxels that are not stored are outside
+/// the segment. The grid is split into TileSize^3 voxel tiles. Tiles that contain only
+/// background voxels are not stored, tiles that are completely inside the segment are
+/// stored without voxel data, and only tiles on the boundary of the segment store one bit
+/// per voxel. Therefore memory usage and processing time is proportional to the surface
+/// of the segment instead of the volume of its bounding box.
+///
+/// Voxel values of a modifier image are interpreted the same way as in
+/// vtkOrientedImageDataResample::ModifyImage, with the labelmap voxel values being 0 (outside)
+/// or 1 (inside).
+///
+/// The sparse representation is not used by default, as segmentations store segments in
+/// shared binary labelmaps. It is recommended for segmentations that contain many small segments
+/// in a large volume. To use it, create the representation and make it the source representation:
+/// \code
+/// segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+/// segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+/// \endcode
+class vtkSegmentationCore_EXPORT vtkOrientedSparseBinaryLabelmap : public vtkDataObject
+{
+public:
+  static vtkOrientedSparseBinaryLabelmap* New();
+  vtkTypeMacro(vtkOrientedSparseBinaryLabelmap, vtkDataObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Number of voxels along each axis of a tile
+  enum
+  {
+    TileSize = 16
+  };
+
+  enum TileState
+  {
+    TileEmpty = 0,
+    TileFull,
+    TileMixed
+  };
+
+  /// Remove all voxels. Geometry is preserved.
+  void Initialize() override;
+
+  /// Copy content and geometry.
+  /// Tiles are not shared between objects, therefore shallow copy copies all voxels, too.
+  void ShallowCopy(vtkDataObject* src) override;
+  /// Copy content and geometry
+  void DeepCopy(vtkDataObject* src) override;
+
+  /// Return the memory used by this object in kibibytes
+  unsigned long GetActualMemorySize() override;
+
+  /// Get the geometry matrix that includes directions, spacing, and origin
+  void GetImageToWorldMatrix(vtkMatrix4x4* mat);
+  /// Set the directions, spacing, and origin from a matrix. Voxels are not resampled.
+  void SetImageToWorldMatrix(vtkMatrix4x4* mat);
+  /// Copy directions, spacing, and origin of an image. Voxels are not resampled.
+  void CopyGeometry(vtkOrientedImageData* image);
+  /// Returns true if the voxel grid of the image is the same as the voxel grid of this labelmap
+  bool IsGeometryMatching(vtkOrientedImageData* image);
+
+  /// Replace geometry and content by the voxels of an image that are equal to labelValue
+  /// \return Success flag
+  bool SetFromImage(vtkOrientedImageData* image, double labelValue = 1.0);
+
+  /// Create a dense image from the labelmap.
+  /// Voxels inside the segment are set to labelValue, other voxels are set to 0.
+  /// The scalar type is the smallest integer type that can store labelValue.
+  /// \param extent Extent of the output image. If not specified then the effective extent is used.
+  /// \return Success flag
+  bool GetImage(vtkOrientedImageData* image, double labelValue = 1.0, const int extent[6] = nullptr);
+
+  /// Combine the labelmap with a modifier image in-place, the same way as
+  /// vtkOrientedImageDataResample::ModifyImage. Only the tiles that the modifier image overlaps
+  /// are visited.
+  /// \param modifierImage Image that has the same geometry as this labelmap, its extent may be arbitrary
+  /// \param operation vtkOrientedImageDataResample::OPERATION_MINIMUM, OPERATION_MAXIMUM, or OPERATION_MASKING
+  /// \param extent If specified then only this extent of the modifier image is used
+  /// \param maskThreshold Modifier voxels above this value are set to fillValue in masking mode
+  /// \param fillValue Voxels are set inside if fillValue is non-zero in masking mode
+  /// \return Success flag
+  bool ModifyImage(vtkOrientedImageData* modifierImage, int operation, const int extent[6] = nullptr,
+    double maskThreshold = 0.0, double fillValue = 1.0, bool* modified = nullptr);
+
+  /// Set all voxels in the extent to inside or outside
+  void FillExtent(const int extent[6], bool inside);
+
+  /// Get/set a single voxel
+  bool GetVoxel(int i, int j, int k);
+  void SetVoxel(int i, int j, int k, bool inside);
+
+  /// Compute the extent of voxels that are inside the segment.
+  /// \return False if the labelmap is empty.
+  bool GetEffectiveExtent(int extent[6]);
+
+  /// Returns true if there are no voxels inside the segment
+  bool IsEmpty();
+
+  /// Get number of stored tiles in the specified state (TileFull or TileMixed)
+  vtkIdType GetNumberOfTiles(int state);
+
+  /// Get number of voxels inside the segment
+  vtkIdType GetNumberOfVoxelsInside();
+
+protected:
+  vtkOrientedSparseBinaryLabelmap();
+  ~vtkOrientedSparseBinaryLabelmap() override;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkOrientedSparseBinaryLabelmap(const vtkOrientedSparseBinaryLabelmap&) = delete;
+  void operator=(const vtkOrientedSparseBinaryLabelmap&) = delete;
+};
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
 #include "vtkCalculateOversamplingFactor.h"
 
 // VTK includes
@@ -40,6 +41,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSMPTools.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -166,6 +168,7 @@ void vtkSegmentation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "SourceRepresentationName:  " << this->SourceRepresentationName << "\n";
+  os << indent << "ParallelConversion:  " << (this->ParallelConversion ? "true" : "false") << "\n";
   os << indent << "Number of segments: " << this->Segments.size() << "\n";
   os << indent << "Segments:\n";
   for (std::deque< std::string >::iterator segmentIdIt = this->SegmentIds.begin();
@@ -953,6 +956,15 @@ void vtkSegmentation::ApplyLinearTransform(vtkAbstractTransform* transform)
     {
       vtkOrientedImageDataResample::TransformOrientedImage(currentSourceRepresentationOrientedImageData, linearTransform);
     }
+    // Sparse binary labelmap: only the geometry is changed, the same way as for oriented image data
+    else if (vtkOrientedSparseBinaryLabelmap::SafeDownCast(currentSourceRepresentation))
+    {
+      vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(currentSourceRepresentation);
+      vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+      sparseLabelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+      vtkMatrix4x4::Multiply4x4(linearTransform->GetMatrix(), imageToWorldMatrix, imageToWorldMatrix);
+      sparseLabelmap->SetImageToWorldMatrix(imageToWorldMatrix);
+    }
     else
     {
       vtkErrorMacro("ApplyLinearTransform: Representation data type '" << currentSourceRepresentation->GetClassName() << "' not supported!");
@@ -1006,6 +1018,15 @@ void vtkSegmentation::ApplyNonLinearTransform(vtkAbstractTransform* transform)
     {
       vtkOrientedImageDataResample::TransformOrientedImage(currentSourceRepresentationOrientedImageData, transform);
     }
+    // Sparse binary labelmap: resampled through a temporary image
+    else if (vtkOrientedSparseBinaryLabelmap::SafeDownCast(currentSourceRepresentation))
+    {
+      vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(currentSourceRepresentation);
+      vtkNew<vtkOrientedImageData> labelmap;
+      sparseLabelmap->GetImage(labelmap);
+      vtkOrientedImageDataResample::TransformOrientedImage(labelmap, transform);
+      sparseLabelmap->SetFromImage(labelmap);
+    }
     else
     {
       vtkErrorMacro("ApplyLinearTransform: Representation data type '" << currentSourceRepresentation->GetClassName() << "' not supported!");
@@ -1023,6 +1044,8 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
 
   // Execute each conversion step in the selected path
   int numberOfRules = (path == nullptr ? 0 : path->GetNumberOfRules());
+  double numberOfSteps = static_cast<double>(numberOfRules) * segmentIDs.size();
+  int numberOfCompletedSteps = 0;
   for (int ruleIndex = 0; ruleIndex < numberOfRules; ++ruleIndex)
   {
     vtkSegmentationConverterRule* currentConversionRule = path->GetRule(ruleIndex);
@@ -1031,9 +1054,9 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
       vtkErrorMacro("ConvertSegmentsUsingPath: Invalid converter rule!");
       return false;
     }
+    const char* targetRepresentationName = currentConversionRule->GetTargetRepresentationName();
 
-    // Perform conversion step
-    currentConversionRule->PreConvert(this);
+    std::vector<vtkSegment*> segmentsToConvert;
     for (auto segmentID : segmentIDs)
     {
       vtkSegment* segment = this->GetSegment(segmentID);
@@ -1048,18 +1071,78 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
       }
 
       // Get target representation
-      vtkSmartPointer<vtkDataObject> targetRepresentation = segment->GetRepresentation(
-        currentConversionRule->GetTargetRepresentationName());
+      vtkSmartPointer<vtkDataObject> targetRepresentation = segment->GetRepresentation(targetRepresentationName);
       // If target representation exists and we do not overwrite existing representations,
       // then no conversion is necessary with this conversion rule
       if (targetRepresentation.GetPointer() && !overwriteExisting)
       {
+        ++numberOfCompletedSteps;
         continue;
       }
-      currentConversionRule->Convert(segment);
+      segmentsToConvert.push_back(segment);
     }
-    currentConversionRule->PostConvert(this);
 
+    // Perform conversion step
+    currentConversionRule->PreConvertSegments(this, segmentsToConvert);
+    if (!this->ParallelConversion || !currentConversionRule->IsConvertThreadSafe() || segmentsToConvert.size() < 2)
+    {
+      for (vtkSegment* segment : segmentsToConvert)
+      {
+        currentConversionRule->Convert(segment);
+        double progress = ++numberOfCompletedSteps / numberOfSteps;
+        this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      }
+      currentConversionRule->PostConvert(this);
+      continue;
+    }
+
+    // Segments are converted in chunks. Each segment is converted into a temporary segment that
+    // shares the representations of the original segment, so that the original segments (and their
+    // observers) are only accessed from this thread, when the results are stored in segment order.
+    // Source representations may be shared by several segments (e.g., segments of the same labelmap
+    // layer), therefore thread-safe rules must not run pipelines directly on them.
+    int numberOfSegmentsToConvert = static_cast<int>(segmentsToConvert.size());
+    int chunkSize = std::max(1, 2 * vtkSMPTools::GetEstimatedNumberOfThreads());
+    for (int chunkStart = 0; chunkStart < numberOfSegmentsToConvert; chunkStart += chunkSize)
+    {
+      int chunkEnd = std::min(numberOfSegmentsToConvert, chunkStart + chunkSize);
+      std::vector<vtkSmartPointer<vtkSegment> > workSegments;
+      for (int segmentIndex = chunkStart; segmentIndex < chunkEnd; ++segmentIndex)
+      {
+        vtkSegment* segment = segmentsToConvert[segmentIndex];
+        vtkSmartPointer<vtkSegment> workSegment = vtkSmartPointer<vtkSegment>::New();
+        workSegment->DeepCopyMetadata(segment);
+        std::vector<std::string> representationNames;
+        segment->GetContainedRepresentationNames(representationNames);
+        for (const std::string& representationName : representationNames)
+        {
+          workSegment->AddRepresentation(representationName, segment->GetRepresentation(representationName));
+        }
+        workSegments.push_back(workSegment);
+      }
+
+      vtkSMPTools::For(0, static_cast<vtkIdType>(workSegments.size()), 1,
+        [&](vtkIdType begin, vtkIdType end)
+        {
+          for (vtkIdType workIndex = begin; workIndex < end; ++workIndex)
+          {
+            currentConversionRule->Convert(workSegments[workIndex]);
+          }
+        });
+
+      for (int segmentIndex = chunkStart; segmentIndex < chunkEnd; ++segmentIndex)
+      {
+        vtkDataObject* targetRepresentation = workSegments[segmentIndex - chunkStart]->GetRepresentation(targetRepresentationName);
+        if (targetRepresentation)
+        {
+          // Nothing happens if the target representation was updated in place
+          segmentsToConvert[segmentIndex]->AddRepresentation(targetRepresentationName, targetRepresentation);
+        }
+        double progress = ++numberOfCompletedSteps / numberOfSteps;
+        this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      }
+    }
+    currentConversionRule->PostConvert(this);
   }
 
   return true;
@@ -1099,7 +1182,7 @@ bool vtkSegmentation::ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentati
     }
 
     // Perform conversion step
-    currentConversionRule->PreConvert(this);
+    currentConversionRule->PreConvertSegments(this, std::vector<vtkSegment*>(1, segment));
     currentConversionRule->Convert(segment);
     currentConversionRule->PostConvert(this);
   }
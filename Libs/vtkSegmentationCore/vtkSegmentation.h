@@ -498,6 +498,13 @@ public:
   /// the segmentation! Use \sa CreateRepresentation for that.
   virtual void SetSourceRepresentationName(const std::string& representationName);
 
+  /// Convert multiple segments concurrently if the conversion rule allows it
+  /// (\sa vtkSegmentationConverterRule::IsConvertThreadSafe).
+  /// The result is the same as with sequential conversion. Enabled by default.
+  vtkGetMacro(ParallelConversion, bool);
+  vtkSetMacro(ParallelConversion, bool);
+  vtkBooleanMacro(ParallelConversion, bool);
+
   /// \deprecated Use SetSourceRepresentationName instead.
   virtual void SetMasterRepresentationName(const std::string& representationName)
   {
@@ -518,6 +525,15 @@ public:
     std::map<vtkDataObject*, vtkDataObject*>& cachedRepresentations);
 
 protected:
+  /// Convert given segments along a specified path.
+  /// Segments are converted concurrently if \sa ParallelConversion is enabled and the rule is thread-safe.
+  /// A vtkCommand::ProgressEvent is invoked after each converted segment, with the fraction of
+  /// completed conversion steps (double*) as call data. Events are always invoked from the calling thread.
+  /// \param segmentIDs Segments to convert
+  /// \param path Path to do the conversion along
+  /// \param overwriteExisting If true then do each conversion step regardless the target representation
+  ///   exists. If false then skip those conversion steps that would overwrite existing representation
+  /// \return Success flag
   bool ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConversionPath* path, bool overwriteExisting = false);
 
   /// Convert given segment along a specified path
@@ -589,6 +605,9 @@ protected:
   /// Modified events of segments are observed
   bool SegmentModifiedEnabled;
 
+  /// Convert segments concurrently if the conversion rule allows it
+  bool ParallelConversion{true};
+
   /// This number is incremented and used for generating the next
   /// segment ID.
   int SegmentIdAutogeneratorIndex;
@@ -55,6 +55,9 @@ public:
   static const char* GetSegmentationFractionalLabelmapRepresentationName() { return "Fractional labelmap"; };
   static const char* GetSegmentationPlanarContourRepresentationName()      { return "Planar contour"; };
   static const char* GetSegmentationClosedSurfaceRepresentationName()      { return "Closed surface"; };
+  /// Binary labelmap stored in tiles (vtkOrientedSparseBinaryLabelmap), one object per segment.
+  /// It is only used if it is set as source representation of the segmentation.
+  static const char* GetSegmentationSparseBinaryLabelmapRepresentationName() { return "Sparse binary labelmap"; };
   static const char* GetBinaryLabelmapRepresentationName()     { return GetSegmentationBinaryLabelmapRepresentationName(); };
   static const char* GetFractionalLabelmapRepresentationName() { return GetSegmentationFractionalLabelmapRepresentationName(); };
   static const char* GetPlanarContourRepresentationName()      { return GetSegmentationPlanarContourRepresentationName(); };
@@ -27,6 +27,9 @@
 #include <vtkNew.h>
 #include <vtkObject.h>
 
+// STD includes
+#include <vector>
+
 class vtkDataObject;
 class vtkSegmentation;
 class vtkSegment;
@@ -84,6 +87,13 @@ public:
   /// This step should be unnecessary if only converting a single segment
   virtual bool PreConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
 
+  /// Perform pre-conversion steps, knowing the segments that are converted before PostConvert is called.
+  /// Calls PreConvert by default.
+  virtual bool PreConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& vtkNotUsed(segmentsToConvert))
+  {
+    return this->PreConvert(segmentation);
+  };
+
   /// Update the target representation based on the source representation
   /// Initializes the target representation and calls ConvertInternal
   /// \sa ConvertInternal
@@ -93,6 +103,15 @@ public:
   /// This step should be unnecessary if only converting a single segment
   virtual bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
 
+  /// Return true if Convert may be called concurrently for different segments between
+  /// PreConvert and PostConvert. A thread-safe rule must only create or modify the target
+  /// representation of the segment it is called with, must not modify shared source
+  /// representations (this includes using them as pipeline input, which sets their
+  /// pipeline information; use a shallow copy instead), and must protect any state
+  /// that it shares between segments.
+  /// Rules are not thread-safe by default.
+  virtual bool IsConvertThreadSafe() { return false; };
+
   /// Get the cost of the conversion.
   /// \return Expected duration of the conversion in milliseconds. If the arguments are omitted, then a rough average can be
   ///   given just to indicate the relative computational cost of the algorithm. If the objects are given, then a more educated
@@ -20,16 +20,312 @@
 
 // SegmentationCore includes
 #include "vtkSegmentationHistory.h"
+#include "vtkOrientedImageData.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
-#include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
+#include <vtkTimeStamp.h>
 
 // std includes
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <set>
+
+//----------------------------------------------------------------------------
+struct vtkSegmentationHistory::LabelmapState
+{
+  /// Run-length encoded voxels of a brick, as a sequence of (vtkTypeUInt32 run length, voxel value) pairs.
+  /// Voxels are ordered the same way as in vtkImageData. Voxels that are outside the image extent are 0.
+  typedef std::vector<unsigned char> Brick;
+  typedef std::array<int, 3> BrickIndex;
+
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+  double ImageToWorldMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+  int ScalarType = VTK_UNSIGNED_CHAR;
+  int NumberOfScalarComponents = 1;
+  bool HasScalars = false;
+  /// Bricks that contain non-zero voxels. Bricks are shared between states if they are not modified.
+  std::map<BrickIndex, std::shared_ptr<const Brick> > Bricks;
+  /// Time when the state was saved. If the labelmap has not been modified since then, the state can be reused.
+  vtkTimeStamp SaveTime;
+};
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int FloorDivide(int value, int divisor)
+{
+  return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+//----------------------------------------------------------------------------
+/// Appends voxel values to a run-length encoded brick.
+/// Voxel values are referenced and not copied until the run is complete,
+/// therefore they must remain valid until Flush() is called.
+class BrickEncoder
+{
+public:
+  BrickEncoder(std::vector<unsigned char>& encoded, int elementSize)
+    : Encoded(encoded)
+    , ElementSize(elementSize)
+  {
+    this->Encoded.clear();
+  }
+
+  /// Add count voxels that all have the same value
+  void AddRun(const unsigned char* value, vtkTypeUInt32 count)
+  {
+    if (this->RunLength > 0 && memcmp(value, this->RunValue, this->ElementSize) == 0)
+    {
+      this->RunLength += count;
+      return;
+    }
+    this->Flush();
+    this->RunValue = value;
+    this->RunLength = count;
+  }
+
+  /// Add count consecutive voxels
+  void AddVoxels(const unsigned char* values, int count)
+  {
+    int runStart = 0;
+    for (int i = 1; i <= count; ++i)
+    {
+      if (i == count || memcmp(values + i * this->ElementSize, values + runStart * this->ElementSize, this->ElementSize) != 0)
+      {
+        this->AddRun(values + runStart * this->ElementSize, i - runStart);
+        runStart = i;
+      }
+    }
+  }
+
+  void Flush()
+  {
+    if (this->RunLength == 0)
+    {
+      return;
+    }
+    size_t position = this->Encoded.size();
+    this->Encoded.resize(position + sizeof(vtkTypeUInt32) + this->ElementSize);
+    memcpy(this->Encoded.data() + position, &this->RunLength, sizeof(vtkTypeUInt32));
+    memcpy(this->Encoded.data() + position + sizeof(vtkTypeUInt32), this->RunValue, this->ElementSize);
+    this->RunLength = 0;
+  }
+
+protected:
+  std::vector<unsigned char>& Encoded;
+  int ElementSize;
+  const unsigned char* RunValue = nullptr;
+  vtkTypeUInt32 RunLength = 0;
+};
+
+//----------------------------------------------------------------------------
+/// Get voxel range of a brick along one axis and its intersection with the image extent
+void GetBrickRange(int brickIndex, int extentMin, int extentMax, int& brickMin, int& brickMax, int& insideMin, int& insideMax)
+{
+  brickMin = brickIndex * vtkSegmentationHistory::BrickSize;
+  brickMax = brickMin + vtkSegmentationHistory::BrickSize - 1;
+  insideMin = std::max(brickMin, extentMin);
+  insideMax = std::min(brickMax, extentMax);
+}
+
+//----------------------------------------------------------------------------
+void EncodeBrick(const unsigned char* scalars, const int extent[6], int elementSize, const std::array<int, 3>& brickIndex,
+  const unsigned char* zeroValue, std::vector<unsigned char>& encoded)
+{
+  int brickMin[3] = { 0 };
+  int brickMax[3] = { 0 };
+  int insideMin[3] = { 0 };
+  int insideMax[3] = { 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    GetBrickRange(brickIndex[axis], extent[axis * 2], extent[axis * 2 + 1],
+      brickMin[axis], brickMax[axis], insideMin[axis], insideMax[axis]);
+  }
+  const vtkIdType rowIncrement = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * elementSize;
+  const vtkIdType sliceIncrement = rowIncrement * (extent[3] - extent[2] + 1);
+
+  BrickEncoder encoder(encoded, elementSize);
+  for (int k = brickMin[2]; k <= brickMax[2]; ++k)
+  {
+    for (int j = brickMin[1]; j <= brickMax[1]; ++j)
+    {
+      if (k < insideMin[2] || k > insideMax[2] || j < insideMin[1] || j > insideMax[1])
+      {
+        encoder.AddRun(zeroValue, vtkSegmentationHistory::BrickSize);
+        continue;
+      }
+      if (insideMin[0] > brickMin[0])
+      {
+        encoder.AddRun(zeroValue, insideMin[0] - brickMin[0]);
+      }
+      const unsigned char* row = scalars + (k - extent[4]) * sliceIncrement + (j - extent[2]) * rowIncrement
+        + static_cast<vtkIdType>(insideMin[0] - extent[0]) * elementSize;
+      encoder.AddVoxels(row, insideMax[0] - insideMin[0] + 1);
+      if (brickMax[0] > insideMax[0])
+      {
+        encoder.AddRun(zeroValue, brickMax[0] - insideMax[0]);
+      }
+    }
+  }
+  encoder.Flush();
+}
+
+//----------------------------------------------------------------------------
+bool IsZeroValue(const unsigned char* value, int elementSize)
+{
+  return std::all_of(value, value + elementSize, [](unsigned char c) { return c == 0; });
+}
+
+//----------------------------------------------------------------------------
+/// Check if voxels of a brick are the same as the voxels of a run-length encoded brick.
+/// The image is compared row by row to the runs, without encoding the voxels.
+/// If encoded is nullptr then the brick is compared to a brick that contains only zero voxels.
+bool IsBrickEqual(const unsigned char* scalars, const int extent[6], int elementSize, const std::array<int, 3>& brickIndex,
+  const std::vector<unsigned char>* encoded, const unsigned char* zeroValue)
+{
+  int brickMin[3] = { 0 };
+  int brickMax[3] = { 0 };
+  int insideMin[3] = { 0 };
+  int insideMax[3] = { 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    GetBrickRange(brickIndex[axis], extent[axis * 2], extent[axis * 2 + 1],
+      brickMin[axis], brickMax[axis], insideMin[axis], insideMax[axis]);
+  }
+  const vtkIdType rowIncrement = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * elementSize;
+  const vtkIdType sliceIncrement = rowIncrement * (extent[3] - extent[2] + 1);
+  const int brickSize = vtkSegmentationHistory::BrickSize;
+
+  size_t position = 0;
+  const unsigned char* runValue = zeroValue;
+  vtkTypeUInt32 runRemaining = encoded ? 0 : static_cast<vtkTypeUInt32>(brickSize * brickSize * brickSize);
+  // Check if the next count voxels match the runs. If voxels is nullptr then the voxels are zero.
+  auto compareVoxels = [&](const unsigned char* voxels, vtkTypeUInt32 count)
+  {
+    while (count > 0)
+    {
+      if (runRemaining == 0)
+      {
+        if (!encoded || position + sizeof(vtkTypeUInt32) + elementSize > encoded->size())
+        {
+          return false;
+        }
+        memcpy(&runRemaining, encoded->data() + position, sizeof(vtkTypeUInt32));
+        runValue = encoded->data() + position + sizeof(vtkTypeUInt32);
+        position += sizeof(vtkTypeUInt32) + elementSize;
+        continue;
+      }
+      vtkTypeUInt32 compareCount = std::min(count, runRemaining);
+      if (voxels)
+      {
+        // All voxels are equal to the run value if the first voxel is equal to the run value
+        // and each voxel is equal to the next one.
+        if (memcmp(voxels, runValue, elementSize) != 0
+          || memcmp(voxels, voxels + elementSize, static_cast<size_t>(compareCount - 1) * elementSize) != 0)
+        {
+          return false;
+        }
+        voxels += static_cast<size_t>(compareCount) * elementSize;
+      }
+      else if (!IsZeroValue(runValue, elementSize))
+      {
+        return false;
+      }
+      runRemaining -= compareCount;
+      count -= compareCount;
+    }
+    return true;
+  };
+
+  for (int k = brickMin[2]; k <= brickMax[2]; ++k)
+  {
+    for (int j = brickMin[1]; j <= brickMax[1]; ++j)
+    {
+      if (k < insideMin[2] || k > insideMax[2] || j < insideMin[1] || j > insideMax[1])
+      {
+        if (!compareVoxels(nullptr, brickSize))
+        {
+          return false;
+        }
+        continue;
+      }
+      const unsigned char* row = scalars + (k - extent[4]) * sliceIncrement + (j - extent[2]) * rowIncrement
+        + static_cast<vtkIdType>(insideMin[0] - extent[0]) * elementSize;
+      if ((insideMin[0] > brickMin[0] && !compareVoxels(nullptr, insideMin[0] - brickMin[0]))
+        || !compareVoxels(row, insideMax[0] - insideMin[0] + 1)
+        || (brickMax[0] > insideMax[0] && !compareVoxels(nullptr, brickMax[0] - insideMax[0])))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool IsZeroBrick(const std::vector<unsigned char>& encoded, int elementSize)
+{
+  return encoded.size() == sizeof(vtkTypeUInt32) + elementSize
+    && IsZeroValue(encoded.data() + sizeof(vtkTypeUInt32), elementSize);
+}
+
+//----------------------------------------------------------------------------
+/// Write voxels of an encoded brick into an image that is initialized to 0
+void DecodeBrick(const std::vector<unsigned char>& encoded, unsigned char* scalars, const int extent[6], int elementSize,
+  const std::array<int, 3>& brickIndex)
+{
+  int brickMin[3] = { 0 };
+  int brickMax[3] = { 0 };
+  int insideMin[3] = { 0 };
+  int insideMax[3] = { 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    GetBrickRange(brickIndex[axis], extent[axis * 2], extent[axis * 2 + 1],
+      brickMin[axis], brickMax[axis], insideMin[axis], insideMax[axis]);
+  }
+  const vtkIdType rowIncrement = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * elementSize;
+  const vtkIdType sliceIncrement = rowIncrement * (extent[3] - extent[2] + 1);
+  const int brickSize = vtkSegmentationHistory::BrickSize;
+
+  vtkIdType voxelIndex = 0; // index of the voxel within the brick
+  size_t position = 0;
+  while (position + sizeof(vtkTypeUInt32) + elementSize <= encoded.size())
+  {
+    vtkTypeUInt32 runLength = 0;
+    memcpy(&runLength, encoded.data() + position, sizeof(vtkTypeUInt32));
+    const unsigned char* value = encoded.data() + position + sizeof(vtkTypeUInt32);
+    position += sizeof(vtkTypeUInt32) + elementSize;
+    if (IsZeroValue(value, elementSize))
+    {
+      // image is already initialized to 0
+      voxelIndex += runLength;
+      continue;
+    }
+    for (vtkTypeUInt32 runIndex = 0; runIndex < runLength; ++runIndex, ++voxelIndex)
+    {
+      int i = brickMin[0] + static_cast<int>(voxelIndex % brickSize);
+      int j = brickMin[1] + static_cast<int>((voxelIndex / brickSize) % brickSize);
+      int k = brickMin[2] + static_cast<int>(voxelIndex / (brickSize * brickSize));
+      if (i < insideMin[0] || i > insideMax[0] || j < insideMin[1] || j > insideMax[1] || k < insideMin[2] || k > insideMax[2])
+      {
+        continue;
+      }
+      memcpy(scalars + (k - extent[4]) * sliceIncrement + (j - extent[2]) * rowIncrement
+        + static_cast<vtkIdType>(i - extent[0]) * elementSize, value, elementSize);
+    }
+  }
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -40,6 +336,7 @@ vtkSegmentationHistory::vtkSegmentationHistory()
   this->Segmentation = nullptr;
 
   this->MaximumNumberOfStates = 5;
+  this->MaximumMemorySize = 1024 * 1024 * 1024;
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
@@ -98,6 +395,9 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "MaximumNumberOfStates:  " << this->MaximumNumberOfStates << "\n";
+  os << indent << "MaximumMemorySize:  " << this->MaximumMemorySize << "\n";
+  os << indent << "Memory size:  " << this->GetMemorySize() << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -130,6 +430,7 @@ bool vtkSegmentationHistory::SaveState()
   this->Segmentation->GetSegmentIDs(segmentIDs);
   newSegmentationState.SegmentIds = segmentIDs;
   std::map<vtkDataObject*, vtkDataObject*> savedObjects;
+  std::map<vtkDataObject*, std::shared_ptr<LabelmapState> > savedLabelmaps;
   for (std::vector<std::string>::iterator segmentIDIt = segmentIDs.begin(); segmentIDIt != segmentIDs.end(); ++segmentIDIt)
   {
     vtkSegment* segment = this->Segmentation->GetSegment(*segmentIDIt);
@@ -141,17 +442,66 @@ bool vtkSegmentationHistory::SaveState()
     // Previous saved state of the segment
     // (if the new state has exactly the same representation then only a shallow copy will be made)
     vtkSegment* baselineSegment = nullptr;
+    LabelmapStatesMap* baselineLabelmaps = nullptr;
     if (this->SegmentationStates.size() > 0)
     {
-      SegmentsMap::iterator baselineSegmentIt = this->SegmentationStates.back().Segments.find(*segmentIDIt);
-      if (baselineSegmentIt != this->SegmentationStates.back().Segments.end())
+      SegmentationState& baselineState = this->SegmentationStates.back();
+      SegmentsMap::iterator baselineSegmentIt = baselineState.Segments.find(*segmentIDIt);
+      if (baselineSegmentIt != baselineState.Segments.end())
       {
         baselineSegment = baselineSegmentIt->second.GetPointer();
       }
+      std::map<std::string, LabelmapStatesMap>::iterator baselineLabelmapsIt = baselineState.Labelmaps.find(*segmentIDIt);
+      if (baselineLabelmapsIt != baselineState.Labelmaps.end())
+      {
+        baselineLabelmaps = &(baselineLabelmapsIt->second);
+      }
+    }
+
+    // Labelmaps are stored as bricks, only the other representations are copied
+    vtkNew<vtkSegment> segmentWithoutLabelmaps;
+    segmentWithoutLabelmaps->DeepCopyMetadata(segment);
+    std::vector<std::string> representationNames;
+    segment->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+    {
+      vtkDataObject* representation = segment->GetRepresentation(representationName);
+      vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(representation);
+      if (!labelmap)
+      {
+        segmentWithoutLabelmaps->AddRepresentation(representationName, representation);
+        continue;
+      }
+      std::shared_ptr<LabelmapState> labelmapState;
+      std::map<vtkDataObject*, std::shared_ptr<LabelmapState> >::iterator savedLabelmapIt = savedLabelmaps.find(labelmap);
+      if (savedLabelmapIt != savedLabelmaps.end())
+      {
+        // Shared labelmap has already been saved for a previous segment
+        labelmapState = savedLabelmapIt->second;
+      }
+      else
+      {
+        std::shared_ptr<LabelmapState> baselineLabelmapState;
+        if (baselineLabelmaps && baselineLabelmaps->find(representationName) != baselineLabelmaps->end())
+        {
+          baselineLabelmapState = (*baselineLabelmaps)[representationName];
+        }
+        if (baselineLabelmapState && baselineLabelmapState->SaveTime.GetMTime() > labelmap->GetMTime())
+        {
+          // we already have an up-to-date copy in the baseline, so reuse that
+          labelmapState = baselineLabelmapState;
+        }
+        else
+        {
+          labelmapState = vtkSegmentationHistory::SaveLabelmapState(labelmap, baselineLabelmapState.get());
+        }
+        savedLabelmaps[labelmap] = labelmapState;
+      }
+      newSegmentationState.Labelmaps[*segmentIDIt][representationName] = labelmapState;
     }
 
     vtkSmartPointer<vtkSegment> segmentClone = vtkSmartPointer<vtkSegment>::New();
-    vtkSegmentation::CopySegment(segmentClone, segment, baselineSegment, savedObjects);
+    vtkSegmentation::CopySegment(segmentClone, segmentWithoutLabelmaps, baselineSegment, savedObjects);
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
   }
   this->SegmentationStates.push_back(newSegmentationState);
@@ -226,6 +576,7 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
+  std::map<LabelmapState*, vtkSmartPointer<vtkOrientedImageData> > restoredLabelmaps;
   for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
     restoredSegmentsIt != restoredState.Segments.end(); ++restoredSegmentsIt)
   {
@@ -238,8 +589,14 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
       this->Segmentation->AddSegment(segment, restoredSegmentsIt->first);
     }
 
+    LabelmapStatesMap& labelmapStates = restoredState.Labelmaps[restoredSegmentsIt->first];
     std::vector<std::string> restoredRepresentationNames;
     segmentToRestore->GetContainedRepresentationNames(restoredRepresentationNames);
+    for (LabelmapStatesMap::iterator labelmapStateIt = labelmapStates.begin(); labelmapStateIt != labelmapStates.end(); ++labelmapStateIt)
+    {
+      restoredRepresentationNames.push_back(labelmapStateIt->first);
+    }
+    std::sort(restoredRepresentationNames.begin(), restoredRepresentationNames.end());
     std::vector<std::string> currentRepresentationNames;
     segment->GetContainedRepresentationNames(currentRepresentationNames);
     if (restoredRepresentationNames != currentRepresentationNames)
@@ -248,6 +605,17 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
     }
 
     vtkSegmentation::CopySegment(segment, segmentToRestore, nullptr, restoredRepresentations);
+    for (LabelmapStatesMap::iterator labelmapStateIt = labelmapStates.begin(); labelmapStateIt != labelmapStates.end(); ++labelmapStateIt)
+    {
+      // If the labelmap is shared between segments then restore it only once
+      vtkSmartPointer<vtkOrientedImageData>& labelmap = restoredLabelmaps[labelmapStateIt->second.get()];
+      if (!labelmap)
+      {
+        labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+        vtkSegmentationHistory::RestoreLabelmapState(labelmapStateIt->second.get(), labelmap);
+      }
+      segment->AddRepresentation(labelmapStateIt->first, labelmap);
+    }
 
     // Remove representations that are not in the restoring segment
     for (std::string representationName : currentRepresentationNames)
@@ -329,6 +697,23 @@ void vtkSegmentationHistory::RemoveAllObsoleteStates()
     this->LastRestoredState--;
     modified = true;
   }
+  // The most recent state and the last restored state are always kept.
+  if (this->MaximumMemorySize > 0 && this->SegmentationStates.size() > 1 && this->LastRestoredState > 0)
+  {
+    vtkTypeUInt64 memorySize = this->GetMemorySize();
+    while (this->SegmentationStates.size() > 1 && this->LastRestoredState > 0 && memorySize > this->MaximumMemorySize)
+    {
+      // Data is only shared with the previous or next state, therefore removing the oldest state
+      // releases the data that is not used by the second oldest state.
+      std::set<const void*> countedObjects;
+      vtkSegmentationHistory::GetStateMemorySize(this->SegmentationStates[1], countedObjects);
+      vtkTypeUInt64 removedMemorySize = vtkSegmentationHistory::GetStateMemorySize(this->SegmentationStates[0], countedObjects);
+      memorySize -= std::min(memorySize, removedMemorySize);
+      this->SegmentationStates.pop_front();
+      this->LastRestoredState--;
+      modified = true;
+    }
+  }
   if (modified)
   {
     this->Modified();
@@ -347,6 +732,163 @@ void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumber
   this->Modified();
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetMaximumMemorySize(vtkTypeUInt64 maximumMemorySize)
+{
+  if (maximumMemorySize == this->MaximumMemorySize)
+  {
+    return;
+  }
+  this->MaximumMemorySize = maximumMemorySize;
+  this->RemoveAllObsoleteStates();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkTypeUInt64 vtkSegmentationHistory::GetMemorySize()
+{
+  vtkTypeUInt64 memorySize = 0;
+  std::set<const void*> countedObjects;
+  for (SegmentationState& state : this->SegmentationStates)
+  {
+    memorySize += vtkSegmentationHistory::GetStateMemorySize(state, countedObjects);
+  }
+  return memorySize;
+}
+
+//---------------------------------------------------------------------------
+vtkTypeUInt64 vtkSegmentationHistory::GetStateMemorySize(SegmentationState& state, std::set<const void*>& countedObjects)
+{
+  vtkTypeUInt64 memorySize = 0;
+  for (SegmentsMap::iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+  {
+    std::vector<std::string> representationNames;
+    segmentIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+    {
+      vtkDataObject* representation = segmentIt->second->GetRepresentation(representationName);
+      if (representation && countedObjects.insert(representation).second)
+      {
+        // GetActualMemorySize returns kibibytes
+        memorySize += static_cast<vtkTypeUInt64>(representation->GetActualMemorySize()) * 1024;
+      }
+    }
+  }
+  for (std::map<std::string, LabelmapStatesMap>::iterator segmentIt = state.Labelmaps.begin(); segmentIt != state.Labelmaps.end(); ++segmentIt)
+  {
+    for (LabelmapStatesMap::iterator labelmapStateIt = segmentIt->second.begin(); labelmapStateIt != segmentIt->second.end(); ++labelmapStateIt)
+    {
+      LabelmapState* labelmapState = labelmapStateIt->second.get();
+      if (!countedObjects.insert(labelmapState).second)
+      {
+        continue;
+      }
+      memorySize += sizeof(LabelmapState);
+      for (auto& brickIt : labelmapState->Bricks)
+      {
+        if (countedObjects.insert(brickIt.second.get()).second)
+        {
+          memorySize += sizeof(LabelmapState::Brick) + brickIt.second->capacity();
+        }
+      }
+    }
+  }
+  return memorySize;
+}
+
+//---------------------------------------------------------------------------
+std::shared_ptr<vtkSegmentationHistory::LabelmapState> vtkSegmentationHistory::SaveLabelmapState(
+  vtkOrientedImageData* labelmap, LabelmapState* baseline)
+{
+  std::shared_ptr<LabelmapState> labelmapState = std::make_shared<LabelmapState>();
+  labelmap->GetExtent(labelmapState->Extent);
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  labelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+  vtkMatrix4x4::DeepCopy(labelmapState->ImageToWorldMatrix, imageToWorldMatrix);
+  labelmapState->ScalarType = labelmap->GetScalarType();
+  labelmapState->NumberOfScalarComponents = labelmap->GetNumberOfScalarComponents();
+  labelmapState->HasScalars = (labelmap->GetPointData()->GetScalars() != nullptr);
+  labelmapState->SaveTime.Modified();
+
+  const int* extent = labelmapState->Extent;
+  if (!labelmapState->HasScalars || extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+  {
+    return labelmapState;
+  }
+
+  // Bricks of the baseline can only be reused if they are stored on the same voxel grid
+  bool baselineBricksReusable = baseline && baseline->HasScalars
+    && baseline->ScalarType == labelmapState->ScalarType
+    && baseline->NumberOfScalarComponents == labelmapState->NumberOfScalarComponents
+    && std::equal(baseline->ImageToWorldMatrix, baseline->ImageToWorldMatrix + 16, labelmapState->ImageToWorldMatrix);
+
+  const int elementSize = labelmap->GetScalarSize() * labelmapState->NumberOfScalarComponents;
+  const unsigned char* scalars = static_cast<const unsigned char*>(labelmap->GetScalarPointer());
+  std::vector<unsigned char> zeroValue(elementSize, 0);
+  std::vector<unsigned char> encoded;
+  LabelmapState::BrickIndex brickIndex;
+  for (brickIndex[2] = FloorDivide(extent[4], BrickSize); brickIndex[2] <= FloorDivide(extent[5], BrickSize); ++brickIndex[2])
+  {
+    for (brickIndex[1] = FloorDivide(extent[2], BrickSize); brickIndex[1] <= FloorDivide(extent[3], BrickSize); ++brickIndex[1])
+    {
+      for (brickIndex[0] = FloorDivide(extent[0], BrickSize); brickIndex[0] <= FloorDivide(extent[1], BrickSize); ++brickIndex[0])
+      {
+        // Unchanged and empty bricks are detected by comparing rows of voxels, only modified bricks are encoded
+        std::shared_ptr<const LabelmapState::Brick> baselineBrick;
+        if (baselineBricksReusable)
+        {
+          auto baselineBrickIt = baseline->Bricks.find(brickIndex);
+          if (baselineBrickIt != baseline->Bricks.end())
+          {
+            baselineBrick = baselineBrickIt->second;
+          }
+        }
+        if (IsBrickEqual(scalars, extent, elementSize, brickIndex, baselineBrick.get(), zeroValue.data()))
+        {
+          if (baselineBrick)
+          {
+            labelmapState->Bricks[brickIndex] = baselineBrick;
+          }
+          continue;
+        }
+        EncodeBrick(scalars, extent, elementSize, brickIndex, zeroValue.data(), encoded);
+        if (IsZeroBrick(encoded, elementSize))
+        {
+          continue;
+        }
+        labelmapState->Bricks[brickIndex] = std::make_shared<const LabelmapState::Brick>(encoded);
+      }
+    }
+  }
+  return labelmapState;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::RestoreLabelmapState(LabelmapState* labelmapState, vtkOrientedImageData* labelmap)
+{
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  imageToWorldMatrix->DeepCopy(labelmapState->ImageToWorldMatrix);
+  labelmap->SetImageToWorldMatrix(imageToWorldMatrix);
+  labelmap->SetExtent(labelmapState->Extent);
+  if (!labelmapState->HasScalars)
+  {
+    return;
+  }
+  labelmap->AllocateScalars(labelmapState->ScalarType, labelmapState->NumberOfScalarComponents);
+  const int* extent = labelmapState->Extent;
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+  {
+    return;
+  }
+  const int elementSize = labelmap->GetScalarSize() * labelmapState->NumberOfScalarComponents;
+  unsigned char* scalars = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+  memset(scalars, 0, static_cast<size_t>(labelmap->GetNumberOfPoints()) * elementSize);
+  for (auto& brickIt : labelmapState->Bricks)
+  {
+    DecodeBrick(*(brickIt.second), scalars, extent, elementSize, brickIt.first);
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller),
   unsigned long vtkNotUsed(eid),
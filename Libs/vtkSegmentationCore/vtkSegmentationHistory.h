@@ -28,15 +28,26 @@
 // STD includes
 #include <deque>
 #include <map>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "vtkSegmentationCoreConfigure.h"
 
 class vtkCallbackCommand;
 class vtkDataObject;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
 
+/// \brief Stores previous states of a segmentation to allow undo/redo
+///
+/// Binary labelmap representations are not copied as a whole. Each labelmap is split into
+/// BrickSize^3 voxel bricks (aligned to the voxel grid, not to the image extent) and each brick
+/// is stored run-length encoded. Bricks that do not differ from the brick of the previous state
+/// are shared between states, and bricks that contain only zero voxels are not stored at all.
+/// Therefore a state only takes memory proportional to the region that has been changed since the
+/// previous state was saved.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -85,6 +96,24 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// Limits how much memory (in bytes) the stored states may use.
+  /// If the limit is exceeded then the oldest states are removed. The most recent state is always kept.
+  /// 0 means there is no limit. Default is 1 GiB.
+  void SetMaximumMemorySize(vtkTypeUInt64 maximumMemorySize);
+
+  /// Get the limit of how much memory (in bytes) the stored states may use.
+  vtkGetMacro(MaximumMemorySize, vtkTypeUInt64);
+
+  /// Get the memory (in bytes) used by all the stored states.
+  /// Data that is shared between states is only counted once.
+  vtkTypeUInt64 GetMemorySize();
+
+  /// Number of voxels along each axis of a labelmap brick
+  enum
+  {
+    BrickSize = 32
+  };
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -94,6 +123,7 @@ protected:
   void RemoveAllNextStates();
 
   /// Delete all old states so that we keep only up to MaximumNumberOfStates states
+  /// and the stored states do not use more than MaximumMemorySize bytes.
   void RemoveAllObsoleteStates();
 
   /// Restores a state defined by stateIndex.
@@ -105,16 +135,37 @@ protected:
 
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
 
+  /// Compressed copy of a binary labelmap representation (defined in the implementation file)
+  struct LabelmapState;
+  /// Labelmap states of a segment, indexed by representation name
+  typedef std::map<std::string, std::shared_ptr<LabelmapState> > LabelmapStatesMap;
+
   struct SegmentationState
   {
+    /// Segments without their labelmap representations
     SegmentsMap Segments;
+    /// Labelmap representations of the segments, indexed by segment ID.
+    /// If multiple segments share the same labelmap then they share the same labelmap state, too.
+    std::map<std::string, LabelmapStatesMap> Labelmaps;
     std::vector<std::string> SegmentIds; // order of segments
   };
 
+  /// Get the memory (in bytes) used by the data of the state that is not in countedObjects.
+  /// Counted data objects are added to countedObjects.
+  static vtkTypeUInt64 GetStateMemorySize(SegmentationState& state, std::set<const void*>& countedObjects);
+
+  /// Create a compressed copy of a labelmap.
+  /// Bricks that have not changed compared to the baseline are shared with the baseline.
+  static std::shared_ptr<LabelmapState> SaveLabelmapState(vtkOrientedImageData* labelmap, LabelmapState* baseline);
+
+  /// Create a labelmap from its compressed copy
+  static void RestoreLabelmapState(LabelmapState* labelmapState, vtkOrientedImageData* labelmap);
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
   unsigned int MaximumNumberOfStates;
+  vtkTypeUInt64 MaximumMemorySize;
 
   // Index of the state in SegmentationStates that was restored last.
   // If LastRestoredState == size of states then it means that the segmentation has changed
@@ -21,6 +21,7 @@
 // SegmentationCore includes
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
 #include "vtkSegmentation.h"
 #include "vtkSegmentationConverter.h"
 #include "vtkSegmentationModifier.h"
@@ -28,8 +29,11 @@
 // VTK includes
 #include <vtkImageConstantPad.h>
 #include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSmartPointer.h>
 
 // STD includes
 #include <algorithm>
@@ -59,6 +63,43 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
     return false;
   }
 
+  if (segmentation->GetSourceRepresentationName() == vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName())
+  {
+    // Sparse labelmaps are not shared between segments, so there is no need to separate layers or to update other segments
+    if (modifiedSegmentIDs)
+    {
+      modifiedSegmentIDs->clear();
+    }
+    bool wasSourceRepresentationModifiedEnabled = segmentation->SetSourceRepresentationModifiedEnabled(sourceRepresentationModifiedEnabled);
+    bool segmentLabelmapModified = false;
+    std::vector<std::string> overwrittenSegmentIDs;
+    bool success = vtkSegmentationModifier::AppendLabelmapToSparseSegment(labelmap, segmentation, segmentID, mergeMode, extent,
+      segmentLabelmapModified)
+      && vtkSegmentationModifier::OverwriteSparseSegments(labelmap, segmentation, segmentID, mergeMode, extent,
+        minimumOfAllSegments, segmentIDsToOverwrite, overwrittenSegmentIDs);
+    segmentation->SetSourceRepresentationModifiedEnabled(wasSourceRepresentationModifiedEnabled);
+    if (!success)
+    {
+      return false;
+    }
+    if (modifiedSegmentIDs)
+    {
+      modifiedSegmentIDs->push_back(segmentID);
+      modifiedSegmentIDs->insert(modifiedSegmentIDs->end(), overwrittenSegmentIDs.begin(), overwrittenSegmentIDs.end());
+    }
+    if (segmentLabelmapModified)
+    {
+      overwrittenSegmentIDs.insert(overwrittenSegmentIDs.begin(), segmentID);
+    }
+    for (const std::string& modifiedSegmentID : overwrittenSegmentIDs)
+    {
+      const char* segmentIdChar = modifiedSegmentID.c_str();
+      segmentation->InvokeEvent(vtkSegmentation::SourceRepresentationModified, (void*)segmentIdChar);
+      segmentation->InvokeEvent(vtkSegmentation::RepresentationModified, (void*)segmentIdChar);
+    }
+    return true;
+  }
+
   // If there are segments on the same layer that we should not overwrite, determine if there are any under the modifier labelmap
   if (vtkSegmentationModifier::SharedLabelmapShouldOverlap(segmentation, segmentID, segmentIDsToOverwrite))
   {
@@ -442,6 +483,158 @@ bool vtkSegmentationModifier::AppendLabelmapToSegment(vtkOrientedImageData* labe
     return true;
 }
 
+//-----------------------------------------------------------------------------
+bool vtkSegmentationModifier::AppendLabelmapToSparseSegment(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
+  int mergeMode, const int extent[6], bool& segmentLabelmapModified)
+{
+  segmentLabelmapModified = false;
+  vtkSegment* selectedSegment = segmentation->GetSegment(segmentID);
+  if (!selectedSegment)
+  {
+    vtkGenericWarningMacro("vtkSegmentationModifier::AppendLabelmapToSparseSegment: Invalid selected segment");
+    return false;
+  }
+  vtkOrientedSparseBinaryLabelmap* segmentLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+    selectedSegment->GetRepresentation(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName()));
+  if (!segmentLabelmap)
+  {
+    vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::AppendLabelmapToSparseSegment: Failed to get sparse binary labelmap "
+      << "representation in segmentation");
+    return false;
+  }
+
+  bool segmentLabelmapWasEmpty = segmentLabelmap->IsEmpty();
+  if (segmentLabelmapWasEmpty && mergeMode == MODE_MERGE_MIN)
+  {
+    // Empty labelmap remains empty
+    return true;
+  }
+
+  vtkSmartPointer<vtkOrientedImageData> modifierLabelmap = labelmap;
+  if (segmentLabelmapWasEmpty)
+  {
+    // Empty labelmap has no voxels that would need resampling
+    segmentLabelmap->CopyGeometry(labelmap);
+  }
+  else if (!segmentLabelmap->IsGeometryMatching(labelmap))
+  {
+    // Resample the modifier to the segment lattice, so that the segment is never resampled
+    modifierLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    if (!vtkSegmentationModifier::ResampleLabelmapToSparseLabelmap(labelmap, extent, segmentLabelmap, modifierLabelmap))
+    {
+      vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::AppendLabelmapToSparseSegment: Failed to resample labelmap");
+      return false;
+    }
+    extent = nullptr;
+  }
+
+  int operation = vtkOrientedImageDataResample::OPERATION_MAXIMUM;
+  switch (mergeMode)
+  {
+    case MODE_REPLACE:
+      // Voxels outside the modifier labelmap are removed, the same way as for binary labelmaps
+      segmentLabelmap->Initialize();
+      break;
+    case MODE_MERGE_MIN:
+      // Other segments are not affected, regardless of minimumOfAllSegments
+      operation = vtkOrientedImageDataResample::OPERATION_MINIMUM;
+      break;
+    case MODE_MERGE_MASK:
+      operation = vtkOrientedImageDataResample::OPERATION_MASKING;
+      break;
+    default:
+      operation = vtkOrientedImageDataResample::OPERATION_MAXIMUM;
+  }
+
+  bool voxelsModified = false;
+  if (!segmentLabelmap->ModifyImage(modifierLabelmap, operation, extent, 0.0, 1.0, &voxelsModified))
+  {
+    vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::AppendLabelmapToSparseSegment: Failed to modify labelmap");
+    return false;
+  }
+  segmentLabelmapModified = voxelsModified || (mergeMode == MODE_REPLACE && !segmentLabelmapWasEmpty);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSegmentationModifier::OverwriteSparseSegments(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
+  int mergeMode, const int extent[6], bool minimumOfAllSegments, const std::vector<std::string>& segmentIDsToOverwrite,
+  std::vector<std::string>& overwrittenSegmentIDs)
+{
+  overwrittenSegmentIDs.clear();
+  if (mergeMode == MODE_MERGE_MIN && !minimumOfAllSegments)
+  {
+    // Voxels are only removed from the modified segment
+    return true;
+  }
+
+  // Voxels that are set in the modified segment are removed from the overwritten segments, the same way as
+  // other segments in a shared binary labelmap are overwritten. Minimum of all segments is computed by
+  // applying the minimum operation to the overwritten segments.
+  int operation = (mergeMode == MODE_MERGE_MIN ? vtkOrientedImageDataResample::OPERATION_MINIMUM : vtkOrientedImageDataResample::OPERATION_MASKING);
+  for (const std::string& overwrittenSegmentID : segmentIDsToOverwrite)
+  {
+    if (overwrittenSegmentID == segmentID)
+    {
+      continue;
+    }
+    vtkSegment* overwrittenSegment = segmentation->GetSegment(overwrittenSegmentID);
+    vtkOrientedSparseBinaryLabelmap* overwrittenLabelmap = overwrittenSegment ? vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+      overwrittenSegment->GetRepresentation(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName())) : nullptr;
+    if (!overwrittenLabelmap || overwrittenLabelmap->IsEmpty())
+    {
+      continue;
+    }
+
+    vtkSmartPointer<vtkOrientedImageData> modifierLabelmap = labelmap;
+    const int* modifierExtent = extent;
+    if (!overwrittenLabelmap->IsGeometryMatching(labelmap))
+    {
+      modifierLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+      if (!vtkSegmentationModifier::ResampleLabelmapToSparseLabelmap(labelmap, extent, overwrittenLabelmap, modifierLabelmap))
+      {
+        vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::OverwriteSparseSegments: Failed to resample labelmap");
+        return false;
+      }
+      modifierExtent = nullptr;
+    }
+
+    bool voxelsModified = false;
+    if (!overwrittenLabelmap->ModifyImage(modifierLabelmap, operation, modifierExtent, 0.0, 0.0, &voxelsModified))
+    {
+      vtkErrorWithObjectMacro(segmentation, "vtkSegmentationModifier::OverwriteSparseSegments: Failed to modify labelmap of segment "
+        << overwrittenSegmentID);
+      return false;
+    }
+    if (voxelsModified)
+    {
+      overwrittenSegmentIDs.push_back(overwrittenSegmentID);
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSegmentationModifier::ResampleLabelmapToSparseLabelmap(vtkOrientedImageData* labelmap, const int extent[6],
+  vtkOrientedSparseBinaryLabelmap* sparseLabelmap, vtkOrientedImageData* resampledLabelmap)
+{
+  vtkSmartPointer<vtkOrientedImageData> croppedLabelmap = labelmap;
+  if (extent)
+  {
+    croppedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    vtkOrientedImageDataResample::CopyImage(labelmap, croppedLabelmap, extent);
+  }
+  vtkNew<vtkOrientedImageData> referenceImage;
+  vtkNew<vtkMatrix4x4> sparseImageToWorldMatrix;
+  sparseLabelmap->GetImageToWorldMatrix(sparseImageToWorldMatrix);
+  referenceImage->SetImageToWorldMatrix(sparseImageToWorldMatrix);
+  int sparseExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  sparseLabelmap->GetEffectiveExtent(sparseExtent);
+  referenceImage->SetExtent(sparseExtent);
+  return vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(
+    croppedLabelmap, referenceImage, resampledLabelmap, false /*interpolate*/, true /*pad*/);
+}
+
 //-----------------------------------------------------------------------------
 void vtkSegmentationModifier::ShrinkSegmentToEffectiveExtent(vtkOrientedImageData* segmentLabelmap)
 {
@@ -31,6 +31,7 @@
 #include <vector>
 
 class vtkOrientedImageData;
+class vtkOrientedSparseBinaryLabelmap;
 class vtkSegmentation;
 
 /// \brief Utility functions for resampling oriented image data
@@ -42,7 +43,9 @@ public:
 
 public:
   /// Set a labelmap image as binary labelmap representation into the segment defined by the segmentation node and segment ID.
-  /// Source representation must be binary labelmap! Source representation changed event is disabled to prevent deletion of all
+  /// Source representation must be binary labelmap or sparse binary labelmap! Sparse binary labelmaps are modified
+  /// in-place, without resampling or padding the segment, and other segments are never modified.
+  /// Source representation changed event is disabled to prevent deletion of all
   /// other representation in all segments. The other representations in the given segment are re-converted. The extent of the
   /// segment binary labelmap is shrunk to the effective extent. Display update is triggered.
   /// \param mergeMode Determines if the labelmap should replace the segment, combined with a maximum or minimum operation, or set under the mask.
@@ -73,6 +76,23 @@ protected:
 
   static void ShrinkSegmentToEffectiveExtent(vtkOrientedImageData* segmentLabelmap);
 
+  /// Combine the labelmap with the sparse binary labelmap representation of the segment.
+  /// If the labelmap geometry is different from the segment then the labelmap is resampled.
+  static bool AppendLabelmapToSparseSegment(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
+    int mergeMode, const int extent[6], bool& segmentLabelmapModified);
+
+  /// Remove the voxels that are set in the modified segment from the sparse binary labelmaps of the segments to overwrite.
+  /// In MODE_MERGE_MIN mode the segments to overwrite are only modified if minimumOfAllSegments is enabled.
+  /// \param overwrittenSegmentIDs Output list of segments that were modified
+  static bool OverwriteSparseSegments(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
+    int mergeMode, const int extent[6], bool minimumOfAllSegments, const std::vector<std::string>& segmentIDsToOverwrite,
+    std::vector<std::string>& overwrittenSegmentIDs);
+
+  /// Resample the labelmap to the lattice of the sparse binary labelmap.
+  /// If extent is specified then only that extent of the labelmap is used.
+  static bool ResampleLabelmapToSparseLabelmap(vtkOrientedImageData* labelmap, const int extent[6],
+    vtkOrientedSparseBinaryLabelmap* sparseLabelmap, vtkOrientedImageData* resampledLabelmap);
+
   static bool SharedLabelmapShouldOverlap(vtkSegmentation* segmentation, std::string segmentID, std::vector<std::string>& segmentIDsToOverwrite);
 
   static void SeparateModifiedSegmentFromSharedLabelmap(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
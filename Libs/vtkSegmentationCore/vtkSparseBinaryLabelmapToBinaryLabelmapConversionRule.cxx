@@ -0,0 +1,107 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::~vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule() = default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::GetConversionCost(
+    vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+    vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms)
+  return 50;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkOrientedSparseBinaryLabelmap"))
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else if (!className.compare("vtkOrientedImageData"))
+  {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!sparseLabelmap)
+  {
+    vtkErrorMacro("Convert: Source representation is not a sparse binary labelmap");
+    return false;
+  }
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!binaryLabelmap)
+  {
+    vtkErrorMacro("Convert: Target representation is not oriented image data");
+    return false;
+  }
+
+  return sparseLabelmap->GetImage(binaryLabelmap, segment->GetLabelValue());
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::PostConvert(vtkSegmentation* segmentation)
+{
+  // Each segment is converted to a separate labelmap, merge them to reduce memory usage
+  segmentation->CollapseBinaryLabelmaps(false);
+  return true;
+}
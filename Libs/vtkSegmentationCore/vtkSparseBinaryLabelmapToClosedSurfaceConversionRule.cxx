@@ -0,0 +1,111 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedSparseBinaryLabelmap.h"
+#include "vtkSegment.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkSparseBinaryLabelmapToClosedSurfaceConversionRule);
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToClosedSurfaceConversionRule::vtkSparseBinaryLabelmapToClosedSurfaceConversionRule() = default;
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToClosedSurfaceConversionRule::~vtkSparseBinaryLabelmapToClosedSurfaceConversionRule() = default;
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToClosedSurfaceConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+  {
+    return (vtkDataObject*)vtkPolyData::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToClosedSurfaceConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkOrientedSparseBinaryLabelmap"))
+  {
+    return (vtkDataObject*)vtkOrientedSparseBinaryLabelmap::New();
+  }
+  else if (!className.compare("vtkPolyData"))
+  {
+    return (vtkDataObject*)vtkPolyData::New();
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkOrientedSparseBinaryLabelmap* sparseLabelmap = vtkOrientedSparseBinaryLabelmap::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!sparseLabelmap)
+  {
+    vtkErrorMacro("Convert: Source representation is not a sparse binary labelmap");
+    return false;
+  }
+  vtkPolyData* closedSurfacePolyData = vtkPolyData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!closedSurfacePolyData)
+  {
+    vtkErrorMacro("Convert: Target representation is not poly data");
+    return false;
+  }
+
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!sparseLabelmap->GetEffectiveExtent(extent))
+  {
+    closedSurfacePolyData->Reset();
+    return true;
+  }
+
+  // Add a background voxel layer around the segment so that the surface is closed without padding the image again
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    extent[axis * 2] -= 1;
+    extent[axis * 2 + 1] += 1;
+  }
+  vtkNew<vtkOrientedImageData> binaryLabelmap;
+  if (!sparseLabelmap->GetImage(binaryLabelmap, 1.0, extent))
+  {
+    vtkErrorMacro("Convert: Failed to create binary labelmap from sparse binary labelmap");
+    return false;
+  }
+  std::vector<int> labelValues = { 1 };
+  return this->CreateClosedSurface(binaryLabelmap, closedSurfacePolyData, labelValues);
+}
@@ -0,0 +1,68 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSparseBinaryLabelmapToClosedSurfaceConversionRule_h
+#define __vtkSparseBinaryLabelmapToClosedSurfaceConversionRule_h
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkSegmentationConverter.h"
+#include "vtkSegmentationCoreConfigure.h"
+
+/// \brief Convert sparse binary labelmap representation (vtkOrientedSparseBinaryLabelmap type)
+///   to closed surface representation (vtkPolyData type). The surface is extracted from the
+///   effective extent of the segment using the same algorithm and conversion parameters as
+///   binary labelmap to closed surface conversion. Joint smoothing is not used, as each
+///   segment is stored in a separate labelmap.
+class vtkSegmentationCore_EXPORT vtkSparseBinaryLabelmapToClosedSurfaceConversionRule
+  : public vtkBinaryLabelmapToClosedSurfaceConversionRule
+{
+public:
+  static vtkSparseBinaryLabelmapToClosedSurfaceConversionRule* New();
+  vtkTypeMacro(vtkSparseBinaryLabelmapToClosedSurfaceConversionRule, vtkBinaryLabelmapToClosedSurfaceConversionRule);
+  vtkSegmentationConverterRule* CreateRuleInstance() override;
+
+  /// Constructs representation object from representation name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByRepresentation(std::string representationName) override;
+
+  /// Constructs representation object from class name for the supported representation classes
+  /// (typically source and target representation VTK classes, subclasses of vtkDataObject)
+  /// Note: Need to take ownership of the created object! For example using vtkSmartPointer<vtkDataObject>::Take
+  vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
+
+  /// Update the target representation based on the source representation
+  bool Convert(vtkSegment* segment) override;
+
+  /// Human-readable name of the converter rule
+  const char* GetName() override { return "Sparse binary labelmap to closed surface"; };
+
+  /// Human-readable name of the source representation
+  const char* GetSourceRepresentationName() override { return vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName(); };
+
+  /// Human-readable name of the target representation
+  const char* GetTargetRepresentationName() override { return vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(); };
+
+protected:
+  vtkSparseBinaryLabelmapToClosedSurfaceConversionRule();
+  ~vtkSparseBinaryLabelmapToClosedSurfaceConversionRule() override;
+
+private:
+  vtkSparseBinaryLabelmapToClosedSurfaceConversionRule(const vtkSparseBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
+  void operator=(const vtkSparseBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
+};
+
+#endif
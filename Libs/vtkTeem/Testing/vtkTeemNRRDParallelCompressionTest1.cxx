@@ -0,0 +1,143 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// Teem includes
+#include <teem/nrrd.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool WriteAndReadImage(vtkImageData* image, const std::string& fileName, bool parallelCompression)
+{
+  vtkNew<vtkTimerLog> timer;
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(image);
+  writer->SetUseCompression(true);
+  writer->SetCompressionLevel(1);
+  writer->SetParallelCompression(parallelCompression);
+  timer->StartTimer();
+  writer->Write();
+  timer->StopTimer();
+  if (writer->GetWriteError())
+  {
+    std::cerr << "Failed to write " << fileName << std::endl;
+    return false;
+  }
+  std::cout << "Write " << (parallelCompression ? "parallel" : "sequential") << ": " << timer->GetElapsedTime() << "s" << std::endl;
+
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  timer->StartTimer();
+  reader->Update();
+  timer->StopTimer();
+  std::cout << "Read " << (parallelCompression ? "parallel" : "sequential") << ": " << timer->GetElapsedTime() << "s" << std::endl;
+
+  vtkImageData* readImage = reader->GetOutput();
+  int* dimensions = image->GetDimensions();
+  int* readDimensions = readImage->GetDimensions();
+  if (readDimensions[0] != dimensions[0] || readDimensions[1] != dimensions[1] || readDimensions[2] != dimensions[2]
+    || readImage->GetScalarType() != image->GetScalarType())
+  {
+    std::cerr << "Image geometry or scalar type mismatch in " << fileName << std::endl;
+    return false;
+  }
+  size_t dataSize = static_cast<size_t>(image->GetNumberOfPoints()) * image->GetScalarSize();
+  if (memcmp(readImage->GetScalarPointer(), image->GetScalarPointer(), dataSize) != 0)
+  {
+    std::cerr << "Voxel values mismatch in " << fileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Check that the file is readable by the standard NRRD reader as well
+bool ReadImageUsingNrrdLoad(vtkImageData* image, const std::string& fileName)
+{
+  Nrrd* nrrd = nrrdNew();
+  if (nrrdLoad(nrrd, fileName.c_str(), nullptr) != 0)
+  {
+    char* err = biffGetDone(NRRD);
+    std::cerr << "nrrdLoad failed to read " << fileName << ": " << err << std::endl;
+    free(err);
+    nrrdNuke(nrrd);
+    return false;
+  }
+  size_t dataSize = static_cast<size_t>(image->GetNumberOfPoints()) * image->GetScalarSize();
+  bool success = (nrrdElementNumber(nrrd) * nrrdElementSize(nrrd) == dataSize
+    && memcmp(nrrd->data, image->GetScalarPointer(), dataSize) == 0);
+  if (!success)
+  {
+    std::cerr << "Voxel values read by nrrdLoad mismatch in " << fileName << std::endl;
+  }
+  nrrdNuke(nrrd);
+  return success;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDParallelCompressionTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = argv[1];
+
+  // Image is larger than a compression chunk, so that multiple gzip members are written
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(160, 128, 128);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+  {
+    voxels[i] = static_cast<short>((i % 160) * (i / 20480) - 1000);
+  }
+
+  if (!WriteAndReadImage(image, tempDir + "/vtkTeemNRRDParallelCompressionTest1_sequential.nrrd", false))
+  {
+    return EXIT_FAILURE;
+  }
+  if (!WriteAndReadImage(image, tempDir + "/vtkTeemNRRDParallelCompressionTest1_parallel.nrrd", true))
+  {
+    return EXIT_FAILURE;
+  }
+  // Multiple gzip members must be readable by other NRRD readers
+  if (!ReadImageUsingNrrdLoad(image, tempDir + "/vtkTeemNRRDParallelCompressionTest1_parallel.nrrd"))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
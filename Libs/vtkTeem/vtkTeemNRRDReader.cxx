@@ -42,16 +42,122 @@
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkShortArray.h"
+#include <vtkSMPTools.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnsignedShortArray.h"
 #include "vtkUnsignedIntArray.h"
 #include "vtkUnsignedLongArray.h"
+#include <vtksys/FStream.hxx>
 #include <vtksys/SystemTools.hxx>
+#include <vtk_zlib.h>
 
 // Teem includes
 #include "teem/ten.h"
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+// Layout of gzip members written by vtkTeemNRRDWriter in parallel compression mode:
+// 24-byte header that contains the total member size in an extra field with subfield ID "SL",
+// raw deflate stream, CRC32 and uncompressed size.
+const size_t GzipMemberHeaderSize = 24;
+const size_t GzipMemberTrailerSize = 8;
+
+//----------------------------------------------------------------------------
+unsigned long long ReadLittleEndian(const unsigned char* buffer, int numberOfBytes)
+{
+  unsigned long long value = 0;
+  for (int i = numberOfBytes - 1; i >= 0; --i)
+  {
+    value = (value << 8) | buffer[i];
+  }
+  return value;
+}
+
+//----------------------------------------------------------------------------
+/// Returns the total size of the gzip member starting at the buffer, 0 if the member
+/// does not have the header written by parallel compression.
+size_t GetGzipMemberSize(const unsigned char* buffer, size_t bufferSize)
+{
+  if (bufferSize < GzipMemberHeaderSize + GzipMemberTrailerSize
+    || buffer[0] != 0x1f || buffer[1] != 0x8b || buffer[2] != 8 || buffer[3] != 4
+    || ReadLittleEndian(buffer + 10, 2) != 12
+    || buffer[12] != 'S' || buffer[13] != 'L'
+    || ReadLittleEndian(buffer + 14, 2) != 8)
+  {
+    return 0;
+  }
+  unsigned long long memberSize = ReadLittleEndian(buffer + 16, 8);
+  if (memberSize < GzipMemberHeaderSize + GzipMemberTrailerSize || memberSize > bufferSize)
+  {
+    return 0;
+  }
+  return static_cast<size_t>(memberSize);
+}
+
+//----------------------------------------------------------------------------
+bool DecompressGzipMember(const unsigned char* member, size_t memberSize, unsigned char* data, size_t dataSize)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+  {
+    return false;
+  }
+  stream.next_in = const_cast<Bytef*>(member + GzipMemberHeaderSize);
+  stream.avail_in = static_cast<uInt>(memberSize - GzipMemberHeaderSize - GzipMemberTrailerSize);
+  stream.next_out = data;
+  stream.avail_out = static_cast<uInt>(dataSize);
+  int status = inflate(&stream, Z_FINISH);
+  size_t decompressedSize = stream.total_out;
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END || decompressedSize != dataSize)
+  {
+    return false;
+  }
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, data, static_cast<uInt>(dataSize));
+  return crc == ReadLittleEndian(member + memberSize - GzipMemberTrailerSize, 4);
+}
+
+//----------------------------------------------------------------------------
+/// Returns the position of the data in a NRRD file that has attached header
+/// (the header ends with an empty line), 0 if the end of the header is not found.
+size_t GetAttachedDataOffset(std::istream& file)
+{
+  const size_t blockSize = 65536;
+  std::vector<char> block(blockSize);
+  std::string header;
+  file.seekg(0, std::ios::beg);
+  while (file)
+  {
+    file.read(block.data(), blockSize);
+    // the empty line may start in the previous block
+    size_t searchStart = (header.size() > 3 ? header.size() - 3 : 0);
+    header.append(block.data(), static_cast<size_t>(file.gcount()));
+    size_t lfPosition = header.find("\n\n", searchStart);
+    size_t crLfPosition = header.find("\r\n\r\n", searchStart);
+    if (lfPosition != std::string::npos && (crLfPosition == std::string::npos || lfPosition + 2 < crLfPosition + 4))
+    {
+      return lfPosition + 2;
+    }
+    if (crLfPosition != std::string::npos)
+    {
+      return crLfPosition + 4;
+    }
+  }
+  return 0;
+}
+
+} // end of anonymous namespace
+
 vtkStandardNewMacro(vtkTeemNRRDReader);
 
 //----------------------------------------------------------------------------
@@ -67,6 +173,14 @@ vtkTeemNRRDReader::vtkTeemNRRDReader()
   this->DataType = -1;
   this->NumberOfComponents = -1;
   this->DataArrayName = "NRRDImage";
+  this->FrameDataCompressed = false;
+  this->FrameDataEndian = airEndianUnknown;
+  this->FrameDataType = VTK_VOID;
+  this->FrameDimensions[0] = 0;
+  this->FrameDimensions[1] = 0;
+  this->FrameDimensions[2] = 0;
+  this->FrameSize = 0;
+  this->NumberOfFrames = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -916,7 +1030,8 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
 
   // Read in the this->nrrd.  Yes, this means that the header is being read
   // twice: once by ExecuteInformation, and once here
-  if ( nrrdLoad(this->nrrd, this->GetFileName(), nullptr) != 0 )
+  if ( !this->LoadParallelCompressedData()
+    && nrrdLoad(this->nrrd, this->GetFileName(), nullptr) != 0 )
   {
     char *err =  biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Read: Error reading " << this->GetFileName() << ":\n" << err);
@@ -1099,6 +1214,343 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
   nrrdEmpty(this->nrrd);
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::LoadParallelCompressedData()
+{
+  // Read the header to get the data type, size, encoding, and endianness
+  NrrdIoState *nio = nrrdIoStateNew();
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  if (nrrdLoad(this->nrrd, this->GetFileName(), nio) != 0)
+  {
+    // the error is reported when nrrdLoad is attempted again
+    free(biffGetDone(NRRD));
+    nrrdIoStateNix(nio);
+    return false;
+  }
+  bool gzipEncoded = (nio->encoding == nrrdEncodingGzip && nio->lineSkip == 0 && nio->byteSkip == 0);
+  int endian = nio->endian;
+  nrrdIoStateNix(nio);
+  if (!gzipEncoded)
+  {
+    return false;
+  }
+
+  // Check the layout using only the header and the member headers and trailers,
+  // so that files that are not compressed in independent members (e.g., written by
+  // other applications) are left to nrrdLoad without reading the data.
+  vtksys::ifstream file(this->GetFileName(), std::ios::in | std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+  // Detached headers do not contain compressed data, therefore they are rejected
+  // when the first member header is checked.
+  size_t dataOffset = GetAttachedDataOffset(file);
+  file.clear();
+  file.seekg(0, std::ios::end);
+  size_t fileSize = static_cast<size_t>(file.tellg());
+  if (dataOffset == 0 || dataOffset >= fileSize)
+  {
+    return false;
+  }
+  size_t dataSize = nrrdElementNumber(this->nrrd) * nrrdElementSize(this->nrrd);
+  std::vector<DataChunkType> members;
+  if (!vtkTeemNRRDReader::ReadGzipMemberDirectory(file, dataOffset, fileSize, members)
+    || members.back().UncompressedOffset + members.back().UncompressedSize != dataSize)
+  {
+    return false;
+  }
+
+  // Read all compressed data
+  std::vector<unsigned char> buffer(fileSize - dataOffset);
+  file.clear();
+  file.seekg(dataOffset, std::ios::beg);
+  if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+  {
+    return false;
+  }
+
+  size_t size[NRRD_DIM_MAX] = { 0 };
+  nrrdAxisInfoGet_nva(this->nrrd, nrrdAxisInfoSize, size);
+  if (nrrdMaybeAlloc_nva(this->nrrd, this->nrrd->type, this->nrrd->dim, size) != 0)
+  {
+    free(biffGetDone(NRRD));
+    return false;
+  }
+
+  unsigned char* data = static_cast<unsigned char*>(this->nrrd->data);
+  std::atomic<bool> success{ true };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(members.size()), 1,
+    [&](vtkIdType begin, vtkIdType end)
+    {
+      for (vtkIdType memberIndex = begin; memberIndex < end; ++memberIndex)
+      {
+        const DataChunkType& member = members[memberIndex];
+        if (!DecompressGzipMember(buffer.data() + member.Offset - dataOffset, member.Size,
+          data + member.UncompressedOffset, member.UncompressedSize))
+        {
+          success = false;
+        }
+      }
+    });
+  if (!success)
+  {
+    nrrdEmpty(this->nrrd);
+    return false;
+  }
+
+  if (nrrdElementSize(this->nrrd) > 1 && endian != airEndianUnknown && endian != airMyEndian())
+  {
+    nrrdSwapEndian(this->nrrd);
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ReadGzipMemberDirectory(std::istream& file, size_t dataOffset, size_t fileSize,
+  std::vector<DataChunkType>& members)
+{
+  // Read the header and trailer of each member to get their size
+  members.clear();
+  size_t uncompressedOffset = 0;
+  for (size_t offset = dataOffset; offset < fileSize; )
+  {
+    unsigned char memberHeader[GzipMemberHeaderSize] = { 0 };
+    unsigned char memberTrailer[GzipMemberTrailerSize] = { 0 };
+    file.clear();
+    file.seekg(offset, std::ios::beg);
+    file.read(reinterpret_cast<char*>(memberHeader), GzipMemberHeaderSize);
+    size_t memberSize = (file ? GetGzipMemberSize(memberHeader, fileSize - offset) : 0);
+    if (memberSize > 0)
+    {
+      file.seekg(offset + memberSize - GzipMemberTrailerSize, std::ios::beg);
+      file.read(reinterpret_cast<char*>(memberTrailer), GzipMemberTrailerSize);
+    }
+    if (memberSize == 0 || !file)
+    {
+      members.clear();
+      return false;
+    }
+    DataChunkType member;
+    member.Offset = offset;
+    member.Size = memberSize;
+    member.UncompressedOffset = uncompressedOffset;
+    member.UncompressedSize = static_cast<size_t>(ReadLittleEndian(memberTrailer + 4, 4));
+    members.push_back(member);
+    uncompressedOffset += member.UncompressedSize;
+    offset += memberSize;
+  }
+  return !members.empty();
+}
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDReader::ReadFrameDirectory()
+{
+  this->FrameDataChunks.clear();
+  this->NumberOfFrames = 0;
+  this->FrameDirectoryFileName = (this->GetFileName() ? this->GetFileName() : "");
+
+  // Data location is only known for attached headers
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(this->FrameDirectoryFileName));
+  if (extension != ".nrrd")
+  {
+    return 0;
+  }
+
+  Nrrd* nrrdHeader = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  bool supported = true;
+  if (nrrdLoad(nrrdHeader, this->FrameDirectoryFileName.c_str(), nio) != 0)
+  {
+    free(biffGetDone(NRRD));
+    supported = false;
+  }
+  unsigned int rangeAxisIdx[NRRD_DIM_MAX] = { 0 };
+  int pointDataType = -1;
+  int numOfComponents = -1;
+  supported = supported
+    && nrrdHeader->dim == 4
+    && nrrdRangeAxesGet(nrrdHeader, rangeAxisIdx) == 1 && rangeAxisIdx[0] == 3
+    && vtkTeemNRRDReader::GetPointType(nrrdHeader, pointDataType, numOfComponents)
+    && pointDataType == vtkDataSetAttributes::SCALARS
+    && numOfComponents == static_cast<int>(nrrdHeader->axis[3].size)
+    && nio->lineSkip == 0 && nio->byteSkip == 0
+    && (nio->encoding == nrrdEncodingRaw || nio->encoding == nrrdEncodingGzip);
+  if (supported)
+  {
+    this->FrameDataCompressed = (nio->encoding == nrrdEncodingGzip);
+    this->FrameDataEndian = nio->endian;
+    this->FrameDataType = this->NrrdToVTKScalarType(nrrdHeader->type);
+    this->FrameSize = nrrdElementSize(nrrdHeader);
+    for (int axi = 0; axi < 3; axi++)
+    {
+      this->FrameDimensions[axi] = static_cast<int>(nrrdHeader->axis[axi].size);
+      this->FrameSize *= nrrdHeader->axis[axi].size;
+    }
+    this->NumberOfFrames = static_cast<int>(nrrdHeader->axis[3].size);
+  }
+  nrrdNuke(nrrdHeader);
+  nrrdIoStateNix(nio);
+  if (!supported || this->FrameSize == 0)
+  {
+    this->NumberOfFrames = 0;
+    return 0;
+  }
+
+  vtksys::ifstream file(this->FrameDirectoryFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+  {
+    this->NumberOfFrames = 0;
+    return 0;
+  }
+  size_t dataOffset = GetAttachedDataOffset(file);
+  file.clear();
+  file.seekg(0, std::ios::end);
+  size_t fileSize = static_cast<size_t>(file.tellg());
+  size_t dataSize = this->FrameSize * this->NumberOfFrames;
+  if (dataOffset == 0)
+  {
+    this->NumberOfFrames = 0;
+    return 0;
+  }
+
+  if (!this->FrameDataCompressed)
+  {
+    if (dataOffset + dataSize > fileSize)
+    {
+      this->NumberOfFrames = 0;
+      return 0;
+    }
+    DataChunkType chunk;
+    chunk.Offset = dataOffset;
+    chunk.Size = dataSize;
+    chunk.UncompressedOffset = 0;
+    chunk.UncompressedSize = dataSize;
+    this->FrameDataChunks.push_back(chunk);
+    return this->NumberOfFrames;
+  }
+
+  // Only data compressed in independent chunks can be read partially.
+  if (!vtkTeemNRRDReader::ReadGzipMemberDirectory(file, dataOffset, fileSize, this->FrameDataChunks)
+    || this->FrameDataChunks.back().UncompressedOffset + this->FrameDataChunks.back().UncompressedSize != dataSize)
+  {
+    this->FrameDataChunks.clear();
+    this->NumberOfFrames = 0;
+    return 0;
+  }
+  return this->NumberOfFrames;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ReadFrame(int frameIndex, vtkImageData* frameImageData)
+{
+  if (!frameImageData)
+  {
+    vtkErrorMacro("ReadFrame: invalid image data");
+    return false;
+  }
+  if (frameIndex < 0 || frameIndex >= this->NumberOfFrames || this->FrameDataChunks.empty())
+  {
+    vtkErrorMacro("ReadFrame: frame " << frameIndex << " is not found in frame directory of "
+      << this->FrameDirectoryFileName << " (number of frames: " << this->NumberOfFrames << ")");
+    return false;
+  }
+
+  frameImageData->SetDimensions(this->FrameDimensions);
+  frameImageData->AllocateScalars(this->FrameDataType, 1);
+  frameImageData->GetPointData()->GetScalars()->SetName(this->DataArrayName.c_str());
+  unsigned char* frameData = static_cast<unsigned char*>(frameImageData->GetScalarPointer());
+  size_t frameBegin = this->FrameSize * frameIndex;
+  size_t frameEnd = frameBegin + this->FrameSize;
+
+  vtksys::ifstream file(this->FrameDirectoryFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+  {
+    vtkErrorMacro("ReadFrame: failed to open " << this->FrameDirectoryFileName);
+    return false;
+  }
+
+  // Find the chunks that contain the frame
+  size_t firstChunkIndex = std::upper_bound(this->FrameDataChunks.begin(), this->FrameDataChunks.end(), frameBegin,
+    [](size_t position, const DataChunkType& chunk) { return position < chunk.UncompressedOffset; })
+    - this->FrameDataChunks.begin() - 1;
+  size_t endChunkIndex = firstChunkIndex;
+  while (endChunkIndex < this->FrameDataChunks.size() && this->FrameDataChunks[endChunkIndex].UncompressedOffset < frameEnd)
+  {
+    endChunkIndex++;
+  }
+
+  if (!this->FrameDataCompressed)
+  {
+    const DataChunkType& chunk = this->FrameDataChunks[firstChunkIndex];
+    file.seekg(chunk.Offset + frameBegin - chunk.UncompressedOffset, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(frameData), this->FrameSize))
+    {
+      vtkErrorMacro("ReadFrame: failed to read frame " << frameIndex << " from " << this->FrameDirectoryFileName);
+      return false;
+    }
+  }
+  else
+  {
+    // Chunks of a frame are stored next to each other, read them at once and decompress them in parallel
+    size_t compressedBegin = this->FrameDataChunks[firstChunkIndex].Offset;
+    size_t compressedEnd = this->FrameDataChunks[endChunkIndex - 1].Offset + this->FrameDataChunks[endChunkIndex - 1].Size;
+    std::vector<unsigned char> compressedData(compressedEnd - compressedBegin);
+    file.seekg(compressedBegin, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(compressedData.data()), compressedData.size()))
+    {
+      vtkErrorMacro("ReadFrame: failed to read frame " << frameIndex << " from " << this->FrameDirectoryFileName);
+      return false;
+    }
+    std::atomic<bool> success{ true };
+    vtkSMPTools::For(static_cast<vtkIdType>(firstChunkIndex), static_cast<vtkIdType>(endChunkIndex), 1,
+      [&](vtkIdType begin, vtkIdType end)
+      {
+        std::vector<unsigned char> chunkData;
+        for (vtkIdType chunkIndex = begin; chunkIndex < end; ++chunkIndex)
+        {
+          const DataChunkType& chunk = this->FrameDataChunks[chunkIndex];
+          chunkData.resize(chunk.UncompressedSize);
+          if (!DecompressGzipMember(compressedData.data() + chunk.Offset - compressedBegin, chunk.Size,
+            chunkData.data(), chunk.UncompressedSize))
+          {
+            success = false;
+            continue;
+          }
+          // copy the part of the chunk that belongs to the frame
+          size_t copyBegin = std::max(frameBegin, chunk.UncompressedOffset);
+          size_t copyEnd = std::min(frameEnd, chunk.UncompressedOffset + chunk.UncompressedSize);
+          memcpy(frameData + copyBegin - frameBegin, chunkData.data() + copyBegin - chunk.UncompressedOffset, copyEnd - copyBegin);
+        }
+      });
+    if (!success)
+    {
+      vtkErrorMacro("ReadFrame: failed to decompress frame " << frameIndex << " from " << this->FrameDirectoryFileName);
+      return false;
+    }
+  }
+
+  if (frameImageData->GetScalarSize() > 1 && this->FrameDataEndian != airEndianUnknown && this->FrameDataEndian != airMyEndian())
+  {
+    Nrrd* frameNrrd = nrrdNew();
+    size_t size[3] = { static_cast<size_t>(this->FrameDimensions[0]),
+      static_cast<size_t>(this->FrameDimensions[1]), static_cast<size_t>(this->FrameDimensions[2]) };
+    if (nrrdWrap_nva(frameNrrd, frameData, this->VTKToNrrdPixelType(this->FrameDataType), 3, size) == 0)
+    {
+      nrrdSwapEndian(frameNrrd);
+    }
+    else
+    {
+      free(biffGetDone(NRRD));
+    }
+    // Free the nrrd struct but don't touch the image data
+    nrrdNix(frameNrrd);
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkTeemNRRDReader::PrintSelf(ostream& os, vtkIndent indent)
 {
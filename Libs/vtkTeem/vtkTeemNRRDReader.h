@@ -32,6 +32,7 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <vector>
 
 #include "vtkTeemConfigure.h"
 #include "vtkMedicalImageReader2.h"
@@ -94,6 +95,26 @@ public:
 
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
+  /// Read the location of each frame in the file, which allows reading frames of
+  /// a 4D image one by one (see ReadFrame), without loading the whole image into memory.
+  /// Frames are the 3D volumes along the range axis. This is only possible if the range axis
+  /// is the last (slowest) axis, so that each frame is stored contiguously (see
+  /// vtkTeemNRRDWriter::RangeAxisLast), and the data is stored in the .nrrd file
+  /// without compression or with parallel compression (see vtkTeemNRRDWriter::ParallelCompression).
+  /// Returns the number of frames, 0 if frames cannot be read individually from the file.
+  int ReadFrameDirectory();
+
+  /// Read a single frame into the provided image data object. Dimensions, scalar type,
+  /// and voxel values are set, origin and spacing are left unchanged.
+  /// ReadFrameDirectory() must be called before.
+  /// Returns false if reading failed.
+  bool ReadFrame(int frameIndex, vtkImageData* frameImageData);
+
+  /// Dimensions and scalar type of the frames that ReadFrame reads.
+  /// Only valid if ReadFrameDirectory() found frames in the file.
+  vtkGetVector3Macro(FrameDimensions, int);
+  vtkGetMacro(FrameDataType, int);
+
   ///  is the given file name a NRRD file?
   int CanReadFile(const char* filename) override;
 
@@ -277,6 +298,38 @@ protected:
 
   int tenSpaceDirectionReduce(Nrrd *nout, const Nrrd *nin, double SD[9]);
 
+  /// Load this->nrrd with data that was written by vtkTeemNRRDWriter using parallel compression,
+  /// decompressing the data chunks in parallel.
+  /// Returns false (without logging any error) if the file is not in this format,
+  /// in which case the file has to be loaded using nrrdLoad.
+  bool LoadParallelCompressedData();
+
+  /// Location of a chunk of voxel data in the file
+  struct DataChunkType
+  {
+    size_t Offset;
+    size_t Size;
+    size_t UncompressedOffset;
+    size_t UncompressedSize;
+  };
+
+  /// Get the location of the gzip members written by parallel compression, reading only the
+  /// header and trailer of each member. Data starts at \a dataOffset and lasts until the end of the file.
+  /// Returns false if the data is not compressed in such members.
+  static bool ReadGzipMemberDirectory(std::istream& file, size_t dataOffset, size_t fileSize,
+    std::vector<DataChunkType>& members);
+
+  /// Frame directory, set by ReadFrameDirectory().
+  /// Uncompressed data is stored as a single chunk.
+  std::string FrameDirectoryFileName;
+  std::vector<DataChunkType> FrameDataChunks;
+  bool FrameDataCompressed;
+  int FrameDataEndian;
+  int FrameDataType;
+  int FrameDimensions[3];
+  size_t FrameSize;
+  int NumberOfFrames;
+
 private:
   vtkTeemNRRDReader(const vtkTeemNRRDReader&) = delete;
   void operator=(const vtkTeemNRRDReader&) = delete;
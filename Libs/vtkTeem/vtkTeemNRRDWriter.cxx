@@ -7,17 +7,156 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include <vtkSMPTools.h>
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
 
 #include <itkMath.h>
 #include <vnl/vnl_double_3.h>
 
 #include "itkNumberToString.h"
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
 
 class AttributeMapType: public std::map<std::string, std::string> {};
 class AxisInfoMapType : public std::map<unsigned int, std::string> {};
 
+namespace
+{
+
+// Parallel gzip compression writes the data as a sequence of independent gzip members
+// (concatenated gzip members are a valid gzip stream). Each member header contains an
+// extra field with subfield ID "SL" that stores the total size of the member in bytes,
+// which allows the reader to find all members without decompressing them.
+// The same layout is parsed in vtkTeemNRRDReader.
+const size_t ParallelGzipChunkSize = 4 * 1024 * 1024;
+const size_t GzipMemberHeaderSize = 24;
+const size_t GzipMemberTrailerSize = 8;
+
+//----------------------------------------------------------------------------
+void WriteLittleEndian(unsigned char* buffer, unsigned long long value, int numberOfBytes)
+{
+  for (int i = 0; i < numberOfBytes; ++i)
+  {
+    buffer[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool CompressGzipMember(const unsigned char* data, size_t dataSize, int level, std::vector<unsigned char>& member)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // negative window bits: raw deflate stream, header and trailer are written here
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    return false;
+  }
+  uLong compressedSizeBound = deflateBound(&stream, static_cast<uLong>(dataSize));
+  member.resize(GzipMemberHeaderSize + compressedSizeBound + GzipMemberTrailerSize);
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(dataSize);
+  stream.next_out = member.data() + GzipMemberHeaderSize;
+  stream.avail_out = static_cast<uInt>(compressedSizeBound);
+  int status = deflate(&stream, Z_FINISH);
+  size_t compressedSize = stream.total_out;
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END)
+  {
+    return false;
+  }
+  member.resize(GzipMemberHeaderSize + compressedSize + GzipMemberTrailerSize);
+
+  unsigned char* header = member.data();
+  header[0] = 0x1f; // ID1
+  header[1] = 0x8b; // ID2
+  header[2] = 8; // CM = deflate
+  header[3] = 4; // FLG = FEXTRA
+  WriteLittleEndian(header + 4, 0, 4); // MTIME
+  header[8] = 0; // XFL
+  header[9] = 255; // OS = unknown
+  WriteLittleEndian(header + 10, 12, 2); // XLEN
+  header[12] = 'S'; // SI1
+  header[13] = 'L'; // SI2
+  WriteLittleEndian(header + 14, 8, 2); // LEN
+  WriteLittleEndian(header + 16, member.size(), 8);
+
+  unsigned char* trailer = member.data() + GzipMemberHeaderSize + compressedSize;
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, data, static_cast<uInt>(dataSize));
+  WriteLittleEndian(trailer, crc, 4);
+  WriteLittleEndian(trailer + 4, dataSize & 0xffffffff, 4); // ISIZE
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int ParallelGzipWrite(FILE* file, const void* data, size_t elementNum, const Nrrd* nrrd, NrrdIoState* nio)
+{
+  static const char me[] = "ParallelGzipWrite";
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  size_t dataSize = elementNum * nrrdElementSize(nrrd);
+  vtkIdType numberOfChunks = static_cast<vtkIdType>(std::max<size_t>(1, (dataSize + ParallelGzipChunkSize - 1) / ParallelGzipChunkSize));
+  int level = nio->zlibLevel;
+
+  // Compress a limited number of chunks at a time to keep memory usage bounded
+  vtkIdType numberOfChunksPerBatch = std::max(1, 2 * vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<std::vector<unsigned char>> members(numberOfChunksPerBatch);
+  for (vtkIdType firstChunk = 0; firstChunk < numberOfChunks; firstChunk += numberOfChunksPerBatch)
+  {
+    vtkIdType lastChunk = std::min(firstChunk + numberOfChunksPerBatch, numberOfChunks);
+    std::atomic<bool> success{ true };
+    vtkSMPTools::For(firstChunk, lastChunk, 1,
+      [&](vtkIdType begin, vtkIdType end)
+      {
+        for (vtkIdType chunk = begin; chunk < end; ++chunk)
+        {
+          size_t chunkStart = static_cast<size_t>(chunk) * ParallelGzipChunkSize;
+          size_t chunkSize = std::min(ParallelGzipChunkSize, dataSize - chunkStart);
+          if (!CompressGzipMember(bytes + chunkStart, chunkSize, level, members[chunk - firstChunk]))
+          {
+            success = false;
+          }
+        }
+      });
+    if (!success)
+    {
+      biffAddf(NRRD, "%s: failed to compress data chunk", me);
+      return 1;
+    }
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
+    {
+      const std::vector<unsigned char>& member = members[chunk - firstChunk];
+      if (fwrite(member.data(), 1, member.size(), file) != member.size())
+      {
+        biffAddf(NRRD, "%s: failed to write compressed data", me);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+/// Same as the gzip encoding of teem (the header specifies "gzip" encoding),
+/// but the data is compressed in parallel.
+const NrrdEncoding* GetParallelGzipEncoding()
+{
+  static const NrrdEncoding parallelGzipEncoding = []()
+  {
+    NrrdEncoding encoding = *nrrdEncodingGzip;
+    encoding.write = ParallelGzipWrite;
+    return encoding;
+  }();
+  return &parallelGzipEncoding;
+}
+
+} // end of anonymous namespace
+
 vtkStandardNewMacro(vtkTeemNRRDWriter);
 
 //----------------------------------------------------------------------------
@@ -31,6 +170,7 @@ vtkTeemNRRDWriter::vtkTeemNRRDWriter()
   this->UseCompression = 1;
   // use default CompressionLevel
   this->CompressionLevel = -1;
+  this->ParallelCompression = false;
   this->DiffusionWeightedData = 0;
   this->FileType = VTK_BINARY;
   this->WriteErrorOff();
@@ -40,6 +180,7 @@ vtkTeemNRRDWriter::vtkTeemNRRDWriter()
   this->VectorAxisKind = nrrdKindUnknown;
   this->Space = nrrdSpaceRightAnteriorSuperior;
   this->ForceRangeAxis = false;
+  this->RangeAxisLast = false;
 }
 
 //----------------------------------------------------------------------------
@@ -412,13 +553,33 @@ void vtkTeemNRRDWriter::WriteData()
     return;
   }
 
+  // Move the range axis to the last position. Axis information (kind, label, unit, space direction)
+  // is permuted along with the data, key/value pairs have to be copied explicitly.
+  Nrrd* permutedNrrd = nullptr;
+  if (this->RangeAxisLast && nrrd->dim > 3)
+  {
+    unsigned int axmap[NRRD_DIM_MAX] = { 1, 2, 3, 0 };
+    permutedNrrd = nrrdNew();
+    if (nrrdAxesPermute(permutedNrrd, nrrd, axmap)
+      || nrrdKeyValueCopy(permutedNrrd, nrrd))
+    {
+      char *err = biffGetDone(NRRD); // would be nice to free(err)
+      vtkErrorMacro("Write: Error permuting range axis for "
+                        << this->GetFileName() << ":\n" << err);
+      this->WriteErrorOn();
+      nrrdNuke(permutedNrrd);
+      nrrd = nrrdNix(nrrd);
+      return;
+    }
+  }
+
   NrrdIoState *nio = nrrdIoStateNew();
 
   // set encoding for data: compressed (raw), (uncompressed) raw, or ascii
   if ( this->GetUseCompression() && nrrdEncodingGzip->available() )
   {
     // this is necessarily gzip-compressed *raw* data
-    nio->encoding = nrrdEncodingGzip;
+    nio->encoding = this->ParallelCompression ? GetParallelGzipEncoding() : nrrdEncodingGzip;
     nio->zlibLevel = this->CompressionLevel;
   }
   else
@@ -440,13 +601,18 @@ void vtkTeemNRRDWriter::WriteData()
   nio->endian = airEndianUnknown;
 
   // Write the nrrd to file.
-  if (nrrdSave(this->GetFileName(), nrrd, nio))
+  if (nrrdSave(this->GetFileName(), permutedNrrd ? permutedNrrd : nrrd, nio))
   {
     char *err = biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Write: Error writing "
                       << this->GetFileName() << ":\n" << err);
     this->WriteErrorOn();
   }
+  if (permutedNrrd)
+  {
+    // permuted data is owned by the nrrd struct
+    permutedNrrd = nrrdNuke(permutedNrrd);
+  }
   // Free the nrrd struct but don't touch nrrd->data
   nrrd = nrrdNix(nrrd);
   nio = nrrdIoStateNix(nio);
@@ -456,6 +622,10 @@ void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "UseCompression: " << this->UseCompression << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "ParallelCompression: " << (this->ParallelCompression ? "true" : "false") << "\n";
+  os << indent << "RangeAxisLast: " << (this->RangeAxisLast ? "true" : "false") << "\n";
   os << indent << "RAS to IJK Matrix: ";
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
@@ -58,6 +58,16 @@ public:
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
+  /// Compress the data in independent chunks, using multiple threads.
+  /// Each chunk is written as a separate gzip member, so the file remains a standard
+  /// gzip-encoded NRRD file that any NRRD reader can load. The compressed size of each
+  /// member is stored in a gzip extra field, which allows vtkTeemNRRDReader to
+  /// decompress the chunks in parallel, too.
+  /// Only used if UseCompression is enabled. Disabled by default.
+  vtkSetMacro(ParallelCompression, bool);
+  vtkGetMacro(ParallelCompression, bool);
+  vtkBooleanMacro(ParallelCompression, bool);
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -102,6 +112,14 @@ public:
   vtkGetMacro(ForceRangeAxis, bool);
   vtkBooleanMacro(ForceRangeAxis, bool);
 
+  /// Write the range axis (components, or frames of an image sequence) as the last (slowest) axis,
+  /// instead of the first (fastest) axis. This stores each component contiguously, which allows
+  /// reading individual frames of an image sequence (see vtkTeemNRRDReader::ReadFrame).
+  /// Writing requires a temporary copy of the image. Disabled by default.
+  vtkSetMacro(RangeAxisLast, bool);
+  vtkGetMacro(RangeAxisLast, bool);
+  vtkBooleanMacro(RangeAxisLast, bool);
+
   /// Utility function to return image as a Nrrd*
   void* MakeNRRD();
 
@@ -129,6 +147,7 @@ protected:
 
   int UseCompression;
   int CompressionLevel;
+  bool ParallelCompression;
   int FileType;
 
   AttributeMapType *Attributes;
@@ -138,6 +157,7 @@ protected:
   int Space;
 
   bool ForceRangeAxis;
+  bool RangeAxisLast;
 
 private:
   vtkTeemNRRDWriter(const vtkTeemNRRDWriter&) = delete;
@@ -32,6 +32,8 @@ Version:   $Revision$
 // VTK includes
 #include <vtkVersion.h> // must precede reference to VTK_MAJOR_VERSION
 #include <vtkDebugLeaks.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
 #include <vtkDecimatePro.h>
 #include <vtkDiscreteFlyingEdges3D.h>
 #include <vtkFlyingEdges3D.h>
@@ -42,17 +44,23 @@ Version:   $Revision$
 #include <vtkImageData.h>
 #include <vtkImageThreshold.h>
 #include <vtkImageToStructuredPoints.h>
+#include <vtkIdList.h>
 #include <vtkInformation.h>
 #include <vtkLookupTable.h>
+#include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkPolyDataWriter.h>
 #include <vtkReverseSense.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkSmoothPolyDataFilter.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkStripper.h>
+#include <vtkSurfaceNets3D.h>
 #include <vtkThreshold.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -62,6 +70,364 @@ Version:   $Revision$
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Add a model node with display and storage nodes to the scene and put it in the
+// model hierarchy. The model file must have been written already.
+void AddModelToScene(vtkMRMLScene* modelScene, vtkMRMLNode* rnd, vtkMRMLModelHierarchyNode* topColorHierarchyNode,
+                     vtkMRMLColorTableNode* colorNode, int label, const std::string& labelName,
+                     const std::string& fileName, bool debug)
+{
+  if (debug)
+  {
+    std::cout << "Adding model " << labelName << " to the output scene, with filename " << fileName.c_str()
+              << endl;
+  }
+  // each model needs a mrml node, a storage node and a display node
+  vtkNew<vtkMRMLModelNode> mnode;
+  mnode->SetScene(modelScene);
+  mnode->SetName(labelName.c_str());
+
+  vtkNew<vtkMRMLModelStorageNode> snode;
+  snode->SetFileName(fileName.c_str());
+  if (modelScene->AddNode(snode.GetPointer()) == nullptr)
+  {
+    std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
+  }
+  vtkNew<vtkMRMLModelDisplayNode> dnode;
+  dnode->SetColor(0.5, 0.5, 0.5);
+  double *rgba;
+  if (colorNode != nullptr)
+  {
+    rgba = colorNode->GetLookupTable()->GetTableValue(label);
+    if (rgba != nullptr)
+    {
+      if (debug)
+      {
+        std::cout << "Got color: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
+      }
+      dnode->SetColor(rgba[0], rgba[1], rgba[2]);
+    }
+    else
+    {
+      std::cerr << "Couldn't get look up table value for " << label << ", display node color is not set (grey)"
+                << endl;
+    }
+  }
+
+  dnode->SetVisibility(1);
+  modelScene->AddNode(dnode.GetPointer());
+  if (debug)
+  {
+    std::cout << "Added display node: id = " << (dnode->GetID() == nullptr ? "(null)" : dnode->GetID()) << endl;
+    std::cout << "Setting model's storage node: id = "
+              << (snode->GetID() == nullptr ? "(null)" : snode->GetID()) << endl;
+  }
+  mnode->SetAndObserveStorageNodeID(snode->GetID());
+  mnode->SetAndObserveDisplayNodeID(dnode->GetID());
+  modelScene->AddNode(mnode.GetPointer());
+
+  // put it in the hierarchy, either the flat one by default or
+  // try to find the matching color hierarchy node to make this an
+  // associated node
+  std::string colorName;
+  if (colorNode != nullptr)
+  {
+    colorName = std::string(colorNode->GetColorNameAsFileName(label));
+  }
+  else
+  {
+    // might be in a testing case where the hierarchy nodes are
+    // numbered (made from the generic colors)
+    std::stringstream ss;
+    ss << label;
+    colorName = ss.str();
+    if (debug)
+    {
+      std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
+    }
+  }
+  vtkMRMLNode *mrmlNode = nullptr;
+  if (colorName.compare("") != 0)
+  {
+    mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
+  }
+  // if there's no color hierarchy, or no color name or the mrml node
+  // named for the color isn't a model hierarchy node, use a flat hierarchy
+  if (topColorHierarchyNode == nullptr ||
+      colorName.compare("") == 0 ||
+      mrmlNode == nullptr ||
+      strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
+  {
+    vtkNew<vtkMRMLModelHierarchyNode> mhnd;
+    mhnd->SetHideFromEditors(1);
+    modelScene->AddNode(mhnd.GetPointer());
+    mhnd->SetParentNodeID(rnd->GetID());
+    mhnd->SetModelNodeID(mnode->GetID());
+  }
+  else
+  {
+    // use the template color hierarchy
+    vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
+    if (colorHierarchyNode)
+    {
+      colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
+      // and hide it so that it doesn't clutter up the tree
+      colorHierarchyNode->SetHideFromEditors(1);
+      if (debug)
+      {
+        std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
+      }
+    }
+  }
+  if (debug)
+  {
+    std::cout << "...done adding model to output scene" << endl;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Report progress of steps that are not a single VTK filter, the same way as vtkPluginFilterWatcher.
+// Must be called from the main thread.
+void ReportProgress(ModuleProcessInformation* processInformation, const std::string& comment, double progress)
+{
+  if (processInformation)
+  {
+    strncpy(processInformation->ProgressMessage, comment.c_str(), 1023);
+    processInformation->Progress = progress;
+    if (processInformation->ProgressCallbackFunction
+        && processInformation->ProgressCallbackClientData)
+    {
+      (*(processInformation->ProgressCallbackFunction))(processInformation->ProgressCallbackClientData);
+    }
+  }
+  else
+  {
+    std::cout << "<filter-comment>" << " \"" << comment << "\" " << "</filter-comment>" << std::endl;
+    std::cout << "<filter-progress>" << progress << "</filter-progress>" << std::endl;
+    std::cout << std::flush;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool WriteModel(vtkPolyData* polyData, const std::string& fileName, const char* header)
+{
+  vtkNew<vtkPolyDataWriter> writer;
+  // version 5.1 is not compatible with earlier Slicer versions (VTK < 9) and most other software
+  writer->SetFileVersion(42);
+  writer->SetInputData(polyData);
+  writer->SetHeader(header);
+  writer->SetFileType(2);
+  writer->SetFileName(fileName.c_str());
+  return writer->Write() != 0;
+}
+
+//----------------------------------------------------------------------------
+// Model of one label, generated from the multi-label surface nets output
+struct LabelSurface
+{
+  int Label{ 0 };
+  std::string Name;
+  std::string FileName;
+  // Cells of the surface nets output that bound this label. Cells where the label is
+  // on the second side are stored as -cellId-1 and their point order is reversed.
+  std::vector<vtkIdType> CellIds;
+  bool Empty{ false };
+  bool Written{ false };
+  std::string ErrorMessage;
+};
+
+//----------------------------------------------------------------------------
+// Settings of the per-label pipeline, shared by all threads (read-only)
+struct LabelSurfaceParameters
+{
+  vtkPolyData* Boundaries{ nullptr };
+  double IJKToLPS[16];
+  bool ReverseSense{ false };
+  bool SmoothSurface{ true };
+  bool SincFilter{ true };
+  int Smooth{ 10 };
+  double Decimate{ 0.25 };
+  bool SplitNormals{ true };
+  bool PointNormals{ true };
+  bool SaveIntermediateModels{ false };
+  std::string IntermediateFilePrefix;
+  const char* Header{ nullptr };
+};
+
+//----------------------------------------------------------------------------
+// Copy the cells of one label out of the multi-label surface. Orientation is made
+// consistent and outward facing in IJK space, using the sign of the enclosed volume.
+// Safe to call from multiple threads at once.
+vtkSmartPointer<vtkPolyData> ExtractLabelSurface(vtkPolyData* boundaries, const std::vector<vtkIdType>& cellIds)
+{
+  vtkPoints* inputPoints = boundaries->GetPoints();
+  vtkCellArray* inputPolys = boundaries->GetPolys();
+
+  vtkNew<vtkPoints> points;
+  points->SetDataType(inputPoints->GetDataType());
+  vtkNew<vtkCellArray> polys;
+  polys->AllocateEstimate(static_cast<vtkIdType>(cellIds.size()), 3);
+
+  std::unordered_map<vtkIdType, vtkIdType> pointIdMap;
+  pointIdMap.reserve(cellIds.size());
+  vtkNew<vtkIdList> inputCellPointIds;
+  std::vector<vtkIdType> cellPointIds;
+  double signedVolume = 0.0;
+  for (vtkIdType encodedCellId : cellIds)
+  {
+    bool reverse = (encodedCellId < 0);
+    // surface nets output only contains polygons, therefore cell ID and polygon index are the same
+    inputPolys->GetCellAtId(reverse ? -encodedCellId - 1 : encodedCellId, inputCellPointIds);
+    vtkIdType numberOfCellPoints = inputCellPointIds->GetNumberOfIds();
+    cellPointIds.resize(numberOfCellPoints);
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+    {
+      vtkIdType inputPointId = inputCellPointIds->GetId(reverse ? numberOfCellPoints - 1 - pointIndex : pointIndex);
+      auto pointIdIt = pointIdMap.find(inputPointId);
+      if (pointIdIt == pointIdMap.end())
+      {
+        double point[3];
+        inputPoints->GetPoint(inputPointId, point);
+        pointIdIt = pointIdMap.emplace(inputPointId, points->InsertNextPoint(point)).first;
+      }
+      cellPointIds[pointIndex] = pointIdIt->second;
+    }
+    polys->InsertNextCell(numberOfCellPoints, cellPointIds.data());
+
+    // accumulate the volume of the tetrahedra formed by the origin and a fan of triangles
+    double p0[3], p1[3], p2[3], cross[3];
+    points->GetPoint(cellPointIds[0], p0);
+    for (vtkIdType pointIndex = 1; pointIndex + 1 < numberOfCellPoints; ++pointIndex)
+    {
+      points->GetPoint(cellPointIds[pointIndex], p1);
+      points->GetPoint(cellPointIds[pointIndex + 1], p2);
+      vtkMath::Cross(p1, p2, cross);
+      signedVolume += vtkMath::Dot(p0, cross);
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->SetPoints(points);
+  surface->SetPolys(polys);
+  if (signedVolume < 0)
+  {
+    vtkNew<vtkReverseSense> reverser;
+    reverser->SetInputData(surface);
+    reverser->Update();
+    surface = reverser->GetOutput();
+  }
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+// Run decimation, smoothing, normal computation, and write the model of one label.
+// Each call creates its own filters, so calls for different labels may run in parallel.
+// Errors are stored in the label surface and reported later from the main thread.
+void ProcessLabelSurface(LabelSurface& labelSurface, const LabelSurfaceParameters& parameters)
+{
+  vtkSmartPointer<vtkPolyData> surface = ExtractLabelSurface(parameters.Boundaries, labelSurface.CellIds);
+  if (surface->GetNumberOfPolys() == 0)
+  {
+    labelSurface.Empty = true;
+    return;
+  }
+  if (parameters.SaveIntermediateModels)
+  {
+    WriteModel(surface, parameters.IntermediateFilePrefix + labelSurface.Name + "-SurfaceNets.vtk", parameters.Header);
+  }
+
+  vtkNew<vtkDecimatePro> decimator;
+  decimator->SetInputData(surface);
+  decimator->SetFeatureAngle(60);
+  decimator->SplittingOff();
+  decimator->PreserveTopologyOn();
+  decimator->SetMaximumError(1);
+  decimator->SetTargetReduction(parameters.Decimate);
+  decimator->Update();
+  surface = decimator->GetOutput();
+  if (parameters.SaveIntermediateModels)
+  {
+    WriteModel(surface, parameters.IntermediateFilePrefix + labelSurface.Name + "-Decimated.vtk", parameters.Header);
+  }
+
+  if (parameters.ReverseSense)
+  {
+    vtkNew<vtkReverseSense> reverser;
+    reverser->SetInputData(surface);
+    reverser->ReverseNormalsOn();
+    reverser->Update();
+    surface = reverser->GetOutput();
+  }
+
+  if (parameters.SmoothSurface)
+  {
+    if (parameters.SincFilter)
+    {
+      vtkNew<vtkWindowedSincPolyDataFilter> smootherSinc;
+      smootherSinc->SetInputData(surface);
+      smootherSinc->SetPassBand(0.1);
+      smootherSinc->SetNumberOfIterations(parameters.Smooth);
+      smootherSinc->FeatureEdgeSmoothingOff();
+      smootherSinc->BoundarySmoothingOff();
+      smootherSinc->Update();
+      surface = smootherSinc->GetOutput();
+    }
+    else
+    {
+      vtkNew<vtkSmoothPolyDataFilter> smootherPoly;
+      smootherPoly->SetInputData(surface);
+      smootherPoly->SetRelaxationFactor(0.33);
+      smootherPoly->SetFeatureAngle(60);
+      smootherPoly->SetConvergence(0);
+      smootherPoly->SetNumberOfIterations(parameters.Smooth);
+      smootherPoly->FeatureEdgeSmoothingOff();
+      smootherPoly->BoundarySmoothingOff();
+      smootherPoly->Update();
+      surface = smootherPoly->GetOutput();
+    }
+    if (parameters.SaveIntermediateModels)
+    {
+      WriteModel(surface, parameters.IntermediateFilePrefix + labelSurface.Name + "-Smoothed.vtk", parameters.Header);
+    }
+  }
+
+  // transforms are not shared between threads
+  vtkNew<vtkTransform> transformIJKtoLPS;
+  transformIJKtoLPS->SetMatrix(parameters.IJKToLPS);
+  vtkNew<vtkTransformPolyDataFilter> transformer;
+  transformer->SetInputData(surface);
+  transformer->SetTransform(transformIJKtoLPS);
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputConnection(transformer->GetOutputPort());
+  normals->SetComputePointNormals(parameters.PointNormals);
+  normals->SetFeatureAngle(60);
+  normals->SetSplitting(parameters.SplitNormals);
+
+  vtkNew<vtkStripper> stripper;
+  stripper->SetInputConnection(normals->GetOutputPort());
+  stripper->Update();
+
+  if (!WriteModel(stripper->GetOutput(), labelSurface.FileName, parameters.Header))
+  {
+    labelSurface.ErrorMessage = "Failed to write model file " + labelSurface.FileName;
+    return;
+  }
+  labelSurface.Written = true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 int main(int argc, char * argv[])
 {
   PARSE_ARGS;
@@ -87,6 +453,7 @@ int main(int argc, char * argv[])
     std::cout << "Calculate point normals? " << PointNormals << std::endl;
     std::cout << "Pad? " << Pad << std::endl;
     std::cout << "Filter type: " << FilterType << std::endl;
+    std::cout << "Surface nets: " << SurfaceNets << std::endl;
     std::cout << "Input color hierarchy scene file: "
               << (ModelHierarchyFile.size() > 0 ? ModelHierarchyFile.c_str() : "None")  << std::endl;
     std::cout << "Output model scene file: "
@@ -648,102 +1015,106 @@ int main(int argc, char * argv[])
       }
     }
 
-    if (cubes)
+    // surface nets extracts the surfaces of all labels after the label loop
+    if (!SurfaceNets)
     {
-      cubes->SetInputData(nullptr);
-      cubes = nullptr;
-    }
+      if (cubes)
+      {
+        cubes->SetInputData(nullptr);
+        cubes = nullptr;
+      }
 
-    cubes = vtkSmartPointer<vtkDiscreteFlyingEdges3D>::New();
-    std::string            comment1 = "Discrete Marching Cubes";
-    vtkPluginFilterWatcher watchDMCubes(cubes,
-                                        comment1.c_str(),
-                                        CLPProcessInformation,
-                                        1.0 / numFilterSteps,
-                                        currentFilterOffset / numFilterSteps);
-    if (debug)
-    {
-      watchDMCubes.QuietOn();
-    }
-    currentFilterOffset += 1.0;
-    // add padding if flag is set
-    if (Pad)
-    {
-      cubes->SetInputConnection(padder->GetOutputPort());
-    }
-    else
-    {
-      cubes->SetInputData(image);
-    }
-    if (useStartEnd)
-    {
+      cubes = vtkSmartPointer<vtkDiscreteFlyingEdges3D>::New();
+      std::string            comment1 = "Discrete Marching Cubes";
+      vtkPluginFilterWatcher watchDMCubes(cubes,
+                                          comment1.c_str(),
+                                          CLPProcessInformation,
+                                          1.0 / numFilterSteps,
+                                          currentFilterOffset / numFilterSteps);
       if (debug)
       {
-        std::cout << "Marching cubes: Using end label = " << EndLabel << ", start label = " << StartLabel << endl;
+        watchDMCubes.QuietOn();
       }
-      cubes->GenerateValues((EndLabel - StartLabel + 1), StartLabel, EndLabel);
-    }
-    else
-    {
-      if (debug)
+      currentFilterOffset += 1.0;
+      // add padding if flag is set
+      if (Pad)
       {
-        std::cout << "Marching cubes: Using max = " << labelsMax << ", min = " << labelsMin << endl;
+        cubes->SetInputConnection(padder->GetOutputPort());
       }
-      cubes->GenerateValues((labelsMax - labelsMin + 1), labelsMin, labelsMax);
-    }
-    try
-    {
-      cubes->Update();
-    }
-    catch(...)
-    {
-      std::cerr << "ERROR while updating marching cubes filter." << std::endl;
-      return EXIT_FAILURE;
-    }
-    if (JointSmoothing)
-    {
-      float passBand = 0.001;
-      if (smoother)
+      else
       {
-        smoother->SetInputData(nullptr);
-        smoother = nullptr;
+        cubes->SetInputData(image);
       }
-      smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
-      std::stringstream stream;
-      stream << "Joint Smooth All Models (";
-      stream << numModelsToGenerate;
-      stream << " to process)";
-      std::string            comment2 = stream.str();
-      vtkPluginFilterWatcher watchSmoother(smoother,
-                                           comment2.c_str(),
-                                           CLPProcessInformation,
-                                           1.0 / numFilterSteps,
-                                           currentFilterOffset / numFilterSteps);
-      currentFilterOffset += 1.0;
-      if (debug)
+      if (useStartEnd)
       {
-        watchSmoother.QuietOn();
+        if (debug)
+        {
+          std::cout << "Marching cubes: Using end label = " << EndLabel << ", start label = " << StartLabel << endl;
+        }
+        cubes->GenerateValues((EndLabel - StartLabel + 1), StartLabel, EndLabel);
+      }
+      else
+      {
+        if (debug)
+        {
+          std::cout << "Marching cubes: Using max = " << labelsMax << ", min = " << labelsMin << endl;
+        }
+        cubes->GenerateValues((labelsMax - labelsMin + 1), labelsMin, labelsMax);
       }
-      cubes->ReleaseDataFlagOn();
-      smoother->SetInputConnection(cubes->GetOutputPort());
-      smoother->SetNumberOfIterations(Smooth);
-      smoother->BoundarySmoothingOff();
-      smoother->FeatureEdgeSmoothingOff();
-      smoother->SetFeatureAngle(120.0l);
-      smoother->SetPassBand(passBand);
-      smoother->NonManifoldSmoothingOn();
-      smoother->NormalizeCoordinatesOn();
-
       try
       {
-        smoother->Update();
+        cubes->Update();
       }
       catch(...)
       {
-        std::cerr << "ERROR while updating smoothing filter." << std::endl;
+        std::cerr << "ERROR while updating marching cubes filter." << std::endl;
         return EXIT_FAILURE;
       }
-      //        smoother->ReleaseDataFlagOn();
+      if (JointSmoothing)
+      {
+        float passBand = 0.001;
+        if (smoother)
+        {
+          smoother->SetInputData(nullptr);
+          smoother = nullptr;
+        }
+        smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+        std::stringstream stream;
+        stream << "Joint Smooth All Models (";
+        stream << numModelsToGenerate;
+        stream << " to process)";
+        std::string            comment2 = stream.str();
+        vtkPluginFilterWatcher watchSmoother(smoother,
+                                             comment2.c_str(),
+                                             CLPProcessInformation,
+                                             1.0 / numFilterSteps,
+                                             currentFilterOffset / numFilterSteps);
+        currentFilterOffset += 1.0;
+        if (debug)
+        {
+          watchSmoother.QuietOn();
+        }
+        cubes->ReleaseDataFlagOn();
+        smoother->SetInputConnection(cubes->GetOutputPort());
+        smoother->SetNumberOfIterations(Smooth);
+        smoother->BoundarySmoothingOff();
+        smoother->FeatureEdgeSmoothingOff();
+        smoother->SetFeatureAngle(120.0l);
+        smoother->SetPassBand(passBand);
+        smoother->NonManifoldSmoothingOn();
+        smoother->NormalizeCoordinatesOn();
+
+        try
+        {
+          smoother->Update();
+        }
+        catch(...)
+        {
+          std::cerr << "ERROR while updating smoothing filter." << std::endl;
+          return EXIT_FAILURE;
+        }
+        //        smoother->ReleaseDataFlagOn();
+      }
     }
 /*
       vtkPluginFilterWatcher watchImageAccumulate(hist,
@@ -871,6 +1242,7 @@ int main(int argc, char * argv[])
       loopLabels.push_back(Labels[i]);
     }
   }
+  std::vector<LabelSurface> labelSurfaces;
   for(::size_t l = 0; l < loopLabels.size(); l++)
   {
     // get the label out of the vector
@@ -981,6 +1353,16 @@ int main(int argc, char * argv[])
       */
     }
 
+    if (SurfaceNets)
+    {
+      // the surfaces of all the labels are extracted together after the loop
+      LabelSurface labelSurface;
+      labelSurface.Label = i;
+      labelSurface.Name = labelName;
+      labelSurfaces.push_back(labelSurface);
+      continue;
+    }
+
     // threshold
     if (JointSmoothing == 0)
     {
@@ -1619,115 +2001,194 @@ int main(int argc, char * argv[])
       writer = nullptr;
       if (modelScene.GetPointer() != nullptr)
       {
-        if (debug)
-        {
-          std::cout << "Adding model " << labelName << " to the output scene, with filename " << fileName.c_str()
-                    << endl;
-        }
-        // each model needs a mrml node, a storage node and a display node
-        vtkNew<vtkMRMLModelNode> mnode;
-        mnode->SetScene(modelScene.GetPointer());
-        mnode->SetName(labelName.c_str());
-
-        vtkNew<vtkMRMLModelStorageNode> snode;
-        snode->SetFileName(fileName.c_str());
-        if (modelScene->AddNode(snode.GetPointer()) == nullptr)
-        {
-          std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
-        }
-        vtkNew<vtkMRMLModelDisplayNode> dnode;
-        dnode->SetColor(0.5, 0.5, 0.5);
-        double *rgba;
-        if (colorNode != nullptr)
+        AddModelToScene(modelScene.GetPointer(), rnd, topColorHierarchyNode, colorNode, i, labelName, fileName, debug);
+      }
+    } // end of skipping an empty label
+  }   // end of loop over labels
+
+  //
+  // Surface nets: extract the surfaces of all the labels in one pass,
+  // then process and write the models of the labels in parallel
+  //
+  if (SurfaceNets && labelSurfaces.size() > 0)
+  {
+    vtkNew<vtkSurfaceNets3D> surfaceNets;
+    std::stringstream commentStream;
+    commentStream << "Surface Nets (" << labelSurfaces.size() << " labels)";
+    std::string            commentSurfaceNets = commentStream.str();
+    vtkPluginFilterWatcher watchSurfaceNets(surfaceNets,
+                                            commentSurfaceNets.c_str(),
+                                            CLPProcessInformation,
+                                            1.0 / numFilterSteps,
+                                            currentFilterOffset / numFilterSteps);
+    currentFilterOffset += 1.0;
+    if (debug)
+    {
+      watchSurfaceNets.QuietOn();
+    }
+    if (Pad)
+    {
+      surfaceNets->SetInputConnection(padder->GetOutputPort());
+    }
+    else
+    {
+      surfaceNets->SetInputData(image);
+    }
+    for (::size_t l = 0; l < labelSurfaces.size(); l++)
+    {
+      surfaceNets->SetValue(static_cast<int>(l), labelSurfaces[l].Label);
+    }
+    // decimation requires triangles
+    surfaceNets->SetOutputMeshTypeToTriangles();
+    surfaceNets->ComputeScalarsOn();
+    if (JointSmoothing && Smooth > 0)
+    {
+      // constrained smoothing of all boundaries at once keeps the models fitting together
+      surfaceNets->SmoothingOn();
+      surfaceNets->SetNumberOfIterations(Smooth);
+    }
+    else
+    {
+      surfaceNets->SmoothingOff();
+    }
+    try
+    {
+      surfaceNets->Update();
+    }
+    catch(...)
+    {
+      std::cerr << "ERROR while updating surface nets filter." << std::endl;
+      return EXIT_FAILURE;
+    }
+    vtkPolyData* boundaries = surfaceNets->GetOutput();
+    vtkDataArray* boundaryLabels = boundaries->GetCellData()->GetScalars();
+    if (boundaries->GetNumberOfPolys() > 0 &&
+        (boundaryLabels == nullptr || boundaryLabels->GetNumberOfComponents() != 2))
+    {
+      std::cerr << "ERROR: surface nets output does not contain boundary labels." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (debug)
+    {
+      std::cout << "Surface nets: number of polygons = " << boundaries->GetNumberOfPolys() << endl;
+    }
+
+    // Sort the boundary cells by label in a single pass.
+    // Each cell is shared by the two labels on its sides.
+    std::map<int, ::size_t> labelSurfaceIndices;
+    for (::size_t l = 0; l < labelSurfaces.size(); l++)
+    {
+      labelSurfaceIndices[labelSurfaces[l].Label] = l;
+    }
+    vtkIdType numberOfBoundaryCells = boundaries->GetNumberOfPolys() > 0 ? boundaries->GetNumberOfCells() : 0;
+    for (vtkIdType cellId = 0; cellId < numberOfBoundaryCells; cellId++)
+    {
+      double cellLabels[2];
+      boundaryLabels->GetTuple(cellId, cellLabels);
+      std::map<int, ::size_t>::iterator labelSurfaceIt = labelSurfaceIndices.find(static_cast<int>(cellLabels[0]));
+      if (labelSurfaceIt != labelSurfaceIndices.end())
+      {
+        labelSurfaces[labelSurfaceIt->second].CellIds.push_back(cellId);
+      }
+      labelSurfaceIt = labelSurfaceIndices.find(static_cast<int>(cellLabels[1]));
+      if (labelSurfaceIt != labelSurfaceIndices.end())
+      {
+        labelSurfaces[labelSurfaceIt->second].CellIds.push_back(-cellId - 1);
+      }
+    }
+
+    LabelSurfaceParameters parameters;
+    parameters.Boundaries = boundaries;
+    vtkMatrix4x4::DeepCopy(parameters.IJKToLPS, transformIJKtoLPS->GetMatrix());
+    parameters.ReverseSense = ((transformIJKtoLPS->GetMatrix())->Determinant() < 0);
+    parameters.SmoothSurface = !JointSmoothing;
+    parameters.SincFilter = (strcmp(FilterType.c_str(), "Sinc") == 0);
+    if (parameters.SmoothSurface && parameters.SincFilter && Smooth == 1)
+    {
+      std::cerr << "Warning: Smoothing iterations of 1 not allowed for Sinc filter, using 2" << endl;
+      Smooth = 2;
+    }
+    parameters.Smooth = Smooth;
+    parameters.Decimate = Decimate;
+    parameters.SplitNormals = SplitNormals;
+    parameters.PointNormals = PointNormals;
+    parameters.SaveIntermediateModels = SaveIntermediateModels;
+    parameters.IntermediateFilePrefix = (rootDir != "" ? rootDir + std::string("/") : std::string(""));
+    parameters.Header = modelFileHeader;
+    if (rootDir == "")
+    {
+      std::cout << "WARNING: output directory is an empty string..." << endl;
+    }
+    for (::size_t l = 0; l < labelSurfaces.size(); l++)
+    {
+      labelSurfaces[l].FileName = parameters.IntermediateFilePrefix + labelSurfaces[l].Name + std::string(".vtk");
+    }
+
+    // Labels are processed in batches so that finished models are added to the scene and
+    // progress is reported from the main thread while the remaining labels are processed.
+    vtkIdType numberOfLabelSurfaces = static_cast<vtkIdType>(labelSurfaces.size());
+    vtkIdType batchSize = std::max(1, 2 * vtkSMPTools::GetEstimatedNumberOfThreads());
+    double startProgress = currentFilterOffset / numFilterSteps;
+    for (vtkIdType batchStart = 0; batchStart < numberOfLabelSurfaces; batchStart += batchSize)
+    {
+      if (CLPProcessInformation && CLPProcessInformation->Abort)
+      {
+        std::cerr << "Model generation was aborted." << std::endl;
+        break;
+      }
+      vtkIdType batchEnd = std::min(numberOfLabelSurfaces, batchStart + batchSize);
+      vtkSMPTools::For(batchStart, batchEnd, 1, [&](vtkIdType begin, vtkIdType end)
+      {
+        for (vtkIdType l = begin; l < end; l++)
         {
-          rgba = colorNode->GetLookupTable()->GetTableValue(i);
-          if (rgba != nullptr)
+          try
           {
-            if (debug)
-            {
-              std::cout << "Got color: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
-            }
-            dnode->SetColor(rgba[0], rgba[1], rgba[2]);
+            ProcessLabelSurface(labelSurfaces[l], parameters);
           }
-          else
+          catch(...)
           {
-            std::cerr << "Couldn't get look up table value for " << i << ", display node color is not set (grey)"
-                      << endl;
+            labelSurfaces[l].ErrorMessage = "Failed to generate model " + labelSurfaces[l].Name;
           }
         }
-
-        dnode->SetVisibility(1);
-        modelScene->AddNode(dnode.GetPointer());
-        if (debug)
-        {
-          std::cout << "Added display node: id = " << (dnode->GetID() == nullptr ? "(null)" : dnode->GetID()) << endl;
-          std::cout << "Setting model's storage node: id = "
-                    << (snode->GetID() == nullptr ? "(null)" : snode->GetID()) << endl;
-        }
-        mnode->SetAndObserveStorageNodeID(snode->GetID());
-        mnode->SetAndObserveDisplayNodeID(dnode->GetID());
-        modelScene->AddNode(mnode.GetPointer());
-
-        // put it in the hierarchy, either the flat one by default or
-        // try to find the matching color hierarchy node to make this an
-        // associated node
-        std::string colorName;
-        if (colorNode != nullptr)
-        {
-          colorName = std::string(colorNode->GetColorNameAsFileName(i));
-        }
-        else
+      });
+      for (vtkIdType l = batchStart; l < batchEnd; l++)
+      {
+        LabelSurface& labelSurface = labelSurfaces[l];
+        // release the memory, the cells are not needed anymore
+        std::vector<vtkIdType>().swap(labelSurface.CellIds);
+        if (!labelSurface.Written)
         {
-          // might be in a testing case where the hierarchy nodes are
-          // numbered (made from the generic colors)
-          std::stringstream ss;
-          ss << i;
-          colorName = ss.str();
-          if (debug)
+          if (labelSurface.Empty)
           {
-            std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
+            std::cout << "Cannot create a model from label " << labelSurface.Label
+                      << "\nNo polygons can be created,\nthere may be no voxels with this label in the volume." << endl;
           }
-        }
-        vtkMRMLNode *mrmlNode = nullptr;
-        if (colorName.compare("") != 0)
-        {
-          mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
-        }
-        // if there's no color hierarchy, or no color name or the mrml node
-        // named for the color isn't a model hierarchy node, use a flat hierarchy
-        if (topColorHierarchyNode == nullptr ||
-            colorName.compare("") == 0 ||
-            mrmlNode == nullptr ||
-            strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
-        {
-          vtkNew<vtkMRMLModelHierarchyNode> mhnd;
-          mhnd->SetHideFromEditors(1);
-          modelScene->AddNode(mhnd.GetPointer());
-          mhnd->SetParentNodeID(rnd->GetID());
-          mhnd->SetModelNodeID(mnode->GetID());
-        }
-        else
-        {
-          // use the template color hierarchy
-          vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
-          if (colorHierarchyNode)
+          else
           {
-            colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
-            // and hide it so that it doesn't clutter up the tree
-            colorHierarchyNode->SetHideFromEditors(1);
-            if (debug)
-            {
-              std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
-            }
+            std::cerr << "ERROR: " << labelSurface.ErrorMessage << std::endl;
           }
+          std::vector<int>::iterator madeModelIt = std::find(madeModels.begin(), madeModels.end(), labelSurface.Label);
+          if (madeModelIt != madeModels.end())
+          {
+            madeModels.erase(madeModelIt);
+          }
+          skippedModels.push_back(labelSurface.Label);
+          continue;
         }
         if (debug)
         {
-          std::cout << "...done adding model to output scene" << endl;
+          std::cout << "Wrote model " << labelSurface.Name << " to file " << labelSurface.FileName << endl;
+        }
+        if (modelScene.GetPointer() != nullptr)
+        {
+          AddModelToScene(modelScene.GetPointer(), rnd, topColorHierarchyNode, colorNode,
+                          labelSurface.Label, labelSurface.Name, labelSurface.FileName, debug);
         }
       }
-    } // end of skipping an empty label
-  }   // end of loop over labels
+      ReportProgress(CLPProcessInformation, "Generate models",
+                     startProgress + (1.0 - startProgress) * batchEnd / numberOfLabelSurfaces);
+    }
+  }
   if (debug)
   {
     std::cout << "End of looping over labels" << endl;
@@ -720,6 +720,7 @@ bool vtkMRMLMarkupsJsonStorageNode::ReadControlPoints(vtkMRMLMarkupsJsonElement*
   bool wasUpdatingPoints = markupsNode->IsUpdatingPoints;
   markupsNode->IsUpdatingPoints = true;
   int numberOfControlPoints = controlPointsArray->GetArraySize();
+  markupsNode->ControlPoints.reserve(markupsNode->ControlPoints.size() + numberOfControlPoints);
   for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; ++controlPointIndex)
   {
     vtkSmartPointer<vtkMRMLMarkupsJsonElement> controlPointItem
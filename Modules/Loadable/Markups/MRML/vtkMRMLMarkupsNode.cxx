@@ -40,12 +40,14 @@
 #include <vtkCollection.h>
 #include <vtkParallelTransportFrame.h>
 #include <vtkGeneralTransform.h>
+#include <vtkIdList.h>
 #include <vtkMatrix3x3.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
@@ -458,6 +460,7 @@ void vtkMRMLMarkupsNode::RemoveAllControlPoints()
   }
 
   this->ControlPoints.clear();
+  this->InvalidateControlPointIndexLookup();
 
   if (!this->GetDisableModifiedEvent())
   {
@@ -632,6 +635,12 @@ int vtkMRMLMarkupsNode::AddControlPoint(ControlPoint *controlPoint, bool autoLab
   }
 
   this->ControlPoints.push_back(controlPoint);
+  if (this->ControlPointIndexLookupValid)
+  {
+    // emplace does not overwrite, so the first control point is found if IDs or labels are not unique
+    this->ControlPointIDToIndex.emplace(controlPoint->ID, static_cast<int>(this->ControlPoints.size()) - 1);
+    this->ControlPointLabelToIndex.emplace(controlPoint->Label, static_cast<int>(this->ControlPoints.size()) - 1);
+  }
 
   if (!this->GetDisableModifiedEvent())
   {
@@ -721,6 +730,70 @@ int vtkMRMLMarkupsNode::AddNControlPoints(int n, std::string label /*=std::strin
   return controlPointIndex;
 }
 
+//-----------------------------------------------------------
+int vtkMRMLMarkupsNode::AddControlPoints(vtkPoints* points)
+{
+  if (!points)
+  {
+    vtkErrorMacro("AddControlPoints: invalid points");
+    return -1;
+  }
+  int numberOfPoints = static_cast<int>(points->GetNumberOfPoints());
+  if (this->MaximumNumberOfControlPoints >= 0 && this->GetNumberOfControlPoints() + numberOfPoints > this->MaximumNumberOfControlPoints)
+  {
+    vtkErrorMacro("AddControlPoints: number of existing points (" << this->GetNumberOfControlPoints()
+      << ") plus requested number of new points (" << numberOfPoints << ") are more than maximum number of control points allowed ("
+      << this->MaximumNumberOfControlPoints << ")");
+    return -1;
+  }
+  if (this->GetFixedNumberOfControlPoints())
+  {
+    vtkErrorMacro("AddControlPoints: Markup node control point number is locked.");
+    return -1;
+  }
+
+  // Curve polydata and measurements are updated once, in EndModify()
+  MRMLNodeModifyBlocker blocker(this);
+  bool wasUpdatingPoints = this->IsUpdatingPoints;
+  this->IsUpdatingPoints = true;
+
+  this->ControlPoints.reserve(this->ControlPoints.size() + numberOfPoints);
+  int controlPointIndex = -1;
+  for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+  {
+    ControlPoint* controlPoint = new ControlPoint;
+    points->GetPoint(pointIndex, controlPoint->Position);
+    controlPoint->PositionStatus = PositionDefined;
+    controlPointIndex = this->AddControlPoint(controlPoint);
+  }
+
+  this->IsUpdatingPoints = wasUpdatingPoints;
+  return controlPointIndex;
+}
+
+//-----------------------------------------------------------
+int vtkMRMLMarkupsNode::AddControlPointsWorld(vtkPoints* points)
+{
+  if (!points)
+  {
+    vtkErrorMacro("AddControlPointsWorld: invalid points");
+    return -1;
+  }
+  vtkNew<vtkPoints> pointsLocal;
+  vtkMRMLTransformNode* tnode = this->GetParentTransformNode();
+  vtkNew<vtkGeneralTransform> worldToLocalTransform;
+  if (tnode)
+  {
+    tnode->GetTransformFromWorld(worldToLocalTransform);
+    worldToLocalTransform->TransformPoints(points, pointsLocal);
+  }
+  else
+  {
+    pointsLocal->DeepCopy(points);
+  }
+  return this->AddControlPoints(pointsLocal);
+}
+
 //-----------------------------------------------------------
 int vtkMRMLMarkupsNode::AddControlPointWorld(double x, double y, double z, std::string label /*=std::string()*/)
 {
@@ -848,6 +921,7 @@ void vtkMRMLMarkupsNode::RemoveNthControlPoint(int pointIndex)
 
   delete this->ControlPoints[static_cast<unsigned int> (pointIndex)];
   this->ControlPoints.erase(this->ControlPoints.begin() + pointIndex);
+  this->InvalidateControlPointIndexLookup();
 
   if (!this->GetDisableModifiedEvent())
   {
@@ -870,6 +944,88 @@ void vtkMRMLMarkupsNode::RemoveNthControlPoint(int pointIndex)
   }
 }
 
+//-----------------------------------------------------------
+void vtkMRMLMarkupsNode::RemoveControlPoints(vtkIdList* pointIndices)
+{
+  if (!pointIndices)
+  {
+    vtkErrorMacro("RemoveControlPoints: invalid point index list");
+    return;
+  }
+  if (pointIndices->GetNumberOfIds() == 0)
+  {
+    // no control points to remove
+    return;
+  }
+  if (this->GetFixedNumberOfControlPoints())
+  {
+    vtkErrorMacro("RemoveControlPoints: Markup node control point number locked.");
+    return;
+  }
+
+  int numberOfControlPoints = this->GetNumberOfControlPoints();
+  std::vector<bool> removeControlPoint(numberOfControlPoints, false);
+  for (vtkIdType i = 0; i < pointIndices->GetNumberOfIds(); i++)
+  {
+    vtkIdType pointIndex = pointIndices->GetId(i);
+    if (pointIndex < 0 || pointIndex >= numberOfControlPoints)
+    {
+      vtkErrorMacro("RemoveControlPoints: control point index " << pointIndex
+        << " is out of range 0-" << numberOfControlPoints - 1);
+      return;
+    }
+    removeControlPoint[pointIndex] = true;
+  }
+
+  // Points must be still alive when the about to be removed events are invoked,
+  // so they are invoked before modified events are blocked (which would defer them).
+  for (int pointIndex = 0; pointIndex < numberOfControlPoints; pointIndex++)
+  {
+    if (removeControlPoint[pointIndex])
+    {
+      this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointAboutToBeRemovedEvent, static_cast<void*>(&pointIndex));
+    }
+  }
+
+  MRMLNodeModifyBlocker blocker(this);
+
+  // Remove all the points in a single pass, keeping the order of the remaining points
+  bool definedPointsRemoved = false;
+  bool missingPointsRemoved = false;
+  int numberOfKeptControlPoints = 0;
+  for (int pointIndex = 0; pointIndex < numberOfControlPoints; pointIndex++)
+  {
+    ControlPoint* controlPoint = this->ControlPoints[pointIndex];
+    if (!removeControlPoint[pointIndex])
+    {
+      this->ControlPoints[numberOfKeptControlPoints++] = controlPoint;
+      continue;
+    }
+    if (controlPoint->PositionStatus == vtkMRMLMarkupsNode::PositionDefined)
+    {
+      definedPointsRemoved = true;
+    }
+    if (controlPoint->PositionStatus == vtkMRMLMarkupsNode::PositionMissing)
+    {
+      missingPointsRemoved = true;
+    }
+    delete controlPoint;
+  }
+  this->ControlPoints.resize(numberOfKeptControlPoints);
+  this->InvalidateControlPointIndexLookup();
+
+  if (definedPointsRemoved)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointPositionUndefinedEvent);
+  }
+  if (missingPointsRemoved)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointPositionNonMissingEvent);
+  }
+  this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointRemovedEvent);
+  this->StorableModifiedTime.Modified();
+}
+
 //-----------------------------------------------------------
 bool vtkMRMLMarkupsNode::InsertControlPoint(ControlPoint *controlPoint, int targetIndex)
 {
@@ -892,6 +1048,7 @@ bool vtkMRMLMarkupsNode::InsertControlPoint(ControlPoint *controlPoint, int targ
 
   std::vector < ControlPoint* >::iterator pos = this->ControlPoints.begin() + destIndex;
   this->ControlPoints.insert(pos, controlPoint);
+  this->InvalidateControlPointIndexLookup();
 
   if (!this->GetDisableModifiedEvent())
   {
@@ -989,6 +1146,7 @@ void vtkMRMLMarkupsNode::SwapControlPoints(int m1, int m2)
   *controlPoint1 = *controlPoint2;
   // and copy the backup of the first one into the second
   *controlPoint2 = controlPoint1Backup;
+  this->InvalidateControlPointIndexLookup();
 
   if (!this->GetDisableModifiedEvent())
   {
@@ -1564,16 +1722,55 @@ int vtkMRMLMarkupsNode::GetControlPointIndexByID(const char* id)
   {
     return -1;
   }
-  for (int controlPointIndex = 0; controlPointIndex < this->GetNumberOfControlPoints(); controlPointIndex++)
+  this->UpdateControlPointIndexLookup();
+  auto foundIt = this->ControlPointIDToIndex.find(id);
+  if (foundIt == this->ControlPointIDToIndex.end())
   {
-    ControlPoint *compareControlPoint = this->ControlPoints[controlPointIndex];
-    if (compareControlPoint &&
-        strcmp(compareControlPoint->ID.c_str(), id) == 0)
+    return -1;
+  }
+  int controlPointIndex = foundIt->second;
+  if (controlPointIndex >= this->GetNumberOfControlPoints()
+    || this->ControlPoints[controlPointIndex]->ID != id)
+  {
+    // The control point was modified directly (without invalidating the lookup table),
+    // rebuild the table and try again.
+    this->InvalidateControlPointIndexLookup();
+    this->UpdateControlPointIndexLookup();
+    foundIt = this->ControlPointIDToIndex.find(id);
+    if (foundIt == this->ControlPointIDToIndex.end())
     {
-      return controlPointIndex;
+      return -1;
     }
+    controlPointIndex = foundIt->second;
   }
-  return -1;
+  return controlPointIndex;
+}
+
+//-------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::UpdateControlPointIndexLookup()
+{
+  if (this->ControlPointIndexLookupValid)
+  {
+    return;
+  }
+  int numberOfControlPoints = this->GetNumberOfControlPoints();
+  this->ControlPointIDToIndex.clear();
+  this->ControlPointIDToIndex.reserve(numberOfControlPoints);
+  this->ControlPointLabelToIndex.clear();
+  this->ControlPointLabelToIndex.reserve(numberOfControlPoints);
+  for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
+  {
+    // emplace does not overwrite, so the first control point is found if IDs or labels are not unique
+    this->ControlPointIDToIndex.emplace(this->ControlPoints[controlPointIndex]->ID, controlPointIndex);
+    this->ControlPointLabelToIndex.emplace(this->ControlPoints[controlPointIndex]->Label, controlPointIndex);
+  }
+  this->ControlPointIndexLookupValid = true;
+}
+
+//-------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::InvalidateControlPointIndexLookup()
+{
+  this->ControlPointIndexLookupValid = false;
 }
 
 //-------------------------------------------------------------------------
@@ -1583,16 +1780,28 @@ int vtkMRMLMarkupsNode::GetControlPointIndexByLabel(const char* label)
   {
     return -1;
   }
-  for (int controlPointIndex = 0; controlPointIndex < this->GetNumberOfControlPoints(); controlPointIndex++)
+  this->UpdateControlPointIndexLookup();
+  auto foundIt = this->ControlPointLabelToIndex.find(label);
+  if (foundIt == this->ControlPointLabelToIndex.end())
   {
-    ControlPoint *compareControlPoint = this->ControlPoints[controlPointIndex];
-    if (compareControlPoint &&
-        strcmp(compareControlPoint->Label.c_str(), label) == 0)
+    return -1;
+  }
+  int controlPointIndex = foundIt->second;
+  if (controlPointIndex >= this->GetNumberOfControlPoints()
+    || this->ControlPoints[controlPointIndex]->Label != label)
+  {
+    // The control point was modified directly (without invalidating the lookup table),
+    // rebuild the table and try again.
+    this->InvalidateControlPointIndexLookup();
+    this->UpdateControlPointIndexLookup();
+    foundIt = this->ControlPointLabelToIndex.find(label);
+    if (foundIt == this->ControlPointLabelToIndex.end())
     {
-      return controlPointIndex;
+      return -1;
     }
+    controlPointIndex = foundIt->second;
   }
-  return -1;
+  return controlPointIndex;
 }
 
 //-------------------------------------------------------------------------
@@ -1643,6 +1852,7 @@ void vtkMRMLMarkupsNode::SetNthControlPointID(int n, std::string id)
     return;
   }
   controlPoint->ID = id;
+  this->InvalidateControlPointIndexLookup();
 }
 
 //---------------------------------------------------------------------------
@@ -1774,6 +1984,7 @@ void vtkMRMLMarkupsNode::SetNthControlPointLabel(int n, std::string label)
     return;
   }
   controlPoint->Label = label;
+  this->InvalidateControlPointIndexLookup();
   this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent, static_cast<void*>(&n));
   this->StorableModifiedTime.Modified();
 }
@@ -33,6 +33,9 @@
 #include <vtkSmartPointer.h>
 #include <vtkVector.h>
 
+// STD includes
+#include <unordered_map>
+
 class vtkMatrix3x3;
 class vtkMRMLUnitNode;
 
@@ -67,6 +70,7 @@ class vtkAlgorithmOutput;
 class vtkCollection;
 class vtkDataArray;
 class vtkGeneralTransform;
+class vtkIdList;
 class vtkMatrix4x4;
 class vtkMRMLMarkupsDisplayNode;
 class vtkPolyData;
@@ -318,6 +322,17 @@ public:
   /// Get a copy of all control point positions in world coordinate system
   void GetControlPointPositionsWorld(vtkPoints* points);
 
+  ///@{
+  /// Add a new control point for each point in the point list.
+  /// Points are added in a single batch: observers are notified once,
+  /// after all the points are added (PointAddedEvent is invoked without call data).
+  /// If requested number of points would result more points than the maximum allowed number of points
+  /// then no points are added at all.
+  /// Return index of the last added control point, -1 on failure.
+  int AddControlPoints(vtkPoints* points);
+  int AddControlPointsWorld(vtkPoints* points);
+  ///@}
+
   ///@{
   /// Add a new control point, returning the point index, -1 on failure.
   int AddControlPoint(vtkVector3d point, std::string label = std::string());
@@ -362,6 +377,12 @@ public:
   /// Remove Nth Control Point
   void RemoveNthControlPoint(int pointIndex);
 
+  /// Remove all control points that have their index in the list.
+  /// Points are removed in a single pass and observers are notified once
+  /// (PointRemovedEvent is invoked without call data).
+  /// If any of the indices is invalid then no points are removed.
+  void RemoveControlPoints(vtkIdList* pointIndices);
+
   /// Swap two control points (position data and all other properties).
   void SwapControlPoints(int m1, int m2);
 
@@ -1035,6 +1056,22 @@ protected:
   /// Flag set from SetControlPointPositionsWorld that pauses update of measurements until the update is complete.
   bool IsUpdatingPoints{false};
 
+  /// Rebuild ControlPointIDToIndex and ControlPointLabelToIndex if ControlPoints has been
+  /// changed since they were last built.
+  void UpdateControlPointIndexLookup();
+  /// Mark ControlPointIDToIndex and ControlPointLabelToIndex as outdated.
+  /// Must be called whenever control points are inserted, removed, reordered, or their ID or label is changed.
+  void InvalidateControlPointIndexLookup();
+
+  /// Index of each control point ID, for fast search by ID (first index is stored if
+  /// multiple control points have the same ID)
+  std::unordered_map<std::string, int> ControlPointIDToIndex;
+  /// Index of each control point label, for fast search by label (first index is stored if
+  /// multiple control points have the same label)
+  std::unordered_map<std::string, int> ControlPointLabelToIndex;
+  /// ControlPointIDToIndex and ControlPointLabelToIndex are up-to-date
+  bool ControlPointIndexLookupValid{false};
+
   friend class qSlicerMarkupsModuleWidget; // To directly access measurements
 };
 
@@ -20,12 +20,16 @@
 #include "vtkMRMLScene.h"
 
 // VTK includes
+#include <vtkIdList.h>
 #include <vtkIndent.h>
 #include <vtkMath.h>
 #include <vtkNew.h>
+#include <vtkPoints.h>
 #include <vtkTestingOutputWindow.h>
 
 // STL includes
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "vtkMRMLCoreTestingMacros.h"
@@ -45,7 +49,7 @@ public:
   {
   }
 
-  void Execute(vtkObject *caller, unsigned long event, void*) override
+  void Execute(vtkObject *caller, unsigned long event, void* callData) override
   {
     vtkMRMLDisplayableNode* dispNode = vtkMRMLDisplayableNode::SafeDownCast(caller);
     if (!dispNode)
@@ -53,9 +57,17 @@ public:
       return;
     }
     invokedEvents.push_back(event);
+    vtkMRMLMarkupsNode* markupsNode = vtkMRMLMarkupsNode::SafeDownCast(caller);
+    if (event == vtkMRMLMarkupsNode::PointAboutToBeRemovedEvent && markupsNode && callData)
+    {
+      // the point must still exist when the event is invoked
+      int pointIndex = *static_cast<int*>(callData);
+      aboutToBeRemovedPointIDs.push_back(markupsNode->GetNthControlPointID(pointIndex));
+    }
   }
 
   std::vector<int> invokedEvents;
+  std::vector<std::string> aboutToBeRemovedPointIDs;
 };
 
 void addEventsToObserver(vtkMRMLMarkupsNode* node, vtkMRMLMarkupNodeObserver* observer)
@@ -82,6 +94,13 @@ bool containsEvent(vtkMRMLMarkupNodeObserver* observer, int eventId)
   return found;
 }
 
+int countEvent(vtkMRMLMarkupNodeObserver* observer, int eventId)
+{
+  int count = static_cast<int>(std::count(observer->invokedEvents.begin(), observer->invokedEvents.end(), eventId));
+  observer->invokedEvents.clear();
+  return count;
+}
+
 }
 
 int vtkMRMLMarkupsNodeEventsTest(int, char* [])
@@ -150,5 +169,61 @@ int vtkMRMLMarkupsNodeEventsTest(int, char* [])
   node->RemoveNthControlPoint(0);
   CHECK_BOOL(containsEvent(observer, vtkMRMLMarkupsNode::PointAboutToBeRemovedEvent), true);
 
+  // Test 13: bulk add invokes a single PointAddedEvent
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i < 100; i++)
+  {
+    points->InsertNextPoint(i, 2 * i, 3 * i);
+  }
+  CHECK_INT(node->AddControlPoints(points), 99);
+  CHECK_INT(node->GetNumberOfControlPoints(), 100);
+  CHECK_INT(countEvent(observer, vtkMRMLMarkupsNode::PointAddedEvent), 1);
+  double position[3] = { 0.0, 0.0, 0.0 };
+  node->GetNthControlPointPosition(42, position);
+  CHECK_DOUBLE(position[1], 84.0);
+
+  // Test 14: bulk remove invokes a single PointRemovedEvent and keeps ID lookup consistent
+  std::string id50 = node->GetNthControlPointID(50);
+  CHECK_INT(node->GetControlPointIndexByID(id50.c_str()), 50);
+  vtkNew<vtkIdList> pointsToRemove;
+  for (int i = 0; i < 100; i += 2)
+  {
+    pointsToRemove->InsertNextId(i);
+  }
+  std::string id0 = node->GetNthControlPointID(0);
+  std::string id51 = node->GetNthControlPointID(51);
+  std::string id98 = node->GetNthControlPointID(98);
+  observer->aboutToBeRemovedPointIDs.clear();
+  node->RemoveControlPoints(pointsToRemove);
+  CHECK_INT(node->GetNumberOfControlPoints(), 50);
+  // each removed point is reported with its index, while it still exists
+  CHECK_INT(static_cast<int>(observer->aboutToBeRemovedPointIDs.size()), 50);
+  CHECK_STD_STRING(observer->aboutToBeRemovedPointIDs[0], id0);
+  CHECK_STD_STRING(observer->aboutToBeRemovedPointIDs[49], id98);
+  CHECK_INT(countEvent(observer, vtkMRMLMarkupsNode::PointRemovedEvent), 1);
+  CHECK_INT(node->GetControlPointIndexByID(id50.c_str()), -1);
+  CHECK_INT(node->GetControlPointIndexByID(id0.c_str()), -1);
+  CHECK_INT(node->GetControlPointIndexByID(id51.c_str()), 25);
+  node->GetNthControlPointPosition(25, position);
+  CHECK_DOUBLE(position[0], 51.0);
+
+  // Test 15: ID lookup follows ID changes
+  node->SetNthControlPointID(25, "renamed");
+  CHECK_INT(node->GetControlPointIndexByID(id51.c_str()), -1);
+  CHECK_INT(node->GetControlPointIndexByID("renamed"), 25);
+  node->SwapControlPoints(0, 25);
+  CHECK_INT(node->GetControlPointIndexByID("renamed"), 0);
+
+  // Test 16: label lookup follows label changes and returns the first matching point
+  node->SetNthControlPointLabel(10, "target");
+  node->SetNthControlPointLabel(20, "target");
+  CHECK_INT(node->GetControlPointIndexByLabel("target"), 10);
+  node->SetNthControlPointLabel(10, "other");
+  CHECK_INT(node->GetControlPointIndexByLabel("target"), 20);
+  CHECK_INT(node->GetControlPointIndexByLabel("other"), 10);
+  node->RemoveNthControlPoint(0);
+  CHECK_INT(node->GetControlPointIndexByLabel("target"), 19);
+  CHECK_INT(node->GetControlPointIndexByLabel("nonexistent"), -1);
+
   return EXIT_SUCCESS;
 }
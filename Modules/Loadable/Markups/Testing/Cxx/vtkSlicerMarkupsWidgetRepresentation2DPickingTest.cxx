@@ -0,0 +1,152 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLInteractionEventData.h"
+#include "vtkMRMLMarkupsFiducialDisplayNode.h"
+#include "vtkMRMLMarkupsFiducialNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSliceNode.h"
+
+// Markups VTKWidgets includes
+#include "vtkSlicerPointsRepresentation2D.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkTimerLog.h>
+
+namespace
+{
+
+// Slice view is 500x500 pixels, showing 250x250mm area around the origin (0.5mm/pixel).
+// Control points are placed on a regular grid, with 50mm (100 pixel) spacing.
+const double POINT_SPACING_MM = 50.0;
+
+//---------------------------------------------------------------------------
+void GetControlPointDisplayPosition(int column, int row, int displayPosition[2])
+{
+  displayPosition[0] = static_cast<int>(column * POINT_SPACING_MM * 2.0 + 250.0);
+  displayPosition[1] = static_cast<int>(row * POINT_SPACING_MM * 2.0 + 250.0);
+}
+
+//---------------------------------------------------------------------------
+int Pick(vtkSlicerMarkupsWidgetRepresentation2D* rep, vtkMRMLInteractionEventData* eventData,
+  const int displayPosition[2])
+{
+  eventData->SetDisplayPosition(displayPosition);
+  int foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentNone;
+  int foundComponentIndex = -1;
+  double closestDistance2 = 0.0;
+  rep->CanInteract(eventData, foundComponentType, foundComponentIndex, closestDistance2);
+  if (foundComponentType != vtkMRMLMarkupsDisplayNode::ComponentControlPoint)
+  {
+    return -1;
+  }
+  return foundComponentIndex;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkSlicerMarkupsWidgetRepresentation2DPickingTest(int argc, char* argv[])
+{
+  int numberOfPointsPerRow = 100;
+  if (argc > 1)
+  {
+    numberOfPointsPerRow = atoi(argv[1]);
+  }
+  int numberOfPoints = numberOfPointsPerRow * numberOfPointsPerRow;
+
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLSliceNode> sliceNode;
+  sliceNode->SetLayoutName("Red");
+  sliceNode->SetDimensions(500, 500, 1);
+  sliceNode->SetFieldOfView(250.0, 250.0, 1.0);
+  scene->AddNode(sliceNode);
+
+  vtkNew<vtkMRMLMarkupsFiducialNode> markupsNode;
+  scene->AddNode(markupsNode);
+  vtkNew<vtkMRMLMarkupsFiducialDisplayNode> displayNode;
+  scene->AddNode(displayNode);
+  markupsNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+  vtkNew<vtkPoints> points;
+  for (int row = 0; row < numberOfPointsPerRow; ++row)
+  {
+    for (int column = 0; column < numberOfPointsPerRow; ++column)
+    {
+      points->InsertNextPoint(column * POINT_SPACING_MM, row * POINT_SPACING_MM, 0.0);
+    }
+  }
+  CHECK_INT(markupsNode->AddControlPoints(points), numberOfPoints - 1);
+
+  vtkNew<vtkSlicerPointsRepresentation2D> rep;
+  rep->SetViewNode(sliceNode);
+  rep->SetMarkupsDisplayNode(displayNode);
+  rep->UpdateFromMRML(nullptr, 0);
+
+  vtkNew<vtkMRMLInteractionEventData> eventData;
+  eventData->SetType(vtkCommand::MouseMoveEvent);
+  eventData->SetViewNode(sliceNode);
+
+  // First pick builds the picking grid
+  vtkNew<vtkTimerLog> timer;
+  int displayPosition[2] = { 0, 0 };
+  GetControlPointDisplayPosition(1, 2, displayPosition);
+  timer->StartTimer();
+  CHECK_INT(Pick(rep, eventData, displayPosition), 2 * numberOfPointsPerRow + 1);
+  timer->StopTimer();
+  std::cout << "First pick among " << numberOfPoints << " control points: "
+    << timer->GetElapsedTime() * 1000.0 << "ms" << std::endl;
+
+  // Hover over each control point (slightly off-center) and between control points
+  timer->StartTimer();
+  for (int row = 0; row < numberOfPointsPerRow; ++row)
+  {
+    for (int column = 0; column < numberOfPointsPerRow; ++column)
+    {
+      GetControlPointDisplayPosition(column, row, displayPosition);
+      displayPosition[0] += 10;
+      displayPosition[1] -= 10;
+      CHECK_INT(Pick(rep, eventData, displayPosition), row * numberOfPointsPerRow + column);
+      displayPosition[0] += 40;
+      displayPosition[1] -= 40;
+      CHECK_INT(Pick(rep, eventData, displayPosition), -1);
+    }
+  }
+  timer->StopTimer();
+  std::cout << "Average pick latency: "
+    << timer->GetElapsedTime() * 1000.0 / (2 * numberOfPoints) << "ms" << std::endl;
+
+  // Moving a control point updates the picking grid
+  double newPositionWorld[3] = { 25.0, 25.0, 0.0 };
+  markupsNode->SetNthControlPointPositionWorld(0, newPositionWorld);
+  rep->UpdateFromMRML(markupsNode, vtkMRMLMarkupsNode::PointModifiedEvent);
+  GetControlPointDisplayPosition(0, 0, displayPosition);
+  CHECK_INT(Pick(rep, eventData, displayPosition), -1);
+  displayPosition[0] += 50;
+  displayPosition[1] += 50;
+  CHECK_INT(Pick(rep, eventData, displayPosition), 0);
+
+  // Removed control points cannot be picked
+  markupsNode->RemoveAllControlPoints();
+  rep->UpdateFromMRML(markupsNode, vtkMRMLMarkupsNode::PointRemovedEvent);
+  CHECK_INT(Pick(rep, eventData, displayPosition), -1);
+
+  return EXIT_SUCCESS;
+}
@@ -51,6 +51,10 @@
 #include <vtkMRMLInteractionEventData.h>
 #include <vtkMRMLTransformNode.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+
 //----------------------------------------------------------------------
 vtkSlicerMarkupsWidgetRepresentation::ControlPointsPipeline::ControlPointsPipeline()
 {
@@ -118,6 +122,69 @@ vtkSlicerMarkupsWidgetRepresentation::ControlPointsPipeline::ControlPointsPipeli
 //----------------------------------------------------------------------
 vtkSlicerMarkupsWidgetRepresentation::ControlPointsPipeline::~ControlPointsPipeline() = default;
 
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointDisplayGrid::Initialize(double cellSize)
+{
+  this->CellSize = cellSize;
+  this->Entries.clear();
+  this->Cells.clear();
+  this->Valid = true;
+  this->BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------
+unsigned long long vtkSlicerMarkupsWidgetRepresentation::ControlPointDisplayGrid::GetCellKey(double x, double y) const
+{
+  // Avoid very small cells, which would just make lookup slower
+  double cellSize = std::max(this->CellSize, 1.0);
+  long long cellX = static_cast<long long>(std::floor(x / cellSize));
+  long long cellY = static_cast<long long>(std::floor(y / cellSize));
+  // Cell indices can be negative, shift them as unsigned values to avoid undefined behavior
+  return (static_cast<unsigned long long>(cellX) << 32) ^ (static_cast<unsigned long long>(cellY) & 0xffffffffULL);
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointDisplayGrid::InsertControlPoint(
+  int controlPointIndex, const double displayPosition[3], double pickingDistance)
+{
+  Entry entry;
+  entry.ControlPointIndex = controlPointIndex;
+  entry.DisplayPosition[0] = displayPosition[0];
+  entry.DisplayPosition[1] = displayPosition[1];
+  entry.DisplayPosition[2] = displayPosition[2];
+  entry.PickingDistance2 = pickingDistance * pickingDistance;
+  this->Entries.push_back(entry);
+  this->Cells[this->GetCellKey(displayPosition[0], displayPosition[1])].push_back(static_cast<int>(this->Entries.size()) - 1);
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointDisplayGrid::FindNearbyEntries(
+  const double displayPosition[2], std::vector<const Entry*>& nearbyEntries) const
+{
+  nearbyEntries.clear();
+  double cellSize = std::max(this->CellSize, 1.0);
+  std::vector<int> entryIndices;
+  for (int offsetY = -1; offsetY <= 1; offsetY++)
+  {
+    for (int offsetX = -1; offsetX <= 1; offsetX++)
+    {
+      auto cellIt = this->Cells.find(this->GetCellKey(
+        displayPosition[0] + offsetX * cellSize, displayPosition[1] + offsetY * cellSize));
+      if (cellIt != this->Cells.end())
+      {
+        entryIndices.insert(entryIndices.end(), cellIt->second.begin(), cellIt->second.end());
+      }
+    }
+  }
+  // Entries are inserted in control point order, so sorting the entry indices
+  // makes the search result independent from the grid layout.
+  std::sort(entryIndices.begin(), entryIndices.end());
+  for (int entryIndex : entryIndices)
+  {
+    nearbyEntries.push_back(&this->Entries[entryIndex]);
+  }
+}
+
 //----------------------------------------------------------------------
 vtkSlicerMarkupsWidgetRepresentation::vtkSlicerMarkupsWidgetRepresentation()
 {
@@ -510,6 +577,9 @@ void vtkSlicerMarkupsWidgetRepresentation::UpdateFromMRMLInternal(
     this->MarkupsTransformModifiedTime.Modified();
   }
 
+  // Control point positions, visibility, or view may have changed
+  this->PickingGrid.Valid = false;
+
   if (!event || event == vtkMRMLDisplayableNode::DisplayModifiedEvent)
   {
     // Update MRML data node from display node
@@ -67,6 +67,10 @@
 #include "vtkTransformPolyDataFilter.h"
 #include "vtkTubeFilter.h"
 
+// STD includes
+#include <unordered_map>
+#include <vector>
+
 class vtkMRMLInteractionEventData;
 
 class VTK_SLICER_MARKUPS_MODULE_VTKWIDGETS_EXPORT vtkSlicerMarkupsWidgetRepresentation : public vtkMRMLAbstractWidgetRepresentation
@@ -179,6 +183,45 @@ protected:
     vtkSmartPointer<vtkTextProperty> TextProperty;
   };
 
+  /// Spatial index of control point display positions, for fast picking.
+  /// Control points are binned in a uniform grid of square cells. Cell size is set
+  /// to the largest picking distance, therefore only the cells around a display position
+  /// need to be checked.
+  class ControlPointDisplayGrid
+  {
+  public:
+    struct Entry
+    {
+      int ControlPointIndex;
+      double DisplayPosition[3];
+      double PickingDistance2; // squared maximum picking distance, in pixels
+    };
+
+    /// Remove all entries and set the cell size (in pixels).
+    void Initialize(double cellSize);
+    double GetCellSize() const { return this->CellSize; }
+
+    /// Add a control point. Picking distance is specified in pixels.
+    void InsertControlPoint(int controlPointIndex, const double displayPosition[3], double pickingDistance);
+
+    /// Get entries that are in the cells around the display position (only x and y coordinates are used),
+    /// sorted by control point index.
+    void FindNearbyEntries(const double displayPosition[2], std::vector<const Entry*>& nearbyEntries) const;
+
+    /// Grid is up-to-date. Cleared whenever the representation is updated from MRML.
+    bool Valid{false};
+    /// Time of the last Initialize call.
+    vtkTimeStamp BuildTime;
+
+  protected:
+    unsigned long long GetCellKey(double x, double y) const;
+
+    double CellSize{1.0};
+    std::vector<Entry> Entries;
+    /// Indices of entries in each non-empty cell
+    std::unordered_map<unsigned long long, std::vector<int>> Cells;
+  };
+
   // Calculate view size and scale factor
   virtual void UpdateViewScaleFactor() = 0;
 
@@ -222,6 +265,10 @@ protected:
 
   ControlPointsPipeline* ControlPoints[NumberOfControlPointTypes]; // Unselected, Selected, Active, Project, ProjectBehind
 
+  /// Display positions of visible control points, used in CanInteract.
+  /// Rebuilt on demand, by the 2D and 3D representations.
+  ControlPointDisplayGrid PickingGrid;
+
 private:
   vtkSlicerMarkupsWidgetRepresentation(const vtkSlicerMarkupsWidgetRepresentation&) = delete;
   void operator=(const vtkSlicerMarkupsWidgetRepresentation&) = delete;
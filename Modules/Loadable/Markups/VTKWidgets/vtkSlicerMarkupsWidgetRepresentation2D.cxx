@@ -543,13 +543,53 @@ void vtkSlicerMarkupsWidgetRepresentation2D::CanInteract(
     }
   }
 
-  vtkIdType numberOfPoints = markupsNode->GetNumberOfControlPoints();
+  // Only control points in the grid cells around the display position can be close enough
+  this->UpdatePickingGrid();
+  std::vector<const ControlPointDisplayGrid::Entry*> nearbyEntries;
+  this->PickingGrid.FindNearbyEntries(displayPosition3, nearbyEntries);
+  for (const ControlPointDisplayGrid::Entry* entry : nearbyEntries)
+  {
+    double dist2 = vtkMath::Distance2BetweenPoints(entry->DisplayPosition, displayPosition3);
+    if (dist2 < maxPickingDistanceFromControlPoint2 && dist2 < closestDistance2)
+    {
+      closestDistance2 = dist2;
+      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+      foundComponentIndex = entry->ControlPointIndex;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation2D::UpdatePickingGrid()
+{
+  vtkMRMLSliceNode* sliceNode = this->GetSliceNode();
+  vtkMRMLMarkupsNode* markupsNode = this->GetMarkupsNode();
+  if (!sliceNode || !markupsNode || !this->MarkupsDisplayNode)
+  {
+    return;
+  }
+
+  // Control point size may change without updating from MRML (in UpdateControlPointSize),
+  // therefore the picking distance is checked, too.
+  double maxPickingDistanceFromControlPoint = sqrt(this->GetMaximumControlPointPickingDistance2());
+  if (this->PickingGrid.Valid
+    && this->PickingGrid.GetCellSize() == maxPickingDistanceFromControlPoint
+    && this->PickingGrid.BuildTime > this->GetMTime()
+    && this->PickingGrid.BuildTime > sliceNode->GetXYToRAS()->GetMTime()
+    && this->PickingGrid.BuildTime > this->MarkupsDisplayNode->GetMTime())
+  {
+    // up-to-date
+    return;
+  }
+
+  this->PickingGrid.Initialize(maxPickingDistanceFromControlPoint);
 
   double pointDisplayPos[4] = { 0.0, 0.0, 0.0, 1.0 };
   double pointWorldPos[4] = { 0.0, 0.0, 0.0, 1.0 };
-
   vtkNew<vtkMatrix4x4> rasToxyMatrix;
   sliceNode->GetXYToRAS()->Invert(sliceNode->GetXYToRAS(), rasToxyMatrix.GetPointer());
+  bool sliceProjection = this->MarkupsDisplayNode->GetSliceProjection();
+  int numberOfPoints = markupsNode->GetNumberOfControlPoints();
   for (int i = 0; i < numberOfPoints; i++)
   {
     if (!this->GetNthControlPointViewVisibility(i))
@@ -558,17 +598,12 @@ void vtkSlicerMarkupsWidgetRepresentation2D::CanInteract(
     }
     markupsNode->GetNthControlPointPositionWorld(i, pointWorldPos);
     rasToxyMatrix->MultiplyPoint(pointWorldPos, pointDisplayPos);
-    if (this->MarkupsDisplayNode->GetSliceProjection())
-    {
-      pointDisplayPos[2] = displayPosition3[2];
-    }
-    double dist2 = vtkMath::Distance2BetweenPoints(pointDisplayPos, displayPosition3);
-    if (dist2 < maxPickingDistanceFromControlPoint2 && dist2 < closestDistance2)
+    if (sliceProjection)
     {
-      closestDistance2 = dist2;
-      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-      foundComponentIndex = i;
+      // projected points are compared in the slice plane
+      pointDisplayPos[2] = 0.0;
     }
+    this->PickingGrid.InsertControlPoint(i, pointDisplayPos, maxPickingDistanceFromControlPoint);
   }
 }
 
@@ -110,6 +110,10 @@ protected:
   // in pixels.
   double GetMaximumControlPointPickingDistance2();
 
+  /// Rebuild PickingGrid from the current control point positions and slice geometry,
+  /// if any of them changed since the grid was last built.
+  void UpdatePickingGrid();
+
   bool GetAllControlPointsVisible() override;
 
   /// Check, if the point is displayable in the current slice geometry
@@ -49,6 +49,9 @@
 #include <vtkMRMLInteractionEventData.h>
 #include <vtkMRMLViewNode.h>
 
+// STD includes
+#include <algorithm>
+
 std::map<vtkRenderer*, vtkSmartPointer<vtkFloatArray> > vtkSlicerMarkupsWidgetRepresentation3D::CachedZBuffers;
 
 vtkSlicerMarkupsWidgetRepresentation3D::ControlPointsPipeline3D::ControlPointsPipeline3D()
@@ -405,6 +408,26 @@ void vtkSlicerMarkupsWidgetRepresentation3D::CanInteract(
     }
   }
 
+  if (interactionEventData->IsDisplayPositionValid())
+  {
+    // Only control points in the grid cells around the display position can be close enough
+    this->UpdatePickingGrid(interactionEventData);
+    std::vector<const ControlPointDisplayGrid::Entry*> nearbyEntries;
+    this->PickingGrid.FindNearbyEntries(displayPosition3, nearbyEntries);
+    for (const ControlPointDisplayGrid::Entry* entry : nearbyEntries)
+    {
+      double dist2 = vtkMath::Distance2BetweenPoints(entry->DisplayPosition, displayPosition3);
+      if (dist2 < entry->PickingDistance2 && dist2 < closestDistance2
+        && this->IsControlPointVisibleInLastRender(entry->ControlPointIndex))
+      {
+        closestDistance2 = dist2;
+        foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+        foundComponentIndex = entry->ControlPointIndex;
+      }
+    }
+    return;
+  }
+
   vtkIdType numberOfPoints = markupsNode->GetNumberOfControlPoints();
   for (int i = 0; i < numberOfPoints; i++)
   {
@@ -413,94 +436,90 @@ void vtkSlicerMarkupsWidgetRepresentation3D::CanInteract(
     {
       continue;
     }
-    double centerPosWorld[4] = { 0.0, 0.0, 0.0, 1.0 };
-    double centerPosDisplay[4] = { 0.0, 0.0, 0.0, 1.0 };
-    markupsNode->GetNthControlPointPositionWorld(i, centerPosWorld);
-    this->Renderer->SetWorldPoint(centerPosWorld);
-
-    // Check SelectVisiblePoints output to see if the point is occluded or not.
-    // SelectVisiblePoints is very sensitive to when it is executed (it has to check the z buffer after
-    // opaque geometry is rendered but 2D labels are not yet), therefore we do not
-    // update its output but just use the last output generated for the last rendering.
-    bool pointVisible = false;
-    if (this->MarkupsDisplayNode
-      && this->MarkupsDisplayNode->GetOccludedVisibility()
-      && this->MarkupsDisplayNode->GetOccludedOpacity() > 0.0)
-    {
-      pointVisible = true;
-    }
-    for (int controlPointType = 0; controlPointType <= Active && !pointVisible; ++controlPointType)
-    {
-      if ((controlPointType == Unselected && markupsNode->GetNthControlPointSelected(i))
-        || (controlPointType == Selected && !markupsNode->GetNthControlPointSelected(i)))
-      {
-        continue;
-      }
-      ControlPointsPipeline3D* controlPoints = this->GetControlPointsPipeline(controlPointType);
-      if (!controlPoints->VisiblePointsPolyData->GetPointData())
-      {
-        continue;
-      }
-      vtkIdTypeArray* visiblePointIndices = vtkIdTypeArray::SafeDownCast(
-        controlPoints->VisiblePointsPolyData->GetPointData()->GetAbstractArray("controlPointIndices"));
-      if (!visiblePointIndices)
-      {
-        continue;
-      }
-      if (visiblePointIndices->LookupValue(i) >= 0)
-      {
-        // visible
-        pointVisible = true;
-        break;
-      }
-    }
-    if (!pointVisible)
+    if (!this->IsControlPointVisibleInLastRender(i))
     {
       continue;
     }
-    if (interactionEventData->IsDisplayPositionValid())
-    {
-      double pixelTolerance = this->ControlPointSize / 2.0 / this->GetViewScaleFactorAtPosition(centerPosWorld, interactionEventData)
-        + this->PickingTolerance * this->ScreenScaleFactor;
-      interactionEventData->WorldToDisplay(centerPosWorld, centerPosDisplay);
-      double dist2 = vtkMath::Distance2BetweenPoints(centerPosDisplay, displayPosition3);
-      if (dist2 < pixelTolerance * pixelTolerance && dist2 < closestDistance2)
-      {
-        closestDistance2 = dist2;
-        foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-        foundComponentIndex = i;
-      }
-    }
-    else
+    double centerPosWorld[4] = { 0.0, 0.0, 0.0, 1.0 };
+    markupsNode->GetNthControlPointPositionWorld(i, centerPosWorld);
+    const double* worldPosition = interactionEventData->GetWorldPosition();
+    double worldTolerance = this->ControlPointSize / 2.0 +
+      this->PickingTolerance / interactionEventData->GetWorldToPhysicalScale();
+    double dist2 = vtkMath::Distance2BetweenPoints(centerPosWorld, worldPosition);
+    if (dist2 < worldTolerance * worldTolerance && dist2 < closestDistance2)
     {
-      const double* worldPosition = interactionEventData->GetWorldPosition();
-      double worldTolerance = this->ControlPointSize / 2.0 +
-        this->PickingTolerance / interactionEventData->GetWorldToPhysicalScale();
-      double dist2 = vtkMath::Distance2BetweenPoints(centerPosWorld, worldPosition);
-      if (dist2 < worldTolerance * worldTolerance && dist2 < closestDistance2)
-      {
-        closestDistance2 = dist2;
-        foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-        foundComponentIndex = i;
-      }
+      closestDistance2 = dist2;
+      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+      foundComponentIndex = i;
     }
   }
+}
 
-  /* This would probably faster for many points:
+//----------------------------------------------------------------------
+bool vtkSlicerMarkupsWidgetRepresentation3D::IsControlPointVisibleInLastRender(int controlPointIndex)
+{
+  if (this->MarkupsDisplayNode
+    && this->MarkupsDisplayNode->GetOccludedVisibility()
+    && this->MarkupsDisplayNode->GetOccludedOpacity() > 0.0)
+  {
+    // occluded points are visible, too
+    return true;
+  }
+  // Check SelectVisiblePoints output to see if the point is occluded or not.
+  return this->GetNthControlPointViewVisibility(controlPointIndex);
+}
 
-  this->BuildLocator();
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation3D::UpdatePickingGrid(vtkMRMLInteractionEventData* interactionEventData)
+{
+  vtkMRMLMarkupsNode* markupsNode = this->GetMarkupsNode();
+  if (!markupsNode || !this->Renderer || !this->Renderer->GetActiveCamera())
+  {
+    return;
+  }
 
-  double closestDistance2 = VTK_DOUBLE_MAX;
-  int closestNode = static_cast<int> (this->Locator->FindClosestPointWithinRadius(
-    this->PixelTolerance, displayPos, closestDistance2));
+  // Display positions depend on the camera and the render window size
+  if (this->PickingGrid.Valid
+    && this->PickingGrid.BuildTime > this->GetMTime()
+    && this->PickingGrid.BuildTime > this->Renderer->GetActiveCamera()->GetMTime()
+    && (!this->Renderer->GetVTKWindow() || this->PickingGrid.BuildTime > this->Renderer->GetVTKWindow()->GetMTime()))
+  {
+    // up-to-date
+    return;
+  }
 
-  if (closestNode != this->GetActiveNode())
+  // Picking distance depends on the distance from the camera (in perspective projection)
+  // therefore it is computed for each point.
+  int numberOfPoints = markupsNode->GetNumberOfControlPoints();
+  std::vector<int> visibleControlPointIndices;
+  std::vector<double> displayPositions;
+  std::vector<double> pickingDistances;
+  double maxPickingDistance = 0.0;
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    if (!(markupsNode->GetNthControlPointPositionVisibility(i)
+      && markupsNode->GetNthControlPointVisibility(i)))
     {
-    this->SetActiveNode(closestNode);
-    this->NeedToRender = 1;
+      continue;
     }
-  return (this->GetActiveNode() >= 0);
-  */
+    double pointPosWorld[3] = { 0.0, 0.0, 0.0 };
+    double pointPosDisplay[3] = { 0.0, 0.0, 0.0 };
+    markupsNode->GetNthControlPointPositionWorld(i, pointPosWorld);
+    interactionEventData->WorldToDisplay(pointPosWorld, pointPosDisplay);
+    double pickingDistance = this->ControlPointSize / 2.0 / this->GetViewScaleFactorAtPosition(pointPosWorld, interactionEventData)
+      + this->PickingTolerance * this->ScreenScaleFactor;
+    maxPickingDistance = std::max(maxPickingDistance, pickingDistance);
+    visibleControlPointIndices.push_back(i);
+    displayPositions.insert(displayPositions.end(), pointPosDisplay, pointPosDisplay + 3);
+    pickingDistances.push_back(pickingDistance);
+  }
+
+  this->PickingGrid.Initialize(maxPickingDistance);
+  for (size_t entryIndex = 0; entryIndex < visibleControlPointIndices.size(); ++entryIndex)
+  {
+    this->PickingGrid.InsertControlPoint(visibleControlPointIndices[entryIndex],
+      &displayPositions[entryIndex * 3], pickingDistances[entryIndex]);
+  }
 }
 
 //----------------------------------------------------------------------
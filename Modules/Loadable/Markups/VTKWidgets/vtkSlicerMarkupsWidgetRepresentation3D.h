@@ -96,6 +96,14 @@ protected:
 
   double GetViewScaleFactorAtPosition(double positionWorld[3], vtkMRMLInteractionEventData* interactionEventData = nullptr);
 
+  /// Return true if the control point can be picked: it is not occluded in the last rendering
+  /// or occluded control points are displayed.
+  bool IsControlPointVisibleInLastRender(int controlPointIndex);
+
+  /// Rebuild PickingGrid from the current control point positions and camera,
+  /// if any of them changed since the grid was last built.
+  void UpdatePickingGrid(vtkMRMLInteractionEventData* interactionEventData);
+
   void UpdateViewScaleFactor() override;
 
   void UpdateControlPointSize() override;
@@ -1,5 +1,6 @@
 #include "vtkImageGrowCutSegment.h"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <vector>
@@ -9,6 +10,7 @@
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTimerLog.h>
@@ -27,6 +29,11 @@ const int MaskPixelTypeID = VTK_UNSIGNED_CHAR;
 const NodeKeyValueType DIST_INF = std::numeric_limits<NodeKeyValueType>::max();
 const NodeKeyValueType DIST_EPSILON = 1e-3;
 
+// Number of buckets used by the bucket queue engine if bucket width is not specified
+const double DEFAULT_NUMBER_OF_BUCKETS = 256;
+// Bucket width is increased if it would require more buckets than this
+const double MAXIMUM_NUMBER_OF_BUCKETS = 1 << 20;
+
 //----------------------------------------------------------------------------
 class vtkImageGrowCutSegment::vtkInternal
 {
@@ -36,18 +43,33 @@ public:
 
   void Reset();
 
+  // Allocate result and distance volumes and compute neighborhood of each voxel
+  void InitializeVolumes(vtkImageData* seedLabelVolume, double distancePenalty);
+
   template<typename IntensityPixelType, typename LabelPixelType>
   bool InitializationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty);
 
   template<typename IntensityPixelType, typename LabelPixelType>
   void DijkstraBasedClassificationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume);
 
+  template<typename IntensityPixelType, typename LabelPixelType>
+  void BucketQueueClassification(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
+    double distancePenalty, double bucketWidth);
+
   template <class SourceVolType>
   bool ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
-    vtkImageData *resultLabelVolume, double distancePenalty);
+    vtkImageData *resultLabelVolume, double distancePenalty, int engine, double bucketWidth);
 
   template< class SourceVolType, class SeedVolType>
-  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty);
+  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
+    double distancePenalty, int engine, double bucketWidth);
+
+  // Voxel waiting in a bucket of the bucket queue engine
+  struct BucketEntry
+  {
+    NodeIndexType Index;
+    NodeKeyValueType Distance;
+  };
 
   // Stores the shortest distance from known labels to each point
   // If a point is set to DIST_INF then that point will modified, as a shorter distance path will be found.
@@ -107,6 +129,71 @@ void vtkImageGrowCutSegment::vtkInternal::Reset()
   m_ResultLabelVolume->Initialize();
 }
 
+//-----------------------------------------------------------------------------
+void vtkImageGrowCutSegment::vtkInternal::InitializeVolumes(vtkImageData* seedLabelVolume, double distancePenalty)
+{
+  m_ResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+  m_ResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+  m_ResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
+  m_ResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+  m_DistanceVolume->SetOrigin(seedLabelVolume->GetOrigin());
+  m_DistanceVolume->SetSpacing(seedLabelVolume->GetSpacing());
+  m_DistanceVolume->SetExtent(seedLabelVolume->GetExtent());
+  m_DistanceVolume->AllocateScalars(NodeKeyValueTypeID, 1);
+
+  NodeIndexType dimXYZ = m_DimX * m_DimY * m_DimZ;
+  double* spacing = seedLabelVolume->GetSpacing();
+
+  // Compute index offset
+  m_DistancePenalty = distancePenalty;
+  m_NeighborIndexOffsets.clear();
+  m_NeighborDistancePenalties.clear();
+  // Neighbors are traversed in the order of m_NeighborIndexOffsets,
+  // therefore one would expect that the offsets should
+  // be as continuous as possible (e.g., x coordinate
+  // should change most quickly), but that resulted in
+  // about 5-6% longer computation time. Therefore,
+  // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
+  for (long ix = -1; ix <= 1; ix++)
+  {
+    for (long iy = -1; iy <= 1; iy++)
+    {
+      for (long iz = -1; iz <= 1; iz++)
+      {
+        if (ix == 0 && iy == 0 && iz == 0)
+        {
+          continue;
+        }
+        m_NeighborIndexOffsets.push_back(ix + long(m_DimX)*(iy + long(m_DimY)*iz));
+        m_NeighborDistancePenalties.push_back(this->m_DistancePenalty * sqrt((spacing[0] * ix) * (spacing[0] * ix)
+          + (spacing[1] * iy) * (spacing[1] * iy) + (spacing[2] * iz) * (spacing[2] * iz)));
+      }
+    }
+  }
+
+  // Determine neighborhood size for computation at each voxel.
+  // The neighborhood size is everywhere the same (size of m_NeighborIndexOffsets)
+  // except at the edges of the volume, where the neighborhood size is 0.
+  m_NumberOfNeighbors.resize(dimXYZ);
+  const unsigned char numberOfNeighbors = static_cast<unsigned char>(m_NeighborIndexOffsets.size());
+  unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
+  for (NodeIndexType z = 0; z < m_DimZ; z++)
+  {
+    bool zEdge = (z == 0 || z == m_DimZ - 1);
+    for (NodeIndexType y = 0; y < m_DimY; y++)
+    {
+      bool yEdge = (y == 0 || y == m_DimY - 1);
+      *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don't need to check if m_DimX>0)
+      unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
+      for (NodeIndexType x = m_DimX-2; x > 0; x--)
+      {
+        *(nbSizePtr++) = nbSize;
+      }
+      *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>1)
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 template<typename IntensityPixelType, typename LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
@@ -149,67 +236,10 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
 
   if (!m_bSegInitialized)
   {
-    m_ResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
-    m_ResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
-    m_ResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
-    m_ResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
-    m_DistanceVolume->SetOrigin(seedLabelVolume->GetOrigin());
-    m_DistanceVolume->SetSpacing(seedLabelVolume->GetSpacing());
-    m_DistanceVolume->SetExtent(seedLabelVolume->GetExtent());
-    m_DistanceVolume->AllocateScalars(NodeKeyValueTypeID, 1);
+    this->InitializeVolumes(seedLabelVolume, distancePenalty);
     LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
     NodeKeyValueType* distanceVolumePtr = static_cast<NodeKeyValueType*>(m_DistanceVolume->GetScalarPointer());
 
-    // Compute index offset
-    m_DistancePenalty = distancePenalty;
-    m_NeighborIndexOffsets.clear();
-    m_NeighborDistancePenalties.clear();
-    // Neighbors are traversed in the order of m_NeighborIndexOffsets,
-    // therefore one would expect that the offsets should
-    // be as continuous as possible (e.g., x coordinate
-    // should change most quickly), but that resulted in
-    // about 5-6% longer computation time. Therefore,
-    // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
-    double* spacing = seedLabelVolume->GetSpacing();
-    for (long ix = -1; ix <= 1; ix++)
-    {
-      for (long iy = -1; iy <= 1; iy++)
-      {
-        for (long iz = -1; iz <= 1; iz++)
-        {
-          if (ix == 0 && iy == 0 && iz == 0)
-          {
-            continue;
-          }
-          m_NeighborIndexOffsets.push_back(ix + long(m_DimX)*(iy + long(m_DimY)*iz));
-          m_NeighborDistancePenalties.push_back(this->m_DistancePenalty * sqrt((spacing[0] * ix) * (spacing[0] * ix)
-            + (spacing[1] * iy) * (spacing[1] * iy) + (spacing[2] * iz) * (spacing[2] * iz)));
-        }
-      }
-    }
-
-    // Determine neighborhood size for computation at each voxel.
-    // The neighborhood size is everywhere the same (size of m_NeighborIndexOffsets)
-    // except at the edges of the volume, where the neighborhood size is 0.
-    m_NumberOfNeighbors.resize(dimXYZ);
-    const unsigned char numberOfNeighbors = static_cast<unsigned char>(m_NeighborIndexOffsets.size());
-    unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
-    for (NodeIndexType z = 0; z < m_DimZ; z++)
-    {
-      bool zEdge = (z == 0 || z == m_DimZ - 1);
-      for (NodeIndexType y = 0; y < m_DimY; y++)
-      {
-        bool yEdge = (y == 0 || y == m_DimY - 1);
-        *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don't need to check if m_DimX>0)
-        unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
-        for (NodeIndexType x = m_DimX-2; x > 0; x--)
-        {
-          *(nbSizePtr++) = nbSize;
-        }
-        *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>1)
-      }
-    }
-
     if (!maskLabelVolumePtr)
     {
       // no mask
@@ -403,10 +433,161 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
   m_HeapNodes = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType, typename LabelPixelType>
+void vtkImageGrowCutSegment::vtkInternal::BucketQueueClassification(
+    vtkImageData *intensityVolume,
+    vtkImageData *seedLabelVolume,
+    vtkImageData *maskLabelVolume,
+    double distancePenalty,
+    double bucketWidth)
+{
+  LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
+  MaskPixelType* maskLabelVolumePtr = nullptr;
+  if (maskLabelVolume != nullptr)
+  {
+    maskLabelVolumePtr = static_cast<MaskPixelType*>(maskLabelVolume->GetScalarPointer());
+  }
+
+  const bool fullComputation = !m_bSegInitialized;
+  if (fullComputation)
+  {
+    this->InitializeVolumes(seedLabelVolume, distancePenalty);
+  }
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  NodeKeyValueType* distanceVolumePtr = static_cast<NodeKeyValueType*>(m_DistanceVolume->GetScalarPointer());
+  IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+
+  // Initialize voxels and collect the seeds that growing starts from.
+  // In quick update mode only new/changed seeds are collected, therefore only the region
+  // where these seeds are closer than previous seeds is visited during growing.
+  // Slices are processed in parallel. Seeds are collected per slice to make the result independent
+  // from the number of threads.
+  const NodeIndexType sliceSize = m_DimX * m_DimY;
+  std::vector<std::vector<NodeIndexType> > seedIndicesPerSlice(m_DimZ);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(m_DimZ), [&](vtkIdType beginSlice, vtkIdType endSlice)
+  {
+    for (vtkIdType z = beginSlice; z < endSlice; ++z)
+    {
+      std::vector<NodeIndexType>& seedIndices = seedIndicesPerSlice[z];
+      const NodeIndexType endIndex = static_cast<NodeIndexType>(z + 1) * sliceSize;
+      for (NodeIndexType index = static_cast<NodeIndexType>(z) * sliceSize; index < endIndex; index++)
+      {
+        LabelPixelType seedValue = seedLabelVolumePtr[index];
+        if (fullComputation)
+        {
+          if (maskLabelVolumePtr && maskLabelVolumePtr[index] != 0)
+          {
+            // masked region, small distance will prevent overwriting of masked voxels
+            resultLabelVolumePtr[index] = 0;
+            distanceVolumePtr[index] = DIST_EPSILON;
+            continue;
+          }
+          resultLabelVolumePtr[index] = seedValue;
+          if (seedValue == 0)
+          {
+            distanceVolumePtr[index] = DIST_INF;
+            continue;
+          }
+        }
+        else
+        {
+          // Old seeds are ignored in updates, as their labels have been already propagated
+          if (seedValue == 0
+            || (resultLabelVolumePtr[index] == seedValue && distanceVolumePtr[index] <= DIST_EPSILON))
+          {
+            continue;
+          }
+          resultLabelVolumePtr[index] = seedValue;
+        }
+        distanceVolumePtr[index] = DIST_EPSILON;
+        seedIndices.push_back(index);
+      }
+    }
+  });
+
+  // Voxels are sorted into buckets by their distance. Voxels within the same bucket are processed
+  // in arbitrary order and a voxel is processed again if a shorter path is found to it later
+  // (delta-stepping), therefore the result is the same as with exact ordering.
+  // Distance of a queued voxel can be at most one neighbor step larger than the current distance,
+  // so a circular array of buckets that covers the largest step is sufficient.
+  double* intensityRange = intensityVolume->GetScalarRange();
+  double maximumNeighborDistancePenalty = 0.0;
+  if (!m_NeighborDistancePenalties.empty())
+  {
+    maximumNeighborDistancePenalty = *std::max_element(m_NeighborDistancePenalties.begin(), m_NeighborDistancePenalties.end());
+  }
+  double maximumStep = (intensityRange[1] - intensityRange[0]) + maximumNeighborDistancePenalty;
+  if (bucketWidth <= 0.0)
+  {
+    bucketWidth = maximumStep / DEFAULT_NUMBER_OF_BUCKETS;
+  }
+  bucketWidth = std::max(bucketWidth, maximumStep / MAXIMUM_NUMBER_OF_BUCKETS);
+  if (bucketWidth <= 0.0)
+  {
+    // uniform intensity and no distance penalty
+    bucketWidth = 1.0;
+  }
+  // +3 to tolerate rounding errors of the distance computation
+  const vtkTypeUInt64 numberOfBuckets = static_cast<vtkTypeUInt64>(maximumStep / bucketWidth) + 3;
+  std::vector<std::vector<BucketEntry> > buckets(numberOfBuckets);
+
+  vtkTypeUInt64 currentBucketIndex = static_cast<vtkTypeUInt64>(DIST_EPSILON / bucketWidth);
+  std::vector<BucketEntry>& seedBucket = buckets[currentBucketIndex % numberOfBuckets];
+  for (const std::vector<NodeIndexType>& seedIndices : seedIndicesPerSlice)
+  {
+    for (NodeIndexType index : seedIndices)
+    {
+      seedBucket.push_back({ index, DIST_EPSILON });
+    }
+  }
+  size_t numberOfQueuedVoxels = seedBucket.size();
+
+  while (numberOfQueuedVoxels > 0)
+  {
+    std::vector<BucketEntry>& currentBucket = buckets[currentBucketIndex % numberOfBuckets];
+    while (!currentBucket.empty())
+    {
+      BucketEntry entry = currentBucket.back();
+      currentBucket.pop_back();
+      numberOfQueuedVoxels--;
+      NodeIndexType index = entry.Index;
+      NodeKeyValueType currentDistance = entry.Distance;
+      if (currentDistance != distanceVolumePtr[index])
+      {
+        // a shorter path has been found to this voxel since it was queued
+        continue;
+      }
+      LabelPixelType currentLabel = resultLabelVolumePtr[index];
+
+      // Update neighbors
+      NodeKeyValueType pixCenter = imSrc[index];
+      unsigned char nbSize = m_NumberOfNeighbors[index];
+      for (unsigned char i = 0; i < nbSize; i++)
+      {
+        NodeIndexType indexNgbh = index + m_NeighborIndexOffsets[i];
+        NodeKeyValueType neighborCurrentDistance = distanceVolumePtr[indexNgbh];
+        NodeKeyValueType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance + m_NeighborDistancePenalties[i];
+        if (neighborCurrentDistance > neighborNewDistance)
+        {
+          distanceVolumePtr[indexNgbh] = neighborNewDistance;
+          resultLabelVolumePtr[indexNgbh] = currentLabel;
+          vtkTypeUInt64 neighborBucketIndex = static_cast<vtkTypeUInt64>(neighborNewDistance / bucketWidth);
+          buckets[neighborBucketIndex % numberOfBuckets].push_back({ indexNgbh, neighborNewDistance });
+          numberOfQueuedVoxels++;
+        }
+      }
+    }
+    currentBucketIndex++;
+  }
+
+  m_bSegInitialized = true;
+}
+
 //-----------------------------------------------------------------------------
 template< class IntensityPixelType, class LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, double distancePenalty, int engine, double bucketWidth)
 {
   int* imSize = intensityVolume->GetDimensions();
 
@@ -433,6 +614,13 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
     return false;
   }
 
+  if (engine == vtkImageGrowCutSegment::EngineBucketQueue)
+  {
+    BucketQueueClassification<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume, maskLabelVolume,
+      distancePenalty, bucketWidth);
+    return true;
+  }
+
   if (!InitializationAHP<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty))
   {
     return false;
@@ -445,7 +633,7 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
 //----------------------------------------------------------------------------
 template <class SourceVolType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty, int engine, double bucketWidth)
 {
   int* extent = intensityVolume->GetExtent();
   double* spacing = intensityVolume->GetSpacing();
@@ -521,7 +709,8 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensity
   bool success = false;
   switch (seedLabelVolume->GetScalarType())
   {
-    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty)));
+    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume,
+      distancePenalty, engine, bucketWidth)));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
   }
@@ -544,6 +733,8 @@ vtkImageGrowCutSegment::vtkImageGrowCutSegment()
   this->SetNumberOfInputPorts(3);
   this->SetNumberOfOutputPorts(1);
   this->DistancePenalty = 0.0;
+  this->Engine = EngineFibonacciHeap;
+  this->BucketWidth = 0.0;
 }
 
 //-----------------------------------------------------------------------------
@@ -577,7 +768,8 @@ void vtkImageGrowCutSegment::ExecuteDataWithInformation(
 
   switch (intensityVolume->GetScalarType())
   {
-    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume, this->DistancePenalty));
+    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume,
+      this->DistancePenalty, this->Engine, this->BucketWidth));
     break;
   }
   logger->StopTimer();
@@ -608,6 +800,8 @@ void vtkImageGrowCutSegment::Reset()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::PrintSelf(ostream &os, vtkIndent indent)
 {
-  // XXX Implement this function
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DistancePenalty: " << this->DistancePenalty << "\n";
+  os << indent << "Engine: " << (this->Engine == EngineBucketQueue ? "BucketQueue" : "FibonacciHeap") << "\n";
+  os << indent << "BucketWidth: " << this->BucketWidth << "\n";
 }
@@ -36,6 +36,31 @@ public:
   vtkGetMacro(DistancePenalty, double);
   vtkSetMacro(DistancePenalty, double);
 
+  enum
+  {
+    /// Dijkstra's algorithm using a Fibonacci heap. All voxels are inserted into the heap
+    /// in each update.
+    EngineFibonacciHeap = 0,
+    /// Distances are sorted into buckets of BucketWidth size and voxels are re-processed if a shorter
+    /// path is found to them (delta-stepping). Initialization runs on multiple threads and quick updates
+    /// after adding seeds only visit the region where the new seeds are closer than previous seeds.
+    EngineBucketQueue
+  };
+
+  /// Algorithm used for growing the regions from the seeds.
+  /// Both engines compute the same result (except voxels that are at equal distance from multiple seeds).
+  /// Default is EngineFibonacciHeap.
+  vtkGetMacro(Engine, int);
+  vtkSetClampMacro(Engine, int, EngineFibonacciHeap, EngineBucketQueue);
+  void SetEngineToFibonacciHeap() { this->SetEngine(EngineFibonacciHeap); }
+  void SetEngineToBucketQueue() { this->SetEngine(EngineBucketQueue); }
+
+  /// Range of distances that are stored in the same bucket by the bucket queue engine.
+  /// Smaller value reduces the number of times a voxel is re-processed but increases the number of buckets.
+  /// By default = 0, which means the width is chosen so that 256 buckets cover the intensity range of the image.
+  vtkGetMacro(BucketWidth, double);
+  vtkSetMacro(BucketWidth, double);
+
 protected:
   vtkImageGrowCutSegment();
   ~vtkImageGrowCutSegment() override;
@@ -52,6 +77,8 @@ private:
   class vtkInternal;
   vtkInternal * Internal;
   double DistancePenalty;
+  int Engine;
+  double BucketWidth;
 };
 
 #endif
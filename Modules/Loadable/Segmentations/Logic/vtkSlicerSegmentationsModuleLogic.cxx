@@ -23,9 +23,12 @@
 
 // SegmentationCore includes
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkSparseBinaryLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverterFactory.h"
@@ -155,6 +158,12 @@ void vtkSlicerSegmentationsModuleLogic::RegisterNodes()
     vtkSmartPointer<vtkClosedSurfaceToFractionalLabelmapConversionRule>::New() );
   vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
     vtkSmartPointer<vtkFractionalLabelmapToClosedSurfaceConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseBinaryLabelmapToClosedSurfaceConversionRule>::New() );
 }
 
 //---------------------------------------------------------------------------
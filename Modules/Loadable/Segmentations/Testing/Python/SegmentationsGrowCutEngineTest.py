@@ -0,0 +1,83 @@
+import logging
+import time
+import unittest
+
+import vtk
+from vtk.util import numpy_support
+
+import slicer
+
+"""
+This class compares the grow-cut engines of vtkImageGrowCutSegment on sample data.
+Both the initial segmentation and the quick update after adding seeds are checked and timed.
+"""
+
+
+class SegmentationsGrowCutEngineTest(unittest.TestCase):
+    # ------------------------------------------------------------------------------
+    def setUp(self):
+        """Do whatever is needed to reset the state - typically a scene clear will be enough."""
+        slicer.mrmlScene.Clear(0)
+
+    # ------------------------------------------------------------------------------
+    def runTest(self):
+        """Run as few or as many tests as needed here."""
+        self.setUp()
+        self.test_SegmentationsGrowCutEngineTest()
+
+    # ------------------------------------------------------------------------------
+    def test_SegmentationsGrowCutEngineTest(self):
+        import SampleData
+
+        volumeNode = SampleData.downloadSample("MRHead")
+        intensityImage = volumeNode.GetImageData()
+
+        seedImage = vtk.vtkImageData()
+        seedImage.CopyStructure(intensityImage)
+        seedImage.AllocateScalars(vtk.VTK_SHORT, 1)
+        seeds = numpy_support.vtk_to_numpy(seedImage.GetPointData().GetScalars())
+        dims = intensityImage.GetDimensions()
+        seeds = seeds.reshape(dims[2], dims[1], dims[0])
+        seeds[:] = 0
+        # background
+        seeds[5:10, 5:15, 5:15] = 1
+        # inside the head
+        seeds[60:70, 120:130, 120:130] = 2
+        seedImage.Modified()
+
+        results = {}
+        for engineName, engine in [
+            ("Fibonacci heap", slicer.vtkImageGrowCutSegment.EngineFibonacciHeap),
+            ("Bucket queue", slicer.vtkImageGrowCutSegment.EngineBucketQueue),
+        ]:
+            growCut = slicer.vtkImageGrowCutSegment()
+            growCut.SetEngine(engine)
+            growCut.SetIntensityVolume(intensityImage)
+            growCut.SetSeedLabelVolume(seedImage)
+
+            startTime = time.time()
+            growCut.Update()
+            initialTime = time.time() - startTime
+            initialResult = numpy_support.vtk_to_numpy(growCut.GetOutput().GetPointData().GetScalars()).copy()
+
+            # Add a small seed region, only the region around it should be recomputed
+            seeds[100:105, 60:65, 120:125] = 1
+            seedImage.Modified()
+            startTime = time.time()
+            growCut.Update()
+            updateTime = time.time() - startTime
+            updatedResult = numpy_support.vtk_to_numpy(growCut.GetOutput().GetPointData().GetScalars()).copy()
+            seeds[100:105, 60:65, 120:125] = 0
+            seedImage.Modified()
+
+            logging.info(f"{engineName}: initial segmentation {initialTime:.3f}s, update after adding seeds {updateTime:.3f}s")
+            results[engineName] = (initialResult, updatedResult)
+
+        # Results may only differ where voxels are at equal distance from multiple seeds
+        numberOfVoxels = intensityImage.GetNumberOfPoints()
+        for resultIndex in range(2):
+            numberOfDifferentVoxels = (results["Fibonacci heap"][resultIndex] != results["Bucket queue"][resultIndex]).sum()
+            self.assertLess(numberOfDifferentVoxels, numberOfVoxels * 0.001)
+            self.assertTrue((results["Bucket queue"][resultIndex] == 2).any())
+
+        logging.info("Test finished")
@@ -261,6 +261,9 @@ void vtkSlicerSequencesLogic::UpdateAllProxyNodes()
     {
       // we just started to play now, no need to update output nodes yet
       this->LastSequenceBrowserUpdateTimeSec[browserNode] = updateStartTimeSec;
+      browserNode->ResetPlaybackStatistics();
+      browserNode->RecordPlaybackFrame(updateStartTimeSec, 0);
+      this->PrefetchPlaybackItems(browserNode);
       continue;
     }
     // play is already in progress
@@ -275,11 +278,72 @@ void vtkSlicerSequencesLogic::UpdateAllProxyNodes()
       {
         selectionIncrement = 1;
       }
+      browserNode->RecordPlaybackFrame(updateStartTimeSec, selectionIncrement - 1);
       browserNode->SelectNextItem(selectionIncrement);
+      // Proxy nodes are updated by now, start preparing the next items
+      this->PrefetchPlaybackItems(browserNode);
     }
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerSequencesLogic::PrefetchPlaybackItems(vtkMRMLSequenceBrowserNode* browserNode)
+{
+  vtkMRMLSequenceNode* masterSequenceNode = browserNode ? browserNode->GetMasterSequenceNode() : nullptr;
+  if (!masterSequenceNode || !browserNode->GetPlaybackActive() || browserNode->GetPlaybackPrefetchItemCount() <= 0)
+  {
+    return;
+  }
+  int numberOfItems = masterSequenceNode->GetNumberOfDataNodes();
+  int selectedItemNumber = browserNode->GetSelectedItemNumber();
+  if (numberOfItems <= 0 || selectedItemNumber < 0)
+  {
+    return;
+  }
+
+  // Index values of the items that will be displayed next
+  std::vector<std::string> indexValues;
+  for (int offset = 1; offset <= browserNode->GetPlaybackPrefetchItemCount(); ++offset)
+  {
+    int itemNumber = selectedItemNumber + offset;
+    if (itemNumber >= numberOfItems)
+    {
+      if (!browserNode->GetPlaybackLooped())
+      {
+        break;
+      }
+      itemNumber %= numberOfItems;
+    }
+    if (itemNumber == selectedItemNumber)
+    {
+      // all items are prefetched already
+      break;
+    }
+    indexValues.push_back(masterSequenceNode->GetNthIndexValue(itemNumber));
+  }
+
+  std::vector< vtkMRMLSequenceNode* > synchronizedSequenceNodes;
+  browserNode->GetSynchronizedSequenceNodes(synchronizedSequenceNodes, true);
+  for (vtkMRMLSequenceNode* synchronizedSequenceNode : synchronizedSequenceNodes)
+  {
+    if (!synchronizedSequenceNode || !browserNode->GetPlayback(synchronizedSequenceNode)
+      || !synchronizedSequenceNode->GetOnDemandFrameLoader())
+    {
+      continue;
+    }
+    std::vector<int> itemNumbers;
+    for (const std::string& indexValue : indexValues)
+    {
+      int itemNumber = synchronizedSequenceNode->GetItemNumberFromIndexValue(indexValue, /* exactMatchRequired= */ false);
+      if (itemNumber >= 0)
+      {
+        itemNumbers.push_back(itemNumber);
+      }
+    }
+    synchronizedSequenceNode->PrefetchDataNodes(itemNumbers);
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrowserNode* browserNode)
 {
@@ -355,7 +419,13 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
       // node is available for the current index, an empty one is added based on the missingItemMode
       if (synchronizedSequenceNode->GetNumberOfDataNodes() > 0)
       {
-        sourceDataNode = synchronizedSequenceNode->GetDataNodeAtValue(indexValue, /* exactMatchRequired= */ true);
+        // The proxy node will share data with the item, therefore the item must not share
+        // its data node with other items (as it is the case for items recorded in delta storage mode).
+        int itemNumber = synchronizedSequenceNode->GetItemNumberFromIndexValue(indexValue, /* exactMatchRequired= */ true);
+        if (itemNumber >= 0)
+        {
+          sourceDataNode = synchronizedSequenceNode->UnshareNthDataNode(itemNumber);
+        }
         if (sourceDataNode == nullptr)
         {
           // No source node is available for the current exact index, add one now.
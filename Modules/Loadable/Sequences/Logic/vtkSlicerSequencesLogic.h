@@ -118,6 +118,10 @@ protected:
 
   bool IsDataConnectorNode(vtkMRMLNode*);
 
+  /// Start preparing the items that follow the selected item during playback
+  /// (see vtkMRMLSequenceBrowserNode::PlaybackPrefetchItemCount).
+  void PrefetchPlaybackItems(vtkMRMLSequenceBrowserNode* browserNode);
+
   // Time of the last update of each browser node (in universal time)
   std::map< vtkMRMLSequenceBrowserNode*, double > LastSequenceBrowserUpdateTimeSec;
 
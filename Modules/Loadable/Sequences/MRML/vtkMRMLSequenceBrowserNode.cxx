@@ -25,12 +25,19 @@
 
 // MRML includes
 #include <vtkMRMLScene.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLTransformNode.h>
 #include <vtkMRMLVolumeNode.h>
 #include <vtkMRMLHierarchyNode.h>
 
 // VTK includes
+#include <vtkAbstractTransform.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
 #include <vtkNew.h>
 #include <vtkIntArray.h>
+#include <vtkPointData.h>
+#include <vtkPointSet.h>
 #include <vtkCommand.h>
 #include <vtkCollection.h>
 #include <vtkCollectionIterator.h>
@@ -39,10 +46,12 @@
 #include <vtksys/RegularExpression.hxx>
 #include <vtkTimerLog.h>
 #include <vtkVariant.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
 #include <sstream>
 #include <algorithm> // for std::find
+#include <cstring> // for memcmp
 #if defined(_WIN32) && !defined(__CYGWIN__)
 #  define SNPRINTF _snprintf
 #else
@@ -60,6 +69,69 @@ namespace
   const char* PROXY_NODE_COPY_ATTRIBUTE_NAME = "proxyNodeCopy";
 
   const int INVALID_ITEM_NUMBER = -1;
+
+  // Items older than the recording buffer duration are only removed when the buffer
+  // exceeds the duration by this fraction, to avoid rebuilding the sequence index at each recorded item.
+  const double RECORDING_BUFFER_TRIM_TOLERANCE = 0.1;
+
+  //----------------------------------------------------------------------------
+  // Returns the last modification time of the node, including the data objects that it stores.
+  vtkMTimeType GetNodeContentMTime(vtkMRMLNode* node)
+  {
+    vtkMTimeType contentMTime = node->GetMTime();
+    vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+    vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(node);
+    if (volumeNode && volumeNode->GetImageData())
+    {
+      contentMTime = std::max(contentMTime, volumeNode->GetImageData()->GetMTime());
+    }
+    else if (modelNode && modelNode->GetMesh())
+    {
+      contentMTime = std::max(contentMTime, modelNode->GetMesh()->GetMTime());
+    }
+    else if (transformNode && transformNode->GetTransformToParent())
+    {
+      contentMTime = std::max(contentMTime, transformNode->GetTransformToParent()->GetMTime());
+    }
+    return contentMTime;
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns true if the two images have the same voxels (geometry is not compared).
+  bool IsVoxelContentEqual(vtkImageData* image1, vtkImageData* image2)
+  {
+    if (!image1 || !image2)
+    {
+      return false;
+    }
+    if (image1 == image2)
+    {
+      return true;
+    }
+    int* dimensions1 = image1->GetDimensions();
+    int* dimensions2 = image2->GetDimensions();
+    if (dimensions1[0] != dimensions2[0] || dimensions1[1] != dimensions2[1] || dimensions1[2] != dimensions2[2])
+    {
+      return false;
+    }
+    vtkDataArray* scalars1 = image1->GetPointData()->GetScalars();
+    vtkDataArray* scalars2 = image2->GetPointData()->GetScalars();
+    if (!scalars1 || !scalars2
+      || scalars1->GetDataType() != scalars2->GetDataType()
+      || scalars1->GetNumberOfComponents() != scalars2->GetNumberOfComponents()
+      || scalars1->GetNumberOfTuples() != scalars2->GetNumberOfTuples())
+    {
+      return false;
+    }
+    if (image1->GetPointData()->GetNumberOfArrays() != 1 || image2->GetPointData()->GetNumberOfArrays() != 1)
+    {
+      // only the scalars are compared
+      return false;
+    }
+    size_t dataSize = static_cast<size_t>(scalars1->GetNumberOfValues()) * scalars1->GetDataTypeSize();
+    return memcmp(scalars1->GetVoidPointer(0), scalars2->GetVoidPointer(0), dataSize) == 0;
+  }
 }
 
 
@@ -76,6 +148,12 @@ struct vtkMRMLSequenceBrowserNode::SynchronizationProperties
   bool OverwriteProxyName{false}; // change proxy node name during replay (includes index value)
   bool SaveChanges{false}; // save proxy node changes into the sequence
   MissingItemModeType MissingItemMode{MissingItemCreateFromPrevious};
+
+  // Recording state (not saved in the scene).
+  // Data node that was created when the proxy node was last recorded and the proxy node
+  // content modification time at that moment.
+  vtkWeakPointer<vtkMRMLNode> LastRecordedDataNode;
+  vtkMTimeType LastRecordedContentMTime{0};
 };
 
 void vtkMRMLSequenceBrowserNode::SynchronizationProperties::FromString( std::string str )
@@ -158,6 +236,7 @@ void vtkMRMLSequenceBrowserNode::WriteXML(ostream& of, int nIndent)
   of << indent << " playbackRateFps=\"" << this->PlaybackRateFps << "\"";
   of << indent << " playbackItemSkippingEnabled=\"" << (this->PlaybackItemSkippingEnabled ? "true" : "false") << "\"";
   of << indent << " playbackLooped=\"" << (this->PlaybackLooped ? "true" : "false") << "\"";
+  of << indent << " playbackPrefetchItemCount=\"" << this->PlaybackPrefetchItemCount << "\"";
   of << indent << " selectedItemNumber=\"" << this->SelectedItemNumber << "\"";
   of << indent << " recordingActive=\"" << (this->RecordingActive ? "true" : "false") << "\"";
   of << indent << " recordOnMasterModifiedOnly=\"" << (this->RecordMasterOnly ? "true" : "false") << "\"";
@@ -167,6 +246,8 @@ void vtkMRMLSequenceBrowserNode::WriteXML(ostream& of, int nIndent)
   {
     of << indent << " recordingSamplingMode=\"" << recordingSamplingModeString << "\"";
   }
+  of << indent << " recordingStorageMode=\"" << this->GetRecordingStorageModeAsString() << "\"";
+  of << indent << " recordingBufferDurationSec=\"" << this->RecordingBufferDurationSec << "\"";
 
   std::string indexDisplayModeString = this->GetIndexDisplayModeAsString();
   if (!indexDisplayModeString.empty())
@@ -253,6 +334,14 @@ void vtkMRMLSequenceBrowserNode::ReadXMLAttributes(const char** atts)
         this->SetPlaybackLooped(0);
       }
     }
+    else if (!strcmp(attName, "playbackPrefetchItemCount"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      int playbackPrefetchItemCount = 2;
+      ss >> playbackPrefetchItemCount;
+      this->SetPlaybackPrefetchItemCount(playbackPrefetchItemCount);
+    }
     else if (!strcmp(attName, "selectedItemNumber"))
     {
       std::stringstream ss;
@@ -293,6 +382,24 @@ void vtkMRMLSequenceBrowserNode::ReadXMLAttributes(const char** atts)
       }
       SetRecordingSamplingMode(recordingSamplingMode);
     }
+    else if (!strcmp(attName, "recordingStorageMode"))
+    {
+      int recordingStorageMode = this->GetRecordingStorageModeFromString(attValue);
+      if (recordingStorageMode<0 || recordingStorageMode >= vtkMRMLSequenceBrowserNode::NumberOfRecordingStorageModes)
+      {
+        vtkErrorMacro("Invalid recording storage mode: " << (attValue ? attValue : "(empty)") << ". Using FullCopy.");
+        recordingStorageMode = vtkMRMLSequenceBrowserNode::RecordingStorageFullCopy;
+      }
+      this->SetRecordingStorageMode(recordingStorageMode);
+    }
+    else if (!strcmp(attName, "recordingBufferDurationSec"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      double recordingBufferDurationSec = 0.0;
+      ss >> recordingBufferDurationSec;
+      this->SetRecordingBufferDurationSec(recordingBufferDurationSec);
+    }
     else if (!strcmp(attName, "indexDisplayMode"))
     {
       int indexDisplayMode = this->GetIndexDisplayModeFromString(attValue);
@@ -381,8 +488,11 @@ void vtkMRMLSequenceBrowserNode::Copy(vtkMRMLNode *anode)
   this->SetPlaybackRateFps(node->GetPlaybackRateFps());
   this->SetPlaybackItemSkippingEnabled(node->GetPlaybackItemSkippingEnabled());
   this->SetPlaybackLooped(node->GetPlaybackLooped());
+  this->SetPlaybackPrefetchItemCount(node->GetPlaybackPrefetchItemCount());
   this->SetRecordMasterOnly(node->GetRecordMasterOnly());
   this->SetRecordingSamplingMode(node->GetRecordingSamplingMode());
+  this->SetRecordingStorageMode(node->GetRecordingStorageMode());
+  this->SetRecordingBufferDurationSec(node->GetRecordingBufferDurationSec());
   this->SetIndexDisplayMode(node->GetIndexDisplayMode());
   this->SetIndexDisplayFormat(node->GetIndexDisplayFormat());
   this->SetRecordingActive(node->GetRecordingActive());
@@ -400,10 +510,15 @@ void vtkMRMLSequenceBrowserNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << " Playback rate (fps): " << this->PlaybackRateFps << '\n';
   os << indent << " Playback item skipping enabled: " << (this->PlaybackItemSkippingEnabled ? "true" : "false") << '\n';
   os << indent << " Playback looped: " << (this->PlaybackLooped ? "true" : "false") << '\n';
+  os << indent << " Playback prefetch item count: " << this->PlaybackPrefetchItemCount << '\n';
+  os << indent << " Playback dropped frame count: " << this->PlaybackDroppedFrameCount << '\n';
+  os << indent << " Playback achieved rate (fps): " << this->PlaybackAchievedRateFps << '\n';
   os << indent << " Selected item number: " << this->SelectedItemNumber << '\n';
   os << indent << " Recording active: " << (this->RecordingActive ? "true" : "false") << '\n';
   os << indent << " Recording on master modified only: " << (this->RecordMasterOnly ? "true" : "false") << '\n';
   os << indent << " Recording sampling mode: " << this->GetRecordingSamplingModeAsString() << "\n";
+  os << indent << " Recording storage mode: " << this->GetRecordingStorageModeAsString() << "\n";
+  os << indent << " Recording buffer duration (sec): " << this->RecordingBufferDurationSec << "\n";
   os << indent << " Index display mode: " << this->GetIndexDisplayModeAsString() << "\n";
   os << indent << " Index display format: " << this->GetIndexDisplayFormat() << "\n";
 
@@ -980,6 +1095,17 @@ void vtkMRMLSequenceBrowserNode::SetRecordingActive(bool recording)
   }
   if (this->RecordingActive!=recording)
   {
+    if (recording)
+    {
+      // The first item of each recording is always a full copy
+      for (std::pair<const std::string, SynchronizationProperties*>& syncPropsIt : this->SynchronizationPropertiesMap)
+      {
+        if (syncPropsIt.second)
+        {
+          syncPropsIt.second->LastRecordedDataNode = nullptr;
+        }
+      }
+    }
     this->RecordingActive = recording;
     this->Modified();
   }
@@ -1055,6 +1181,36 @@ int vtkMRMLSequenceBrowserNode::SelectNextItem(int selectionIncrement/*=1*/)
   return selectedItemNumber;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::ResetPlaybackStatistics()
+{
+  this->PlaybackDroppedFrameCount = 0;
+  this->PlaybackAchievedRateFps = 0.0;
+  this->PlaybackRateMeasurementStartTimeSec = -1.0;
+  this->PlaybackRateMeasurementFrameCount = 0;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::RecordPlaybackFrame(double timeSec, int numberOfDroppedFrames)
+{
+  this->PlaybackDroppedFrameCount += std::max(0, numberOfDroppedFrames);
+  if (this->PlaybackRateMeasurementStartTimeSec < 0)
+  {
+    // first frame, measurement period starts now
+    this->PlaybackRateMeasurementStartTimeSec = timeSec;
+    this->PlaybackRateMeasurementFrameCount = 0;
+    return;
+  }
+  this->PlaybackRateMeasurementFrameCount++;
+  double elapsedTimeSec = timeSec - this->PlaybackRateMeasurementStartTimeSec;
+  if (elapsedTimeSec >= 1.0)
+  {
+    this->PlaybackAchievedRateFps = this->PlaybackRateMeasurementFrameCount / elapsedTimeSec;
+    this->PlaybackRateMeasurementStartTimeSec = timeSec;
+    this->PlaybackRateMeasurementFrameCount = 0;
+  }
+}
+
 //---------------------------------------------------------------------------
 int vtkMRMLSequenceBrowserNode::GetNumberOfItems()
 {
@@ -1170,17 +1326,101 @@ void vtkMRMLSequenceBrowserNode::SaveProxyNodesState()
     vtkMRMLSequenceNode* currSequenceNode = (*it);
     if (this->GetRecording(currSequenceNode))
     {
-      currSequenceNode->SetDataNodeAtValue(this->GetProxyNode(currSequenceNode), currTime.str().c_str());
+      this->SaveProxyNodeState(currSequenceNode, currTime.str());
       snapshotAdded = true;
     }
   }
   if (snapshotAdded)
   {
+    if (continuousRecording && this->RecordingBufferDurationSec > 0)
+    {
+      this->RemoveItemsOutsideRecordingBuffer(sequenceNodes, vtkVariant(currTime.str()).ToDouble());
+    }
     this->Modified();
     this->SelectLastItem();
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::SaveProxyNodeState(vtkMRMLSequenceNode* sequenceNode, const std::string& indexValue)
+{
+  vtkMRMLNode* proxyNode = this->GetProxyNode(sequenceNode);
+  SynchronizationProperties* syncProps = this->GetSynchronizationPropertiesForSequence(sequenceNode);
+  if (this->RecordingStorageMode != vtkMRMLSequenceBrowserNode::RecordingStorageDelta || !proxyNode || !syncProps)
+  {
+    sequenceNode->SetDataNodeAtValue(proxyNode, indexValue);
+    return;
+  }
+
+  // The previously recorded data node can only be reused if it is still the last item of the sequence
+  vtkMTimeType contentMTime = GetNodeContentMTime(proxyNode);
+  int lastItemNumber = sequenceNode->GetNumberOfDataNodes() - 1;
+  vtkMRMLNode* lastRecordedDataNode = nullptr;
+  if (lastItemNumber >= 0 && syncProps->LastRecordedDataNode
+    && sequenceNode->GetNthDataNode(lastItemNumber) == syncProps->LastRecordedDataNode.GetPointer())
+  {
+    lastRecordedDataNode = syncProps->LastRecordedDataNode.GetPointer();
+  }
+
+  if (lastRecordedDataNode && contentMTime == syncProps->LastRecordedContentMTime)
+  {
+    // Proxy node has not changed since it was last recorded
+    sequenceNode->SetDataNodeAtValueFromItem(lastItemNumber, indexValue);
+    return;
+  }
+
+  vtkMRMLNode* recordedDataNode = nullptr;
+  vtkMRMLVolumeNode* proxyVolumeNode = vtkMRMLVolumeNode::SafeDownCast(proxyNode);
+  vtkMRMLVolumeNode* lastRecordedVolumeNode = vtkMRMLVolumeNode::SafeDownCast(lastRecordedDataNode);
+  if (proxyVolumeNode && lastRecordedVolumeNode && !sequenceNode->GetOnDemandFrameLoader()
+    && IsVoxelContentEqual(proxyVolumeNode->GetImageData(), lastRecordedVolumeNode->GetImageData()))
+  {
+    // Only volume properties changed, keep using the voxels of the previous item.
+    // Shallow-copy is safe because the image data of the proxy node is replaced before anything else could modify it.
+    recordedDataNode = sequenceNode->SetDataNodeAtValue(proxyNode, indexValue, /* shallowCopy= */ true);
+    vtkMRMLVolumeNode* recordedVolumeNode = vtkMRMLVolumeNode::SafeDownCast(recordedDataNode);
+    if (recordedVolumeNode)
+    {
+      recordedVolumeNode->SetAndObserveImageData(lastRecordedVolumeNode->GetImageData());
+    }
+  }
+  else
+  {
+    recordedDataNode = sequenceNode->SetDataNodeAtValue(proxyNode, indexValue);
+  }
+  syncProps->LastRecordedDataNode = recordedDataNode;
+  syncProps->LastRecordedContentMTime = contentMTime;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::RemoveItemsOutsideRecordingBuffer(
+  const std::vector< vtkMRMLSequenceNode* >& sequenceNodes, double latestIndexValue)
+{
+  double oldestIndexValueToKeep = latestIndexValue - this->RecordingBufferDurationSec;
+  double trimIndexValue = oldestIndexValueToKeep - this->RecordingBufferDurationSec * RECORDING_BUFFER_TRIM_TOLERANCE;
+  for (vtkMRMLSequenceNode* sequenceNode : sequenceNodes)
+  {
+    if (!this->GetRecording(sequenceNode)
+      || sequenceNode->GetIndexType() != vtkMRMLSequenceNode::NumericIndex
+      || sequenceNode->GetNumberOfDataNodes() < 2)
+    {
+      continue;
+    }
+    if (vtkVariant(sequenceNode->GetNthIndexValue(0)).ToDouble() >= trimIndexValue)
+    {
+      // buffer is not full yet
+      continue;
+    }
+    MRMLNodeModifyBlocker blocker(sequenceNode);
+    // Always keep the last item
+    while (sequenceNode->GetNumberOfDataNodes() > 1
+      && vtkVariant(sequenceNode->GetNthIndexValue(0)).ToDouble() < oldestIndexValueToKeep)
+    {
+      sequenceNode->RemoveNthDataNode(0);
+    }
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLSequenceBrowserNode::OnNodeReferenceAdded(vtkMRMLNodeReference* nodeReference)
 {
@@ -1547,6 +1787,45 @@ int vtkMRMLSequenceBrowserNode::GetRecordingSamplingModeFromString(const std::st
   return -1;
 }
 
+//-----------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::SetRecordingStorageModeFromString(const char *recordingStorageModeString)
+{
+  int recordingStorageMode = GetRecordingStorageModeFromString(recordingStorageModeString);
+  this->SetRecordingStorageMode(recordingStorageMode);
+}
+
+//-----------------------------------------------------------
+std::string vtkMRMLSequenceBrowserNode::GetRecordingStorageModeAsString()
+{
+  return vtkMRMLSequenceBrowserNode::GetRecordingStorageModeAsString(this->RecordingStorageMode);
+}
+
+//-----------------------------------------------------------
+std::string vtkMRMLSequenceBrowserNode::GetRecordingStorageModeAsString(int recordingStorageMode)
+{
+  switch (recordingStorageMode)
+  {
+    case vtkMRMLSequenceBrowserNode::RecordingStorageFullCopy: return "fullCopy";
+    case vtkMRMLSequenceBrowserNode::RecordingStorageDelta: return "delta";
+    default:
+      return "";
+  }
+}
+
+//-----------------------------------------------------------
+int vtkMRMLSequenceBrowserNode::GetRecordingStorageModeFromString(const std::string& recordingStorageModeString)
+{
+  for (int i = 0; i<vtkMRMLSequenceBrowserNode::NumberOfRecordingStorageModes; i++)
+  {
+    if (recordingStorageModeString == GetRecordingStorageModeAsString(i))
+    {
+      // found it
+      return i;
+    }
+  }
+  return -1;
+}
+
 //-----------------------------------------------------------
 std::string vtkMRMLSequenceBrowserNode::GetMissingItemModeAsString(int missingItemMode)
 {
@@ -62,6 +62,14 @@ public:
     NumberOfRecordingSamplingModes // this line must be the last one
   };
 
+  /// Modes for storing recorded proxy node states in the sequences.
+  enum RecordingStorageModeType
+  {
+    RecordingStorageFullCopy = 0, ///< each recorded item is a full copy of the proxy node (this is the default mode)
+    RecordingStorageDelta, ///< only changed proxy nodes are copied, unchanged ones refer to the previously recorded item
+    NumberOfRecordingStorageModes // this line must be the last one
+  };
+
   /// Specify what happens when during sequence browsing if a sequence does not contain an item for the
   /// current index.
   enum MissingItemModeType
@@ -162,6 +170,26 @@ public:
   vtkBooleanMacro(PlaybackLooped, bool);
   //@}
 
+  //@{
+  /// Get/Set number of items that are prepared in the background during playback,
+  /// ahead of the selected item (for example, frames that are loaded on demand from file).
+  /// Set to 0 to disable prefetching. Default is 2.
+  vtkGetMacro(PlaybackPrefetchItemCount, int);
+  vtkSetClampMacro(PlaybackPrefetchItemCount, int, 0, VTK_INT_MAX);
+  //@}
+
+  //@{
+  /// Playback statistics.
+  /// PlaybackDroppedFrameCount is the number of items that were skipped since playback started
+  /// because the requested playback rate could not be reached.
+  /// PlaybackAchievedRateFps is the number of items displayed per second, measured over the last second.
+  /// Statistics are updated by the sequences logic and changes do not invoke modified events.
+  vtkGetMacro(PlaybackDroppedFrameCount, int);
+  vtkGetMacro(PlaybackAchievedRateFps, double);
+  void ResetPlaybackStatistics();
+  void RecordPlaybackFrame(double timeSec, int numberOfDroppedFrames);
+  //@}
+
   //@{
   /// Get/Set selected item number. Item number is an integer between 0 and (NumberOfItems - 1).
   vtkGetMacro(SelectedItemNumber, int);
@@ -202,6 +230,38 @@ public:
   static int GetRecordingSamplingModeFromString(const std::string &recordingSamplingModeString);
   //@}
 
+  //@{
+  /// Get/set how recorded proxy node states are stored.
+  /// In RecordingStorageDelta mode a proxy node that has not changed since it was last recorded
+  /// is not copied, but the new item refers to the data node of the previous item.
+  /// If only the properties of a volume changed (for example, its position) but not the voxels
+  /// then the new item shares the image data with the previous item.
+  /// This greatly reduces memory usage when proxy nodes are updated at different rates
+  /// (for example, when a tracked transform and a live image are recorded).
+  /// \sa vtkMRMLSequenceNode::SetDataNodeAtValueFromItem
+  vtkSetMacro(RecordingStorageMode, int);
+  void SetRecordingStorageModeFromString(const char *recordingStorageModeString);
+  vtkGetMacro(RecordingStorageMode, int);
+  virtual std::string GetRecordingStorageModeAsString();
+  //@}
+
+  //@{
+  /// Helper functions for converting between string and code representation of recording storage modes
+  static std::string GetRecordingStorageModeAsString(int recordingStorageMode);
+  static int GetRecordingStorageModeFromString(const std::string &recordingStorageModeString);
+  //@}
+
+  //@{
+  /// Get/set the duration (in seconds) of the recording buffer.
+  /// If the value is positive then only the items that were recorded during the last
+  /// RecordingBufferDurationSec seconds are kept in the recorded sequences
+  /// (older items are removed in batches, therefore the buffer may temporarily exceed
+  /// the duration by 10%). Only applies to continuous recording into sequences with numeric index.
+  /// Set to 0 to keep all items. Default is 0.
+  vtkGetMacro(RecordingBufferDurationSec, double);
+  vtkSetClampMacro(RecordingBufferDurationSec, double, 0.0, VTK_DOUBLE_MAX);
+  //@}
+
   //@{
   /// Helper functions for converting between string and code representation of recording sampling modes
   static std::string GetMissingItemModeAsString(int missingItemMode);
@@ -386,18 +446,33 @@ protected:
   std::string GetSynchronizationPostfixFromSequence(vtkMRMLSequenceNode* sequenceNode);
   std::string GetSynchronizationPostfixFromSequenceID(const char* sequenceNodeID);
 
+  /// Record the current state of the proxy node into the sequence at the specified index value,
+  /// according to the current recording storage mode.
+  void SaveProxyNodeState(vtkMRMLSequenceNode* sequenceNode, const std::string& indexValue);
+
+  /// Remove items that are older than RecordingBufferDurationSec from the recorded sequences.
+  void RemoveItemsOutsideRecordingBuffer(const std::vector< vtkMRMLSequenceNode* >& sequenceNodes, double latestIndexValue);
+
 protected:
   bool PlaybackActive{false};
   double PlaybackRateFps{10.0};
   bool PlaybackItemSkippingEnabled{true};
   bool PlaybackLooped{true};
+  int PlaybackPrefetchItemCount{2};
   int SelectedItemNumber{-1};
 
+  int PlaybackDroppedFrameCount{0};
+  double PlaybackAchievedRateFps{0.0};
+  double PlaybackRateMeasurementStartTimeSec{-1.0};
+  int PlaybackRateMeasurementFrameCount{0};
+
   bool RecordingActive{false};
   double RecordingTimeOffsetSec; // difference between universal time and index value
   double LastSaveProxyNodesStateTimeSec;
   bool RecordMasterOnly{false};
   int RecordingSamplingMode{vtkMRMLSequenceBrowserNode::SamplingLimitedToPlaybackFrameRate};
+  int RecordingStorageMode{vtkMRMLSequenceBrowserNode::RecordingStorageFullCopy};
+  double RecordingBufferDurationSec{0.0};
   int IndexDisplayMode{vtkMRMLSequenceBrowserNode::IndexDisplayAsIndexValue};
   std::string IndexDisplayFormat;
 
@@ -20,6 +20,7 @@
 
 // MRML includes
 #include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLSequenceBrowserNode.h"
@@ -27,7 +28,11 @@
 #include "vtkSlicerSequencesLogic.h"
 
 // VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkPointData.h>
 
 namespace
 {
@@ -212,6 +217,171 @@ int TestRemoveItem()
   return EXIT_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+int TestPlaybackStatistics()
+{
+  vtkNew<vtkMRMLSequenceBrowserNode> browserNode;
+  CHECK_INT(browserNode->GetPlaybackPrefetchItemCount(), 2);
+  browserNode->SetPlaybackPrefetchItemCount(-1);
+  CHECK_INT(browserNode->GetPlaybackPrefetchItemCount(), 0);
+
+  // 10 frames per second, 2 frames dropped at every second frame
+  browserNode->ResetPlaybackStatistics();
+  for (int frameIndex = 0; frameIndex <= 20; ++frameIndex)
+  {
+    browserNode->RecordPlaybackFrame(100.0 + frameIndex * 0.1, (frameIndex % 2) * 2);
+  }
+  CHECK_INT(browserNode->GetPlaybackDroppedFrameCount(), 20);
+  CHECK_DOUBLE_TOLERANCE(browserNode->GetPlaybackAchievedRateFps(), 10.0, 0.01);
+
+  browserNode->ResetPlaybackStatistics();
+  CHECK_INT(browserNode->GetPlaybackDroppedFrameCount(), 0);
+  CHECK_DOUBLE(browserNode->GetPlaybackAchievedRateFps(), 0.0);
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestDeltaRecording()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLSequenceBrowserNode> browserNode;
+  scene->AddNode(browserNode);
+  CHECK_INT(browserNode->GetRecordingStorageMode(), vtkMRMLSequenceBrowserNode::RecordingStorageFullCopy);
+  CHECK_INT(vtkMRMLSequenceBrowserNode::GetRecordingStorageModeFromString(
+    vtkMRMLSequenceBrowserNode::GetRecordingStorageModeAsString(vtkMRMLSequenceBrowserNode::RecordingStorageDelta)),
+    vtkMRMLSequenceBrowserNode::RecordingStorageDelta);
+  browserNode->SetRecordingStorageModeFromString("delta");
+  CHECK_INT(browserNode->GetRecordingStorageMode(), vtkMRMLSequenceBrowserNode::RecordingStorageDelta);
+
+  vtkNew<vtkMRMLSequenceNode> transformSequenceNode;
+  transformSequenceNode->SetName("TransformSequence");
+  scene->AddNode(transformSequenceNode);
+  vtkNew<vtkMRMLSequenceNode> volumeSequenceNode;
+  volumeSequenceNode->SetName("VolumeSequence");
+  scene->AddNode(volumeSequenceNode);
+  browserNode->SetAndObserveMasterSequenceNodeID(transformSequenceNode->GetID());
+  browserNode->AddSynchronizedSequenceNodeID(volumeSequenceNode->GetID());
+
+  vtkNew<vtkMRMLTransformNode> transformNode;
+  transformNode->SetName("Transform");
+  scene->AddNode(transformNode);
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName("Volume");
+  scene->AddNode(volumeNode);
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(4, 4, 4);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->Fill(0);
+  volumeNode->SetAndObserveImageData(imageData);
+
+  browserNode->AddProxyNode(transformNode, transformSequenceNode, false);
+  browserNode->AddProxyNode(volumeNode, volumeSequenceNode, false);
+  browserNode->SetRecording(transformSequenceNode, true);
+  browserNode->SetRecording(volumeSequenceNode, true);
+
+  // First item is a full copy
+  browserNode->SaveProxyNodesState();
+  CHECK_INT(transformSequenceNode->GetNumberOfDataNodes(), 1);
+  CHECK_INT(volumeSequenceNode->GetNumberOfDataNodes(), 1);
+
+  // Only the transform changed, the volume item refers to the previous data node
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, 10.0);
+  transformNode->SetMatrixTransformToParent(matrix);
+  browserNode->SaveProxyNodesState();
+  CHECK_INT(transformSequenceNode->GetNumberOfDataNodes(), 2);
+  CHECK_INT(volumeSequenceNode->GetNumberOfDataNodes(), 2);
+  CHECK_BOOL(transformSequenceNode->IsNthDataNodeShared(1), false);
+  CHECK_BOOL(volumeSequenceNode->IsNthDataNodeShared(1), true);
+  CHECK_POINTER(volumeSequenceNode->GetNthDataNode(1), volumeSequenceNode->GetNthDataNode(0));
+
+  // Only the volume geometry changed, the new item shares the voxels with the previous item
+  volumeNode->SetOrigin(5.0, 0.0, 0.0);
+  browserNode->SaveProxyNodesState();
+  vtkMRMLScalarVolumeNode* volumeItem1 = vtkMRMLScalarVolumeNode::SafeDownCast(volumeSequenceNode->GetNthDataNode(1));
+  vtkMRMLScalarVolumeNode* volumeItem2 = vtkMRMLScalarVolumeNode::SafeDownCast(volumeSequenceNode->GetNthDataNode(2));
+  CHECK_NOT_NULL(volumeItem2);
+  CHECK_POINTER_DIFFERENT(volumeItem2, volumeItem1);
+  CHECK_POINTER(volumeItem2->GetImageData(), volumeItem1->GetImageData());
+  CHECK_DOUBLE(volumeItem2->GetOrigin()[0], 5.0);
+  CHECK_DOUBLE(volumeItem1->GetOrigin()[0], 0.0);
+
+  // Editing the voxels of an unshared item (as it is done before saving changes of the proxy node)
+  // does not change the voxels of the item it was recorded from
+  CHECK_BOOL(volumeSequenceNode->IsNthDataNodeShared(2), false);
+  CHECK_POINTER(volumeSequenceNode->UnshareNthDataNode(2), volumeItem2);
+  CHECK_POINTER_DIFFERENT(volumeItem2->GetImageData(), volumeItem1->GetImageData());
+  volumeItem2->GetImageData()->SetScalarComponentFromDouble(1, 0, 0, 0, 50.0);
+  CHECK_DOUBLE(volumeItem2->GetImageData()->GetScalarComponentAsDouble(1, 0, 0, 0), 50.0);
+  CHECK_DOUBLE(volumeItem1->GetImageData()->GetScalarComponentAsDouble(1, 0, 0, 0), 0.0);
+  CHECK_DOUBLE(vtkMRMLScalarVolumeNode::SafeDownCast(volumeSequenceNode->GetNthDataNode(0))
+    ->GetImageData()->GetScalarComponentAsDouble(1, 0, 0, 0), 0.0);
+
+  // Voxels changed, the new item gets its own copy
+  imageData->GetPointData()->GetScalars()->SetTuple1(0, 100);
+  imageData->Modified();
+  browserNode->SaveProxyNodesState();
+  vtkMRMLScalarVolumeNode* volumeItem3 = vtkMRMLScalarVolumeNode::SafeDownCast(volumeSequenceNode->GetNthDataNode(3));
+  CHECK_NOT_NULL(volumeItem3);
+  CHECK_POINTER_DIFFERENT(volumeItem3->GetImageData(), volumeItem2->GetImageData());
+  CHECK_POINTER_DIFFERENT(volumeItem3->GetImageData(), imageData.GetPointer());
+  CHECK_DOUBLE(volumeItem3->GetImageData()->GetScalarComponentAsDouble(0, 0, 0, 0), 100.0);
+  CHECK_DOUBLE(volumeItem2->GetImageData()->GetScalarComponentAsDouble(0, 0, 0, 0), 0.0);
+
+  // Updating a shared item does not change the other items
+  vtkMRMLNode* volumeItem0 = volumeSequenceNode->GetNthDataNode(0);
+  volumeSequenceNode->UpdateDataNodeAtValue(volumeNode, volumeSequenceNode->GetNthIndexValue(0));
+  CHECK_BOOL(volumeSequenceNode->IsNthDataNodeShared(0), false);
+  CHECK_BOOL(volumeSequenceNode->IsNthDataNodeShared(1), false);
+  CHECK_POINTER(volumeSequenceNode->GetNthDataNode(1), volumeItem0);
+  CHECK_DOUBLE(vtkMRMLScalarVolumeNode::SafeDownCast(volumeItem0)->GetOrigin()[0], 0.0);
+
+  // Removing an item keeps the data node if other items still use it
+  volumeSequenceNode->SetDataNodeAtValueFromItem(1, "100");
+  volumeSequenceNode->RemoveNthDataNode(1);
+  CHECK_INT(volumeSequenceNode->GetNumberOfDataNodes(), 4);
+  CHECK_POINTER(volumeSequenceNode->GetNthDataNode(3), volumeItem0);
+  CHECK_NOT_NULL(volumeItem0->GetScene());
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestRecordingBuffer()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLSequenceBrowserNode> browserNode;
+  scene->AddNode(browserNode);
+  CHECK_DOUBLE(browserNode->GetRecordingBufferDurationSec(), 0.0);
+  browserNode->SetRecordingBufferDurationSec(4.5);
+  browserNode->SetRecordingSamplingMode(vtkMRMLSequenceBrowserNode::SamplingAll);
+
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  sequenceNode->SetName("TransformSequence");
+  scene->AddNode(sequenceNode);
+  vtkNew<vtkMRMLTransformNode> transformNode;
+  transformNode->SetName("Transform");
+  scene->AddNode(transformNode);
+  for (int i = 0; i <= 10; i++)
+  {
+    sequenceNode->SetDataNodeAtValue(transformNode, std::to_string(i));
+  }
+  browserNode->SetAndObserveMasterSequenceNodeID(sequenceNode->GetID());
+  browserNode->AddProxyNode(transformNode, sequenceNode, false);
+  browserNode->SetRecording(sequenceNode, true);
+
+  // Recording continues from the last index value, items older than 4.5 seconds are removed
+  browserNode->SetRecordingActive(true);
+  browserNode->SaveProxyNodesState();
+  browserNode->SetRecordingActive(false);
+  CHECK_STD_STRING(sequenceNode->GetNthIndexValue(0), "6");
+  CHECK_BOOL(sequenceNode->GetNumberOfDataNodes() >= 5, true);
+
+  return EXIT_SUCCESS;
+}
+
 }  // end anonymous namespace
 
 int vtkMRMLSequenceBrowserNodeTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
@@ -219,5 +389,8 @@ int vtkMRMLSequenceBrowserNodeTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)
   CHECK_EXIT_SUCCESS(TestIndexFormatting());
   CHECK_EXIT_SUCCESS(TestSelectNextItem());
   CHECK_EXIT_SUCCESS(TestRemoveItem());
+  CHECK_EXIT_SUCCESS(TestPlaybackStatistics());
+  CHECK_EXIT_SUCCESS(TestDeltaRecording());
+  CHECK_EXIT_SUCCESS(TestRecordingBuffer());
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,155 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include <vtkMRMLScriptedModuleNode.h>
+#include <vtkMRMLSequenceNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <sstream>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+std::string GetIndexValue(int itemNumber)
+{
+  std::ostringstream indexStr;
+  indexStr << itemNumber * 0.5;
+  return indexStr.str();
+}
+
+//---------------------------------------------------------------------------
+int TestIndexConsistency()
+{
+  vtkNew<vtkMRMLSequenceNode> seqNode;
+  seqNode->SetIndexType(vtkMRMLSequenceNode::NumericIndex);
+  vtkNew<vtkMRMLScriptedModuleNode> dataNode;
+
+  // Items added in random order are sorted
+  seqNode->SetDataNodeAtValue(dataNode, "20");
+  seqNode->SetDataNodeAtValue(dataNode, "10");
+  seqNode->SetDataNodeAtValue(dataNode, "30");
+  seqNode->SetDataNodeAtValue(dataNode, "15");
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("10"), 0);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("15"), 1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("30"), 3);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("16"), -1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("16", false), 1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("100", false), 3);
+
+  // Appended item is found
+  seqNode->SetDataNodeAtValue(dataNode, "40");
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("40"), 4);
+
+  // Removed items are not found anymore, following items are shifted
+  seqNode->RemoveDataNodeAtValue("40");
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("40"), -1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("40", false), 3);
+  seqNode->RemoveDataNodeAtValue("10");
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("15"), 0);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("30"), 2);
+
+  // Changed index value
+  CHECK_BOOL(seqNode->UpdateIndexValue("15", "35"), true);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("15"), -1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("35"), 2);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("20"), 0);
+
+  // Text index
+  vtkNew<vtkMRMLSequenceNode> textSeqNode;
+  textSeqNode->SetIndexType(vtkMRMLSequenceNode::TextIndex);
+  textSeqNode->SetDataNodeAtValue(dataNode, "b");
+  textSeqNode->SetDataNodeAtValue(dataNode, "a");
+  CHECK_INT(textSeqNode->GetItemNumberFromIndexValue("b"), 0);
+  CHECK_INT(textSeqNode->GetItemNumberFromIndexValue("a"), 1);
+  CHECK_INT(textSeqNode->GetItemNumberFromIndexValue("c"), -1);
+  CHECK_BOOL(textSeqNode->UpdateIndexValue("b", "c"), true);
+  CHECK_INT(textSeqNode->GetItemNumberFromIndexValue("c"), 0);
+  CHECK_INT(textSeqNode->GetItemNumberFromIndexValue("b"), -1);
+
+  // Copied sequence
+  vtkNew<vtkMRMLSequenceNode> copiedSeqNode;
+  copiedSeqNode->CopySequenceIndex(seqNode);
+  CHECK_INT(copiedSeqNode->GetItemNumberFromIndexValue("35"), 2);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestIndexPerformance(int numberOfItems)
+{
+  vtkNew<vtkMRMLSequenceNode> seqNode;
+  seqNode->SetIndexType(vtkMRMLSequenceNode::NumericIndex);
+  vtkNew<vtkMRMLScriptedModuleNode> dataNode;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfItems; ++i)
+  {
+    seqNode->SetDataNodeAtValue(dataNode, GetIndexValue(i));
+  }
+  timer->StopTimer();
+  std::cout << "Add " << numberOfItems << " items: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_INT(seqNode->GetNumberOfDataNodes(), numberOfItems);
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfItems; ++i)
+  {
+    CHECK_INT(seqNode->GetItemNumberFromIndexValue(GetIndexValue(i)), i);
+  }
+  timer->StopTimer();
+  std::cout << "Find " << numberOfItems << " items by exact numeric index: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfItems - 1; ++i)
+  {
+    std::ostringstream indexStr;
+    indexStr << i * 0.5 + 0.2;
+    CHECK_INT(seqNode->GetItemNumberFromIndexValue(indexStr.str(), false), i);
+  }
+  timer->StopTimer();
+  std::cout << "Find " << numberOfItems << " items by nearest numeric index: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  seqNode->SetIndexType(vtkMRMLSequenceNode::TextIndex);
+  timer->StartTimer();
+  for (int i = 0; i < numberOfItems; ++i)
+  {
+    CHECK_INT(seqNode->GetItemNumberFromIndexValue(GetIndexValue(i)), i);
+  }
+  timer->StopTimer();
+  std::cout << "Find " << numberOfItems << " items by text index: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSequenceNodeIndexTest(int argc, char* argv[])
+{
+  int numberOfItems = 100000;
+  if (argc > 1)
+  {
+    numberOfItems = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestIndexConsistency());
+  CHECK_EXIT_SUCCESS(TestIndexPerformance(numberOfItems));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/*==============================================================================
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSequenceNode.h>
+#include <vtkMRMLVolumeSequenceStorageNode.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <sstream>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+namespace
+{
+
+const int NumberOfFrames = 6;
+
+//-----------------------------------------------------------------------------
+short GetFrameVoxelValue(vtkMRMLSequenceNode* sequenceNode, int frameIndex)
+{
+  vtkMRMLScalarVolumeNode* frameVolume = vtkMRMLScalarVolumeNode::SafeDownCast(sequenceNode->GetNthDataNode(frameIndex));
+  if (!frameVolume || !frameVolume->GetImageData())
+  {
+    return -1;
+  }
+  return *static_cast<short*>(frameVolume->GetImageData()->GetScalarPointer(3, 2, 1));
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLSequenceNode* CreateSequence(vtkMRMLScene* scene)
+{
+  vtkMRMLSequenceNode* sequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  for (int frameIndex = 0; frameIndex < NumberOfFrames; ++frameIndex)
+  {
+    vtkNew<vtkImageData> image;
+    image->SetDimensions(64, 64, 16);
+    image->AllocateScalars(VTK_SHORT, 1);
+    image->GetPointData()->GetScalars()->Fill(frameIndex * 10);
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    volumeNode->SetAndObserveImageData(image);
+    volumeNode->SetSpacing(1.5, 1.5, 3.0);
+    std::ostringstream indexStr;
+    indexStr << frameIndex * 0.5;
+    sequenceNode->SetDataNodeAtValue(volumeNode, indexStr.str());
+  }
+  return sequenceNode;
+}
+
+//-----------------------------------------------------------------------------
+int TestOnDemandLoading(vtkMRMLScene* scene, vtkMRMLSequenceNode* sequenceNode,
+  const std::string& fileName, bool compressed)
+{
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> writerStorageNode;
+  scene->AddNode(writerStorageNode);
+  writerStorageNode->SetOnDemandFrameLoading(true);
+  writerStorageNode->SetUseCompression(compressed);
+  writerStorageNode->SetCompressionParameter(writerStorageNode->GetCompressionParameterFastestParallel());
+  writerStorageNode->SetFileName(fileName.c_str());
+  CHECK_INT(writerStorageNode->WriteData(sequenceNode), 1);
+
+  vtkMRMLSequenceNode* readSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> storageNode;
+  scene->AddNode(storageNode);
+  storageNode->SetOnDemandFrameLoading(true);
+  storageNode->SetFileName(fileName.c_str());
+  CHECK_INT(storageNode->ReadData(readSequenceNode), 1);
+  CHECK_INT(readSequenceNode->GetNumberOfDataNodes(), NumberOfFrames);
+  CHECK_BOOL(readSequenceNode->GetOnDemandFrameLoader() == storageNode.GetPointer(), true);
+  CHECK_STD_STRING(readSequenceNode->GetNthIndexValue(3), sequenceNode->GetNthIndexValue(3));
+  // No frames are loaded yet
+  CHECK_INT(static_cast<int>(storageNode->GetFrameCacheMemorySize()), 0);
+  // Checking whether the sequence can be written does not load frames
+  CHECK_BOOL(storageNode->CanWriteFromReferenceNode(readSequenceNode), true);
+  CHECK_INT(static_cast<int>(storageNode->GetFrameCacheMemorySize()), 0);
+  CHECK_NULL(vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(1, false))->GetImageData());
+
+  // Allow loading of 2 frames
+  vtkMRMLScalarVolumeNode* firstFrame = vtkMRMLScalarVolumeNode::SafeDownCast(sequenceNode->GetNthDataNode(0));
+  unsigned long frameMemorySize = firstFrame->GetImageData()->GetActualMemorySize();
+  storageNode->SetMaximumFrameCacheMemorySize(frameMemorySize * 2 + frameMemorySize / 2);
+
+  for (int frameIndex = NumberOfFrames - 1; frameIndex >= 0; --frameIndex)
+  {
+    CHECK_INT(GetFrameVoxelValue(readSequenceNode, frameIndex), frameIndex * 10);
+    CHECK_BOOL(storageNode->GetFrameCacheMemorySize() <= storageNode->GetMaximumFrameCacheMemorySize(), true);
+  }
+
+  // Prefetched frames are loaded in the background, then used when the frame is accessed
+  readSequenceNode->PrefetchDataNodes({ 3, 4, 100 });
+  readSequenceNode->PrefetchDataNodes({ 4 });
+  CHECK_INT(GetFrameVoxelValue(readSequenceNode, 4), 40);
+  CHECK_INT(GetFrameVoxelValue(readSequenceNode, 3), 30);
+  CHECK_BOOL(storageNode->GetFrameCacheMemorySize() <= storageNode->GetMaximumFrameCacheMemorySize(), true);
+
+  // Geometry is restored
+  vtkMRMLScalarVolumeNode* readFrame = vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetDataNodeAtValue("1"));
+  CHECK_NOT_NULL(readFrame);
+  CHECK_DOUBLE(readFrame->GetSpacing()[2], 3.0);
+  CHECK_INT(readFrame->GetImageData()->GetDimensions()[0], 64);
+
+  // Modified frame is not unloaded
+  readFrame->GetImageData()->GetPointData()->GetScalars()->Fill(123);
+  readFrame->GetImageData()->GetPointData()->GetScalars()->Modified();
+  for (int frameIndex = 0; frameIndex < NumberOfFrames; ++frameIndex)
+  {
+    if (frameIndex != 2)
+    {
+      GetFrameVoxelValue(readSequenceNode, frameIndex);
+    }
+  }
+  CHECK_INT(GetFrameVoxelValue(readSequenceNode, 2), 123);
+
+  // Copy contains all frames
+  vtkNew<vtkMRMLSequenceNode> copiedSequenceNode;
+  copiedSequenceNode->Copy(readSequenceNode);
+  CHECK_NULL(copiedSequenceNode->GetOnDemandFrameLoader());
+  CHECK_INT(GetFrameVoxelValue(copiedSequenceNode, 4), 40);
+
+  // Saving into the file that frames are loaded from keeps all frames,
+  // and frames are loaded on demand from the new file
+  storageNode->SetUseCompression(compressed);
+  storageNode->SetCompressionParameter(storageNode->GetCompressionParameterFastestParallel());
+  CHECK_INT(storageNode->WriteData(readSequenceNode), 1);
+  CHECK_BOOL(readSequenceNode->GetOnDemandFrameLoader() == storageNode.GetPointer(), true);
+  CHECK_BOOL(storageNode->GetFrameCacheMemorySize() <= storageNode->GetMaximumFrameCacheMemorySize(), true);
+  for (int frameIndex = NumberOfFrames - 1; frameIndex >= 0; --frameIndex)
+  {
+    CHECK_INT(GetFrameVoxelValue(readSequenceNode, frameIndex), frameIndex == 2 ? 123 : frameIndex * 10);
+  }
+
+  vtkMRMLSequenceNode* savedSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> savedStorageNode;
+  scene->AddNode(savedStorageNode);
+  savedStorageNode->SetFileName(fileName.c_str());
+  CHECK_INT(savedStorageNode->ReadData(savedSequenceNode), 1);
+  CHECK_INT(savedSequenceNode->GetNumberOfDataNodes(), NumberOfFrames);
+  for (int frameIndex = 0; frameIndex < NumberOfFrames; ++frameIndex)
+  {
+    CHECK_INT(GetFrameVoxelValue(savedSequenceNode, frameIndex), frameIndex == 2 ? 123 : frameIndex * 10);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLVolumeSequenceStorageNodeOnDemandTest(int argc, char* argv[])
+{
+  std::string tempDir = ".";
+  if (argc > 1)
+  {
+    tempDir = argv[1];
+  }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSequenceNode* sequenceNode = CreateSequence(scene);
+
+  CHECK_EXIT_SUCCESS(TestOnDemandLoading(scene, sequenceNode, tempDir + "/OnDemandRaw.seq.nrrd", false));
+  CHECK_EXIT_SUCCESS(TestOnDemandLoading(scene, sequenceNode, tempDir + "/OnDemandCompressed.seq.nrrd", true));
+
+  // Frames written by default are interleaved, therefore they are loaded into memory
+  std::string interleavedFileName = tempDir + "/OnDemandInterleaved.seq.nrrd";
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> writerStorageNode;
+  scene->AddNode(writerStorageNode);
+  writerStorageNode->SetFileName(interleavedFileName.c_str());
+  CHECK_INT(writerStorageNode->WriteData(sequenceNode), 1);
+
+  vtkMRMLSequenceNode* readSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> storageNode;
+  scene->AddNode(storageNode);
+  storageNode->SetOnDemandFrameLoading(true);
+  storageNode->SetFileName(interleavedFileName.c_str());
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  CHECK_INT(storageNode->ReadData(readSequenceNode), 1);
+  TESTING_OUTPUT_ASSERT_WARNINGS_END();
+  CHECK_NULL(readSequenceNode->GetOnDemandFrameLoader());
+  CHECK_INT(readSequenceNode->GetNumberOfDataNodes(), NumberOfFrames);
+  CHECK_INT(GetFrameVoxelValue(readSequenceNode, 5), 50);
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
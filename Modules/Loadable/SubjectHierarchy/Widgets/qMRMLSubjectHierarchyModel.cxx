@@ -58,6 +58,14 @@
 #include "qSlicerSubjectHierarchyAbstractPlugin.h"
 #include "qSlicerSubjectHierarchyDefaultPlugin.h"
 
+// VTK includes
+#include <vtkIdList.h>
+
+// STD includes
+#include <algorithm>
+#include <set>
+#include <vector>
+
 
 //------------------------------------------------------------------------------
 qMRMLSubjectHierarchyModelPrivate::qMRMLSubjectHierarchyModelPrivate(qMRMLSubjectHierarchyModel& object)
@@ -301,6 +309,7 @@ void qMRMLSubjectHierarchyModel::setSubjectHierarchyNode(vtkMRMLSubjectHierarchy
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemTransformModifiedEvent, d->CallBack, -10.0);
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemDisplayModifiedEvent, d->CallBack, -10.0);
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, d->CallBack, -10.0);
+    shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemsBatchModifiedEvent, d->CallBack, -10.0);
   }
 }
 
@@ -1435,7 +1444,7 @@ void qMRMLSubjectHierarchyModel::onEvent(
 
   // Get item ID for subject hierarchy node events
   vtkIdType itemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
-  if (callData)
+  if (callData && event != vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemsBatchModifiedEvent)
   {
     vtkIdType* itemIdPtr = reinterpret_cast<vtkIdType*>(callData);
     if (itemIdPtr)
@@ -1464,6 +1473,9 @@ void qMRMLSubjectHierarchyModel::onEvent(
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
       sceneModel->onSubjectHierarchyItemModified(itemID);
       break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemsBatchModifiedEvent:
+      sceneModel->onSubjectHierarchyItemsBatchModified(reinterpret_cast<vtkIdList*>(callData));
+      break;
     case vtkMRMLScene::EndImportEvent:
       sceneModel->onMRMLSceneImported(scene);
       break;
@@ -1559,6 +1571,44 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemModified(vtkIdType itemID
   this->updateModelItems(itemID);
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemsBatchModified(vtkIdList* itemIDs)
+{
+  Q_D(qMRMLSubjectHierarchyModel);
+  if (!itemIDs || !d->SubjectHierarchyNode)
+  {
+    return;
+  }
+
+  // Order items by depth so that parents are in their final place when the children are updated
+  vtkIdType sceneItemID = d->SubjectHierarchyNode->GetSceneItemID();
+  std::vector<std::pair<int, vtkIdType> > itemsByDepth;
+  std::set<vtkIdType> processedItemIDs;
+  for (vtkIdType index = 0; index < itemIDs->GetNumberOfIds(); ++index)
+  {
+    vtkIdType itemID = itemIDs->GetId(index);
+    if (!processedItemIDs.insert(itemID).second)
+    {
+      continue;
+    }
+    int depth = 0;
+    for (vtkIdType parentItemID = d->SubjectHierarchyNode->GetItemParent(itemID);
+      parentItemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID && parentItemID != sceneItemID;
+      parentItemID = d->SubjectHierarchyNode->GetItemParent(parentItemID))
+    {
+      ++depth;
+    }
+    itemsByDepth.emplace_back(depth, itemID);
+  }
+  std::stable_sort(itemsByDepth.begin(), itemsByDepth.end(),
+    [](const std::pair<int, vtkIdType>& a, const std::pair<int, vtkIdType>& b) { return a.first < b.first; });
+
+  for (const std::pair<int, vtkIdType>& item : itemsByDepth)
+  {
+    this->updateModelItems(item.second);
+  }
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSubjectHierarchyModel::onMRMLSceneImported(vtkMRMLScene* scene)
 {
@@ -37,6 +37,7 @@ class qMRMLSubjectHierarchyModelPrivate;
 class vtkMRMLSubjectHierarchyNode;
 class vtkMRMLNode;
 class vtkMRMLScene;
+class vtkIdList;
 
 /// \brief Item model for subject hierarchy
 ///
@@ -196,6 +197,9 @@ protected slots:
   virtual void onSubjectHierarchyItemAboutToBeRemoved(vtkIdType itemID);
   virtual void onSubjectHierarchyItemRemoved(vtkIdType itemID);
   virtual void onSubjectHierarchyItemModified(vtkIdType itemID);
+  /// Update the model items of all items modified in a subject hierarchy batch modify.
+  /// Parents are updated before their children so that reparenting is applied top-down.
+  virtual void onSubjectHierarchyItemsBatchModified(vtkIdList* itemIDs);
 
   virtual void onMRMLSceneImported(vtkMRMLScene* scene);
   virtual void onMRMLSceneClosed(vtkMRMLScene* scene);